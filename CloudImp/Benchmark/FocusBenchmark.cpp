@@ -0,0 +1,148 @@
+#ifdef CLOUDIMP_STANDALONE
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+#include <vector>
+#include "../Server/FocusData.h"
+#include "../Server/FocusFramer.h"
+#include "../FocusTrace/FocusRect.h"
+
+/// rect set resembling a frame: few dynamic, some ui, many static rects on a 1920x1080 screen
+static void MakeRects(int count, unsigned int seed, std::vector<FocusRectInfo*>& outRects)
+{
+	srand(seed);
+	for (int i = 0; i < count; i++)
+	{
+		FocusRectInfo* rectInfo = new FocusRectInfo();
+		int kind = i % 8;
+		rectInfo->priority = kind == 0 ? 255 : (kind == 1 ? 128 : rand() % 128);
+		float width = 20.0f + rand() % 300;
+		float height = 20.0f + rand() % 200;
+		rectInfo->left = (float)(rand() % 1900);
+		rectInfo->top = (float)(rand() % 1060);
+		rectInfo->right = rectInfo->left + width;
+		rectInfo->bottom = rectInfo->top + height;
+		rectInfo->distToCam = rectInfo->priority == 128 ? 0.0f : 100.0f + rand() % 5000;
+		outRects.push_back(rectInfo);
+	}
+}
+
+static void FreeRects(std::vector<FocusRectInfo*>& rects)
+{
+	for (int i = 0; i < rects.size(); i++)
+	{
+		delete rects[i];
+	}
+	rects.clear();
+}
+
+static void BM_Serialize(benchmark::State& state)
+{
+	std::vector<FocusRectInfo*> rects;
+	MakeRects(state.range(0), 1, rects);
+	float camPos[3] = { 0.0f, 0.0f, 0.0f };
+	float camRot[3] = { 0.0f, 0.0f, 0.0f };
+	for (auto _ : state)
+	{
+		unsigned int size = 0;
+		unsigned char* buf = Serialize(&rects, camPos, camRot, false, 0.0f, false, &size);
+		benchmark::DoNotOptimize(buf);
+		delete[] buf;
+	}
+	state.SetItemsProcessed(state.iterations() * rects.size());
+	FreeRects(rects);
+}
+BENCHMARK(BM_Serialize)->Arg(16)->Arg(64)->Arg(256);
+
+static void BM_Deserialize(benchmark::State& state)
+{
+	std::vector<FocusRectInfo*> rects;
+	MakeRects(state.range(0), 1, rects);
+	float camPos[3] = { 0.0f, 0.0f, 0.0f };
+	float camRot[3] = { 0.0f, 0.0f, 0.0f };
+	unsigned int size = 0;
+	unsigned char* buf = Serialize(&rects, camPos, camRot, false, 0.0f, false, &size);
+	FocusInfo info;
+	for (auto _ : state)
+	{
+		Deserialize(buf, size, &info);
+		benchmark::DoNotOptimize(info.rectInfos.data());
+	}
+	state.SetItemsProcessed(state.iterations() * rects.size());
+	delete[] buf;
+	FreeRects(rects);
+}
+BENCHMARK(BM_Deserialize)->Arg(16)->Arg(64)->Arg(256);
+
+/// frame one packet, then feed it back in 512 byte reads as the socket senders do
+static void BM_Framing(benchmark::State& state)
+{
+	std::vector<FocusRectInfo*> rects;
+	MakeRects(state.range(0), 1, rects);
+	float camPos[3] = { 0.0f, 0.0f, 0.0f };
+	float camRot[3] = { 0.0f, 0.0f, 0.0f };
+	unsigned int size = 0;
+	unsigned char* buf = Serialize(&rects, camPos, camRot, false, 0.0f, false, &size);
+	FocusPacketFramer framer;
+	std::vector<Packet> packets;
+	for (auto _ : state)
+	{
+		unsigned int framedSize = 0;
+		unsigned char* framed = FocusPacketFramer::Frame(buf, size, &framedSize);
+		for (unsigned int offset = 0; offset < framedSize; offset += 512)
+		{
+			unsigned int chunk = framedSize - offset < 512 ? framedSize - offset : 512;
+			framer.Feed(framed + offset, chunk, packets);
+		}
+		for (int i = 0; i < packets.size(); i++)
+		{
+			delete[] packets[i].buf;
+		}
+		packets.clear();
+		delete[] framed;
+	}
+	state.SetBytesProcessed(state.iterations() * (size + FOCUS_FRAME_HEADER_SIZE));
+	delete[] buf;
+	FreeRects(rects);
+}
+BENCHMARK(BM_Framing)->Arg(16)->Arg(64)->Arg(256);
+
+static void BM_ClipOccludedRects(benchmark::State& state)
+{
+	std::vector<FocusRectInfo*> rects;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		MakeRects(state.range(0), 1, rects);
+		state.ResumeTiming();
+		FocusClipOccludedRects(rects);
+		benchmark::DoNotOptimize(rects.data());
+		state.PauseTiming();
+		FreeRects(rects);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ClipOccludedRects)->Arg(16)->Arg(64)->Arg(256);
+
+static void BM_MergeRects(benchmark::State& state)
+{
+	std::vector<FocusRectInfo*> rects;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		MakeRects(state.range(0), 1, rects);
+		state.ResumeTiming();
+		FocusMergeRects(rects);
+		benchmark::DoNotOptimize(rects.data());
+		state.PauseTiming();
+		FreeRects(rects);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MergeRects)->Arg(16)->Arg(64)->Arg(256);
+
+BENCHMARK_MAIN();
+
+#endif	/*CLOUDIMP_STANDALONE*/
@@ -0,0 +1,112 @@
+#include "FocusCaptureScheduler.h"
+
+FocusCaptureScheduler::FocusCaptureScheduler()
+{
+	nextJob = 0;
+	captureUI = true;
+	maxPerFrame = 1;
+	defaultInterval = 5.0f;
+	eventCooldown = 1.0f;
+	sinceEvent = eventCooldown;
+}
+
+void FocusCaptureScheduler::Add(FocusCaptureScreenBase* capture, float interval)
+{
+	Job job;
+	job.capture = capture;
+	job.useDefault = interval < 0.0f;
+	job.interval = job.useDefault ? defaultInterval : interval;
+	job.elapsed = 0.0f;
+	job.screenDue = false;
+	job.uiDue = false;
+	jobs.push_back(job);
+}
+
+void FocusCaptureScheduler::SetDefaultInterval(float interval)
+{
+	defaultInterval = interval;
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		if (jobs[i].useDefault)
+			jobs[i].interval = interval;
+	}
+}
+
+void FocusCaptureScheduler::Clear()
+{
+	jobs.clear();
+	nextJob = 0;
+}
+
+void FocusCaptureScheduler::Trigger()
+{
+	if (sinceEvent < eventCooldown)
+		return;
+	sinceEvent = 0.0f;
+
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		jobs[i].screenDue = true;
+		jobs[i].elapsed = 0.0f;
+	}
+}
+
+int FocusCaptureScheduler::GetPendingCount()
+{
+	int count = 0;
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		if (jobs[i].screenDue)
+			count++;
+		if (jobs[i].uiDue)
+			count++;
+	}
+	return count;
+}
+
+void FocusCaptureScheduler::Update(float DeltaSeconds)
+{
+	sinceEvent += DeltaSeconds;
+
+	std::vector<Job>::iterator iter;
+	for (iter = jobs.begin(); iter != jobs.end(); iter++)
+	{
+		iter->capture->Update();
+
+		if (iter->interval <= 0.0f)
+			continue;
+		iter->elapsed += DeltaSeconds;
+		if (iter->elapsed >= iter->interval)
+		{
+			iter->screenDue = true;
+			iter->elapsed = 0.0f;
+		}
+	}
+
+	/// ui capture of a job runs the frame after its screen capture
+	int executed = 0;
+	int count = jobs.size();
+	int start = nextJob;
+	for (int i = 0; i < count && executed < maxPerFrame; i++)
+	{
+		Job& job = jobs[(start + i) % count];
+		if (job.screenDue)
+		{
+			job.capture->CaptureScreenToDisk(outputPath.c_str());
+			job.screenDue = false;
+			job.uiDue = captureUI;
+			executed++;
+		}
+		else if (job.uiDue)
+		{
+			job.capture->CaptureUIToDisk(outputPath.c_str());
+			job.uiDue = false;
+			executed++;
+		}
+		else
+		{
+			continue;
+		}
+		nextJob = (start + i + 1) % count;
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef __FOCUS_CAPTURE_SCHEDULER_H__
+#define __FOCUS_CAPTURE_SCHEDULER_H__
+
+#include <vector>
+#include <string>
+#include "FocusTracer.h"
+
+/// decide which capture runs on which frame:
+///  - each capture has its own interval, 0 for event only, less than 0 to follow the default interval
+///  - Trigger() marks every capture due, e.g. on scene cut
+///  - at most maxPerFrame screen or ui captures execute per Update so GPU cost is spread
+class FocusCaptureScheduler
+{
+public:
+	FocusCaptureScheduler();
+	~FocusCaptureScheduler() {}
+
+	void SetOutputPath(const char* path) { outputPath = path != NULL ? path : ""; }
+	const char* GetOutputPath() { return outputPath.c_str(); }
+	void SetCaptureUI(bool enable) { captureUI = enable; }
+	void SetMaxPerFrame(int count) { maxPerFrame = count > 0 ? count : 1; }
+	void SetEventCooldown(float seconds) { eventCooldown = seconds; }
+
+	/// capture is owned by caller
+	void Add(FocusCaptureScreenBase* capture, float interval);
+	/// only changes captures added without an interval of their own
+	void SetDefaultInterval(float interval);
+	void Clear();
+
+	void Trigger();
+	void Update(float DeltaSeconds);
+
+	int GetPendingCount();
+
+private:
+	struct Job
+	{
+		FocusCaptureScreenBase* capture;
+		float interval;
+		bool useDefault;
+		float elapsed;
+		bool screenDue;
+		bool uiDue;
+	};
+
+	std::vector<Job> jobs;
+	int nextJob;			/// round robin start, keeps low rate captures from starving
+
+	std::string outputPath;
+	bool captureUI;
+	int maxPerFrame;
+	float defaultInterval;
+	float eventCooldown;
+	float sinceEvent;
+};
+
+#endif	/*__FOCUS_CAPTURE_SCHEDULER_H__*/
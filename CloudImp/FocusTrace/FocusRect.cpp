@@ -0,0 +1,171 @@
+#include "FocusRect.h"
+#include <math.h>
+#include <algorithm>
+
+static float RectArea(const FocusRectInfo* r)
+{
+	return (r->right - r->left) * (r->bottom - r->top);
+}
+
+static bool compareRectDist(FocusRectInfo* i1, FocusRectInfo* i2)
+{
+	return (i1->distToCam < i2->distToCam);
+}
+
+int FocusCheckOverlapped(const FocusRectInfo* a, const FocusRectInfo* b)
+{
+	return !(a->left >= b->right || a->right <= b->left || a->top >= b->bottom || a->bottom <= b->top);
+}
+
+int FocusClipRect(const FocusRectInfo* front, const FocusRectInfo* back, FocusRectInfo* temp)
+{
+	int ret = -1;
+	if (FocusCheckOverlapped(front, back) == 0)
+		return ret;
+
+	/// overlapped rect
+	ret = 0;
+	float left, top, right, bottom;
+	left = fmaxf(back->left, front->left);
+	top = fmaxf(back->top, front->top);
+	right = fminf(back->right, front->right);
+	bottom = fminf(back->bottom, front->bottom);
+
+	/// clip along each edge
+	float remainLeft = back->left;
+	float remainRight = back->right;
+	float remainTop = back->top;
+	float remainBottom = back->bottom;
+	/// top
+	if (top < remainBottom && top > remainTop)
+	{
+		temp[ret].top = remainTop;
+		temp[ret].bottom = top;
+		remainTop = top;
+		temp[ret].left = remainLeft;
+		temp[ret].right = remainRight;
+		temp[ret].distToCam = back->distToCam;
+		temp[ret].priority = back->priority;
+		ret++;
+	}
+	/// bottom
+	if (bottom < remainBottom && bottom > remainTop)
+	{
+		temp[ret].top = bottom;
+		temp[ret].bottom = remainBottom;
+		remainBottom = bottom;
+		temp[ret].left = remainLeft;
+		temp[ret].right = remainRight;
+		temp[ret].distToCam = back->distToCam;
+		temp[ret].priority = back->priority;
+		ret++;
+	}
+	/// left
+	if (left < remainRight && left > remainLeft)
+	{
+		temp[ret].left = remainLeft;
+		temp[ret].right = left;
+		remainLeft = left;
+		temp[ret].top = remainTop;
+		temp[ret].bottom = remainBottom;
+		temp[ret].distToCam = back->distToCam;
+		temp[ret].priority = back->priority;
+		ret++;
+	}
+	/// right
+	if (right < remainRight && right > remainLeft)
+	{
+		temp[ret].left = right;
+		temp[ret].right = remainRight;
+		remainRight = right;
+		temp[ret].top = remainTop;
+		temp[ret].bottom = remainBottom;
+		temp[ret].distToCam = back->distToCam;
+		temp[ret].priority = back->priority;
+		ret++;
+	}
+
+	return ret;
+}
+
+void FocusClipOccludedRects(std::vector<FocusRectInfo*>& rectInfos)
+{
+	std::stable_sort(rectInfos.begin(), rectInfos.end(), compareRectDist);
+
+	std::vector<FocusRectInfo*> visible;
+	std::vector<FocusRectInfo*> pieces;
+	std::vector<FocusRectInfo*> nextPieces;
+	FocusRectInfo temp[FOCUS_MAX_CLIP_PIECES];
+	for (int i = 0; i < rectInfos.size(); i++)
+	{
+		/// clip against every nearer visible piece
+		pieces.clear();
+		pieces.push_back(rectInfos[i]);
+		int frontCount = visible.size();
+		for (int f = 0; f < frontCount && !pieces.empty(); f++)
+		{
+			nextPieces.clear();
+			for (int p = 0; p < pieces.size(); p++)
+			{
+				int count = FocusClipRect(visible[f], pieces[p], temp);
+				if (count < 0)
+				{
+					nextPieces.push_back(pieces[p]);
+					continue;
+				}
+				for (int t = 0; t < count; t++)
+				{
+					nextPieces.push_back(new FocusRectInfo(temp[t]));
+				}
+				delete pieces[p];
+			}
+			pieces.swap(nextPieces);
+		}
+		visible.insert(visible.end(), pieces.begin(), pieces.end());
+	}
+	rectInfos.swap(visible);
+}
+
+void FocusMergeRects(std::vector<FocusRectInfo*>& rectInfos, float maxWaste)
+{
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (int i = 0; i < rectInfos.size(); i++)
+		{
+			FocusRectInfo* a = rectInfos[i];
+			for (int j = i + 1; j < rectInfos.size(); j++)
+			{
+				FocusRectInfo* b = rectInfos[j];
+				if (a->priority != b->priority)
+					continue;
+
+				FocusRectInfo bound;
+				bound.left = fminf(a->left, b->left);
+				bound.top = fminf(a->top, b->top);
+				bound.right = fmaxf(a->right, b->right);
+				bound.bottom = fmaxf(a->bottom, b->bottom);
+
+				float inter = 0.0f;
+				if (FocusCheckOverlapped(a, b))
+				{
+					inter = (fminf(a->right, b->right) - fmaxf(a->left, b->left)) * (fminf(a->bottom, b->bottom) - fmaxf(a->top, b->top));
+				}
+				float covered = RectArea(a) + RectArea(b) - inter;
+				if (RectArea(&bound) > covered * (1.0f + maxWaste))
+					continue;
+
+				a->left = bound.left;
+				a->top = bound.top;
+				a->right = bound.right;
+				a->bottom = bound.bottom;
+				a->distToCam = fminf(a->distToCam, b->distToCam);
+				delete b;
+				rectInfos.erase(rectInfos.begin() + j);
+				j--;
+				merged = true;
+			}
+		}
+	}
+}
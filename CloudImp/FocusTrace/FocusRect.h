@@ -0,0 +1,24 @@
+#ifndef __FOCUS_RECT_H__
+#define __FOCUS_RECT_H__
+
+#include <vector>
+#include "../Server/FocusData.h"
+
+#define FOCUS_MAX_CLIP_PIECES 4
+
+/// rect pipeline working on heap allocated rect infos as collected by FocusTraceSystem,
+/// removed rects are deleted and new pieces allocated with new
+
+extern int FocusCheckOverlapped(const FocusRectInfo* a, const FocusRectInfo* b);
+
+/// cut overlapped part of front out of back, pieces of back written to temp (FOCUS_MAX_CLIP_PIECES at most)
+/// return -1 if not overlapped, otherwise piece count
+extern int FocusClipRect(const FocusRectInfo* front, const FocusRectInfo* back, FocusRectInfo* temp);
+
+/// nearer rects hide farther ones, farther rects are replaced by their visible pieces
+extern void FocusClipOccludedRects(std::vector<FocusRectInfo*>& rectInfos);
+
+/// merge rects of same priority while bounding rect wastes at most maxWaste of covered area
+extern void FocusMergeRects(std::vector<FocusRectInfo*>& rectInfos, float maxWaste = 0.2f);
+
+#endif	/*__FOCUS_RECT_H__*/
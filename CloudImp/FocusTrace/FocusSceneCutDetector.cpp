@@ -0,0 +1,170 @@
+#include "FocusSceneCutDetector.h"
+#include <math.h>
+#include <string.h>
+
+#define SCENE_CUT_HISTOGRAM_STEP 8		/// sample every Nth pixel in both directions
+#define SCENE_CUT_RECT_MATCH_IOU 0.3f
+
+static float Clamp01(float v)
+{
+	return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+static float AngleDelta(float a, float b)
+{
+	float d = fmodf(fabsf(a - b), 360.0f);
+	return d > 180.0f ? 360.0f - d : d;
+}
+
+static float RectIoU(const FocusRectInfo& a, const FocusRectInfo& b)
+{
+	float w = fminf(a.right, b.right) - fmaxf(a.left, b.left);
+	float h = fminf(a.bottom, b.bottom) - fmaxf(a.top, b.top);
+	if (w <= 0.0f || h <= 0.0f)
+		return 0.0f;
+	float inter = w * h;
+	float areaA = (a.right - a.left) * (a.bottom - a.top);
+	float areaB = (b.right - b.left) * (b.bottom - b.top);
+	return inter / (areaA + areaB - inter);
+}
+
+FocusSceneCutDetector::FocusSceneCutDetector()
+{
+	posThreshold = 1000.0f;
+	rotThreshold = 60.0f;
+	churnThreshold = 0.8f;
+	histogramThreshold = 0.5f;
+	keyframeThreshold = 0.6f;
+	keyframeCooldown = 15;
+	histogramMaxAge = 2;
+	Reset();
+}
+
+void FocusSceneCutDetector::Reset()
+{
+	hasPose = false;
+	hasHistogram = false;
+	framesSinceHistogram = 0;
+	lastRects.clear();
+	poseScore = 0.0f;
+	churnScore = 0.0f;
+	histogramScore = 0.0f;
+	confidence = 0.0f;
+	keyframeHint = false;
+	framesSinceKeyframe = 0;
+}
+
+void FocusSceneCutDetector::AddCameraPose(const float* pos, const float* rot)
+{
+	if (hasPose)
+	{
+		float dx = pos[0] - lastPos[0];
+		float dy = pos[1] - lastPos[1];
+		float dz = pos[2] - lastPos[2];
+		float posDelta = sqrtf(dx * dx + dy * dy + dz * dz);
+		float rotDelta = fmaxf(AngleDelta(rot[1], lastRot[1]), AngleDelta(rot[2], lastRot[2]));
+		poseScore = fmaxf(Clamp01(posDelta / posThreshold), Clamp01(rotDelta / rotThreshold));
+	}
+	memcpy(lastPos, pos, sizeof(lastPos));
+	memcpy(lastRot, rot, sizeof(lastRot));
+	hasPose = true;
+}
+
+/// fraction of rects without a same priority, overlapping partner in the other frame
+float FocusSceneCutDetector::CalcRectChurn(const std::vector<FocusRectInfo>& prev, const std::vector<FocusRectInfo>& cur)
+{
+	int total = prev.size() > cur.size() ? prev.size() : cur.size();
+	if (total == 0)
+		return 0.0f;
+
+	int matched = 0;
+	for (int i = 0; i < cur.size(); i++)
+	{
+		for (int j = 0; j < prev.size(); j++)
+		{
+			if (cur[i].priority == prev[j].priority && RectIoU(cur[i], prev[j]) >= SCENE_CUT_RECT_MATCH_IOU)
+			{
+				matched++;
+				break;
+			}
+		}
+	}
+	return 1.0f - (float)matched / total;
+}
+
+void FocusSceneCutDetector::AddRects(const std::vector<FocusRectInfo*>& rectInfos)
+{
+	std::vector<FocusRectInfo> rects;
+	std::vector<FocusRectInfo*>::const_iterator iter;
+	for (iter = rectInfos.begin(); iter != rectInfos.end(); iter++)
+	{
+		/// ui rects follow hud state, not the scene
+		if ((*iter)->priority != 128)
+			rects.push_back(**iter);
+	}
+
+	/// a single rect appearing or vanishing is no cut
+	if (lastRects.size() >= 2 || rects.size() >= 2)
+	{
+		churnScore = Clamp01(CalcRectChurn(lastRects, rects) / churnThreshold);
+	}
+	lastRects.swap(rects);
+}
+
+void FocusSceneCutDetector::AddFrame(const unsigned char* bgra, int width, int height, int stride)
+{
+	if (bgra == NULL || width <= 0 || height <= 0)
+		return;
+
+	float histogram[SCENE_CUT_HISTOGRAM_BINS];
+	memset(histogram, 0, sizeof(histogram));
+	int count = 0;
+	for (int y = 0; y < height; y += SCENE_CUT_HISTOGRAM_STEP)
+	{
+		const unsigned char* row = bgra + y * stride;
+		for (int x = 0; x < width; x += SCENE_CUT_HISTOGRAM_STEP)
+		{
+			const unsigned char* p = row + x * 4;
+			int luma = (p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8;
+			histogram[luma * SCENE_CUT_HISTOGRAM_BINS / 256] += 1.0f;
+			count++;
+		}
+	}
+	for (int i = 0; i < SCENE_CUT_HISTOGRAM_BINS; i++)
+	{
+		histogram[i] /= count;
+	}
+
+	/// a stale histogram only becomes the new reference
+	if (hasHistogram && framesSinceHistogram <= histogramMaxAge)
+	{
+		float delta = 0.0f;
+		for (int i = 0; i < SCENE_CUT_HISTOGRAM_BINS; i++)
+		{
+			delta += fabsf(histogram[i] - lastHistogram[i]);
+		}
+		histogramScore = Clamp01(0.5f * delta / histogramThreshold);
+	}
+	memcpy(lastHistogram, histogram, sizeof(lastHistogram));
+	hasHistogram = true;
+	framesSinceHistogram = 0;
+}
+
+float FocusSceneCutDetector::Evaluate(bool forced)
+{
+	/// independent cues, any strong one is enough while weak ones reinforce each other
+	confidence = 1.0f - (1.0f - poseScore) * (1.0f - churnScore * 0.7f) * (1.0f - histogramScore * 0.8f);
+	if (forced)
+		confidence = 1.0f;
+
+	framesSinceKeyframe++;
+	framesSinceHistogram++;
+	keyframeHint = forced || (confidence >= keyframeThreshold && framesSinceKeyframe > keyframeCooldown);
+	if (keyframeHint)
+		framesSinceKeyframe = 0;
+
+	poseScore = 0.0f;
+	churnScore = 0.0f;
+	histogramScore = 0.0f;
+	return confidence;
+}
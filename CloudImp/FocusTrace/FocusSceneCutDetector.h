@@ -0,0 +1,79 @@
+#ifndef __FOCUS_SCENE_CUT_DETECTOR_H__
+#define __FOCUS_SCENE_CUT_DETECTOR_H__
+
+#include <vector>
+#include "../Server/FocusData.h"
+
+#define SCENE_CUT_HISTOGRAM_BINS 32
+
+/// guess scene change from focus telemetry, one Evaluate per frame:
+///  camera pose delta  - teleport, respawn, spectator switch
+///  rect set churn     - tracked rects replaced by unrelated ones
+///  luma histogram     - optional, from captured frames, only compared against a histogram at most
+///                       histogramMaxAge frames old so sparse scheduled captures don't read as cuts
+class FocusSceneCutDetector
+{
+public:
+	FocusSceneCutDetector();
+	~FocusSceneCutDetector() {}
+
+	/// per cue delta which counts as full confidence
+	void SetThresholds(float posDelta, float rotDelta, float rectChurn, float histogramDelta)
+	{
+		posThreshold = posDelta;
+		rotThreshold = rotDelta;
+		churnThreshold = rectChurn;
+		histogramThreshold = histogramDelta;
+	}
+	/// confidence needed for keyframe hint, minimum frames between two hints
+	void SetKeyframeParam(float threshold, int cooldownFrames)
+	{
+		keyframeThreshold = threshold;
+		keyframeCooldown = cooldownFrames;
+	}
+	/// oldest previous histogram, in frames, a new one is compared against
+	void SetHistogramMaxAge(int frames) { histogramMaxAge = frames; }
+
+	void AddCameraPose(const float* pos, const float* rot);
+	void AddRects(const std::vector<FocusRectInfo*>& rectInfos);
+	void AddFrame(const unsigned char* bgra, int width, int height, int stride);
+
+	/// combine cues fed since last call, forced for explicit scene jump
+	float Evaluate(bool forced);
+
+	float GetConfidence() { return confidence; }
+	bool IsKeyframeHint() { return keyframeHint; }
+
+	void Reset();
+
+private:
+	float CalcRectChurn(const std::vector<FocusRectInfo>& prev, const std::vector<FocusRectInfo>& cur);
+
+	float posThreshold;
+	float rotThreshold;
+	float churnThreshold;
+	float histogramThreshold;
+	float keyframeThreshold;
+	int keyframeCooldown;
+	int histogramMaxAge;
+
+	/// previous frame state
+	bool hasPose;
+	float lastPos[3];
+	float lastRot[3];
+	std::vector<FocusRectInfo> lastRects;
+	bool hasHistogram;
+	float lastHistogram[SCENE_CUT_HISTOGRAM_BINS];
+	int framesSinceHistogram;
+
+	/// current frame cues
+	float poseScore;
+	float churnScore;
+	float histogramScore;
+
+	float confidence;
+	bool keyframeHint;
+	int framesSinceKeyframe;
+};
+
+#endif	/*__FOCUS_SCENE_CUT_DETECTOR_H__*/
@@ -0,0 +1,141 @@
+#include "FocusTcpSender.h"
+
+/// engine builds use UTFocusSocketSender, keep platform socket headers out of them
+#ifdef CLOUDIMP_STANDALONE
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib,"ws2_32.lib")
+typedef int socklen_t;
+#define FOCUS_INVALID_SOCKET ((long long)INVALID_SOCKET)
+#define FocusCloseSocket closesocket
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#define FOCUS_INVALID_SOCKET (-1LL)
+#define FocusCloseSocket close
+#endif
+
+FocusTcpSender::FocusTcpSender()
+{
+	socket = FOCUS_INVALID_SOCKET;
+	connected = false;
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+}
+
+FocusTcpSender::~FocusTcpSender()
+{
+	Disconnect();
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+bool FocusTcpSender::Connect()
+{
+	return Connect("127.0.0.1", 8888);
+}
+
+bool FocusTcpSender::Connect(const char* ipAddr, int port)
+{
+	Disconnect();
+
+	socket = (long long)::socket(AF_INET, SOCK_STREAM, 0);
+	if (socket == FOCUS_INVALID_SOCKET)
+		return false;
+
+	/// small packets every frame, do not wait for coalescing
+	int noDelay = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+	struct sockaddr_in addr;
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, ipAddr, &addr.sin_addr) != 1 ||
+		connect(socket, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		Disconnect();
+		return false;
+	}
+	connected = true;
+	return true;
+}
+
+bool FocusTcpSender::IsConnected()
+{
+	return connected;
+}
+
+bool FocusTcpSender::Send(unsigned char* buf, unsigned int size)
+{
+	if (!connected)
+		return false;
+
+	/// rebuild packet with header
+	unsigned char* realBuf = FocusPacketFramer::Frame(buf, size, &size);
+
+	/// send
+	unsigned char* sendBuf = realBuf;
+	int left = size;
+	while (left > 0)
+	{
+		int sent = send(socket, (const char*)sendBuf, left, 0);
+		if (sent <= 0)
+		{
+			delete[] realBuf;
+			Disconnect();
+			return false;
+		}
+		left -= sent;
+		sendBuf += sent;
+	}
+	delete[] realBuf;
+	return true;
+}
+
+void FocusTcpSender::Recv(std::vector<Packet>& packets)
+{
+	if (!connected)
+		return;
+
+	/// poll, never block the game thread
+	unsigned char recvbuf[512];
+#ifdef _WIN32
+	u_long pending = 0;
+	if (ioctlsocket(socket, FIONREAD, &pending) != 0 || pending == 0)
+		return;
+	int iResult = recv(socket, (char*)recvbuf, 512, 0);
+#else
+	int iResult = recv(socket, recvbuf, 512, MSG_DONTWAIT);
+	if (iResult < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		return;
+#endif
+	if (iResult > 0)
+	{
+		framer.Feed(recvbuf, iResult, packets);
+	}
+	else
+	{
+		Disconnect();
+	}
+}
+
+void FocusTcpSender::Disconnect()
+{
+	if (socket != FOCUS_INVALID_SOCKET)
+		FocusCloseSocket(socket);
+	socket = FOCUS_INVALID_SOCKET;
+	connected = false;
+	framer.Reset();
+}
+
+#endif	/*CLOUDIMP_STANDALONE*/
@@ -0,0 +1,27 @@
+#ifndef __FOCUS_TCP_SENDER_H__
+#define __FOCUS_TCP_SENDER_H__
+
+#include "FocusTracer.h"
+
+/// plain socket transport for builds without engine socket subsystem
+class FocusTcpSender : public FocusSocketSenderBase
+{
+public:
+	FocusTcpSender();
+	virtual ~FocusTcpSender();
+
+	virtual bool Connect();		/// 127.0.0.1:8888
+	virtual bool Connect(const char* ipAddr, int port);
+	virtual bool IsConnected();
+	virtual bool Send(unsigned char* buf, unsigned int size);
+	virtual void Recv(std::vector<Packet>& packets);
+	virtual void Disconnect();
+
+private:
+	FocusPacketFramer framer;
+
+	long long socket;
+	bool connected;
+};
+
+#endif	/*__FOCUS_TCP_SENDER_H__*/
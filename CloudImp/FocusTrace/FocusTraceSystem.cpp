@@ -1,4 +1,5 @@
 #include "FocusTraceSystem.h"
+#include <string.h>
 
 FocusTraceSystem* FocusTraceSystem::instance = NULL;
 
@@ -24,10 +25,13 @@ void FocusTraceSystem::Release()
 		sender->Disconnect();
 		delete sender;
 	}
+	if (screenPercentage != NULL)
+		delete screenPercentage;
 	uiTracer = NULL;
 	drawer = NULL;
 	camera = NULL;
 	sender = NULL;
+	screenPercentage = NULL;
 
 	std::vector<FocusRectInfo*>::iterator rectInfoIter;
 	for (rectInfoIter = rectInfos.begin(); rectInfoIter != rectInfos.end(); rectInfoIter++)
@@ -38,12 +42,11 @@ void FocusTraceSystem::Release()
 
 	tracers.clear();
 
-	std::vector<FocusCaptureScreenBase*>::iterator capIter;
-	for (capIter = captures.begin(); capIter != captures.end(); capIter++)
-	{
-		delete (*capIter);
-	}
-	captures.clear();
+	ClearCaptureScreen();
+
+	if (captureFactory != NULL)
+		delete captureFactory;
+	captureFactory = NULL;
 }
 
 FocusTraceSystem::FocusTraceSystem()
@@ -53,7 +56,12 @@ FocusTraceSystem::FocusTraceSystem()
 	camera = NULL;
 	sceneJumped = false;
 	sender = NULL;
-	timer = 0;
+	screenPercentage = NULL;
+	captureFactory = NULL;
+	captureInterval = 5.0f;
+	captureOnEvent = true;
+	clipOccluded = false;
+	rectMergeWaste = -1.0f;
 }
 
 void FocusTraceSystem::SetScreenPercentage(float per)
@@ -64,15 +72,8 @@ void FocusTraceSystem::SetScreenPercentage(float per)
 	}
 }
 
-static bool compareRectDist(FocusRectInfo* i1, FocusRectInfo* i2)
-{
-	return (i1->distToCam < i2->distToCam);
-}
-
 void FocusTraceSystem::Update(float DeltaSeconds)
 {
-	timer += DeltaSeconds;
-
 	/// collect valid rect info
 	std::vector<FocusTracerBase*>::iterator iter;
 	for (iter = tracers.begin(); iter != tracers.end(); iter++)
@@ -85,20 +86,7 @@ void FocusTraceSystem::Update(float DeltaSeconds)
 	}
 
 	/// capture screen
-	std::vector<FocusCaptureScreenBase*>::iterator capIter;
-	for (capIter = captures.begin(); capIter != captures.end(); capIter++)
-	{
-		(*capIter)->Update();
-	}
-	if (timer >= captureInterval)
-	{
-		for (capIter = captures.begin(); capIter != captures.end(); capIter++)
-		{
-			(*capIter)->CaptureScreenToDisk("D:\\Screen");
-			(*capIter)->CaptureUIToDisk("D:\\Screen");
-		}
-		timer = 0.0f;
-	}
+	captureScheduler.Update(DeltaSeconds);
 
 	/// collect ui info
 	if (uiTracer)
@@ -109,6 +97,10 @@ void FocusTraceSystem::Update(float DeltaSeconds)
 
 void FocusTraceSystem::OnDrawHud()
 {
+	/// scene cut cues look at the rects as traced, the encoder gets the processed set
+	DetectSceneCut();
+	ProcessRects();
+
 	/// draw in hud
 	if (drawer != NULL && rectInfos.size() > 0)
 	{
@@ -120,6 +112,10 @@ void FocusTraceSystem::OnDrawHud()
 	}
 
 	/// process datas
+	if (captureOnEvent && IsKeyframeHint())
+	{
+		captureScheduler.Trigger();
+	}
 	RetriveAndSendDatas();
 
 	/// restore scene jumped
@@ -164,76 +160,112 @@ bool FocusTraceSystem::GetCameraRotation(float* outRot)
 	return false;
 }
 
-void FocusTraceSystem::InitializeCapture()
+/// value following key up to next white space, quotes are stripped
+static bool ParseParam(const char* cmdLine, const char* key, std::string& outValue)
 {
-	const TCHAR* CmdLineParam = FCommandLine::Get();
-	FString resParam;
-	resParams.clear();
-	if (!FParse::Value(CmdLineParam, TEXT("-capres="), resParam))
+	if (cmdLine == NULL)
+		return false;
+	const char* found = strstr(cmdLine, key);
+	if (found == NULL)
+		return false;
+
+	const char* start = found + strlen(key);
+	bool quoted = (*start == '"');
+	if (quoted)
+		start++;
+	const char* end = start;
+	while (*end != '\0' && (quoted ? *end != '"' : (*end != ' ' && *end != '\t')))
+		end++;
+	outValue.assign(start, end - start);
+	return true;
+}
+
+/// W*H, W*H_AA, optionally followed by @interval
+static bool ParseResParam(const std::string& param, ResParam& outParam)
+{
+	std::string token = param;
+	outParam.interval = -1.0f;
+	size_t split = token.find('@');
+	if (split != std::string::npos)
 	{
-		return;
+		outParam.interval = (float)atof(token.substr(split + 1).c_str());
+		token = token.substr(0, split);
 	}
-	FString left, right;
-	FString width, height;
-	FString isAAStr, resStr;
-	bool isAA;
-	while (resParam.Split(TEXT("|"), &left, &right))
+
+	std::string res = token;
+	outParam.isAA = false;
+	split = token.find('_');
+	if (split != std::string::npos)
 	{
-		isAA = false;
-		if (left.Split(TEXT("_"), &resStr, &isAAStr))
-		{
-			left = resStr;
-			if (isAAStr == TEXT("AA"))
-			{
-				isAA = true;
-			}
-		}
-		if (left.Split(TEXT("*"), &width, &height))
-		{
-			ResParam p;
-			p.width = FCString::Atoi(*width);
-			p.height = FCString::Atoi(*height);
-			p.isAA = isAA;
-			resParams.push_back(p);
-		}
-		resParam = right;
+		res = token.substr(0, split);
+		outParam.isAA = (token.substr(split + 1) == "AA");
 	}
-	isAA = false;
-	if (left.Split(TEXT("_"), &resStr, &isAAStr))
+	split = res.find('*');
+	if (split == std::string::npos)
+		return false;
+	outParam.width = atoi(res.substr(0, split).c_str());
+	outParam.height = atoi(res.substr(split + 1).c_str());
+	return true;
+}
+
+void FocusTraceSystem::InitializeCapture(const char* cmdLine)
+{
+	std::string resParam;
+	resParams.clear();
+	if (!ParseParam(cmdLine, "-capres=", resParam))
 	{
-		left = resStr;
-		if (isAAStr == TEXT("AA"))
-		{
-			isAA = true;
-		}
+		return;
 	}
-	if (resParam.Split(TEXT("*"), &width, &height))
+
+	size_t start = 0;
+	while (start <= resParam.size())
 	{
+		size_t split = resParam.find('|', start);
+		if (split == std::string::npos)
+			split = resParam.size();
 		ResParam p;
-		p.width = FCString::Atoi(*width);
-		p.height = FCString::Atoi(*height);
-		p.isAA = isAA;
-		resParams.push_back(p);
+		if (ParseResParam(resParam.substr(start, split - start), p))
+		{
+			resParams.push_back(p);
+		}
+		start = split + 1;
 	}
 
-	FString intervalParam;
-	if (!FParse::Value(CmdLineParam, TEXT("-capinterval="), intervalParam))
+	std::string intervalParam;
+	if (!ParseParam(cmdLine, "-capinterval=", intervalParam))
 	{
-		intervalParam = TEXT("5");
+		intervalParam = "5";
 	}
-	SetCaptureInterval(FCString::Atoi(*intervalParam));
+	SetCaptureInterval((float)atof(intervalParam.c_str()));
+
+	std::string dirParam;
+	captureScheduler.SetOutputPath(ParseParam(cmdLine, "-capdir=", dirParam) ? dirParam.c_str() : "");
+	captureScheduler.SetCaptureUI(strstr(cmdLine, "-capnoui") == NULL);
+
+	std::string eventParam;
+	captureOnEvent = !ParseParam(cmdLine, "-capevent=", eventParam) || atoi(eventParam.c_str()) != 0;
+
+	std::string budgetParam;
+	captureScheduler.SetMaxPerFrame(ParseParam(cmdLine, "-capbudget=", budgetParam) ? atoi(budgetParam.c_str()) : 1);
 }
 
 void FocusTraceSystem::StartCaptureScreen(void* userData)
 {
 	for (int i = 0; i < resParams.size(); i++)
 	{
-		captures.push_back(new UTFocusCaptureScreen(resParams[i].width, resParams[i].height, resParams[i].isAA, userData));
+		FocusCaptureScreenBase* capture = captureFactory != NULL ? captureFactory->CreateCapture(resParams[i].width, resParams[i].height, resParams[i].isAA, userData) : NULL;
+		if (capture != NULL)
+		{
+			captures.push_back(capture);
+			captureScheduler.Add(capture, resParams[i].interval);
+		}
 	}
 }
 
 void FocusTraceSystem::ClearCaptureScreen()
 {
+	captureScheduler.Clear();
+
 	std::vector<FocusCaptureScreenBase*>::iterator capIter;
 	for (capIter = captures.begin(); capIter != captures.end(); capIter++)
 	{
@@ -242,6 +274,30 @@ void FocusTraceSystem::ClearCaptureScreen()
 	captures.clear();
 }
 
+void FocusTraceSystem::ProcessRects()
+{
+	if (clipOccluded)
+	{
+		FocusClipOccludedRects(rectInfos);
+	}
+	if (rectMergeWaste >= 0.0f)
+	{
+		FocusMergeRects(rectInfos, rectMergeWaste);
+	}
+}
+
+void FocusTraceSystem::DetectSceneCut()
+{
+	float camPos[3];
+	float camRot[3];
+	if (GetCameraPosition(camPos) && GetCameraRotation(camRot))
+	{
+		sceneCutDetector.AddCameraPose(camPos, camRot);
+	}
+	sceneCutDetector.AddRects(rectInfos);
+	sceneCutDetector.Evaluate(sceneJumped);
+}
+
 void FocusTraceSystem::RetriveAndSendDatas()
 {
 	if (sender != NULL && sender->IsConnected())
@@ -251,7 +307,7 @@ void FocusTraceSystem::RetriveAndSendDatas()
 		float camRot[3];
 		GetCameraPosition(camPos);
 		GetCameraRotation(camRot);
-		unsigned char* buf = Serialize(GetRectInfos(), camPos, camRot, IsSceneJumped(), &size);
+		unsigned char* buf = Serialize(GetRectInfos(), camPos, camRot, IsSceneJumped(), GetSceneCutConfidence(), IsKeyframeHint(), &size);
 		if (buf != NULL && size > 0)
 		{
 			sender->Send(buf, size);
@@ -271,78 +327,6 @@ void FocusTraceSystem::RetriveAndSendDatas()
 	}
 }
 
-int FocusTraceSystem::CheckOverlapped(FocusRectInfo* a, FocusRectInfo* b)
-{
-	return !(a->left >= b->right || a->right <= b->left || a->top >= b->bottom || a->bottom <= b->top);
-}
-
-int FocusTraceSystem::CheckAndClipRect(FocusRectInfo* front, FocusRectInfo* back, FocusRectInfo* temp)
-{
-	int ret = -1;
-	if (CheckOverlapped(front, back) == 0)
-		return ret;
-
-	/// overlapped rect
-	ret = 0;
-	float left, top, right, bottom;
-	left = fmaxf(back->left, front->left);
-	top = fmaxf(back->top, front->top);
-	right = fminf(back->right, front->right);
-	bottom = fminf(back->bottom, front->bottom);
-
-	/// clip along each edge
-	float remainLeft = back->left;
-	float remainRight = back->right;
-	float remainTop = back->top;
-	float remainBottom = back->bottom;
-	/// top
-	if (top < remainBottom && top > remainTop)
-	{
-		temp[ret].top = remainTop;
-		temp[ret].bottom = top;
-		remainTop = top;
-		temp[ret].left = remainLeft;
-		temp[ret].right = remainRight;
-		temp[ret].distToCam = back->distToCam;
-		ret++;
-	}
-	/// bottom
-	if (bottom < remainBottom && bottom > remainTop)
-	{
-		temp[ret].top = bottom;
-		temp[ret].bottom = remainBottom;
-		remainBottom = bottom;
-		temp[ret].left = remainLeft;
-		temp[ret].right = remainRight;
-		temp[ret].distToCam = back->distToCam;
-		ret++;
-	}
-	/// left
-	if (left < remainRight && left > remainLeft)
-	{
-		temp[ret].left = remainLeft;
-		temp[ret].right = left;
-		remainLeft = left;
-		temp[ret].top = remainTop;
-		temp[ret].bottom = remainBottom;
-		temp[ret].distToCam = back->distToCam;
-		ret++;
-	}
-	/// right
-	if (right < remainRight && right > remainLeft)
-	{
-		temp[ret].left = right;
-		temp[ret].right = remainRight;
-		remainRight = right;
-		temp[ret].top = remainTop;
-		temp[ret].bottom = remainBottom;
-		temp[ret].distToCam = back->distToCam;
-		ret++;
-	}
-
-	return ret;
-}
-
 void FocusTraceSystem::Register(FocusTracerBase* tracer)
 {
 	tracers.push_back(tracer);
@@ -8,11 +8,15 @@
 #include <vector>
 #include <algorithm>
 #include "FocusTracer.h"
+#include "FocusSceneCutDetector.h"
+#include "FocusCaptureScheduler.h"
+#include "FocusRect.h"
 
 struct ResParam {
 	int width;
 	int height;
 	bool isAA;
+	float interval;	/// seconds between captures, less than 0 for -capinterval
 };
 
 class FocusTraceSystem
@@ -63,13 +67,23 @@ public:
 		}
 		sender = s; 
 	}
-	void InitializeCapture();
+	void SetCaptureFactory(FocusCaptureFactoryBase* factory)
+	{
+		if (captureFactory != NULL)
+			delete captureFactory;
+		captureFactory = factory;
+	}
+	/// -capres=1920*1080_AA@2|1280*720 -capinterval=5 -capdir=path -capnoui -capevent=1 -capbudget=1
+	void InitializeCapture(const char* cmdLine);
 	void StartCaptureScreen(void* userData);
 	void ClearCaptureScreen();
+	/// resolutions with their own @interval keep it
 	void SetCaptureInterval(float interval)
 	{
 		captureInterval = interval;
+		captureScheduler.SetDefaultInterval(interval);
 	}
+	FocusCaptureScheduler* GetCaptureScheduler() { return &captureScheduler; }
 
 	void AddRectInfo(int prio, float left, float top, float right, float bottom, float dist = 0.0f);
 	std::vector<FocusRectInfo*>* GetRectInfos() { return &rectInfos; }
@@ -77,13 +91,30 @@ public:
 	bool GetCameraRotation(float* outRot);	/// stored in degree
 	bool IsSceneJumped() { return sceneJumped; }
 
+	/// frame read back by the capture path for the histogram cue, BGRA, sampled sparsely by the detector
+	void AddSceneCutFrame(const unsigned char* bgra, int width, int height, int stride)
+	{
+		sceneCutDetector.AddFrame(bgra, width, height, stride);
+	}
+	FocusSceneCutDetector* GetSceneCutDetector() { return &sceneCutDetector; }
+	float GetSceneCutConfidence() { return sceneCutDetector.GetConfidence(); }
+	bool IsKeyframeHint() { return sceneCutDetector.IsKeyframeHint(); }
+
 	void SetScreenPercentage(float per);
 
+	/// rects hidden behind nearer ones are clipped away before sending, then same priority
+	/// neighbours merged while the merged rect wastes at most mergeWaste, less than 0 disables merging
+	/// both are off by default so the encoder gets the rects as traced
+	void SetRectProcessing(bool clip, float mergeWaste)
+	{
+		clipOccluded = clip;
+		rectMergeWaste = mergeWaste;
+	}
+
 private:
 	void RetriveAndSendDatas();
-
-	int CheckOverlapped(FocusRectInfo* a, FocusRectInfo* b);
-	int CheckAndClipRect(FocusRectInfo* front, FocusRectInfo* back, FocusRectInfo* temp );
+	void DetectSceneCut();
+	void ProcessRects();
 
 private:
 	std::vector<FocusTracerBase*> tracers;
@@ -91,17 +122,21 @@ private:
 	FocusDrawBase* drawer;
 	FocusCameraBase* camera;
 	bool sceneJumped;
+	FocusSceneCutDetector sceneCutDetector;
 
 	float captureInterval;
 	std::vector<ResParam> resParams;
 	std::vector<FocusCaptureScreenBase*> captures;
+	FocusCaptureFactoryBase* captureFactory;
+	FocusCaptureScheduler captureScheduler;
+	bool captureOnEvent;
 
 	std::vector<FocusRectInfo*> rectInfos;
+	bool clipOccluded;
+	float rectMergeWaste;
 
 	FocusSocketSenderBase* sender;
 	FocusScreenPercentageBase* screenPercentage;
-
-	float timer;
 };
 
 #endif	/*__FOCUS_TRACE_SYSTEM_H__*/
\ No newline at end of file
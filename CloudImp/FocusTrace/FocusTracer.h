@@ -2,6 +2,7 @@
 #define __FOCUS_TRACER_H__
 
 #include "../Server/FocusData.h"
+#include "../Server/FocusFramer.h"
 
 class FocusTracerBase
 {
@@ -27,7 +28,7 @@ public:
 	FocusDrawBase() { isDisplay = false; }
 	virtual ~FocusDrawBase() {}
 
-	virtual void DrawRect(float left, float right, float top, float bottom, uint8 priority) = 0;
+	virtual void DrawRect(float left, float right, float top, float bottom, unsigned char priority) = 0;
 
 protected:
 	bool isDisplay;
@@ -43,17 +44,6 @@ public:
 	virtual bool GetRotation(float* outRot) = 0;
 };
 
-struct Packet
-{
-	Packet(unsigned char* b, unsigned int s)
-	{
-		buf = b;
-		size = s;
-	}
-	unsigned char* buf;
-	unsigned int size;
-};
-
 class FocusSocketSenderBase
 {
 public:
@@ -81,6 +71,15 @@ public:
 	virtual bool CaptureUIToDisk(const char* path) = 0;
 };
 
+class FocusCaptureFactoryBase
+{
+public:
+	FocusCaptureFactoryBase() {}
+	virtual ~FocusCaptureFactoryBase() {}
+
+	virtual FocusCaptureScreenBase* CreateCapture(int width, int height, bool isAA, void* userData) = 0;
+};
+
 class FocusScreenPercentageBase
 {
 public:
@@ -5,6 +5,7 @@
 #include CONCAT(UE_PROJECT_NAME,.,h)
 #include "UObject/Object.h"
 #include "UTFocusTracer.h"
+#include "../../FocusTrace/FocusTraceSystem.h"
 #include "Public/Widgets/SViewport.h"
 #include "Public/Slate/SceneViewport.h"
 #include "Components/SceneCaptureComponent2D.h"
@@ -21,9 +22,40 @@
 #include <stdlib.h>
 #include <vector>
 
+UTFocusOcclusionMode UTFocusTracer::occlusionMode = FOCUS_OCCLUSION_DROP;
+float UTFocusTracer::occlusionTolerance = 0.1f;
+bool UTFocusTracer::occlusionParsed = false;
+
 UTFocusTracer::UTFocusTracer()
 {
 	enable = true;
+	if (!occlusionParsed)
+	{
+		ParseOcclusionParam();
+	}
+}
+
+void UTFocusTracer::ParseOcclusionParam()
+{
+	occlusionParsed = true;
+
+	const TCHAR* CmdLineParam = FCommandLine::Get();
+	FString modeParam;
+	if (FParse::Value(CmdLineParam, TEXT("-focusocclusion="), modeParam))
+	{
+		if (modeParam == TEXT("off"))
+			occlusionMode = FOCUS_OCCLUSION_OFF;
+		else if (modeParam == TEXT("downgrade"))
+			occlusionMode = FOCUS_OCCLUSION_DOWNGRADE;
+		else
+			occlusionMode = FOCUS_OCCLUSION_DROP;
+	}
+
+	FString toleranceParam;
+	if (FParse::Value(CmdLineParam, TEXT("-focusocclusiontime="), toleranceParam))
+	{
+		occlusionTolerance = FCString::Atof(*toleranceParam);
+	}
 }
 
 void UTFocusTracer::Initialize(AActor* aactor, uint8 p, FString key)
@@ -88,6 +120,20 @@ bool UTFocusTracer::UpdateBounds()
 }
 
 
+/// renderer writes LastRenderTimeOnScreen only for primitives that passed frustum and occlusion culling,
+/// tolerance covers the frame(s) between game thread tick and render thread visibility results
+bool UTFocusTracer::IsOccluded()
+{
+	if (occlusionMode == FOCUS_OCCLUSION_OFF || primComp == NULL)
+		return false;
+
+	UWorld* world = primComp->GetWorld();
+	if (world == NULL)
+		return false;
+
+	return (world->GetTimeSeconds() - primComp->LastRenderTimeOnScreen) > occlusionTolerance;
+}
+
 FocusRectInfo* UTFocusTracer::UpdateRectInfo()
 {
 	if (actor->GetRootComponent()->Mobility != EComponentMobility::Static)
@@ -98,6 +144,14 @@ FocusRectInfo* UTFocusTracer::UpdateRectInfo()
 	if (!boundsUpdated)
 		return NULL;
 
+	uint8 rectPriority = priority;
+	if (IsOccluded())
+	{
+		if (occlusionMode == FOCUS_OCCLUSION_DROP)
+			return NULL;
+		rectPriority = 0;
+	}
+
 	if (actor->GetWorld())
 	{
 		player = UGameplayStatics::GetPlayerController(actor->GetWorld(), 0);
@@ -112,7 +166,7 @@ FocusRectInfo* UTFocusTracer::UpdateRectInfo()
 		player->GetPlayerViewPoint(viewWorldPos, viewWorldRot);
 		FocusRectInfo* rectInfo = new FocusRectInfo();
 		rectInfo->distToCam = FVector::Dist(worldPos, viewWorldPos);
-		rectInfo->priority = priority;
+		rectInfo->priority = rectPriority;
 		rectInfo->left = FLT_MAX;
 		rectInfo->right = -FLT_MAX;
 		rectInfo->top = FLT_MAX;
@@ -132,6 +186,23 @@ FocusRectInfo* UTFocusTracer::UpdateRectInfo()
 			}
 		}
 
+		/// clip partially visible rect to viewport
+		int32 viewWidth = 0;
+		int32 viewHeight = 0;
+		player->GetViewportSize(viewWidth, viewHeight);
+		if (viewWidth > 0 && viewHeight > 0)
+		{
+			rectInfo->left = fmaxf(rectInfo->left, 0.0f);
+			rectInfo->top = fmaxf(rectInfo->top, 0.0f);
+			rectInfo->right = fminf(rectInfo->right, (float)viewWidth);
+			rectInfo->bottom = fminf(rectInfo->bottom, (float)viewHeight);
+		}
+		if (rectInfo->left >= rectInfo->right || rectInfo->top >= rectInfo->bottom)
+		{
+			delete rectInfo;
+			return NULL;
+		}
+
 		return rectInfo;
 	}
 
@@ -309,10 +380,6 @@ bool UTFocusCamera::GetRotation(float* outRot)
 UTFocusSocketSender::UTFocusSocketSender()
 {
 	socket = NULL;
-
-	offset = 0;
-	outBuf = NULL;
-	totalSize = 0;
 }
 
 bool UTFocusSocketSender::Connect()
@@ -359,15 +426,13 @@ bool UTFocusSocketSender::Send(unsigned char* buf, unsigned int size)
 		return false;
 
 	/// rebuild packet with header
-	unsigned char* realBuf = new unsigned char[size + 4];
-	*((unsigned int*)realBuf) = size;
-	memcpy(realBuf + 4, buf, size);
-	size += 4;
+	unsigned char* realBuf = FocusPacketFramer::Frame(buf, size, &size);
 
 	/// send
 	int sent = 0;
 	int left = size;
-	while (socket->Send(realBuf, left, sent))
+	unsigned char* sendBuf = realBuf;
+	while (socket->Send(sendBuf, left, sent))
 	{
 		if (sent == left)
 		{
@@ -376,66 +441,12 @@ bool UTFocusSocketSender::Send(unsigned char* buf, unsigned int size)
 		}
 
 		left -= sent;
-		buf += sent;
+		sendBuf += sent;
 	}
+	delete[] realBuf;
 	return false;
 }
 
-static unsigned int MakePackets(unsigned char* buf, unsigned int buf_size, unsigned int offset, std::vector<Packet>* out_packets, unsigned char*& out_buf, unsigned int& total_size, unsigned char* header)
-{
-	if (buf_size == 0)
-		return offset;
-
-	if (buf_size + offset <= 4)
-	{
-		memcpy(header + offset, buf, buf_size);
-	}
-	else
-	{
-		if (offset <= 4)
-		{
-			memcpy(header + offset, buf, 4 - offset);
-			total_size = *((unsigned int*)header);
-			out_buf = new unsigned char[total_size];
-			if (buf_size + offset < total_size + 4)
-			{
-				memcpy(out_buf, buf + 4 - offset, buf_size + offset - 4);
-				offset += buf_size;
-			}
-			else
-			{
-				memcpy(out_buf, buf + 4 - offset, total_size);
-				buf += (total_size + 4 - offset);
-				buf_size -= (total_size + 4 - offset);
-				out_packets->push_back(Packet(out_buf, total_size));
-				offset = 0;
-				out_buf = NULL;
-				offset = MakePackets(buf, buf_size, offset, out_packets, out_buf, total_size, header);
-			}
-		}
-		else
-		{
-			if (buf_size + offset < total_size + 4)
-			{
-				memcpy(out_buf + offset - 4, buf, buf_size);
-				offset += buf_size;
-			}
-			else
-			{
-				memcpy(out_buf + offset - 4, buf, total_size + 4 - offset);
-				buf += (total_size + 4 - offset);
-				buf_size -= (total_size + 4 - offset);
-				out_packets->push_back(Packet(out_buf, total_size));
-				offset = 0;
-				out_buf = NULL;
-				offset = MakePackets(buf, buf_size, offset, out_packets, out_buf, total_size, header);
-			}
-		}
-	}
-	///printf("offset:%d, iResult:%d, totalSize:%d\n", offset, iResult, totalSize);
-	return offset;
-}
-
 void UTFocusSocketSender::Recv(std::vector<Packet>& packets)
 {
 	if (!socket)
@@ -446,7 +457,7 @@ void UTFocusSocketSender::Recv(std::vector<Packet>& packets)
 
 	if (socket->Recv(recvbuf, 512, iResult, ESocketReceiveFlags::None) && iResult > 0)
 	{
-		offset = MakePackets((unsigned char*)recvbuf, iResult, offset, &packets, outBuf, totalSize, header);
+		framer.Feed((unsigned char*)recvbuf, iResult, packets);
 	}
 }
 
@@ -454,11 +465,7 @@ void UTFocusSocketSender::Disconnect()
 {
 	if(socket != NULL)
 		socket->Close();
-	if (outBuf != NULL)
-	{
-		delete[] outBuf;
-		outBuf = NULL;
-	}
+	framer.Reset();
 }
 
 UTFocusSocketSender::~UTFocusSocketSender()
@@ -471,6 +478,7 @@ UTFocusCaptureScreen::UTFocusCaptureScreen(int width, int height, bool isAA, voi
 	,capWidth(width)
 	,capHeight(height)
 	,isAntiAliasing(isAA)
+	,uiRenderTarget(NULL)
 {
 	ASCharacter* chara = (ASCharacter*)userData;
 	UCameraComponent* cam = chara->GetCameraComponent();
@@ -486,8 +494,9 @@ UTFocusCaptureScreen::UTFocusCaptureScreen(int width, int height, bool isAA, voi
 		renderTarget->AddressY = TextureAddress::TA_Clamp;
 
 		capture->FOVAngle = 90;
-		capture->bCaptureEveryFrame = true;
-		capture->bCaptureOnMovement = true;
+		/// only rendered when the scheduler picks this capture
+		capture->bCaptureEveryFrame = false;
+		capture->bCaptureOnMovement = false;
 		capture->AttachToComponent(((ASCharacter*)userData)->GetCameraComponent(), FAttachmentTransformRules::KeepRelativeTransform);
 		capture->ShowFlags.EnableAdvancedFeatures();
 		capture->PostProcessBlendWeight = 1.0f;
@@ -531,6 +540,20 @@ UTFocusCaptureScreen::~UTFocusCaptureScreen()
 {
 	capture = NULL;
 	renderTarget = NULL;
+
+	if (uiRenderTarget != NULL)
+	{
+		uiRenderTarget->RemoveFromRoot();
+		uiRenderTarget->ConditionalBeginDestroy();
+		uiRenderTarget = NULL;
+	}
+	widgetRenderer.Reset();
+}
+
+static FString MakeCaptureFilePath(const char* path, const FString& fileName)
+{
+	FString dir = (path != NULL && path[0] != '\0') ? FString(path) : FPaths::ScreenShotDir();
+	return FPaths::Combine(dir, fileName);
 }
 
 void UTFocusCaptureScreen::Update()
@@ -631,13 +654,18 @@ bool UTFocusCaptureScreen::CaptureScreenToDisk(const char* path)
 	if (!capture)
 		return false;
 
-	capture->CaptureSceneDeferred();
+	/// render now, the read back below flushes rendering commands and would miss a deferred capture
+	capture->CaptureScene();
 
 	TUniquePtr<FImageWriteTask> ImageTask = MakeUnique<FImageWriteTask>();
-	FString FilePath(path);
-	//FilePath += FString::Printf(TEXT("\\%d*%d_%d.bmp"), capWidth, capHeight, GFrameNumber);
-	FilePath = FString::Printf(TEXT("%d_%d_%d.bmp"), capWidth, capHeight, GFrameNumber);
+	FString FilePath = MakeCaptureFilePath(path, FString::Printf(TEXT("%d_%d_%d.bmp"), capWidth, capHeight, GFrameNumber));
 	TUniquePtr<TImagePixelData<FColor>> PixelData = DumpPixels(*renderTarget);
+	if (PixelData.IsValid())
+	{
+		/// scene cut histogram cue, FColor is BGRA in memory
+		const FIntPoint size = PixelData->GetSize();
+		FocusTraceSystem::Instance()->AddSceneCutFrame((const unsigned char*)PixelData->Pixels.GetData(), size.X, size.Y, size.X * sizeof(FColor));
+	}
 	ImageTask->PixelData = MoveTemp(PixelData);
 	ImageTask->Filename = FilePath;
 	ImageTask->Format = EImageFormat::BMP;
@@ -656,17 +684,19 @@ bool UTFocusCaptureScreen::CaptureUIToDisk(const char* path)
 	check(GameViewportWidget.IsValid());
 	TSharedPtr<SWidget> spSWidget = GameViewportWidget->GetContent();
 	check(spSWidget.IsValid());
-	TSharedPtr<FWidgetRenderer> WidgetRenderer = MakeShareable(new FWidgetRenderer(true));
-	check(WidgetRenderer.IsValid());
-	FVector2D offset = GEngine->GameViewport->GetGameViewport()->GetCachedGeometry().LocalToAbsolute(FVector2D(0, 0));
+	if (!widgetRenderer.IsValid())
+	{
+		widgetRenderer = MakeShareable(new FWidgetRenderer(true));
+		uiRenderTarget = FWidgetRenderer::CreateTargetFor(FVector2D(capWidth, capHeight), TF_Bilinear, true);
+		uiRenderTarget->AddToRoot();
+	}
+	check(widgetRenderer.IsValid() && uiRenderTarget != NULL);
 
-	UTextureRenderTarget2D *TextureRenderTarget = WidgetRenderer->DrawWidget(spSWidget.ToSharedRef(), FVector2D(capWidth, capHeight));
+	widgetRenderer->DrawWidget(uiRenderTarget, spSWidget.ToSharedRef(), FVector2D(capWidth, capHeight), 0.0f);
 
 	TUniquePtr<FImageWriteTask> ImageTask = MakeUnique<FImageWriteTask>();
-	FString FilePath(path);
-	//FilePath += FString::Printf(TEXT("\\%d*%d_%d.bmp"), capWidth, capHeight, GFrameNumber);
-	FilePath = FString::Printf(TEXT("%d_%d_%d_UI.bmp"), capWidth, capHeight, GFrameNumber);
-	TUniquePtr<TImagePixelData<FColor>> PixelData = DumpPixels(*TextureRenderTarget);
+	FString FilePath = MakeCaptureFilePath(path, FString::Printf(TEXT("%d_%d_%d_UI.bmp"), capWidth, capHeight, GFrameNumber));
+	TUniquePtr<TImagePixelData<FColor>> PixelData = DumpPixels(*uiRenderTarget);
 	ImageTask->PixelData = MoveTemp(PixelData);
 	ImageTask->Filename = FilePath;
 	ImageTask->Format = EImageFormat::BMP;
@@ -674,14 +704,17 @@ bool UTFocusCaptureScreen::CaptureUIToDisk(const char* path)
 	ImageTask->bOverwriteFile = true;
 	ImageTask->PixelPreProcessors.Add(TAsyncAlphaWrite<FColor>(255));
 
-	TextureRenderTarget->ConditionalBeginDestroy();
-	WidgetRenderer.Reset();
-
 	FHighResScreenshotConfig &HighResScreenshotConfig = GetHighResScreenshotConfig();
 	HighResScreenshotConfig.SetHDRCapture(false);
 	return (HighResScreenshotConfig.ImageWriteQueue->Enqueue(MoveTemp(ImageTask))).Get();
 }
 
+void UTFocusInitializeCapture()
+{
+	FocusTraceSystem::Instance()->SetCaptureFactory(new UTFocusCaptureFactory());
+	FocusTraceSystem::Instance()->InitializeCapture(TCHAR_TO_ANSI(FCommandLine::Get()));
+}
+
 void UTFocusScreenPercentage::SetScreenPercentage(float percentage)
 {
 	auto ScreenPercentageCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("r.ScreenPercentage"));
@@ -5,6 +5,15 @@
 #include "GameFramework/Actor.h"
 #include "Public/Sockets.h"
 
+class FWidgetRenderer;
+
+enum UTFocusOcclusionMode
+{
+	FOCUS_OCCLUSION_OFF = 0,		/// emit rect whenever actor projects on screen
+	FOCUS_OCCLUSION_DROP,			/// drop rect of occluded primitive
+	FOCUS_OCCLUSION_DOWNGRADE,		/// keep rect of occluded primitive with lowest static priority
+};
+
 class UTFocusTracer : public FocusTracerBase
 {
 public:
@@ -22,8 +31,21 @@ public:
 
 	void Initialize(AActor* aactor, uint8 p, FString key);
 
+	static void SetOcclusionMode(UTFocusOcclusionMode mode, float tolerance)
+	{
+		occlusionMode = mode;
+		occlusionTolerance = tolerance;
+		occlusionParsed = true;
+	}
+
 private:
 	bool UpdateBounds();
+	bool IsOccluded();
+	static void ParseOcclusionParam();
+
+	static UTFocusOcclusionMode occlusionMode;
+	static float occlusionTolerance;
+	static bool occlusionParsed;
 
 	AActor* actor;
 	uint8 priority;
@@ -87,11 +109,7 @@ public:
 	virtual void Disconnect();
 
 private:
-	/// recv param
-	unsigned int offset;
-	unsigned char* outBuf;
-	unsigned int totalSize;
-	unsigned char header[4];
+	FocusPacketFramer framer;
 
 	FSocket* socket;
 };
@@ -116,9 +134,28 @@ private:
 	USceneCaptureComponent2D *capture;
 	UTextureRenderTarget2D *renderTarget;
 
+	/// reused by every ui capture
+	TSharedPtr<FWidgetRenderer> widgetRenderer;
+	UTextureRenderTarget2D *uiRenderTarget;
+
 	UCameraComponent* camera;
 };
 
+class UTFocusCaptureFactory : public FocusCaptureFactoryBase
+{
+public:
+	UTFocusCaptureFactory() {}
+	virtual ~UTFocusCaptureFactory() {}
+
+	virtual FocusCaptureScreenBase* CreateCapture(int width, int height, bool isAA, void* userData)
+	{
+		return new UTFocusCaptureScreen(width, height, isAA, userData);
+	}
+};
+
+/// hand engine capture factory and -capres / -capinterval from command line to FocusTraceSystem
+extern void UTFocusInitializeCapture();
+
 class UTFocusScreenPercentage : public FocusScreenPercentageBase
 {
 public:
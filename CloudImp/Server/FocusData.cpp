@@ -1,5 +1,6 @@
 #include "FocusData.h"
 #include "assert.h"
+#include <string.h>
 
 #define LENGTH_INCREMENT(len, offset) \
 	len = len + offset;				  \
@@ -14,7 +15,7 @@
 
 #define MAX_BUGGER_LENGTH (2*1024*1024)
 
-unsigned char* Serialize(std::vector<FocusRectInfo*>* rectInfos, float* camPos, float* camRot, bool sceneJumped, unsigned  int* outSize)
+unsigned char* Serialize(std::vector<FocusRectInfo*>* rectInfos, float* camPos, float* camRot, bool sceneJumped, float sceneCutConfidence, bool keyframeHint, unsigned  int* outSize)
 {
 	unsigned char* buffer = new unsigned char[MAX_BUGGER_LENGTH];
 	unsigned char* buf = buffer;
@@ -67,6 +68,12 @@ unsigned char* Serialize(std::vector<FocusRectInfo*>* rectInfos, float* camPos,
 	*((bool *)buf) = sceneJumped;
 	buf += 4;
 	LENGTH_INCREMENT(totalLength, 4);
+	*((float *)buf) = sceneCutConfidence;
+	buf += 4;
+	LENGTH_INCREMENT(totalLength, 4);
+	*((bool *)buf) = keyframeHint;
+	buf += 4;
+	LENGTH_INCREMENT(totalLength, 4);
 
 	*outSize = totalLength;
 	unsigned char* ret = new unsigned char[totalLength];
@@ -128,5 +135,18 @@ bool Deserialize(unsigned char* buf, unsigned int size, FocusInfo* outInfo)
 	buf += 4;
 	LENGTH_CHECK(totalLength, 4, size);
 
+	/// scene cut fields are absent in packets from older clients
+	outInfo->sceneCutConfidence = outInfo->sceneJumped ? 1.0f : 0.0f;
+	outInfo->keyframeHint = outInfo->sceneJumped;
+	if (totalLength + 8 <= size)
+	{
+		outInfo->sceneCutConfidence = *((float *)buf);
+		buf += 4;
+		LENGTH_CHECK(totalLength, 4, size);
+		outInfo->keyframeHint = *((bool *)buf);
+		buf += 4;
+		LENGTH_CHECK(totalLength, 4, size);
+	}
+
 	return true;
 }
\ No newline at end of file
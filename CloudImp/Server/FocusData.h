@@ -24,9 +24,11 @@ struct FocusInfo
 	float camPos[3];
 	float camRot[3];
 	bool sceneJumped;
+	float sceneCutConfidence;	// 0 --- 1, 1 for explicit scene jump
+	bool keyframeHint;			// encoder should insert keyframe for this frame
 };
 
-extern unsigned char* Serialize(std::vector<FocusRectInfo*>* rectInfos, float* camPos, float* camRot, bool sceneJumped, unsigned  int* outSize);	/// use delete[] to free buffer memory
+extern unsigned char* Serialize(std::vector<FocusRectInfo*>* rectInfos, float* camPos, float* camRot, bool sceneJumped, float sceneCutConfidence, bool keyframeHint, unsigned  int* outSize);	/// use delete[] to free buffer memory
 extern bool Deserialize(unsigned char* buf, unsigned int size, FocusInfo* outInfo);
 
 #endif // !__FOCUS_DATA_H__
@@ -0,0 +1,75 @@
+#include "FocusFramer.h"
+#include <string.h>
+
+FocusPacketFramer::FocusPacketFramer()
+{
+	offset = 0;
+	outBuf = NULL;
+	totalSize = 0;
+}
+
+FocusPacketFramer::~FocusPacketFramer()
+{
+	Reset();
+}
+
+void FocusPacketFramer::Reset()
+{
+	if (outBuf != NULL)
+	{
+		delete[] outBuf;
+		outBuf = NULL;
+	}
+	offset = 0;
+	totalSize = 0;
+}
+
+void FocusPacketFramer::Feed(const unsigned char* buf, unsigned int size, std::vector<Packet>& outPackets)
+{
+	while (size > 0)
+	{
+		/// header
+		if (offset < FOCUS_FRAME_HEADER_SIZE)
+		{
+			unsigned int count = FOCUS_FRAME_HEADER_SIZE - offset;
+			if (count > size)
+				count = size;
+			memcpy(header + offset, buf, count);
+			offset += count;
+			buf += count;
+			size -= count;
+			if (offset < FOCUS_FRAME_HEADER_SIZE)
+				return;
+
+			memcpy(&totalSize, header, FOCUS_FRAME_HEADER_SIZE);
+			outBuf = new unsigned char[totalSize > 0 ? totalSize : 1];
+		}
+
+		/// payload
+		unsigned int received = offset - FOCUS_FRAME_HEADER_SIZE;
+		unsigned int count = totalSize - received;
+		if (count > size)
+			count = size;
+		memcpy(outBuf + received, buf, count);
+		offset += count;
+		buf += count;
+		size -= count;
+
+		if (offset == totalSize + FOCUS_FRAME_HEADER_SIZE)
+		{
+			outPackets.push_back(Packet(outBuf, totalSize));
+			outBuf = NULL;
+			offset = 0;
+			totalSize = 0;
+		}
+	}
+}
+
+unsigned char* FocusPacketFramer::Frame(const unsigned char* buf, unsigned int size, unsigned int* outSize)
+{
+	unsigned char* realBuf = new unsigned char[size + FOCUS_FRAME_HEADER_SIZE];
+	memcpy(realBuf, &size, FOCUS_FRAME_HEADER_SIZE);
+	memcpy(realBuf + FOCUS_FRAME_HEADER_SIZE, buf, size);
+	*outSize = size + FOCUS_FRAME_HEADER_SIZE;
+	return realBuf;
+}
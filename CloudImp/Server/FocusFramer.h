@@ -0,0 +1,42 @@
+#ifndef __FOCUS_FRAMER_H__
+#define __FOCUS_FRAMER_H__
+
+#include <stdlib.h>
+#include <vector>
+
+#define FOCUS_FRAME_HEADER_SIZE 4
+
+struct Packet
+{
+	Packet(unsigned char* b, unsigned int s)
+	{
+		buf = b;
+		size = s;
+	}
+	unsigned char* buf;
+	unsigned int size;
+};
+
+/// stream framing shared by client and server: 4 bytes payload size followed by payload
+class FocusPacketFramer
+{
+public:
+	FocusPacketFramer();
+	~FocusPacketFramer();
+
+	/// split received bytes into packets, partial packet is kept for next call
+	/// use delete[] to free buf of each output packet
+	void Feed(const unsigned char* buf, unsigned int size, std::vector<Packet>& outPackets);
+	void Reset();
+
+	/// prepend header, use delete[] to free returned buffer
+	static unsigned char* Frame(const unsigned char* buf, unsigned int size, unsigned int* outSize);
+
+private:
+	unsigned int offset;		/// bytes of current packet received, header included
+	unsigned char* outBuf;
+	unsigned int totalSize;
+	unsigned char header[FOCUS_FRAME_HEADER_SIZE];
+};
+
+#endif // !__FOCUS_FRAMER_H__
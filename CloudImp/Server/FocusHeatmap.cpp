@@ -0,0 +1,478 @@
+#include "FocusHeatmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#define HEATMAP_FILE_MAGIC 0x504D4846	/// 'FHMP'
+#define HEATMAP_FILE_VERSION 1
+#define HEATMAP_DYNAMIC_PRIORITY 255
+#define HEATMAP_MAX_STATIC_PRIORITY 127
+#define HEATMAP_PI 3.14159265f
+
+static int FloorToCell(float v, float cellSize)
+{
+	return (int)floorf(v / cellSize);
+}
+
+static int FloorToTile(int c)
+{
+	return c >= 0 ? c / HEATMAP_TILE_SIZE : (c - HEATMAP_TILE_SIZE + 1) / HEATMAP_TILE_SIZE;
+}
+
+FocusHeatmapGrid::FocusHeatmapGrid(float size)
+{
+	cellSize = size;
+}
+
+FocusHeatmapGrid::~FocusHeatmapGrid()
+{
+	Clear();
+}
+
+void FocusHeatmapGrid::Clear()
+{
+	TileMap::iterator iter;
+	for (iter = tiles.begin(); iter != tiles.end(); iter++)
+	{
+		delete iter->second;
+	}
+	tiles.clear();
+}
+
+float* FocusHeatmapGrid::GetCell(int cx, int cy, bool create)
+{
+	int tx = FloorToTile(cx);
+	int ty = FloorToTile(cy);
+	long long key = MakeKey(tx, ty);
+	Tile* tile = NULL;
+	TileMap::iterator iter = tiles.find(key);
+	if (iter != tiles.end())
+	{
+		tile = iter->second;
+	}
+	else if (create)
+	{
+		tile = new Tile();
+		memset(tile->cells, 0, sizeof(tile->cells));
+		tiles[key] = tile;
+	}
+	if (tile == NULL)
+		return NULL;
+	return &tile->cells[(cy - ty * HEATMAP_TILE_SIZE) * HEATMAP_TILE_SIZE + (cx - tx * HEATMAP_TILE_SIZE)];
+}
+
+const float* FocusHeatmapGrid::FindCell(int cx, int cy) const
+{
+	TileMap::const_iterator iter = tiles.find(MakeKey(FloorToTile(cx), FloorToTile(cy)));
+	if (iter == tiles.end())
+		return NULL;
+	int tx = FloorToTile(cx);
+	int ty = FloorToTile(cy);
+	return &iter->second->cells[(cy - ty * HEATMAP_TILE_SIZE) * HEATMAP_TILE_SIZE + (cx - tx * HEATMAP_TILE_SIZE)];
+}
+
+void FocusHeatmapGrid::Add(float x, float y, float weight)
+{
+	float* cell = GetCell(FloorToCell(x, cellSize), FloorToCell(y, cellSize), true);
+	*cell += weight;
+}
+
+void FocusHeatmapGrid::AddRect(float left, float top, float right, float bottom, float weight)
+{
+	int x0 = FloorToCell(left, cellSize);
+	int y0 = FloorToCell(top, cellSize);
+	int x1 = FloorToCell(right, cellSize);
+	int y1 = FloorToCell(bottom, cellSize);
+	for (int cy = y0; cy <= y1; cy++)
+	{
+		for (int cx = x0; cx <= x1; cx++)
+		{
+			*GetCell(cx, cy, true) += weight;
+		}
+	}
+}
+
+float FocusHeatmapGrid::Get(float x, float y) const
+{
+	const float* cell = FindCell(FloorToCell(x, cellSize), FloorToCell(y, cellSize));
+	return cell != NULL ? *cell : 0.0f;
+}
+
+float FocusHeatmapGrid::Sum(float x, float y, float radius) const
+{
+	int x0 = FloorToCell(x - radius, cellSize);
+	int y0 = FloorToCell(y - radius, cellSize);
+	int x1 = FloorToCell(x + radius, cellSize);
+	int y1 = FloorToCell(y + radius, cellSize);
+	float sum = 0.0f;
+	for (int cy = y0; cy <= y1; cy++)
+	{
+		for (int cx = x0; cx <= x1; cx++)
+		{
+			const float* cell = FindCell(cx, cy);
+			if (cell != NULL)
+				sum += *cell;
+		}
+	}
+	return sum;
+}
+
+void FocusHeatmapGrid::Decay(float factor)
+{
+	TileMap::iterator iter;
+	for (iter = tiles.begin(); iter != tiles.end(); iter++)
+	{
+		float* cells = iter->second->cells;
+		for (int i = 0; i < HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE; i++)
+		{
+			cells[i] *= factor;
+		}
+	}
+}
+
+/// tile record: int tx, int ty, float scale, unsigned short cells[TILE*TILE] quantized against scale
+bool FocusHeatmapGrid::Write(FILE* file) const
+{
+	unsigned int tileCount = 0;
+	TileMap::const_iterator iter;
+	for (iter = tiles.begin(); iter != tiles.end(); iter++)
+	{
+		tileCount++;
+	}
+	if (fwrite(&cellSize, sizeof(float), 1, file) != 1 || fwrite(&tileCount, sizeof(unsigned int), 1, file) != 1)
+		return false;
+
+	unsigned short quantized[HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE];
+	for (iter = tiles.begin(); iter != tiles.end(); iter++)
+	{
+		const float* cells = iter->second->cells;
+		float scale = 0.0f;
+		for (int i = 0; i < HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE; i++)
+		{
+			scale = fmaxf(scale, cells[i]);
+		}
+		for (int i = 0; i < HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE; i++)
+		{
+			quantized[i] = scale > 0.0f ? (unsigned short)(cells[i] / scale * 65535.0f + 0.5f) : 0;
+		}
+		int coord[2];
+		coord[0] = (int)(iter->first >> 32);
+		coord[1] = (int)(iter->first & 0xFFFFFFFF);
+		if (fwrite(coord, sizeof(int), 2, file) != 2 ||
+			fwrite(&scale, sizeof(float), 1, file) != 1 ||
+			fwrite(quantized, sizeof(quantized), 1, file) != 1)
+			return false;
+	}
+	return true;
+}
+
+bool FocusHeatmapGrid::Read(FILE* file)
+{
+	Clear();
+	unsigned int tileCount = 0;
+	if (fread(&cellSize, sizeof(float), 1, file) != 1 || fread(&tileCount, sizeof(unsigned int), 1, file) != 1)
+		return false;
+
+	unsigned short quantized[HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE];
+	for (unsigned int t = 0; t < tileCount; t++)
+	{
+		int coord[2];
+		float scale;
+		if (fread(coord, sizeof(int), 2, file) != 2 ||
+			fread(&scale, sizeof(float), 1, file) != 1 ||
+			fread(quantized, sizeof(quantized), 1, file) != 1)
+			return false;
+
+		Tile* tile = new Tile();
+		for (int i = 0; i < HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE; i++)
+		{
+			tile->cells[i] = quantized[i] / 65535.0f * scale;
+		}
+		tiles[MakeKey(coord[0], coord[1])] = tile;
+	}
+	return true;
+}
+
+FocusHeatmap::FocusHeatmap(const std::string& name, float worldCellSize, int cells, float life)
+	: mapName(name)
+	, halfLife(life)
+	, screenCells(cells)
+	, screenLayer(1.0f / cells)
+	, worldLayer(worldCellSize)
+{
+}
+
+FocusHeatmap::~FocusHeatmap()
+{
+}
+
+void FocusHeatmap::AddSample(const FocusHeatmapSample& sample)
+{
+	if (sample.type == HEATMAP_SAMPLE_SCREEN)
+	{
+		/// keep right / bottom edge inside the last cell
+		float edge = 1.0f - 0.5f / screenCells;
+		screenLayer.AddRect(fmaxf(sample.x0, 0.0f), fmaxf(sample.y0, 0.0f), fminf(sample.x1, edge), fminf(sample.y1, edge), sample.weight);
+	}
+	else
+	{
+		worldLayer.Add(sample.x0, sample.y0, sample.weight);
+	}
+}
+
+void FocusHeatmap::Decay(float deltaSeconds)
+{
+	if (halfLife <= 0.0f || deltaSeconds <= 0.0f)
+		return;
+	float factor = powf(0.5f, deltaSeconds / halfLife);
+	screenLayer.Decay(factor);
+	worldLayer.Decay(factor);
+}
+
+bool FocusHeatmap::Save(const char* path) const
+{
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+
+	unsigned int header[3];
+	header[0] = HEATMAP_FILE_MAGIC;
+	header[1] = HEATMAP_FILE_VERSION;
+	header[2] = screenCells;
+	bool ok = fwrite(header, sizeof(header), 1, file) == 1 && screenLayer.Write(file) && worldLayer.Write(file);
+	fclose(file);
+	return ok;
+}
+
+bool FocusHeatmap::Load(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	unsigned int header[3];
+	bool ok = fread(header, sizeof(header), 1, file) == 1 && header[0] == HEATMAP_FILE_MAGIC && header[1] == HEATMAP_FILE_VERSION;
+	if (ok)
+	{
+		screenCells = header[2];
+		ok = screenLayer.Read(file) && worldLayer.Read(file);
+	}
+	fclose(file);
+	return ok;
+}
+
+static bool compareActorHeat(const std::pair<float, int>& a, const std::pair<float, int>& b)
+{
+	return a.first < b.first;
+}
+
+void FocusHeatmap::SuggestStaticPriorities(const std::vector<FocusHeatmapActor>& actors, std::vector<int>& outPriorities) const
+{
+	outPriorities.assign(actors.size(), 0);
+	if (actors.empty())
+		return;
+
+	std::vector<std::pair<float, int> > heats;
+	for (int i = 0; i < actors.size(); i++)
+	{
+		float radius = fmaxf(actors[i].radius, worldLayer.GetCellSize() * 0.5f);
+		heats.push_back(std::make_pair(worldLayer.Sum(actors[i].pos[0], actors[i].pos[1], radius), i));
+	}
+	std::stable_sort(heats.begin(), heats.end(), compareActorHeat);
+
+	/// rank percentile, actors without any heat stay at 0
+	for (int i = 0; i < heats.size(); i++)
+	{
+		if (heats[i].first <= 0.0f)
+			continue;
+		int prio = heats.size() > 1 ? (int)((float)i / (heats.size() - 1) * HEATMAP_MAX_STATIC_PRIORITY + 0.5f) : HEATMAP_MAX_STATIC_PRIORITY;
+		outPriorities[heats[i].second] = prio;
+	}
+}
+
+FocusHeatmapSession::FocusHeatmapSession(const std::string& name, float width, float height)
+	: mapName(name)
+	, screenWidth(width)
+	, screenHeight(height)
+	, head(0)
+	, tail(0)
+	, dropped(0)
+{
+}
+
+bool FocusHeatmapSession::Push(const FocusHeatmapSample& sample)
+{
+	unsigned int h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= HEATMAP_SESSION_QUEUE_SIZE)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	samples[h & (HEATMAP_SESSION_QUEUE_SIZE - 1)] = sample;
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+bool FocusHeatmapSession::Pop(FocusHeatmapSample& sample)
+{
+	unsigned int t = tail.load(std::memory_order_relaxed);
+	if (t == head.load(std::memory_order_acquire))
+		return false;
+	sample = samples[t & (HEATMAP_SESSION_QUEUE_SIZE - 1)];
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+void FocusHeatmapSession::Accumulate(const FocusInfo* info)
+{
+	/// camRot stored in degree as roll, pitch, yaw
+	float pitch = info->camRot[1] * HEATMAP_PI / 180.0f;
+	float yaw = info->camRot[2] * HEATMAP_PI / 180.0f;
+	float forward[2];
+	forward[0] = cosf(pitch) * cosf(yaw);
+	forward[1] = cosf(pitch) * sinf(yaw);
+
+	FocusHeatmapSample sample;
+	sample.type = HEATMAP_SAMPLE_WORLD;
+	sample.x0 = info->camPos[0];
+	sample.y0 = info->camPos[1];
+	sample.x1 = sample.y1 = 0.0f;
+	sample.weight = 1.0f;
+	Push(sample);
+
+	for (int i = 0; i < info->rectInfos.size(); i++)
+	{
+		const FocusRectInfo& rectInfo = info->rectInfos[i];
+		if (rectInfo.priority != HEATMAP_DYNAMIC_PRIORITY)
+			continue;
+
+		sample.type = HEATMAP_SAMPLE_SCREEN;
+		sample.x0 = rectInfo.left / screenWidth;
+		sample.y0 = rectInfo.top / screenHeight;
+		sample.x1 = rectInfo.right / screenWidth;
+		sample.y1 = rectInfo.bottom / screenHeight;
+		sample.weight = 1.0f;
+		Push(sample);
+
+		/// focus point along view direction at rect distance
+		sample.type = HEATMAP_SAMPLE_WORLD;
+		sample.x0 = info->camPos[0] + forward[0] * rectInfo.distToCam;
+		sample.y0 = info->camPos[1] + forward[1] * rectInfo.distToCam;
+		sample.x1 = sample.y1 = 0.0f;
+		Push(sample);
+	}
+}
+
+FocusHeatmapService::FocusHeatmapService(const char* dir)
+	: dataDir(dir)
+{
+}
+
+FocusHeatmapService::~FocusHeatmapService()
+{
+	std::vector<FocusHeatmapSession*>::iterator sessionIter;
+	for (sessionIter = sessions.begin(); sessionIter != sessions.end(); sessionIter++)
+	{
+		delete (*sessionIter);
+	}
+	sessions.clear();
+	for (sessionIter = closedSessions.begin(); sessionIter != closedSessions.end(); sessionIter++)
+	{
+		delete (*sessionIter);
+	}
+	closedSessions.clear();
+
+	std::map<std::string, FocusHeatmap*>::iterator mapIter;
+	for (mapIter = heatmaps.begin(); mapIter != heatmaps.end(); mapIter++)
+	{
+		delete mapIter->second;
+	}
+	heatmaps.clear();
+}
+
+FocusHeatmapSession* FocusHeatmapService::OpenSession(const std::string& mapName, float screenWidth, float screenHeight)
+{
+	FocusHeatmapSession* session = new FocusHeatmapSession(mapName, screenWidth, screenHeight);
+	std::lock_guard<std::mutex> guard(sessionLock);
+	sessions.push_back(session);
+	return session;
+}
+
+void FocusHeatmapService::CloseSession(FocusHeatmapSession* session)
+{
+	/// remaining samples are drained and the session freed on next merge
+	std::lock_guard<std::mutex> guard(sessionLock);
+	std::vector<FocusHeatmapSession*>::iterator iter = std::find(sessions.begin(), sessions.end(), session);
+	if (iter != sessions.end())
+	{
+		sessions.erase(iter);
+		closedSessions.push_back(session);
+	}
+}
+
+std::string FocusHeatmapService::GetPath(const std::string& mapName) const
+{
+	return dataDir + "/" + mapName + ".fhm";
+}
+
+FocusHeatmap* FocusHeatmapService::GetHeatmap(const std::string& mapName)
+{
+	std::map<std::string, FocusHeatmap*>::iterator iter = heatmaps.find(mapName);
+	if (iter != heatmaps.end())
+		return iter->second;
+
+	FocusHeatmap* heatmap = new FocusHeatmap(mapName);
+	heatmap->Load(GetPath(mapName).c_str());
+	heatmaps[mapName] = heatmap;
+	return heatmap;
+}
+
+void FocusHeatmapService::Drain(FocusHeatmapSession* session)
+{
+	FocusHeatmap* heatmap = GetHeatmap(session->GetMapName());
+	FocusHeatmapSample sample;
+	while (session->Pop(sample))
+	{
+		heatmap->AddSample(sample);
+	}
+}
+
+void FocusHeatmapService::Merge(float deltaSeconds)
+{
+	std::vector<FocusHeatmapSession*> active;
+	std::vector<FocusHeatmapSession*> closed;
+	{
+		std::lock_guard<std::mutex> guard(sessionLock);
+		active = sessions;
+		closed.swap(closedSessions);
+	}
+
+	std::map<std::string, FocusHeatmap*>::iterator mapIter;
+	for (mapIter = heatmaps.begin(); mapIter != heatmaps.end(); mapIter++)
+	{
+		mapIter->second->Decay(deltaSeconds);
+	}
+
+	std::vector<FocusHeatmapSession*>::iterator iter;
+	for (iter = active.begin(); iter != active.end(); iter++)
+	{
+		Drain(*iter);
+	}
+	for (iter = closed.begin(); iter != closed.end(); iter++)
+	{
+		Drain(*iter);
+		delete (*iter);
+	}
+}
+
+bool FocusHeatmapService::SaveAll()
+{
+	bool ok = true;
+	std::map<std::string, FocusHeatmap*>::iterator mapIter;
+	for (mapIter = heatmaps.begin(); mapIter != heatmaps.end(); mapIter++)
+	{
+		ok = mapIter->second->Save(GetPath(mapIter->first).c_str()) && ok;
+	}
+	return ok;
+}
@@ -0,0 +1,155 @@
+#ifndef __FOCUS_HEATMAP_H__
+#define __FOCUS_HEATMAP_H__
+
+#include <stdlib.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include "FocusData.h"
+
+#define HEATMAP_TILE_SIZE 16				/// cells per tile edge
+#define HEATMAP_SESSION_QUEUE_SIZE 4096		/// pending samples per session, must be power of two
+
+struct FocusHeatmapSample
+{
+	int type;			/// HEATMAP_SAMPLE_SCREEN / HEATMAP_SAMPLE_WORLD
+	float x0, y0;		/// screen: normalized rect, world: position
+	float x1, y1;
+	float weight;
+};
+
+enum
+{
+	HEATMAP_SAMPLE_SCREEN = 0,
+	HEATMAP_SAMPLE_WORLD = 1,
+};
+
+/// actor description used for offline priority suggestion
+struct FocusHeatmapActor
+{
+	float pos[3];
+	float radius;
+};
+
+/// sparse tiled grid, tiles are allocated on first write
+class FocusHeatmapGrid
+{
+public:
+	FocusHeatmapGrid(float cellSize);
+	~FocusHeatmapGrid();
+
+	void Add(float x, float y, float weight);
+	void AddRect(float left, float top, float right, float bottom, float weight);
+	float Get(float x, float y) const;
+	float Sum(float x, float y, float radius) const;
+	void Decay(float factor);
+	void Clear();
+
+	float GetCellSize() const { return cellSize; }
+
+	bool Write(FILE* file) const;
+	bool Read(FILE* file);
+
+private:
+	struct Tile
+	{
+		float cells[HEATMAP_TILE_SIZE * HEATMAP_TILE_SIZE];
+	};
+	typedef std::map<long long, Tile*> TileMap;
+
+	float* GetCell(int cx, int cy, bool create);
+	const float* FindCell(int cx, int cy) const;
+	static long long MakeKey(int tx, int ty) { return ((long long)tx << 32) | (unsigned int)ty; }
+
+	float cellSize;
+	TileMap tiles;
+};
+
+/// per map accumulation
+///  screen layer : where dynamic rects land, in normalized screen space
+///  world layer  : where camera and its focus land, top-down XY in world units
+class FocusHeatmap
+{
+public:
+	FocusHeatmap(const std::string& name, float worldCellSize = 256.0f, int screenCells = 64, float halfLife = 600.0f);
+	~FocusHeatmap();
+
+	void AddSample(const FocusHeatmapSample& sample);
+	void Decay(float deltaSeconds);
+
+	const std::string& GetName() const { return mapName; }
+	const FocusHeatmapGrid& GetScreenLayer() const { return screenLayer; }
+	const FocusHeatmapGrid& GetWorldLayer() const { return worldLayer; }
+
+	bool Save(const char* path) const;
+	bool Load(const char* path);
+
+	/// map heat around each actor to static priority 0 --- 127, ranked across given actors
+	void SuggestStaticPriorities(const std::vector<FocusHeatmapActor>& actors, std::vector<int>& outPriorities) const;
+
+private:
+	std::string mapName;
+	float halfLife;
+	int screenCells;
+	FocusHeatmapGrid screenLayer;
+	FocusHeatmapGrid worldLayer;
+};
+
+/// single producer / single consumer sample queue, filled by the session's receive thread
+/// without locking and drained by FocusHeatmapService::Merge
+class FocusHeatmapSession
+{
+public:
+	FocusHeatmapSession(const std::string& mapName, float screenWidth, float screenHeight);
+	~FocusHeatmapSession() {}
+
+	void Accumulate(const FocusInfo* info);
+
+	const std::string& GetMapName() const { return mapName; }
+	unsigned int GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	friend class FocusHeatmapService;
+
+	bool Push(const FocusHeatmapSample& sample);
+	bool Pop(FocusHeatmapSample& sample);
+
+	std::string mapName;
+	float screenWidth;
+	float screenHeight;
+
+	FocusHeatmapSample samples[HEATMAP_SESSION_QUEUE_SIZE];
+	std::atomic<unsigned int> head;		/// written by producer
+	std::atomic<unsigned int> tail;		/// written by consumer
+	std::atomic<unsigned int> dropped;
+};
+
+class FocusHeatmapService
+{
+public:
+	FocusHeatmapService(const char* dataDir = ".");
+	~FocusHeatmapService();
+
+	FocusHeatmapSession* OpenSession(const std::string& mapName, float screenWidth, float screenHeight);
+	void CloseSession(FocusHeatmapSession* session);
+
+	/// drain every session into its map heatmap, call periodically from one thread
+	void Merge(float deltaSeconds);
+	bool SaveAll();
+
+	FocusHeatmap* GetHeatmap(const std::string& mapName);
+
+private:
+	std::string GetPath(const std::string& mapName) const;
+	void Drain(FocusHeatmapSession* session);
+
+	std::string dataDir;
+	std::mutex sessionLock;		/// guards session list only, never taken while accumulating
+	std::vector<FocusHeatmapSession*> sessions;
+	std::vector<FocusHeatmapSession*> closedSessions;
+	std::map<std::string, FocusHeatmap*> heatmaps;
+};
+
+#endif // !__FOCUS_HEATMAP_H__
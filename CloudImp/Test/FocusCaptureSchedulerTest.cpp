@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "FocusCaptureScheduler.h"
+
+class CountingCapture : public FocusCaptureScreenBase
+{
+public:
+	CountingCapture() : FocusCaptureScreenBase(0, 0, false, NULL), screenCount(0), uiCount(0) {}
+
+	virtual void Update() {}
+	virtual unsigned char* CaptureScreenToMemory(unsigned int& size) { size = 0; return NULL; }
+	virtual bool CaptureScreenToDisk(const char* path) { screenCount++; return true; }
+	virtual bool CaptureUIToDisk(const char* path) { uiCount++; return true; }
+
+	int screenCount;
+	int uiCount;
+};
+
+TEST(FocusCaptureScheduler, DefaultIntervalKeepsExplicitIntervals)
+{
+	CountingCapture explicitCapture;
+	CountingCapture defaultCapture;
+	FocusCaptureScheduler scheduler;
+	scheduler.SetCaptureUI(false);
+	scheduler.SetMaxPerFrame(2);
+	scheduler.SetDefaultInterval(10.0f);
+	scheduler.Add(&explicitCapture, 1.0f);
+	scheduler.Add(&defaultCapture, -1.0f);
+
+	scheduler.SetDefaultInterval(2.0f);
+	for (int i = 0; i < 4; i++)
+	{
+		scheduler.Update(1.0f);
+	}
+
+	EXPECT_EQ(4, explicitCapture.screenCount);
+	EXPECT_EQ(2, defaultCapture.screenCount);
+}
+
+TEST(FocusCaptureScheduler, BudgetSpreadsDueCaptures)
+{
+	CountingCapture a;
+	CountingCapture b;
+	FocusCaptureScheduler scheduler;
+	scheduler.SetCaptureUI(false);
+	scheduler.SetMaxPerFrame(1);
+	scheduler.Add(&a, 0.0f);
+	scheduler.Add(&b, 0.0f);
+
+	scheduler.Trigger();
+	EXPECT_EQ(2, scheduler.GetPendingCount());
+	scheduler.Update(0.0f);
+	EXPECT_EQ(1, a.screenCount + b.screenCount);
+	scheduler.Update(0.0f);
+	EXPECT_EQ(1, a.screenCount);
+	EXPECT_EQ(1, b.screenCount);
+	EXPECT_EQ(0, scheduler.GetPendingCount());
+}
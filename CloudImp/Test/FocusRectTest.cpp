@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "FocusRect.h"
+
+static FocusRectInfo MakeRect(int prio, float left, float top, float right, float bottom, float dist)
+{
+	FocusRectInfo r;
+	r.priority = prio;
+	r.left = left;
+	r.top = top;
+	r.right = right;
+	r.bottom = bottom;
+	r.distToCam = dist;
+	return r;
+}
+
+static float Area(const FocusRectInfo& r)
+{
+	return (r.right - r.left) * (r.bottom - r.top);
+}
+
+static float TotalArea(const std::vector<FocusRectInfo*>& rects)
+{
+	float area = 0.0f;
+	for (int i = 0; i < rects.size(); i++)
+	{
+		area += Area(*rects[i]);
+	}
+	return area;
+}
+
+static void FreeRects(std::vector<FocusRectInfo*>& rects)
+{
+	for (int i = 0; i < rects.size(); i++)
+	{
+		delete rects[i];
+	}
+	rects.clear();
+}
+
+TEST(FocusClipRect, NotOverlapped)
+{
+	FocusRectInfo front = MakeRect(255, 0, 0, 10, 10, 1);
+	FocusRectInfo back = MakeRect(255, 10, 0, 20, 10, 2);
+	FocusRectInfo temp[FOCUS_MAX_CLIP_PIECES];
+	EXPECT_EQ(-1, FocusClipRect(&front, &back, temp));
+}
+
+TEST(FocusClipRect, FullyCovered)
+{
+	FocusRectInfo front = MakeRect(255, 0, 0, 100, 100, 1);
+	FocusRectInfo back = MakeRect(10, 10, 10, 20, 20, 2);
+	FocusRectInfo temp[FOCUS_MAX_CLIP_PIECES];
+	EXPECT_EQ(0, FocusClipRect(&front, &back, temp));
+}
+
+TEST(FocusClipRect, HoleLeavesFourPieces)
+{
+	FocusRectInfo front = MakeRect(255, 40, 40, 60, 60, 1);
+	FocusRectInfo back = MakeRect(10, 0, 0, 100, 100, 2);
+	FocusRectInfo temp[FOCUS_MAX_CLIP_PIECES];
+	ASSERT_EQ(4, FocusClipRect(&front, &back, temp));
+
+	float area = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		area += Area(temp[i]);
+		EXPECT_EQ(10, temp[i].priority);
+		EXPECT_FLOAT_EQ(2.0f, temp[i].distToCam);
+		EXPECT_FALSE(FocusCheckOverlapped(&temp[i], &front));
+		for (int j = i + 1; j < 4; j++)
+		{
+			EXPECT_FALSE(FocusCheckOverlapped(&temp[i], &temp[j]));
+		}
+	}
+	EXPECT_FLOAT_EQ(Area(back) - Area(front), area);
+}
+
+TEST(FocusClipRect, EdgeOverlapLeavesOnePiece)
+{
+	FocusRectInfo front = MakeRect(255, 50, -10, 150, 110, 1);
+	FocusRectInfo back = MakeRect(10, 0, 0, 100, 100, 2);
+	FocusRectInfo temp[FOCUS_MAX_CLIP_PIECES];
+	ASSERT_EQ(1, FocusClipRect(&front, &back, temp));
+	EXPECT_FLOAT_EQ(0.0f, temp[0].left);
+	EXPECT_FLOAT_EQ(50.0f, temp[0].right);
+	EXPECT_FLOAT_EQ(0.0f, temp[0].top);
+	EXPECT_FLOAT_EQ(100.0f, temp[0].bottom);
+}
+
+TEST(FocusClipOccludedRects, NearerRectHidesFartherOne)
+{
+	std::vector<FocusRectInfo*> rects;
+	rects.push_back(new FocusRectInfo(MakeRect(10, 10, 10, 20, 20, 500)));
+	rects.push_back(new FocusRectInfo(MakeRect(255, 0, 0, 100, 100, 100)));
+
+	FocusClipOccludedRects(rects);
+
+	ASSERT_EQ(1, rects.size());
+	EXPECT_EQ(255, rects[0]->priority);
+	EXPECT_FLOAT_EQ(100.0f, rects[0]->distToCam);
+	FreeRects(rects);
+}
+
+TEST(FocusClipOccludedRects, VisiblePiecesDoNotOverlap)
+{
+	std::vector<FocusRectInfo*> rects;
+	rects.push_back(new FocusRectInfo(MakeRect(10, 0, 0, 100, 100, 300)));
+	rects.push_back(new FocusRectInfo(MakeRect(255, 20, 20, 60, 60, 100)));
+	rects.push_back(new FocusRectInfo(MakeRect(200, 40, 40, 80, 80, 200)));
+
+	FocusClipOccludedRects(rects);
+
+	/// union of the three rects is the farthest one, fully covered without overlap
+	EXPECT_FLOAT_EQ(100.0f * 100.0f, TotalArea(rects));
+	for (int i = 0; i < rects.size(); i++)
+	{
+		for (int j = i + 1; j < rects.size(); j++)
+		{
+			EXPECT_FALSE(FocusCheckOverlapped(rects[i], rects[j]));
+		}
+	}
+
+	/// nearest rect survives untouched and comes first
+	EXPECT_EQ(255, rects[0]->priority);
+	EXPECT_FLOAT_EQ(40.0f * 40.0f, Area(*rects[0]));
+	FreeRects(rects);
+}
+
+TEST(FocusClipOccludedRects, DisjointRectsUnchanged)
+{
+	std::vector<FocusRectInfo*> rects;
+	rects.push_back(new FocusRectInfo(MakeRect(10, 0, 0, 10, 10, 2)));
+	rects.push_back(new FocusRectInfo(MakeRect(20, 20, 20, 30, 30, 1)));
+
+	FocusClipOccludedRects(rects);
+
+	ASSERT_EQ(2, rects.size());
+	EXPECT_EQ(20, rects[0]->priority);
+	EXPECT_EQ(10, rects[1]->priority);
+	FreeRects(rects);
+}
+
+TEST(FocusMergeRects, AdjacentSamePriorityMerged)
+{
+	std::vector<FocusRectInfo*> rects;
+	rects.push_back(new FocusRectInfo(MakeRect(10, 0, 0, 50, 100, 300)));
+	rects.push_back(new FocusRectInfo(MakeRect(10, 50, 0, 100, 100, 200)));
+
+	FocusMergeRects(rects);
+
+	ASSERT_EQ(1, rects.size());
+	EXPECT_FLOAT_EQ(0.0f, rects[0]->left);
+	EXPECT_FLOAT_EQ(100.0f, rects[0]->right);
+	EXPECT_FLOAT_EQ(200.0f, rects[0]->distToCam);
+	FreeRects(rects);
+}
+
+TEST(FocusMergeRects, DifferentPriorityKept)
+{
+	std::vector<FocusRectInfo*> rects;
+	rects.push_back(new FocusRectInfo(MakeRect(10, 0, 0, 50, 100, 1)));
+	rects.push_back(new FocusRectInfo(MakeRect(20, 50, 0, 100, 100, 1)));
+
+	FocusMergeRects(rects);
+
+	EXPECT_EQ(2, rects.size());
+	FreeRects(rects);
+}
+
+TEST(FocusMergeRects, WastefulMergeRejected)
+{
+	std::vector<FocusRectInfo*> rects;
+	rects.push_back(new FocusRectInfo(MakeRect(10, 0, 0, 10, 10, 1)));
+	rects.push_back(new FocusRectInfo(MakeRect(10, 90, 90, 100, 100, 1)));
+
+	FocusMergeRects(rects, 0.2f);
+	EXPECT_EQ(2, rects.size());
+
+	/// bounding rect is 50 times the covered area
+	FocusMergeRects(rects, 50.0f);
+	EXPECT_EQ(1, rects.size());
+	FreeRects(rects);
+}
+
+TEST(FocusMergeRects, ChainMergesToOne)
+{
+	std::vector<FocusRectInfo*> rects;
+	for (int i = 0; i < 8; i++)
+	{
+		rects.push_back(new FocusRectInfo(MakeRect(10, i * 10.0f, 0, i * 10.0f + 10.0f, 10, 1)));
+	}
+
+	FocusMergeRects(rects, 0.0f);
+
+	ASSERT_EQ(1, rects.size());
+	EXPECT_FLOAT_EQ(80.0f * 10.0f, Area(*rects[0]));
+	FreeRects(rects);
+}
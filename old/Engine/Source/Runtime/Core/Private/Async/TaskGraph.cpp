@@ -23,6 +23,8 @@
 #include "Math/RandomStream.h"
 #include "HAL/IConsoleManager.h"
 #include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
 #include "Containers/LockFreeFixedSizeAllocator.h"
 #include "Async/TaskGraphInterfaces.h"
 
@@ -70,6 +72,9 @@ static FAutoConsoleVariableRef CVarFastScheduler(
 	ECVF_Cheat
 	);
 
+/** Set at startup from -TaskGraphWorkStealing, the anythread tasks then go through per worker deques instead of the shared queues. Can't be switched at runtime. */
+static bool GWorkStealingScheduler = false;
+
 // move to platform abstraction
 #if PLATFORM_XBOXONE || PLATFORM_PS4
 #define PLATFORM_OK_TO_BURN_CPU (1)
@@ -1324,7 +1329,11 @@ private:
 
 				NotifyStalling();
 				TestRandomizedThreads();
-				Queue.StallRestartEvent->Wait(MAX_uint32, bCountAsStall);
+				// with work stealing, a task may have been pushed to some deque after we looked and before we were on the stalled list
+				if (!IsWorkAvailable())
+				{
+					Queue.StallRestartEvent->Wait(MAX_uint32, bCountAsStall);
+				}
 				TestRandomizedThreads();
 				Queue.StallRestartEvent->Reset();
 			}
@@ -1342,6 +1351,12 @@ private:
 	 */
 	void NotifyStalling();
 
+	/**
+	 *	Internal function to check for queued work after NotifyStalling, only used by the work stealing scheduler.
+	 *	@return true if there is work this thread could pick up.
+	 */
+	bool IsWorkAvailable();
+
 	/** Array of queues, only the first one is used for unnamed threads. **/
 	FThreadTaskQueue Queue;
 
@@ -1377,6 +1392,152 @@ struct FWorkerThread
 	}
 };
 
+/**
+ *	FWorkStealingTaskDeque
+ *	Chase-Lev deque of anythread tasks owned by one worker thread. The owner pushes and pops at the bottom (LIFO, so
+ *	the task it just spawned runs next while its data is still in cache), other workers steal from the top.
+ *	The capacity is fixed so steals never race with a resize, a full deque makes the owner use the shared queues.
+**/
+class FWorkStealingTaskDeque
+{
+public:
+	enum
+	{
+		Capacity = 4096
+	};
+
+	FWorkStealingTaskDeque()
+		: Top(0)
+		, Bottom(0)
+	{
+		FMemory::Memzero(Tasks);
+	}
+
+	/** Owner only. @return false if the deque is full. **/
+	bool Push(FBaseGraphTask* Task)
+	{
+		const int64 LocalBottom = Bottom;
+		if (LocalBottom - Top >= Capacity)
+		{
+			return false;
+		}
+		Tasks[LocalBottom & (Capacity - 1)] = Task;
+		FPlatformMisc::MemoryBarrier(); // the task must be visible before thieves can see the new bottom
+		Bottom = LocalBottom + 1;
+		return true;
+	}
+
+	/** Owner only. @param bOutLostRace set if a thief took the last task first. **/
+	FBaseGraphTask* Pop(bool& bOutLostRace)
+	{
+		const int64 LocalBottom = Bottom - 1;
+		FPlatformAtomics::InterlockedExchange(&Bottom, LocalBottom); // full barrier, the read of Top must not move above this
+		const int64 LocalTop = Top;
+		if (LocalTop > LocalBottom)
+		{
+			Bottom = LocalTop;
+			return nullptr;
+		}
+		FBaseGraphTask* Task = Tasks[LocalBottom & (Capacity - 1)];
+		if (LocalTop == LocalBottom)
+		{
+			// last task, thieves may be after it too
+			if (FPlatformAtomics::InterlockedCompareExchange(&Top, LocalTop + 1, LocalTop) != LocalTop)
+			{
+				Task = nullptr;
+				bOutLostRace = true;
+			}
+			Bottom = LocalTop + 1;
+		}
+		return Task;
+	}
+
+	/** Any thread. @param bOutContended set if another thread took the task we were after. **/
+	FBaseGraphTask* Steal(bool& bOutContended)
+	{
+		const int64 LocalTop = Top;
+		FPlatformMisc::MemoryBarrier();
+		const int64 LocalBottom = Bottom;
+		if (LocalTop >= LocalBottom)
+		{
+			return nullptr;
+		}
+		FBaseGraphTask* Task = Tasks[LocalTop & (Capacity - 1)];
+		if (FPlatformAtomics::InterlockedCompareExchange(&Top, LocalTop + 1, LocalTop) != LocalTop)
+		{
+			bOutContended = true;
+			return nullptr;
+		}
+		return Task;
+	}
+
+	bool IsEmpty() const
+	{
+		return Bottom <= Top;
+	}
+
+private:
+	volatile int64 Top;
+	uint8 PadToAvoidContention[PLATFORM_CACHE_LINE_SIZE - sizeof(int64)];
+	volatile int64 Bottom;
+	FBaseGraphTask* Tasks[Capacity];
+};
+
+/** Counters of the work stealing scheduler, summed over the workers **/
+struct FWorkStealingStats
+{
+	/** Tasks queued to the queuing worker's own deque **/
+	int64 LocalPushes;
+	/** Tasks queued to the shared queues because the worker's deque was full **/
+	int64 Overflows;
+	/** Tasks a worker took from its own deque **/
+	int64 LocalPops;
+	/** Tasks taken from the shared queues (queued from named or external threads, high priority or overflowed) **/
+	int64 SharedPops;
+	/** Tasks taken from another worker's deque **/
+	int64 Steals;
+	/** Steals and last task pops that lost the race to another thread **/
+	int64 Contentions;
+	/** Times a worker found no work and got ready to sleep **/
+	int64 Stalls;
+
+	FWorkStealingStats()
+	{
+		FMemory::Memzero(this, sizeof(*this));
+	}
+};
+
+/**
+ *	FWorkStealingWorker
+ *	Work stealing state of one worker thread. Counters are only written by the owning thread, reading them from other threads gives approximate numbers.
+**/
+struct FWorkStealingWorker
+{
+	FWorkStealingTaskDeque Deque;
+	/** Set while this thread is on the stalled list, so it is only added once **/
+	FThreadSafeCounter StallHinted;
+	/** Local pops since we last looked at the shared queue, so local work can't starve it **/
+	int32 LocalPopsSinceShared;
+	/** For picking the first victim to steal from **/
+	uint32 RandomSeed;
+	FWorkStealingStats Stats;
+
+	FWorkStealingWorker(uint32 InRandomSeed)
+		: LocalPopsSinceShared(0)
+		, RandomSeed(InRandomSeed)
+	{
+	}
+
+	uint32 NextRandom()
+	{
+		// xorshift
+		RandomSeed ^= RandomSeed << 13;
+		RandomSeed ^= RandomSeed >> 17;
+		RandomSeed ^= RandomSeed << 5;
+		return RandomSeed;
+	}
+};
+
 class FTaskGraphImplementation : public FTaskGraphInterface  
 {
 public:
@@ -1462,6 +1623,20 @@ public:
 			WorkerThreads[ThreadIndex].TaskGraphWorker->Setup(ENamedThreads::Type(ThreadIndex), PerThreadIDTLSSlot, &WorkerThreads[ThreadIndex]);
 		}
 
+		GWorkStealingScheduler = FPlatformProcess::SupportsMultithreading() && FParse::Param(FCommandLine::Get(), TEXT("TaskGraphWorkStealing"));
+		FMemory::Memzero(WorkStealingWorkers);
+		if (GWorkStealingScheduler)
+		{
+			// the fast scheduler has its own idea of which threads are stalled, keep it out of the way
+			GFastScheduler = 0;
+			GFastSchedulerLatched = 0;
+			for (int32 ThreadIndex = NumNamedThreads; ThreadIndex < NumThreads; ThreadIndex++)
+			{
+				WorkStealingWorkers[ThreadIndex] = new FWorkStealingWorker(0x9E3779B9u * (ThreadIndex + 1));
+			}
+			UE_LOG(LogTaskGraph, Log, TEXT("Using the work stealing scheduler."));
+		}
+
 		TaskGraphImplementationSingleton = this; // now reentrancy is ok
 
 		for (int32 ThreadIndex = LastExternalThread + 1; ThreadIndex < NumThreads; ThreadIndex++)
@@ -1522,6 +1697,12 @@ public:
 			StalledUnnamedThreads[PriorityIndex].PopAll(NotProperlyUnstalled);
 		}
 		FPlatformTLS::FreeTlsSlot(PerThreadIDTLSSlot);
+		for (int32 ThreadIndex = 0; ThreadIndex < NumThreads; ThreadIndex++)
+		{
+			delete WorkStealingWorkers[ThreadIndex];
+			WorkStealingWorkers[ThreadIndex] = nullptr;
+		}
+		GWorkStealingScheduler = false;
 	}
 
 	// API inherited from FTaskGraphInterface
@@ -1538,7 +1719,12 @@ public:
 
 		TestRandomizedThreads();
 		checkThreadGraph(NumTaskThreadsPerSet);
-		if (GFastSchedulerLatched != GFastScheduler && IsInGameThread())
+		if (GWorkStealingScheduler && ENamedThreads::GetThreadIndex(ThreadToExecuteOn) == ENamedThreads::AnyThread)
+		{
+			QueueTaskWorkStealing(Task, InCurrentThreadIfKnown);
+			return;
+		}
+		if (!GWorkStealingScheduler && GFastSchedulerLatched != GFastScheduler && IsInGameThread())
 		{
 #if USE_NEW_LOCK_FREE_LISTS
 			GFastScheduler = !!FApp::ShouldUseThreadingForPerformance();
@@ -1590,19 +1776,9 @@ public:
 			TASKGRAPH_SCOPE_CYCLE_COUNTER(3, STAT_TaskGraph_QueueTask_AnyThread);
 			if (FPlatformProcess::SupportsMultithreading())
 			{
-				int32 TaskPriority = ENamedThreads::GetTaskPriority(Task->ThreadToExecuteOn);
-				int32 Priority = ENamedThreads::GetThreadPriorityIndex(Task->ThreadToExecuteOn);
-				if (Priority == (ENamedThreads::BackgroundThreadPriority >> ENamedThreads::ThreadPriorityShift) && (!bCreatedBackgroundPriorityThreads || !ENamedThreads::bHasBackgroundThreads))
-				{
-					Priority = ENamedThreads::NormalThreadPriority >> ENamedThreads::ThreadPriorityShift; // we don't have background threads, promote to normal
-					TaskPriority = ENamedThreads::NormalTaskPriority >> ENamedThreads::TaskPriorityShift; // demote to normal task pri
-				}
-				else if (Priority == (ENamedThreads::HighThreadPriority >> ENamedThreads::ThreadPriorityShift) && (!bCreatedHiPriorityThreads || !ENamedThreads::bHasHighPriorityThreads))
-				{
-					Priority = ENamedThreads::NormalThreadPriority >> ENamedThreads::ThreadPriorityShift; // we don't have hi priority threads, demote to normal
-					TaskPriority = ENamedThreads::HighTaskPriority >> ENamedThreads::TaskPriorityShift; // promote to hi task pri
-				}
-				check(Priority >= 0 && Priority < MAX_THREAD_PRIORITIES);
+				int32 TaskPriority;
+				int32 Priority;
+				GetAnyThreadTaskPriorities(Task, Priority, TaskPriority);
 
 				{
 					TASKGRAPH_SCOPE_CYCLE_COUNTER(4, STAT_TaskGraph_QueueTask_IncomingAnyThreadTasks_Push);
@@ -1693,6 +1869,232 @@ public:
 	}
 
 
+	/** 
+	 *	Works out which set of task threads an anythread task runs on and whether it goes in the high priority queue of that set.
+	 *	@param	Task; the task being queued
+	 *	@param	OutPriority; index of the task thread set
+	 *	@param	OutTaskPriority; non zero for high priority tasks
+	**/
+	void GetAnyThreadTaskPriorities(FBaseGraphTask* Task, int32& OutPriority, int32& OutTaskPriority)
+	{
+		OutTaskPriority = ENamedThreads::GetTaskPriority(Task->ThreadToExecuteOn);
+		OutPriority = ENamedThreads::GetThreadPriorityIndex(Task->ThreadToExecuteOn);
+		if (OutPriority == (ENamedThreads::BackgroundThreadPriority >> ENamedThreads::ThreadPriorityShift) && (!bCreatedBackgroundPriorityThreads || !ENamedThreads::bHasBackgroundThreads))
+		{
+			OutPriority = ENamedThreads::NormalThreadPriority >> ENamedThreads::ThreadPriorityShift; // we don't have background threads, promote to normal
+			OutTaskPriority = ENamedThreads::NormalTaskPriority >> ENamedThreads::TaskPriorityShift; // demote to normal task pri
+		}
+		else if (OutPriority == (ENamedThreads::HighThreadPriority >> ENamedThreads::ThreadPriorityShift) && (!bCreatedHiPriorityThreads || !ENamedThreads::bHasHighPriorityThreads))
+		{
+			OutPriority = ENamedThreads::NormalThreadPriority >> ENamedThreads::ThreadPriorityShift; // we don't have hi priority threads, demote to normal
+			OutTaskPriority = ENamedThreads::HighTaskPriority >> ENamedThreads::TaskPriorityShift; // promote to hi task pri
+		}
+		check(OutPriority >= 0 && OutPriority < MAX_THREAD_PRIORITIES);
+	}
+
+	// Work stealing scheduler
+
+	/** 
+	 *	Queues an anythread task with the work stealing scheduler. Normal priority tasks queued from a worker of the right set go to that worker's deque,
+	 *	everything else goes to the shared queues. Then one stalled worker of the set is woken up to go look for it.
+	**/
+	void QueueTaskWorkStealing(FBaseGraphTask* Task, ENamedThreads::Type InCurrentThreadIfKnown)
+	{
+		int32 TaskPriority;
+		int32 Priority;
+		GetAnyThreadTaskPriorities(Task, Priority, TaskPriority);
+
+		int32 CurrentThreadIndex = ENamedThreads::GetThreadIndex(InCurrentThreadIfKnown);
+		if (CurrentThreadIndex == ENamedThreads::AnyThread)
+		{
+			CurrentThreadIndex = ENamedThreads::GetThreadIndex(GetCurrentThread());
+		}
+
+		FWorkStealingWorker* CurrentWorker = nullptr;
+		if (CurrentThreadIndex >= NumNamedThreads && CurrentThreadIndex < NumThreads && ThreadIndexToPriorityIndex(CurrentThreadIndex) == Priority)
+		{
+			CurrentWorker = WorkStealingWorkers[CurrentThreadIndex];
+		}
+
+		if (!TaskPriority && CurrentWorker && CurrentWorker->Deque.Push(Task))
+		{
+			CurrentWorker->Stats.LocalPushes++;
+		}
+		else
+		{
+			if (!TaskPriority && CurrentWorker)
+			{
+				CurrentWorker->Stats.Overflows++;
+			}
+			if (TaskPriority)
+			{
+				IncomingAnyThreadTasksHiPri[Priority].Push(Task);
+			}
+			else
+			{
+				IncomingAnyThreadTasks[Priority].Push(Task);
+			}
+		}
+
+		// pairs with the barrier in FTaskThreadAnyThread::Stall, either we see the stalled thread or it sees the task
+		FPlatformMisc::MemoryBarrier();
+
+		for (int32 Attempt = 0; Attempt < 2; Attempt++)
+		{
+			FTaskThreadBase* StalledThread = StalledUnnamedThreads[Priority].Pop();
+			if (!StalledThread)
+			{
+				break;
+			}
+			const int32 StalledThreadIndex = StalledThread->GetThreadId();
+			WorkStealingWorkers[StalledThreadIndex]->StallHinted.Reset();
+			if (StalledThreadIndex != CurrentThreadIndex)
+			{
+				StalledThread->WakeUp();
+				break;
+			}
+			// that was us, left over from a stall that found work in the end; try the next one
+		}
+	}
+
+	/** 
+	 *	Finds work for a worker with the work stealing scheduler: high priority shared tasks first, then the worker's own deque, then the shared queue and finally
+	 *	tasks stolen from the other workers of the set, starting at a random one.
+	 *	@param	ThreadInNeed; Id of the thread requesting work.
+	 *	@return Task to run, or nullptr if there is none.
+	**/
+	FBaseGraphTask* FindWorkStealing(ENamedThreads::Type ThreadInNeed)
+	{
+		const int32 ThreadIndex = ENamedThreads::GetThreadIndex(ThreadInNeed);
+		const int32 Priority = ThreadIndexToPriorityIndex(ThreadIndex);
+		FWorkStealingWorker& Worker = *WorkStealingWorkers[ThreadIndex];
+
+		FBaseGraphTask* Task = IncomingAnyThreadTasksHiPri[Priority].Pop();
+		if (Task)
+		{
+			Worker.Stats.SharedPops++;
+			return Task;
+		}
+
+		// every so often look at the shared queue first, so tasks queued by the named threads still get picked up while the workers are busy with local work
+		const bool bSharedFirst = ++Worker.LocalPopsSinceShared >= 32;
+		if (bSharedFirst)
+		{
+			Worker.LocalPopsSinceShared = 0;
+			Task = IncomingAnyThreadTasks[Priority].Pop();
+			if (Task)
+			{
+				Worker.Stats.SharedPops++;
+				return Task;
+			}
+		}
+
+		bool bLostRace = false;
+		Task = Worker.Deque.Pop(bLostRace);
+		if (bLostRace)
+		{
+			Worker.Stats.Contentions++;
+		}
+		if (Task)
+		{
+			Worker.Stats.LocalPops++;
+			return Task;
+		}
+
+		if (!bSharedFirst)
+		{
+			Task = IncomingAnyThreadTasks[Priority].Pop();
+			if (Task)
+			{
+				Worker.LocalPopsSinceShared = 0;
+				Worker.Stats.SharedPops++;
+				return Task;
+			}
+		}
+
+		const int32 FirstThreadOfSet = NumNamedThreads + Priority * NumTaskThreadsPerSet;
+		for (int32 Pass = 0; Pass < 2; Pass++)
+		{
+			bool bContended = false;
+			const int32 StartVictim = Worker.NextRandom() % NumTaskThreadsPerSet;
+			for (int32 VictimOffset = 0; VictimOffset < NumTaskThreadsPerSet; VictimOffset++)
+			{
+				const int32 VictimIndex = FirstThreadOfSet + (StartVictim + VictimOffset) % NumTaskThreadsPerSet;
+				if (VictimIndex != ThreadIndex)
+				{
+					bool bVictimContended = false;
+					Task = WorkStealingWorkers[VictimIndex]->Deque.Steal(bVictimContended);
+					if (bVictimContended)
+					{
+						Worker.Stats.Contentions++;
+						bContended = true;
+					}
+					if (Task)
+					{
+						Worker.Stats.Steals++;
+						return Task;
+					}
+				}
+			}
+			// only go around again if we lost a race, an empty pass means there is nothing to steal
+			if (!bContended)
+			{
+				break;
+			}
+		}
+		return nullptr;
+	}
+
+	/** 
+	 *	Checks all the queues a worker could take tasks from, used by stalling workers to close the race with QueueTaskWorkStealing.
+	 *	@param	ThreadInNeed; Id of the thread about to stall.
+	 *	@return true if there is work.
+	**/
+	bool IsWorkAvailable(ENamedThreads::Type ThreadInNeed)
+	{
+		if (!GWorkStealingScheduler)
+		{
+			return false;
+		}
+		const int32 Priority = ThreadIndexToPriorityIndex(ENamedThreads::GetThreadIndex(ThreadInNeed));
+		if (!IncomingAnyThreadTasksHiPri[Priority].IsEmpty() || !IncomingAnyThreadTasks[Priority].IsEmpty())
+		{
+			return true;
+		}
+		const int32 FirstThreadOfSet = NumNamedThreads + Priority * NumTaskThreadsPerSet;
+		for (int32 ThreadIndex = FirstThreadOfSet; ThreadIndex < FirstThreadOfSet + NumTaskThreadsPerSet; ThreadIndex++)
+		{
+			if (!WorkStealingWorkers[ThreadIndex]->Deque.IsEmpty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** 
+	 *	Sums up the work stealing counters of all workers, all zero if the work stealing scheduler is not in use.
+	**/
+	FWorkStealingStats GetWorkStealingStats()
+	{
+		FWorkStealingStats Result;
+		for (int32 ThreadIndex = NumNamedThreads; ThreadIndex < NumThreads; ThreadIndex++)
+		{
+			if (WorkStealingWorkers[ThreadIndex])
+			{
+				const FWorkStealingStats& Stats = WorkStealingWorkers[ThreadIndex]->Stats;
+				Result.LocalPushes += Stats.LocalPushes;
+				Result.Overflows += Stats.Overflows;
+				Result.LocalPops += Stats.LocalPops;
+				Result.SharedPops += Stats.SharedPops;
+				Result.Steals += Stats.Steals;
+				Result.Contentions += Stats.Contentions;
+				Result.Stalls += Stats.Stalls;
+			}
+		}
+		return Result;
+	}
+
 	virtual	int32 GetNumWorkerThreads() final override
 	{
 		int32 Result = (NumThreads - NumNamedThreads) / NumTaskThreadSets - GNumWorkerThreadsToIgnore;
@@ -2172,6 +2574,17 @@ public:
 	**/
 	void NotifyStalling(ENamedThreads::Type StallingThread)
 	{
+		if (GWorkStealingScheduler)
+		{
+			FWorkStealingWorker& Worker = *WorkStealingWorkers[StallingThread];
+			Worker.Stats.Stalls++;
+			if (Worker.StallHinted.Set(1) == 0)
+			{
+				StalledUnnamedThreads[ThreadIndexToPriorityIndex(StallingThread)].Push(&Thread(StallingThread));
+			}
+			FPlatformMisc::MemoryBarrier();
+			return;
+		}
 		if (StallingThread >= NumNamedThreads && !GFastSchedulerLatched)
 		{
 			int32 LocalNumWorkingThread = GetNumWorkerThreads();
@@ -2285,6 +2698,8 @@ private:
 
 	/** Array of callbacks to call before shutdown. **/
 	TArray<TFunction<void()> > ShutdownCallbacks;
+	/** Per worker state of the work stealing scheduler, indexed by thread index. Only allocated for the worker threads when it is in use. **/
+	FWorkStealingWorker* WorkStealingWorkers[MAX_THREADS];
 
 #if USE_NEW_LOCK_FREE_LISTS
 #if USE_INTRUSIVE_TASKQUEUES
@@ -2412,6 +2827,10 @@ private:
 
 FBaseGraphTask* FTaskThreadAnyThread::FindWork()
 {
+	if (GWorkStealingScheduler)
+	{
+		return FTaskGraphImplementation::Get().FindWorkStealing(ThreadId);
+	}
 	return FTaskGraphImplementation::Get().FindWork(ThreadId);
 }
 
@@ -2420,6 +2839,11 @@ void FTaskThreadAnyThread::NotifyStalling()
 	return FTaskGraphImplementation::Get().NotifyStalling(ThreadId);
 }
 
+bool FTaskThreadAnyThread::IsWorkAvailable()
+{
+	return FTaskGraphImplementation::Get().IsWorkAvailable(ThreadId);
+}
+
 
 
 // Statics in FTaskGraphInterface
@@ -2904,6 +3328,61 @@ private:
 };
 
 
+/** Task for the fork/join and DAG benchmarks: forks Branching children while Depth > 0 and completes when they have, otherwise does some work **/
+class FForkJoinGraphTask : public FCustomStatIDGraphTaskBase
+{
+public:
+	FORCEINLINE FForkJoinGraphTask(FThreadSafeCounter& InCounter, FThreadSafeCounter& InCycles, int32 InWork, int32 InDepth, int32 InBranching)
+		: FCustomStatIDGraphTaskBase(TStatId())
+		, Counter(InCounter)
+		, Cycles(InCycles)
+		, Work(InWork)
+		, Depth(InDepth)
+		, Branching(InBranching)
+	{
+	}
+	static FORCEINLINE ENamedThreads::Type GetDesiredThread()
+	{
+		return ENamedThreads::AnyThread;
+	}
+
+	static FORCEINLINE ESubsequentsMode::Type GetSubsequentsMode() { return ESubsequentsMode::TrackSubsequents; }
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+	{
+		if (Depth > 0)
+		{
+			for (int32 Index = 0; Index < Branching; Index++)
+			{
+				MyCompletionGraphEvent->DontCompleteUntil(TGraphTask<FForkJoinGraphTask>::CreateTask(nullptr, CurrentThread).ConstructAndDispatchWhenReady(Counter, Cycles, Work, Depth - 1, Branching));
+			}
+		}
+		else
+		{
+			DoWork(this, Counter, Cycles, Work);
+		}
+	}
+private:
+	FThreadSafeCounter& Counter;
+	FThreadSafeCounter& Cycles;
+	int32 Work;
+	int32 Depth;
+	int32 Branching;
+};
+
+static void PrintWorkStealingStats(const FWorkStealingStats& Stats, const FWorkStealingStats& Since)
+{
+	if (!GWorkStealingScheduler)
+	{
+		UE_LOG(LogConsoleResponse, Display, TEXT("Work stealing scheduler not in use, start with -TaskGraphWorkStealing to enable it."));
+		return;
+	}
+	const int64 Steals = Stats.Steals - Since.Steals;
+	const int64 Contentions = Stats.Contentions - Since.Contentions;
+	UE_LOG(LogConsoleResponse, Display, TEXT("Work stealing: %lld local pushes, %lld overflows, %lld local pops, %lld shared pops, %lld steals, %lld contended (%.1f%% of steals), %lld stalls"),
+		Stats.LocalPushes - Since.LocalPushes, Stats.Overflows - Since.Overflows, Stats.LocalPops - Since.LocalPops, Stats.SharedPops - Since.SharedPops,
+		Steals, Contentions, Steals > 0 ? 100.0 * Contentions / Steals : 0.0, Stats.Stalls - Since.Stalls);
+}
+
 void PrintResult(double& StartTime, double& QueueTime, double& EndTime, double& JoinTime, FThreadSafeCounter& Counter, FThreadSafeCounter& Cycles, const TCHAR* Message)
 {
 	UE_LOG(LogConsoleResponse, Display, TEXT("Total %6.3fms   %6.3fms queue   %6.3fms join   %6.3fms wait   %6.3fms work   : %s")
@@ -3168,8 +3647,60 @@ static void TaskGraphBenchmark(const TArray<FString>& Args)
 		EndTime = FPlatformTime::Seconds();
 	}
 	PrintResult(StartTime, QueueTime, EndTime, JoinTime, Counter, Cycles, TEXT("1000 element ParallelFor, single threaded, with work"));
+
+	{
+		const FWorkStealingStats StatsBefore = FTaskGraphImplementation::Get().GetWorkStealingStats();
+		StartTime = FPlatformTime::Seconds();
+		FGraphEventRef Root = TGraphTask<FForkJoinGraphTask>::CreateTask(nullptr, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(Counter, Cycles, 100, 6, 4);
+		QueueTime = FPlatformTime::Seconds();
+		JoinTime = QueueTime;
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(Root, ENamedThreads::GameThread_Local);
+		EndTime = FPlatformTime::Seconds();
+		PrintResult(StartTime, QueueTime, EndTime, JoinTime, Counter, Cycles, TEXT("fork/join tree, depth 6, 4 children per task, 4096 leaves with work"));
+		PrintWorkStealingStats(FTaskGraphImplementation::Get().GetWorkStealingStats(), StatsBefore);
+	}
+	{
+		const FWorkStealingStats StatsBefore = FTaskGraphImplementation::Get().GetWorkStealingStats();
+		StartTime = FPlatformTime::Seconds();
+		// 64 layers of 64 tasks, each depending on two neighbors in the layer above
+		const int32 LayerWidth = 64;
+		FGraphEventArray PreviousLayer;
+		for (int32 Layer = 0; Layer < 64; Layer++)
+		{
+			FGraphEventArray CurrentLayer;
+			for (int32 Index = 0; Index < LayerWidth; Index++)
+			{
+				FGraphEventArray Prerequisites;
+				if (PreviousLayer.Num())
+				{
+					Prerequisites.Add(PreviousLayer[Index]);
+					Prerequisites.Add(PreviousLayer[(Index + 1) % LayerWidth]);
+				}
+				CurrentLayer.Add(TGraphTask<FForkJoinGraphTask>::CreateTask(&Prerequisites, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(Counter, Cycles, 100, 0, 0));
+			}
+			PreviousLayer = MoveTemp(CurrentLayer);
+		}
+		QueueTime = FPlatformTime::Seconds();
+		FGraphEventRef Join = TGraphTask<FNullGraphTask>::CreateTask(&PreviousLayer, ENamedThreads::GameThread).ConstructAndDispatchWhenReady(TStatId(), ENamedThreads::AnyThread);
+		JoinTime = FPlatformTime::Seconds();
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(Join, ENamedThreads::GameThread_Local);
+		EndTime = FPlatformTime::Seconds();
+		PrintResult(StartTime, QueueTime, EndTime, JoinTime, Counter, Cycles, TEXT("DAG, 64 layers of 64 tasks with two prerequisites each, with work"));
+		PrintWorkStealingStats(FTaskGraphImplementation::Get().GetWorkStealingStats(), StatsBefore);
+	}
+}
+
+static void DumpWorkStealingStats(const TArray<FString>& Args)
+{
+	PrintWorkStealingStats(FTaskGraphImplementation::Get().GetWorkStealingStats(), FWorkStealingStats());
 }
 
+static FAutoConsoleCommand WorkStealingStatsCmd(
+	TEXT("TaskGraph.WorkStealingStats"),
+	TEXT("Prints the counters of the work stealing scheduler (-TaskGraphWorkStealing) since startup."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&DumpWorkStealingStats)
+	);
+
 static FAutoConsoleCommand TaskGraphBenchmarkCmd(
 	TEXT("TaskGraph.Benchmark"),
 	TEXT("Prints the time to run 1000 no-op tasks."),
@@ -0,0 +1,398 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "HAL/MallocSampling.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformStackWalk.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Logging/LogMacros.h"
+#include "CoreGlobals.h"
+
+static int32 GMallocSamplingRate = 1024;
+static FAutoConsoleVariableRef CVarMallocSamplingRate(
+	TEXT("memory.SamplingRate"),
+	GMallocSamplingRate,
+	TEXT("With the sampling malloc proxy on (-MallocSampling), the callstack of about one in this many allocations is recorded."));
+
+/** Callsites per thread table, tables are searched with linear probing */
+static const int32 NumCallsitesPerThread = 512;
+static const int32 MaxProbes = 32;
+
+/** Frames of the sampler itself at the top of each captured callstack */
+static const int32 NumSkippedFrames = 3;
+
+struct FMallocSamplingProxy::FThreadTable
+{
+	struct FCallsite
+	{
+		/** Written last, an entry with a zero hash is free */
+		volatile uint32 Hash;
+		uint64 Count;
+		uint64 Bytes;
+		uint64 Callstack[FMallocSamplingCallsite::CallstackDepth];
+	};
+
+	FThreadTable* Next;
+
+	/** Allocations left before the next sample, and the interval the current countdown started from */
+	int32 Countdown;
+	int32 Interval;
+
+	/** xorshift state for jittering the interval, so periodic allocation patterns don't alias with the sampling */
+	uint32 Random;
+
+	/** Set while sampling, allocations made by the stack walker are not sampled */
+	bool bRecording;
+
+	uint64 NumDropped;
+
+	FCallsite Callsites[NumCallsitesPerThread];
+};
+
+static FMallocSamplingProxy* GMallocSamplingProxy = nullptr;
+
+FMallocSamplingProxy::FMallocSamplingProxy(FMalloc* InMalloc)
+	: UsedMalloc(InMalloc)
+	, TlsSlot(FPlatformTLS::AllocTlsSlot())
+	, Tables(nullptr)
+	, StartTime(FPlatformTime::Seconds())
+{
+	checkf(UsedMalloc, TEXT("FMallocSamplingProxy is used without a valid malloc!"));
+}
+
+void FMallocSamplingProxy::Enable()
+{
+	if (PLATFORM_USES_FIXED_GMalloc_CLASS)
+	{
+		UE_LOG(LogMemory, Error, TEXT("Sampling proxy cannot be turned on because we are using PLATFORM_USES_FIXED_GMalloc_CLASS"));
+		return;
+	}
+	if (GMallocSamplingProxy)
+	{
+		UE_LOG(LogMemory, Error, TEXT("Sampling proxy was already turned on."));
+		return;
+	}
+	while (true)
+	{
+		FMalloc* LocalGMalloc = GMalloc;
+		FMallocSamplingProxy* Proxy = new FMallocSamplingProxy(LocalGMalloc);
+		if (FPlatformAtomics::InterlockedCompareExchangePointer((void**)&GMalloc, Proxy, LocalGMalloc) == LocalGMalloc)
+		{
+			GMallocSamplingProxy = Proxy;
+			UE_LOG(LogMemory, Display, TEXT("Sampling proxy is now on, sampling 1 in %d allocations."), GMallocSamplingRate);
+			return;
+		}
+		delete Proxy;
+	}
+}
+
+FMallocSamplingProxy* FMallocSamplingProxy::Get()
+{
+	return GMallocSamplingProxy;
+}
+
+FMallocSamplingProxy::FThreadTable* FMallocSamplingProxy::GetThreadTable()
+{
+	FThreadTable* Table = (FThreadTable*)FPlatformTLS::GetTlsValue(TlsSlot);
+	if (UNLIKELY(!Table))
+	{
+		Table = (FThreadTable*)UsedMalloc->Malloc(sizeof(FThreadTable), PLATFORM_CACHE_LINE_SIZE);
+		FMemory::Memzero(Table, sizeof(FThreadTable));
+		Table->Random = FPlatformTLS::GetCurrentThreadId() | 1;
+		Table->Interval = FMath::Max(GMallocSamplingRate, 1);
+		Table->Countdown = Table->Interval;
+		FPlatformTLS::SetTlsValue(TlsSlot, Table);
+
+		FThreadTable* Head;
+		do
+		{
+			Head = Tables;
+			Table->Next = Head;
+		}
+		while (FPlatformAtomics::InterlockedCompareExchangePointer((void**)&Tables, Table, Head) != Head);
+	}
+	return Table;
+}
+
+void FMallocSamplingProxy::RecordSample(FThreadTable* Table, SIZE_T Size)
+{
+	const uint64 Weight = Table->Interval;
+
+	// next interval is uniform in [Rate/2, 3*Rate/2) so the average stays Rate
+	const int32 Rate = FMath::Max(GMallocSamplingRate, 1);
+	Table->Random ^= Table->Random << 13;
+	Table->Random ^= Table->Random >> 17;
+	Table->Random ^= Table->Random << 5;
+	Table->Interval = Rate / 2 + 1 + int32(Table->Random % uint32(Rate));
+	Table->Countdown = Table->Interval;
+
+	if (Table->bRecording)
+	{
+		return;
+	}
+	Table->bRecording = true;
+
+	uint64 Callstack[NumSkippedFrames + FMallocSamplingCallsite::CallstackDepth] = { 0 };
+	FPlatformStackWalk::CaptureStackBackTrace(Callstack, ARRAY_COUNT(Callstack));
+	const uint64* CallsiteStack = Callstack + NumSkippedFrames;
+	uint32 Hash = FCrc::MemCrc32(CallsiteStack, FMallocSamplingCallsite::CallstackDepth * sizeof(uint64));
+	Hash = Hash ? Hash : 1;
+
+	bool bRecorded = false;
+	for (int32 Probe = 0; Probe < MaxProbes; Probe++)
+	{
+		FThreadTable::FCallsite& Callsite = Table->Callsites[(Hash + Probe) % NumCallsitesPerThread];
+		if (Callsite.Hash == Hash)
+		{
+			Callsite.Count += Weight;
+			Callsite.Bytes += Weight * Size;
+			bRecorded = true;
+			break;
+		}
+		if (Callsite.Hash == 0)
+		{
+			FMemory::Memcpy(Callsite.Callstack, CallsiteStack, sizeof(Callsite.Callstack));
+			Callsite.Count = Weight;
+			Callsite.Bytes = Weight * Size;
+			// readers only look at entries with a hash, so publish it after the rest
+			FPlatformMisc::MemoryBarrier();
+			Callsite.Hash = Hash;
+			bRecorded = true;
+			break;
+		}
+	}
+	if (!bRecorded)
+	{
+		Table->NumDropped++;
+	}
+
+	Table->bRecording = false;
+}
+
+void* FMallocSamplingProxy::Malloc(SIZE_T Size, uint32 Alignment)
+{
+	FThreadTable* Table = GetThreadTable();
+	if (UNLIKELY(--Table->Countdown <= 0))
+	{
+		RecordSample(Table, Size);
+	}
+	return UsedMalloc->Malloc(Size, Alignment);
+}
+
+void* FMallocSamplingProxy::Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment)
+{
+	// growing containers are the usual source of churn, so a realloc counts as an allocation of the new size
+	if (NewSize)
+	{
+		FThreadTable* Table = GetThreadTable();
+		if (UNLIKELY(--Table->Countdown <= 0))
+		{
+			RecordSample(Table, NewSize);
+		}
+	}
+	return UsedMalloc->Realloc(Ptr, NewSize, Alignment);
+}
+
+void FMallocSamplingProxy::Free(void* Ptr)
+{
+	UsedMalloc->Free(Ptr);
+}
+
+void FMallocSamplingProxy::GetCallsiteRates(TArray<FMallocSamplingCallsite>& OutCallsites, FMallocSamplingSnapshot* Snapshot) const
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = FMath::Max(Now - (Snapshot && Snapshot->Time > 0.0 ? Snapshot->Time : StartTime), 0.001);
+
+	// the same callsite shows up once per thread that hit it
+	TMap<uint32, FMallocSamplingTotals> Totals;
+	TMap<uint32, const FThreadTable::FCallsite*> FirstSeen;
+	for (const FThreadTable* Table = Tables; Table; Table = Table->Next)
+	{
+		for (const FThreadTable::FCallsite& Callsite : Table->Callsites)
+		{
+			const uint32 Hash = Callsite.Hash;
+			if (Hash)
+			{
+				FPlatformMisc::MemoryBarrier();
+				FMallocSamplingTotals& Total = Totals.FindOrAdd(Hash);
+				Total.Count += Callsite.Count;
+				Total.Bytes += Callsite.Bytes;
+				FirstSeen.FindOrAdd(Hash) = &Callsite;
+			}
+		}
+	}
+
+	OutCallsites.Reset(Totals.Num());
+	for (const auto& Pair : Totals)
+	{
+		uint64 Count = Pair.Value.Count;
+		uint64 Bytes = Pair.Value.Bytes;
+		if (Snapshot)
+		{
+			const FMallocSamplingTotals* Previous = Snapshot->Totals.Find(Pair.Key);
+			if (Previous)
+			{
+				Count -= Previous->Count;
+				Bytes -= Previous->Bytes;
+			}
+		}
+		if (Count == 0)
+		{
+			continue;
+		}
+
+		FMallocSamplingCallsite& Callsite = OutCallsites[OutCallsites.AddUninitialized()];
+		Callsite.Hash = Pair.Key;
+		Callsite.AllocsPerSecond = double(Count) / Elapsed;
+		Callsite.BytesPerSecond = double(Bytes) / Elapsed;
+		FMemory::Memcpy(Callsite.Callstack, FirstSeen.FindChecked(Pair.Key)->Callstack, sizeof(Callsite.Callstack));
+	}
+
+	if (Snapshot)
+	{
+		Snapshot->Time = Now;
+		Snapshot->Totals = MoveTemp(Totals);
+	}
+}
+
+uint64 FMallocSamplingProxy::GetNumDroppedSamples() const
+{
+	uint64 NumDropped = 0;
+	for (const FThreadTable* Table = Tables; Table; Table = Table->Next)
+	{
+		NumDropped += Table->NumDropped;
+	}
+	return NumDropped;
+}
+
+/*-----------------------------------------------------------------------------
+	Console commands.
+-----------------------------------------------------------------------------*/
+
+/** @return the function name for a return address, cached because symbol lookups are slow */
+static const FString& GetFrameName(uint64 ProgramCounter, TMap<uint64, FString>& NameCache)
+{
+	FString* Cached = NameCache.Find(ProgramCounter);
+	if (Cached)
+	{
+		return *Cached;
+	}
+
+	FProgramCounterSymbolInfo SymbolInfo;
+	FPlatformStackWalk::ProgramCounterToSymbolInfo(ProgramCounter, SymbolInfo);
+	FString Name = SymbolInfo.FunctionName[0] ? FString(ANSI_TO_TCHAR(SymbolInfo.FunctionName)) : FString::Printf(TEXT("0x%llx"), ProgramCounter);
+	// ';' separates frames in the collapsed stack format
+	Name.ReplaceInline(TEXT(";"), TEXT(":"));
+	return NameCache.Add(ProgramCounter, Name);
+}
+
+static void MallocSamplingReport(const TArray<FString>& Args)
+{
+	FMallocSamplingProxy* Proxy = FMallocSamplingProxy::Get();
+	if (!Proxy)
+	{
+		UE_LOG(LogMemory, Display, TEXT("Sampling proxy is off, start with -MallocSampling or run Memory.UseSampling."));
+		return;
+	}
+
+	const int32 NumToShow = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+
+	static FMallocSamplingSnapshot Snapshot;
+	TArray<FMallocSamplingCallsite> Callsites;
+	Proxy->GetCallsiteRates(Callsites, &Snapshot);
+	Callsites.Sort([](const FMallocSamplingCallsite& A, const FMallocSamplingCallsite& B) { return A.BytesPerSecond > B.BytesPerSecond; });
+
+	double TotalAllocs = 0.0;
+	double TotalBytes = 0.0;
+	for (const FMallocSamplingCallsite& Callsite : Callsites)
+	{
+		TotalAllocs += Callsite.AllocsPerSecond;
+		TotalBytes += Callsite.BytesPerSecond;
+	}
+	UE_LOG(LogMemory, Display, TEXT("Sampled heap churn since the last report: %.0f allocs/s, %.2f MB/s over %d callsites (%llu samples dropped)"),
+		TotalAllocs, TotalBytes / (1024.0 * 1024.0), Callsites.Num(), Proxy->GetNumDroppedSamples());
+
+	TMap<uint64, FString> NameCache;
+	for (int32 Index = 0; Index < FMath::Min(NumToShow, Callsites.Num()); Index++)
+	{
+		const FMallocSamplingCallsite& Callsite = Callsites[Index];
+		FString Stack;
+		for (int32 Frame = 0; Frame < 4 && Callsite.Callstack[Frame]; Frame++)
+		{
+			Stack += (Frame ? TEXT(" < ") : TEXT("")) + GetFrameName(Callsite.Callstack[Frame], NameCache);
+		}
+		UE_LOG(LogMemory, Display, TEXT("  %10.0f allocs/s %10.1f KB/s  %s"), Callsite.AllocsPerSecond, Callsite.BytesPerSecond / 1024.0, *Stack);
+	}
+}
+
+static void MallocSamplingFlameGraph(const TArray<FString>& Args)
+{
+	FMallocSamplingProxy* Proxy = FMallocSamplingProxy::Get();
+	if (!Proxy)
+	{
+		UE_LOG(LogMemory, Display, TEXT("Sampling proxy is off, start with -MallocSampling or run Memory.UseSampling."));
+		return;
+	}
+
+	const bool bCountAllocs = Args.Contains(TEXT("allocs"));
+	FString Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("MallocSampling-%s.folded"), *FDateTime::Now().ToString());
+	for (const FString& Arg : Args)
+	{
+		if (Arg != TEXT("allocs"))
+		{
+			Filename = Arg;
+		}
+	}
+
+	TArray<FMallocSamplingCallsite> Callsites;
+	Proxy->GetCallsiteRates(Callsites, nullptr);
+
+	// collapsed stacks, root first, one line per callsite weighted by its average rate since sampling started
+	TMap<uint64, FString> NameCache;
+	FString Output;
+	for (const FMallocSamplingCallsite& Callsite : Callsites)
+	{
+		int32 Depth = 0;
+		while (Depth < FMallocSamplingCallsite::CallstackDepth && Callsite.Callstack[Depth])
+		{
+			Depth++;
+		}
+		for (int32 Frame = Depth - 1; Frame >= 0; Frame--)
+		{
+			Output += GetFrameName(Callsite.Callstack[Frame], NameCache);
+			Output += Frame ? TEXT(";") : TEXT(" ");
+		}
+		Output += FString::Printf(TEXT("%llu") LINE_TERMINATOR, uint64(bCountAllocs ? Callsite.AllocsPerSecond : Callsite.BytesPerSecond));
+	}
+
+	if (FFileHelper::SaveStringToFile(Output, *Filename))
+	{
+		UE_LOG(LogMemory, Display, TEXT("Wrote %d sampled callsites (%s per second) to %s"), Callsites.Num(), bCountAllocs ? TEXT("allocations") : TEXT("bytes"), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogMemory, Warning, TEXT("Failed to write %s"), *Filename);
+	}
+}
+
+static FAutoConsoleCommand MallocUseSamplingCommand(
+	TEXT("Memory.UseSampling"),
+	TEXT("Puts the sampling malloc proxy on top of the allocator to measure heap churn per callsite, see memory.SamplingRate."),
+	FConsoleCommandDelegate::CreateStatic(&FMallocSamplingProxy::Enable)
+	);
+
+static FAutoConsoleCommand MallocSamplingReportCommand(
+	TEXT("Memory.SamplingReport"),
+	TEXT("Logs the callsites allocating the most bytes per second since the last report. Optional argument: number of callsites to show."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MallocSamplingReport)
+	);
+
+static FAutoConsoleCommand MallocSamplingFlameGraphCommand(
+	TEXT("Memory.SamplingFlameGraph"),
+	TEXT("Writes the sampled callsites in collapsed stack format for flamegraph.pl, weighted by bytes per second (or allocations with 'allocs'). Optional argument: output file."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MallocSamplingFlameGraph)
+	);
@@ -9,6 +9,8 @@
 DECLARE_MEMORY_STAT(TEXT("MemStack Large Block"), STAT_MemStackLargeBLock,STATGROUP_Memory);
 DECLARE_MEMORY_STAT(TEXT("PageAllocator Free"), STAT_PageAllocatorFree, STATGROUP_Memory);
 DECLARE_MEMORY_STAT(TEXT("PageAllocator Used"), STAT_PageAllocatorUsed, STATGROUP_Memory);
+DECLARE_MEMORY_STAT(TEXT("FrameMemStack Game Thread"), STAT_FrameMemStackGameThread, STATGROUP_Memory);
+DECLARE_MEMORY_STAT(TEXT("FrameMemStack High Water"), STAT_FrameMemStackHighWater, STATGROUP_Memory);
 
 FPageAllocator::TPageAllocator FPageAllocator::TheAllocator;
 
@@ -357,3 +359,57 @@ bool FMemStackBase::ContainsPointer(const void* Pointer) const
 
 	return false;
 }
+
+
+/*-----------------------------------------------------------------------------
+	FFrameMemStack implementation.
+-----------------------------------------------------------------------------*/
+
+#if !UE_BUILD_SHIPPING
+static int32 GFrameMemStackPoison = 1;
+static FAutoConsoleVariableRef CVarFrameMemStackPoison(
+	TEXT("memstack.FramePoison"),
+	GFrameMemStackPoison,
+	TEXT("If > 0, memory allocated from a frame mem stack (TFrameAllocator) is filled with 0xdd when it is freed at the end of the frame."));
+#endif
+
+/** Largest frame of any thread's frame stack. */
+static volatile int32 GFrameMemStackHighWater = 0;
+
+void FFrameMemStack::EndFrame()
+{
+	check(!NumMarks);
+	bFrameScoped = true;
+
+	LastFrameBytes = GetByteCount();
+	HighWaterBytes = FMath::Max(HighWaterBytes, LastFrameBytes);
+
+	int32 GlobalHighWater = GFrameMemStackHighWater;
+	while (LastFrameBytes > GlobalHighWater)
+	{
+		const int32 Previous = FPlatformAtomics::InterlockedCompareExchange(&GFrameMemStackHighWater, LastFrameBytes, GlobalHighWater);
+		if (Previous == GlobalHighWater)
+		{
+			SET_MEMORY_STAT(STAT_FrameMemStackHighWater, LastFrameBytes);
+			break;
+		}
+		GlobalHighWater = Previous;
+	}
+	if (IsInGameThread())
+	{
+		SET_MEMORY_STAT(STAT_FrameMemStackGameThread, LastFrameBytes);
+	}
+
+#if !UE_BUILD_SHIPPING
+	if (GFrameMemStackPoison)
+	{
+		for (FTaggedMemory* Chunk = TopChunk; Chunk; Chunk = Chunk->Next)
+		{
+			const int32 UsedSize = (Chunk == TopChunk) ? int32(Top - Chunk->Data()) : Chunk->DataSize;
+			FMemory::Memset(Chunk->Data(), 0xdd, UsedSize);
+		}
+	}
+#endif
+
+	FreeChunks(nullptr);
+}
@@ -0,0 +1,165 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "HAL/MemoryBase.h"
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+
+/** Allocation rate of one callsite, estimated from the sampled allocations. */
+struct FMallocSamplingCallsite
+{
+	enum { CallstackDepth = 12 };
+
+	/** Hash of the callstack, identifies the callsite. */
+	uint32 Hash;
+
+	double AllocsPerSecond;
+	double BytesPerSecond;
+
+	/** Return addresses, innermost first, zero terminated if the stack was shorter. */
+	uint64 Callstack[CallstackDepth];
+};
+
+/** Estimated allocations and bytes of one callsite since sampling was turned on. */
+struct FMallocSamplingTotals
+{
+	FMallocSamplingTotals()
+		: Count(0)
+		, Bytes(0)
+	{}
+
+	uint64 Count;
+	uint64 Bytes;
+};
+
+/** Totals seen by a previous GetCallsiteRates() call, so each caller gets rates over its own interval. */
+struct FMallocSamplingSnapshot
+{
+	FMallocSamplingSnapshot()
+		: Time(0.0)
+	{}
+
+	double Time;
+	TMap<uint32, FMallocSamplingTotals> Totals;
+};
+
+/**
+ * FMalloc proxy that records the callstack of one in every N allocations (memory.SamplingRate) to find the systems
+ * churning the heap, cheaply enough to leave on in production servers.
+ * The samples are counted per callsite in a fixed size table per thread that only its own thread writes to,
+ * so sampling doesn't lock anything; readers tolerate counts that are a few allocations behind.
+ * Turned on with -MallocSampling or Memory.UseSampling; see Memory.SamplingReport and Memory.SamplingFlameGraph.
+ */
+class CORE_API FMallocSamplingProxy : public FMalloc
+{
+public:
+	explicit FMallocSamplingProxy(FMalloc* InMalloc);
+
+	/** Puts a sampling proxy on top of GMalloc, unless there already is one. */
+	static void Enable();
+
+	/** @return the sampling proxy, or nullptr if sampling was never turned on. */
+	static FMallocSamplingProxy* Get();
+
+	/**
+	 * Estimates the allocation rate of every sampled callsite since the snapshot was taken, and updates the snapshot.
+	 * Without a snapshot the rates are averages since sampling was turned on.
+	 */
+	void GetCallsiteRates(TArray<FMallocSamplingCallsite>& OutCallsites, FMallocSamplingSnapshot* Snapshot) const;
+
+	/** @return the number of sampled allocations that were dropped because a thread's callsite table was full. */
+	uint64 GetNumDroppedSamples() const;
+
+	// FMalloc interface
+	virtual void* Malloc(SIZE_T Size, uint32 Alignment) override;
+	virtual void* Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment) override;
+	virtual void Free(void* Ptr) override;
+
+	virtual void InitializeStatsMetadata() override
+	{
+		UsedMalloc->InitializeStatsMetadata();
+	}
+
+	virtual void UpdateStats() override
+	{
+		UsedMalloc->UpdateStats();
+	}
+
+	virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+	{
+		UsedMalloc->GetAllocatorStats(OutStats);
+	}
+
+	virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+	{
+		UsedMalloc->DumpAllocatorStats(Ar);
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return UsedMalloc->IsInternallyThreadSafe();
+	}
+
+	virtual bool ValidateHeap() override
+	{
+		return UsedMalloc->ValidateHeap();
+	}
+
+	virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override
+	{
+		return UsedMalloc->Exec(InWorld, Cmd, Ar);
+	}
+
+	virtual bool GetAllocationSize(void* Original, SIZE_T& OutSize) override
+	{
+		return UsedMalloc->GetAllocationSize(Original, OutSize);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+	{
+		return UsedMalloc->QuantizeSize(Count, Alignment);
+	}
+
+	virtual void Trim() override
+	{
+		UsedMalloc->Trim();
+	}
+
+	virtual void SetupTLSCachesOnCurrentThread() override
+	{
+		UsedMalloc->SetupTLSCachesOnCurrentThread();
+	}
+
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+	{
+		UsedMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return UsedMalloc->GetDescriptiveName();
+	}
+
+private:
+	struct FThreadTable;
+
+	/** @return the calling thread's table, creating it with the wrapped malloc the first time. */
+	FThreadTable* GetThreadTable();
+
+	/** Counts an allocation that was picked for sampling against its callsite. */
+	void RecordSample(FThreadTable* Table, SIZE_T Size);
+
+	/** Malloc we're based on, aka using under the hood */
+	FMalloc* UsedMalloc;
+
+	/** TLS slot holding each thread's FThreadTable */
+	uint32 TlsSlot;
+
+	/** All thread tables, tables are never freed so readers can walk the list without locking */
+	FThreadTable* volatile Tables;
+
+	/** When sampling was turned on */
+	double StartTime;
+};
@@ -148,6 +148,7 @@ public:
 
 	// Friends.
 	friend class FMemMark;
+	friend class FFrameMemStack;
 	friend void* operator new(size_t Size, FMemStackBase& Mem, int32 Count, int32 Align);
 	friend void* operator new(size_t Size, FMemStackBase& Mem, EMemZeroed Tag, int32 Count, int32 Align);
 	friend void* operator new(size_t Size, FMemStackBase& Mem, EMemOned Tag, int32 Count, int32 Align);
@@ -199,6 +200,54 @@ class CORE_API FMemStack : public TThreadSingleton<FMemStack>, public FMemStackB
 };
 
 
+/**
+ * Per-thread memory stack that is emptied at the end of every frame, for temporaries that never outlive the frame
+ * they were made in and don't have a natural scope for a FMemMark.
+ * Only threads that call EndFrame() once per frame (the game and rendering threads) allocate from it, see TFrameAllocator.
+ */
+class CORE_API FFrameMemStack : public TThreadSingleton<FFrameMemStack>, public FMemStackBase
+{
+public:
+	FFrameMemStack()
+		: FMemStackBase(0)
+		, bFrameScoped(false)
+		, LastFrameBytes(0)
+		, HighWaterBytes(0)
+	{
+	}
+
+	/** @return the calling thread's frame stack, or nullptr if nothing empties it at the end of the frame on this thread. */
+	static FORCEINLINE FFrameMemStack* GetIfFrameScoped()
+	{
+		FFrameMemStack& Stack = Get();
+		return Stack.bFrameScoped ? &Stack : nullptr;
+	}
+
+	/**
+	 * Frees everything allocated from this thread's frame stack since the last call, poisoning it first in non-shipping builds
+	 * so containers that were kept past the end of the frame are easy to spot. The first call opts the thread in.
+	 */
+	void EndFrame();
+
+	/** @return the number of bytes that were in use at the end of the last frame. */
+	int32 GetLastFrameBytes() const
+	{
+		return LastFrameBytes;
+	}
+
+	/** @return the largest number of bytes this thread has used in a single frame. */
+	int32 GetHighWaterBytes() const
+	{
+		return HighWaterBytes;
+	}
+
+private:
+	bool bFrameScoped;
+	int32 LastFrameBytes;
+	int32 HighWaterBytes;
+};
+
+
 /*-----------------------------------------------------------------------------
 	FMemStack templates.
 -----------------------------------------------------------------------------*/
@@ -343,6 +392,153 @@ public:
 };
 
 
+/**
+ * A container allocator that allocates from the calling thread's FFrameMemStack, so per-frame temporaries don't touch the heap.
+ * Containers using it must not be kept past the end of the frame they were filled in. On threads without a frame stack
+ * the allocation falls back to the heap and is freed with the container as usual.
+ */
+template<uint32 Alignment = DEFAULT_ALIGNMENT>
+class TFrameAllocator
+{
+public:
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	template<typename ElementType>
+	class ForElementType
+	{
+	public:
+
+		/** Default constructor. */
+		ForElementType():
+			Data(nullptr),
+			bHeapAllocation(false)
+		{}
+
+		/** Destructor. Frame stack allocations go away at the end of the frame. */
+		~ForElementType()
+		{
+			if(bHeapAllocation)
+			{
+				FMemory::Free(Data);
+			}
+		}
+
+		/**
+		 * Moves the state of another allocator into this one.
+		 * @param Other - The allocator to move the state from.  This allocator should be left in a valid empty state.
+		 */
+		FORCEINLINE void MoveToEmpty(ForElementType& Other)
+		{
+			checkSlow(this != &Other);
+
+			if(bHeapAllocation)
+			{
+				FMemory::Free(Data);
+			}
+
+			Data            = Other.Data;
+			bHeapAllocation = Other.bHeapAllocation;
+			Other.Data            = nullptr;
+			Other.bHeapAllocation = false;
+		}
+
+		// FContainerAllocatorInterface
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return Data;
+		}
+		void ResizeAllocation(int32 PreviousNumElements,int32 NumElements,int32 NumBytesPerElement)
+		{
+			const uint32 ElementAlignment = FMath::Max(Alignment,(uint32)ALIGNOF(ElementType));
+
+			// Once on the heap, stay there.
+			if(bHeapAllocation)
+			{
+				if(NumElements)
+				{
+					Data = (ElementType*)FMemory::Realloc(Data, NumElements * NumBytesPerElement, ElementAlignment);
+				}
+				else
+				{
+					FMemory::Free(Data);
+					Data = nullptr;
+					bHeapAllocation = false;
+				}
+				return;
+			}
+
+			ElementType* OldData = Data;
+			Data = nullptr;
+			if( NumElements )
+			{
+				FFrameMemStack* FrameStack = FFrameMemStack::GetIfFrameScoped();
+				if(FrameStack)
+				{
+					Data = (ElementType*)FrameStack->PushBytes(NumElements * NumBytesPerElement, ElementAlignment);
+				}
+				else
+				{
+					Data = (ElementType*)FMemory::Malloc(NumElements * NumBytesPerElement, ElementAlignment);
+					bHeapAllocation = true;
+				}
+
+				// If the container previously held elements, copy them into the new allocation. The old allocation stays on the frame stack.
+				if(OldData && PreviousNumElements)
+				{
+					const int32 NumCopiedElements = FMath::Min(NumElements,PreviousNumElements);
+					FMemory::Memcpy(Data,OldData,NumCopiedElements * NumBytesPerElement);
+				}
+			}
+		}
+		FORCEINLINE int32 CalculateSlackReserve(int32 NumElements, int32 NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE int32 CalculateSlackShrink(int32 NumElements, int32 NumAllocatedElements, int32 NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE int32 CalculateSlackGrow(int32 NumElements, int32 NumAllocatedElements, int32 NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE int32 GetAllocatedSize(int32 NumAllocatedElements, int32 NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		bool HasAllocation()
+		{
+			return !!Data;
+		}
+
+	private:
+		ForElementType(const ForElementType&);
+		ForElementType& operator=(const ForElementType&);
+
+		/** A pointer to the container's elements. */
+		ElementType* Data;
+
+		/** Whether Data came from the heap rather than a frame stack. */
+		bool bHeapAllocation;
+	};
+
+	typedef ForElementType<FScriptContainerElement> ForAnyElementType;
+};
+
+template <uint32 Alignment>
+struct TAllocatorTraits<TFrameAllocator<Alignment>> : TAllocatorTraitsBase<TFrameAllocator<Alignment>>
+{
+	enum { SupportsMove = true };
+};
+
+/** A set allocator that keeps the elements, the element allocation flags and the hash of a TSet or TMap on the frame stack. */
+typedef TSetAllocator<TSparseArrayAllocator<TFrameAllocator<>, TFrameAllocator<>>, TFrameAllocator<>> FFrameSetAllocator;
+
+
 /**
  * FMemMark marks a top-of-stack position in the memory stack.
  * When the marker is constructed or initialized with a particular memory 
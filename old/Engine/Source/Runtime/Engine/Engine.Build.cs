@@ -268,6 +268,7 @@ public class Engine : ModuleRules
 			new string[] {
 				"NetworkReplayStreaming",
 				"NullNetworkReplayStreaming",
+				"LocalFileNetworkReplayStreaming",
 				"HttpNetworkReplayStreaming",
 				"Advertising"
 			}
@@ -0,0 +1,170 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "NetRelevancyGrid.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetworkObjectList.h"
+
+FNetRelevancyGrid::FNetRelevancyGrid()
+	: CellSize(1.0f)
+	, CellRange(0)
+{
+}
+
+/** Returns whether the actor's relevancy is only decided by distance to the viewers, other than the ownership cases */
+static bool IsDistanceCulledActor( const AActor* Actor, const float MaxCullDistanceSquared )
+{
+	const USceneComponent* RootComponent = Actor->GetRootComponent();
+
+	return !Actor->bAlwaysRelevant && !Actor->bOnlyRelevantToOwner && !Actor->bNetUseOwnerRelevancy &&
+		RootComponent != nullptr && RootComponent->GetAttachParent() == nullptr &&
+		Actor->NetCullDistanceSquared <= MaxCullDistanceSquared;
+}
+
+void FNetRelevancyGrid::Build( const TArray<FNetworkObjectInfo*>& ConsiderList, const float InCellSize, const float MaxGriddedCullDistance )
+{
+	CellSize = FMath::Max( InCellSize, 100.0f );
+
+	UngriddedActors.Reset();
+	GriddedActors.Reset();
+	NeighborhoodCache.Reset();
+
+	// keep the cell arrays around, the set of occupied cells is mostly the same from frame to frame
+	for ( auto& Cell : Cells )
+	{
+		Cell.Value.Reset();
+	}
+
+	const float MaxCullDistanceSquared = FMath::Square( MaxGriddedCullDistance );
+	float LargestCullDistanceSquared = 0.0f;
+
+	for ( FNetworkObjectInfo* ActorInfo : ConsiderList )
+	{
+		const AActor* Actor = ActorInfo->Actor;
+
+		if ( IsDistanceCulledActor( Actor, MaxCullDistanceSquared ) )
+		{
+			FGriddedActor Entry;
+			Entry.ActorInfo = ActorInfo;
+			Entry.Cell = GetCell( Actor->GetActorLocation() );
+
+			Cells.FindOrAdd( Entry.Cell ).Add( ActorInfo );
+			GriddedActors.Add( Actor, Entry );
+
+			LargestCullDistanceSquared = FMath::Max( LargestCullDistanceSquared, Actor->NetCullDistanceSquared );
+		}
+		else
+		{
+			UngriddedActors.Add( ActorInfo );
+		}
+	}
+
+	// the viewer can be anywhere in its cell, so one extra cell in each direction
+	CellRange = FMath::CeilToInt( FMath::Sqrt( LargestCullDistanceSquared ) / CellSize ) + 1;
+
+	// drop cells that stayed empty for a frame so the map doesn't keep growing as actors move around
+	for ( auto It = Cells.CreateIterator(); It; ++It )
+	{
+		if ( It.Value().Num() == 0 )
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+const TArray<FNetworkObjectInfo*>& FNetRelevancyGrid::GetNeighborhood( const FIntPoint& Center )
+{
+	TArray<FNetworkObjectInfo*>* Cached = NeighborhoodCache.Find( Center );
+
+	if ( Cached != nullptr )
+	{
+		return *Cached;
+	}
+
+	TArray<FNetworkObjectInfo*>& Neighborhood = NeighborhoodCache.Add( Center );
+
+	for ( int32 Y = Center.Y - CellRange; Y <= Center.Y + CellRange; Y++ )
+	{
+		for ( int32 X = Center.X - CellRange; X <= Center.X + CellRange; X++ )
+		{
+			const TArray<FNetworkObjectInfo*>* Cell = Cells.Find( FIntPoint( X, Y ) );
+
+			if ( Cell != nullptr )
+			{
+				Neighborhood.Append( *Cell );
+			}
+		}
+	}
+
+	return Neighborhood;
+}
+
+void FNetRelevancyGrid::GatherCandidates( UNetConnection* Connection, const TArray<FNetViewer>& Viewers, TArray<FNetworkObjectInfo*>& OutCandidates )
+{
+	OutCandidates.Reset();
+	OutCandidates.Append( UngriddedActors );
+
+	TArray<FIntPoint, TInlineAllocator<4>> Centers;
+
+	for ( const FNetViewer& Viewer : Viewers )
+	{
+		Centers.AddUnique( GetCell( Viewer.ViewLocation ) );
+	}
+
+	if ( Centers.Num() == 1 )
+	{
+		OutCandidates.Append( GetNeighborhood( Centers[0] ) );
+	}
+	else if ( Centers.Num() > 1 )
+	{
+		// split screen viewers in different cells, neighborhoods may overlap so go through the cells directly
+		TSet<FIntPoint> VisitedCells;
+
+		for ( const FIntPoint& Center : Centers )
+		{
+			for ( int32 Y = Center.Y - CellRange; Y <= Center.Y + CellRange; Y++ )
+			{
+				for ( int32 X = Center.X - CellRange; X <= Center.X + CellRange; X++ )
+				{
+					bool bAlreadyVisited = false;
+					const FIntPoint CellCoord( X, Y );
+					VisitedCells.Add( CellCoord, &bAlreadyVisited );
+
+					const TArray<FNetworkObjectInfo*>* Cell = bAlreadyVisited ? nullptr : Cells.Find( CellCoord );
+
+					if ( Cell != nullptr )
+					{
+						OutCandidates.Append( *Cell );
+					}
+				}
+			}
+		}
+	}
+
+	// far away gridded actors this connection still has a channel for, so the relevancy timeout can close it as before
+	for ( auto It = Connection->ActorChannels.CreateConstIterator(); It; ++It )
+	{
+		const AActor* Actor = It.Key().Get();
+		const FGriddedActor* Entry = ( Actor != nullptr ) ? GriddedActors.Find( Actor ) : nullptr;
+
+		if ( Entry != nullptr )
+		{
+			bool bInNeighborhood = false;
+
+			for ( const FIntPoint& Center : Centers )
+			{
+				if ( IsInRange( Center, Entry->Cell ) )
+				{
+					bInNeighborhood = true;
+					break;
+				}
+			}
+
+			if ( !bInNeighborhood )
+			{
+				OutCandidates.Add( Entry->ActorInfo );
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	NetRelevancyGrid.h: Spatial grid of considered network actors for UNetDriver::ServerReplicateActors.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UNetConnection;
+struct FNetViewer;
+struct FNetworkObjectInfo;
+
+/**
+ * Buckets the actors considered for replication this frame into a 2D grid (XY, cell size net.RelevancyGrid.CellSize)
+ * so that each connection only visits the actors near its viewers instead of every considered actor.
+ *
+ * Only actors whose relevancy comes down to the NetCullDistanceSquared test are put in the grid. Actors that are
+ * always relevant, only relevant to their owner, use their owner's relevancy, are attached or have no root component
+ * are visited by every connection, same as without the grid. Actors that already have a channel to a connection are
+ * always visited by that connection so relevancy timeouts and channel closing are unchanged.
+ *
+ * A gridded actor that is far from all of a connection's viewers and has no channel to it is skipped, even if it
+ * would be relevant through ownership (e.g. an actor owned by the viewer spawned outside cull distance).
+ * Classes overriding IsNetRelevantFor() to be relevant beyond their cull distance should be bAlwaysRelevant.
+ */
+class FNetRelevancyGrid
+{
+public:
+	FNetRelevancyGrid();
+
+	/** Rebuild the grid from this frame's consider list */
+	void Build(const TArray<FNetworkObjectInfo*>& ConsiderList, float InCellSize, float MaxGriddedCullDistance);
+
+	/**
+	 * Gather the considered actors this connection needs to look at: ungridded actors, actors in cells within cull
+	 * distance of any of the viewers and gridded actors the connection has a channel for.
+	 * Each actor is returned once.
+	 */
+	void GatherCandidates(UNetConnection* Connection, const TArray<FNetViewer>& Viewers, TArray<FNetworkObjectInfo*>& OutCandidates);
+
+	/** Number of actors visited by every connection */
+	int32 GetNumUngridded() const
+	{
+		return UngriddedActors.Num();
+	}
+
+	/** Number of actors in the grid */
+	int32 GetNumGridded() const
+	{
+		return GriddedActors.Num();
+	}
+
+private:
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	/** Returns whether the given cell is within CellRange of Center */
+	bool IsInRange(const FIntPoint& Center, const FIntPoint& Cell) const
+	{
+		return FMath::Abs(Cell.X - Center.X) <= CellRange && FMath::Abs(Cell.Y - Center.Y) <= CellRange;
+	}
+
+	/** Returns the actors in all cells within CellRange of Center, cached per frame so connections with viewers in the same cell share the list */
+	const TArray<FNetworkObjectInfo*>& GetNeighborhood(const FIntPoint& Center);
+
+	struct FGriddedActor
+	{
+		FNetworkObjectInfo* ActorInfo;
+		FIntPoint Cell;
+	};
+
+	float CellSize;
+	/** Number of cells around a viewer's cell that can hold relevant actors, from the largest cull distance in the grid */
+	int32 CellRange;
+
+	TArray<FNetworkObjectInfo*> UngriddedActors;
+	TMap<FIntPoint, TArray<FNetworkObjectInfo*>> Cells;
+	TMap<const AActor*, FGriddedActor> GriddedActors;
+
+	/** Neighborhood lists gathered this frame, keyed by center cell */
+	TMap<FIntPoint, TArray<FNetworkObjectInfo*>> NeighborhoodCache;
+};
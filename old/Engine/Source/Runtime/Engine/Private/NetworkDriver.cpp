@@ -54,6 +54,9 @@
 #include "Net/DataChannel.h"
 #include "GameFramework/PlayerState.h"
 #include "Net/PerfCountersHelpers.h"
+#include "NetRelevancyGrid.h"
+#include "Async/ParallelFor.h"
+#include "HAL/MallocSampling.h"
 
 
 #if USE_SERVER_PERF_COUNTERS
@@ -168,6 +171,27 @@ static TAutoConsoleVariable<int32> CVarUseAdaptiveNetUpdateFrequency(
 	0, 
 	TEXT( "If 1, NetUpdateFrequency will be calculated based on how often actors actually send something when replicating" ) );
 
+static TAutoConsoleVariable<int32> CVarNetRelevancyGrid(
+	TEXT( "net.RelevancyGrid" ),
+	0,
+	TEXT( "If 1, considered actors are bucketed into a spatial grid each frame and connections only visit actors in cells near their viewers.\n" )
+	TEXT( "Actors that aren't culled by distance alone (always relevant, owner only, attached...) are still visited by every connection." ) );
+
+static TAutoConsoleVariable<float> CVarNetRelevancyGridCellSize(
+	TEXT( "net.RelevancyGrid.CellSize" ),
+	5000.f,
+	TEXT( "Size of the relevancy grid cells in world units" ) );
+
+static TAutoConsoleVariable<float> CVarNetRelevancyGridMaxCullDistance(
+	TEXT( "net.RelevancyGrid.MaxCullDistance" ),
+	20000.f,
+	TEXT( "Actors with a larger NetCullDistance are kept out of the relevancy grid and visited by every connection" ) );
+
+static TAutoConsoleVariable<int32> CVarNetParallelPrioritizeThreshold(
+	TEXT( "net.ParallelPrioritizeThreshold" ),
+	0,
+	TEXT( "If > 0, actor priorities for a connection are computed on worker threads when at least this many actors are relevant to it" ) );
+
 /*-----------------------------------------------------------------------------
 	UNetDriver implementation.
 -----------------------------------------------------------------------------*/
@@ -658,6 +682,29 @@ void UNetDriver::TickFlush(float DeltaSeconds)
 
 				PerfCounters->Set(TEXT("ServerReplicateActorsTimeMs"), ServerReplicateActorsTimeMs);
 				PerfCounters->Set(TEXT("OutSaturationMax"), RemoteSaturationMax);
+
+				// Heap churn, when the sampling malloc proxy is on (-MallocSampling)
+				FMallocSamplingProxy* MallocSampling = FMallocSamplingProxy::Get();
+				if (MallocSampling != nullptr && NetDriverName == NAME_GameNetDriver)
+				{
+					static FMallocSamplingSnapshot MallocSamplingSnapshot;
+					TArray<FMallocSamplingCallsite> Callsites;
+					MallocSampling->GetCallsiteRates(Callsites, &MallocSamplingSnapshot);
+
+					double AllocsPerSecond = 0.0;
+					double BytesPerSecond = 0.0;
+					double TopCallsiteBytesPerSecond = 0.0;
+					for (const FMallocSamplingCallsite& Callsite : Callsites)
+					{
+						AllocsPerSecond += Callsite.AllocsPerSecond;
+						BytesPerSecond += Callsite.BytesPerSecond;
+						TopCallsiteBytesPerSecond = FMath::Max(TopCallsiteBytesPerSecond, Callsite.BytesPerSecond);
+					}
+
+					PerfCounters->Set(TEXT("HeapAllocsPerSec"), AllocsPerSecond, IPerfCounters::Flags::Transient);
+					PerfCounters->Set(TEXT("HeapBytesPerSec"), BytesPerSecond, IPerfCounters::Flags::Transient);
+					PerfCounters->Set(TEXT("HeapTopCallsiteBytesPerSec"), TopCallsiteBytesPerSecond, IPerfCounters::Flags::Transient);
+				}
 			}
 #endif // USE_SERVER_PERF_COUNTERS
 
@@ -2643,7 +2690,7 @@ static FORCEINLINE_DEBUGGABLE bool ShouldActorGoDormant( AActor* Actor, const TA
 	return true;
 }
 
-int32 UNetDriver::ServerReplicateActors_PrioritizeActors( UNetConnection* Connection, const TArray<FNetViewer>& ConnectionViewers, const TArray<FNetworkObjectInfo*> ConsiderList, const bool bCPUSaturated, FActorPriority*& OutPriorityList, FActorPriority**& OutPriorityActors )
+int32 UNetDriver::ServerReplicateActors_PrioritizeActors( UNetConnection* Connection, const TArray<FNetViewer>& ConnectionViewers, const TArray<FNetworkObjectInfo*>& ConsiderList, const bool bCPUSaturated, FActorPriority*& OutPriorityList, FActorPriority**& OutPriorityActors )
 {
 	SCOPE_CYCLE_COUNTER( STAT_NetPrioritizeActorsTime );
 
@@ -2675,7 +2722,20 @@ int32 UNetDriver::ServerReplicateActors_PrioritizeActors( UNetConnection* Connec
 		AGameNetworkManager* const NetworkManager = World->NetworkManager;
 		const bool bLowNetBandwidth = NetworkManager ? NetworkManager->IsInLowBandwidthMode() : false;
 
-		for ( FNetworkObjectInfo* ActorInfo : ConsiderList )
+		// With the relevancy grid only actors near this connection's viewers (or that it has a channel for) are visited
+		TArray<FNetworkObjectInfo*> GridCandidates;
+		if ( RelevancyGrid.IsValid() )
+		{
+			RelevancyGrid->GatherCandidates( Connection, ConnectionViewers, GridCandidates );
+		}
+		const TArray<FNetworkObjectInfo*>& CandidateList = RelevancyGrid.IsValid() ? GridCandidates : ConsiderList;
+
+		// Priorities are independent per actor, so they can be computed on worker threads once the relevant list is known
+		const int32 ParallelPrioritizeThreshold = CVarNetParallelPrioritizeThreshold.GetValueOnGameThread();
+		const bool bDeferPriorities = ParallelPrioritizeThreshold > 0 && CandidateList.Num() >= ParallelPrioritizeThreshold;
+		TArray<UNetConnection*, TFrameAllocator<>> PriorityConnections;
+
+		for ( FNetworkObjectInfo* ActorInfo : CandidateList )
 		{
 			AActor* Actor = ActorInfo->Actor;
 
@@ -2747,7 +2807,17 @@ int32 UNetDriver::ServerReplicateActors_PrioritizeActors( UNetConnection* Connec
 
 				Actor->NetTag = NetTag;
 
-				OutPriorityList[FinalSortedCount] = FActorPriority( PriorityConnection, Channel, ActorInfo, ConnectionViewers, bLowNetBandwidth );
+				if ( bDeferPriorities )
+				{
+					OutPriorityList[FinalSortedCount] = FActorPriority();
+					OutPriorityList[FinalSortedCount].ActorInfo = ActorInfo;
+					OutPriorityList[FinalSortedCount].Channel = Channel;
+					PriorityConnections.Add( PriorityConnection );
+				}
+				else
+				{
+					OutPriorityList[FinalSortedCount] = FActorPriority( PriorityConnection, Channel, ActorInfo, ConnectionViewers, bLowNetBandwidth );
+				}
 				OutPriorityActors[FinalSortedCount] = OutPriorityList + FinalSortedCount;
 
 				FinalSortedCount++;
@@ -2759,6 +2829,16 @@ int32 UNetDriver::ServerReplicateActors_PrioritizeActors( UNetConnection* Connec
 			}
 		}
 
+		if ( bDeferPriorities )
+		{
+			// Only reads actor and viewer state, so it's safe off the game thread
+			ParallelFor( FinalSortedCount, [&]( int32 Index )
+			{
+				FActorPriority& Entry = OutPriorityList[Index];
+				Entry = FActorPriority( PriorityConnections[Index], Entry.Channel, Entry.ActorInfo, ConnectionViewers, bLowNetBandwidth );
+			} );
+		}
+
 		// Add in deleted actors
 		for ( auto It = Connection->DestroyedStartupOrDormantActors.CreateIterator(); It; ++It )
 		{
@@ -3016,6 +3096,20 @@ int32 UNetDriver::ServerReplicateActors(float DeltaSeconds)
 	// Build the consider list (actors that are ready to replicate)
 	ServerReplicateActors_BuildConsiderList( ConsiderList, ServerTickTime );
 
+	// Bucket the consider list so connections can skip actors that are out of range of all their viewers
+	if ( CVarNetRelevancyGrid.GetValueOnGameThread() != 0 && GetDefault<AGameNetworkManager>()->bUseDistanceBasedRelevancy )
+	{
+		if ( !RelevancyGrid.IsValid() )
+		{
+			RelevancyGrid = MakeShareable( new FNetRelevancyGrid );
+		}
+		RelevancyGrid->Build( ConsiderList, CVarNetRelevancyGridCellSize.GetValueOnGameThread(), CVarNetRelevancyGridMaxCullDistance.GetValueOnGameThread() );
+	}
+	else
+	{
+		RelevancyGrid.Reset();
+	}
+
 	FMemMark Mark( FMemStack::Get() );
 
 	for ( int32 i=0; i < ClientConnections.Num(); i++ )
@@ -14,11 +14,17 @@
 #include "Net/NetworkProfiler.h"
 #include "Engine/ActorChannel.h"
 #include "Engine/NetworkSettings.h"
+#include "Engine/NetDriver.h"
 
 static TAutoConsoleVariable<int32> CVarAllowPropertySkipping( TEXT( "net.AllowPropertySkipping" ), 1, TEXT( "Allow skipping of properties that haven't changed for other clients" ) );
 
 static TAutoConsoleVariable<int32> CVarDoPropertyChecksum( TEXT( "net.DoPropertyChecksum" ), 0, TEXT( "" ) );
 
+static TAutoConsoleVariable<int32> CVarShareSerializedProperties( TEXT( "net.ShareSerializedProperties" ), 1, TEXT( "Serialize an object's changed properties once per frame and reuse the bits for every connection sending the same properties (only for properties that serialize the same for every connection)" ) );
+
+static int32 GRepCompareSpans = 1;
+static FAutoConsoleVariableRef CVarRepCompareSpans( TEXT( "net.CompareSpans" ), GRepCompareSpans, TEXT( "Compare runs of plain data properties with a single memcmp before comparing them one by one in CompareProperties" ) );
+
 FAutoConsoleVariable CVarDoReplicationContextString( TEXT( "net.ContextDebug" ), 0, TEXT( "" ) );
 
 int32 LogSkippedRepNotifies = 0;
@@ -404,6 +410,19 @@ uint16 FRepLayout::CompareProperties_r(
 			continue;
 		}
 
+		if ( !bForceFail && GRepCompareSpans && CompareSpans.Num() > 0 && CompareSpans[CmdIndex].EndCmd != 0 )
+		{
+			const FRepCompareSpan& Span = CompareSpans[CmdIndex];
+
+			// Nothing in the span changed, skip over it. Otherwise fall through and find what changed property by property
+			if ( FMemory::Memcmp( CompareData + Cmd.Offset, Data + Cmd.Offset, Span.NumBytes ) == 0 )
+			{
+				Handle += Span.EndCmd - CmdIndex - 1;
+				CmdIndex = Span.EndCmd - 1;		// The -1 to handle the ++ in the for loop
+				continue;
+			}
+		}
+
 		if ( bForceFail || !PropertiesAreIdentical( Cmd, ( const void* )( CompareData + Cmd.Offset ), ( const void* )( Data + Cmd.Offset ) ) )
 		{
 			StoreProperty( Cmd, ( void* )( CompareData + Cmd.Offset ), ( const void* )( Data + Cmd.Offset ) );
@@ -679,7 +698,7 @@ bool FRepLayout::ReplicateProperties(
 
 		SendProperties_BackwardsCompatible( RepState, ChangeTracker, Data, OwningChannel->Connection, Writer, Changed );
 	}
-	else
+	else if ( !SendProperties_Shared( RepState, RepChangelistState, ChangeTracker, Data, ObjectClass, OwningChannel->Connection->Driver->ReplicationFrame, Writer, Changed ) )
 	{
 		SendProperties( RepState, ChangeTracker, Data, ObjectClass, Writer, Changed );
 	}
@@ -1274,6 +1293,119 @@ void FRepLayout::SendProperties(
 	}
 }
 
+// Returns true if this property's bits don't depend on the connection it's sent to
+static FORCEINLINE bool IsSerializationConnectionIndependent( const FRepLayoutCmd& Cmd )
+{
+	switch ( Cmd.Type )
+	{
+		case REPCMD_PropertyBool:
+		case REPCMD_PropertyFloat:
+		case REPCMD_PropertyInt:
+		case REPCMD_PropertyByte:
+		case REPCMD_PropertyUInt32:
+		case REPCMD_PropertyUInt64:
+		case REPCMD_PropertyVector:
+		case REPCMD_PropertyRotator:
+		case REPCMD_PropertyPlane:
+		case REPCMD_PropertyVector100:
+		case REPCMD_PropertyVectorNormal:
+		case REPCMD_PropertyVector10:
+		case REPCMD_PropertyVectorQ:
+		case REPCMD_PropertyString:
+		case REPCMD_RepMovement:
+			return true;
+
+		default:
+			// Objects and generic structs go through the package map (NetGUID exports are per connection), arrays have nested changelists
+			return false;
+	}
+}
+
+bool FRepLayout::SendProperties_Shared(
+	FRepState *	RESTRICT			RepState,
+	FRepChangelistState* RESTRICT	RepChangelistState,
+	FRepChangedPropertyTracker*		ChangedTracker,
+	const uint8* RESTRICT			Data,
+	UClass *						ObjectClass,
+	const uint32					ReplicationFrame,
+	FNetBitWriter&					Writer,
+	TArray< uint16 > &				Changed ) const
+{
+	if ( !CVarShareSerializedProperties.GetValueOnAnyThread() )
+	{
+		return false;
+	}
+
+#ifdef ENABLE_PROPERTY_CHECKSUMS
+	if ( CVarDoPropertyChecksum.GetValueOnAnyThread() == 1 )
+	{
+		return false;
+	}
+#endif
+
+	// Work out which handles SendProperties would actually write for this connection, the bits only depend on those
+	TArray< uint16, TInlineAllocator< 32 > > Handles;
+
+	for ( int32 i = 0; i < Changed.Num() && Changed[i] != 0; i++ )
+	{
+		const uint16 Handle = Changed[i];
+		const FRepLayoutCmd& Cmd = Cmds[BaseHandleToCmdIndex[Handle - 1].CmdIndex];
+		const FRepParentCmd& ParentCmd = Parents[Cmd.ParentIndex];
+
+		if ( !RepState->ConditionMap[ParentCmd.Condition] || !ChangedTracker->Parents[Cmd.ParentIndex].Active )
+		{
+			if ( Cmd.Type == REPCMD_DynamicArray )
+			{
+				// Can't skip over the nested changelist here, let SendProperties handle it
+				return false;
+			}
+			continue;
+		}
+
+		// Role and RemoteRole are swapped per connection
+		if ( !IsSerializationConnectionIndependent( Cmd ) || ParentCmd.RoleSwapIndex != -1 )
+		{
+			return false;
+		}
+
+		Handles.Add( Handle );
+	}
+
+	if ( Handles.Num() == 0 )
+	{
+		return false;
+	}
+
+	// Properties can't change during a replication frame, so another connection that sent the same handles this frame wrote the same bits
+	for ( int32 i = 0; i < FRepChangelistState::MAX_SERIALIZED_CHANGELISTS; i++ )
+	{
+		const FRepSerializedChangelist& Serialized = RepChangelistState->SerializedChangelists[i];
+
+		if ( Serialized.ReplicationFrame == ReplicationFrame && Serialized.Handles.Num() == Handles.Num() && FMemory::Memcmp( Serialized.Handles.GetData(), Handles.GetData(), Handles.Num() * sizeof( uint16 ) ) == 0 )
+		{
+			Writer.SerializeBits( ( void* )Serialized.Bits.GetData(), Serialized.NumBits );
+			return true;
+		}
+	}
+
+	FNetBitWriter SharedWriter( Writer.PackageMap, 0 );
+
+	SendProperties( RepState, ChangedTracker, Data, ObjectClass, SharedWriter, Changed );
+
+	FRepSerializedChangelist& Serialized = RepChangelistState->SerializedChangelists[RepChangelistState->NextSerializedChangelist];
+	RepChangelistState->NextSerializedChangelist = ( RepChangelistState->NextSerializedChangelist + 1 ) % FRepChangelistState::MAX_SERIALIZED_CHANGELISTS;
+
+	Serialized.ReplicationFrame = ReplicationFrame;
+	Serialized.Handles.Reset();
+	Serialized.Handles.Append( Handles.GetData(), Handles.Num() );
+	Serialized.NumBits = SharedWriter.GetNumBits();
+	Serialized.Bits = *SharedWriter.GetBuffer();
+
+	Writer.SerializeBits( SharedWriter.GetData(), SharedWriter.GetNumBits() );
+
+	return true;
+}
+
 static FORCEINLINE void WritePropertyHandle_BackwardsCompatible( FNetBitWriter & Writer, uint32 NetFieldExportHandle, bool bDoChecksum )
 {
 	const int NumStartingBits = Writer.GetNumBits();
@@ -3017,9 +3149,199 @@ void FRepLayout::InitFromObjectClass( UClass * InObjectClass )
 
 	BuildHandleToCmdIndexTable_r( 0, Cmds.Num() - 1, BaseHandleToCmdIndex );
 
+	BuildCompareSpans();
+
 	Owner = InObjectClass;
 }
 
+/** Returns whether the cmd's data is identical whenever its bytes are, and it is compared every time CompareProperties runs */
+static bool CanCompareCmdAsBytes( const FRepLayoutCmd& Cmd, const FRepParentCmd& ParentCmd )
+{
+	if ( !( ParentCmd.Flags & PARENT_IsLifetime ) || ParentCmd.Condition == COND_InitialOnly )
+	{
+		return false;
+	}
+
+	switch ( Cmd.Type )
+	{
+		case REPCMD_PropertyBool:
+		case REPCMD_PropertyByte:
+		case REPCMD_PropertyFloat:
+		case REPCMD_PropertyInt:
+		case REPCMD_PropertyName:
+		case REPCMD_PropertyUInt32:
+		case REPCMD_PropertyUInt64:
+		case REPCMD_PropertyVector:
+		case REPCMD_PropertyVector100:
+		case REPCMD_PropertyVectorQ:
+		case REPCMD_PropertyVectorNormal:
+		case REPCMD_PropertyVector10:
+		case REPCMD_PropertyPlane:
+		case REPCMD_PropertyRotator:
+			// Float based types are identical by bytes too, except that a NaN never equals itself in PropertiesAreIdentical:
+			// a NaN that keeps its bytes is skipped by the span instead of being resent every compare
+			return true;
+
+		case REPCMD_PropertyObject:
+			// Plain object pointers only, asset and lazy pointers own heap data
+			return Cmd.Property->IsA( UObjectProperty::StaticClass() );
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Finds the runs of consecutive cmds that can be compared as bytes and are (nearly) contiguous in memory.
+ * A span never crosses a dynamic array or a return, so the offsets in it are always relative to the same data.
+ * Identical bytes mean identical properties (NaN floats aside, see CanCompareCmdAsBytes), so a span is only a prefilter: when the memcmp fails CompareProperties
+ * still compares the cmds one by one, and padding or non replicated data in the small gaps only cost a missed skip.
+ */
+void FRepLayout::BuildCompareSpans()
+{
+	static const int32 MAX_SPAN_GAP = 8;
+
+	CompareSpans.Empty();
+	CompareSpans.SetNum( Cmds.Num() );
+
+	int32 CmdIndex = 0;
+
+	while ( CmdIndex < Cmds.Num() )
+	{
+		if ( !CanCompareCmdAsBytes( Cmds[CmdIndex], Parents[Cmds[CmdIndex].ParentIndex] ) )
+		{
+			CmdIndex++;
+			continue;
+		}
+
+		const int32 StartOffset = Cmds[CmdIndex].Offset;
+		int32 EndOffset = StartOffset + Cmds[CmdIndex].Property->ElementSize;
+		int32 EndCmd = CmdIndex + 1;
+
+		while ( EndCmd < Cmds.Num() )
+		{
+			const FRepLayoutCmd& Cmd = Cmds[EndCmd];
+
+			if ( !CanCompareCmdAsBytes( Cmd, Parents[Cmd.ParentIndex] ) || Cmd.Offset < Cmds[EndCmd - 1].Offset || Cmd.Offset - EndOffset > MAX_SPAN_GAP )
+			{
+				break;
+			}
+
+			const int32 NewEndOffset = FMath::Max( EndOffset, Cmd.Offset + Cmd.Property->ElementSize );
+
+			if ( NewEndOffset - StartOffset > MAX_uint16 )
+			{
+				break;
+			}
+
+			EndOffset = NewEndOffset;
+			EndCmd++;
+		}
+
+		// A single cmd is compared faster by its own type
+		if ( EndCmd - CmdIndex > 1 )
+		{
+			CompareSpans[CmdIndex].EndCmd	= EndCmd;
+			CompareSpans[CmdIndex].NumBytes	= EndOffset - StartOffset;
+		}
+
+		CmdIndex = EndCmd;
+	}
+}
+
+void FRepLayout::GetCompareSpanStats( int32& OutNumCmds, int32& OutNumSpanCmds, int32& OutNumSpans ) const
+{
+	OutNumCmds		= Cmds.Num();
+	OutNumSpanCmds	= 0;
+	OutNumSpans		= 0;
+
+	for ( int32 i = 0; i < CompareSpans.Num(); i++ )
+	{
+		if ( CompareSpans[i].EndCmd != 0 )
+		{
+			OutNumSpanCmds += CompareSpans[i].EndCmd - i;
+			OutNumSpans++;
+		}
+	}
+}
+
+/**
+ * Times CompareProperties on a class default object against its own shadow state, with and without compare spans.
+ * Nothing changes between compares, which is the common case for most replicated actors on a server.
+ * Usage: net.BenchmarkCompareProperties <Class name or path> [Iterations]
+ * e.g. net.BenchmarkCompareProperties /Game/RestrictedAssets/Blueprints/DefaultCharacter.DefaultCharacter_C 100000
+ */
+static void BenchmarkCompareProperties( const TArray< FString >& Args )
+{
+	if ( Args.Num() < 1 )
+	{
+		UE_LOG( LogRep, Display, TEXT( "Usage: net.BenchmarkCompareProperties <Class name or path> [Iterations]" ) );
+		return;
+	}
+
+	UClass* ObjectClass = FindObject< UClass >( ANY_PACKAGE, *Args[0] );
+
+	if ( ObjectClass == NULL )
+	{
+		ObjectClass = LoadObject< UClass >( NULL, *Args[0] );
+	}
+
+	if ( ObjectClass == NULL )
+	{
+		UE_LOG( LogRep, Warning, TEXT( "BenchmarkCompareProperties: Class %s not found" ), *Args[0] );
+		return;
+	}
+
+	const int32 Iterations = Args.Num() > 1 ? FMath::Max( FCString::Atoi( *Args[1] ), 1 ) : 10000;
+
+	UObject* Object = ObjectClass->GetDefaultObject();
+
+	TSharedPtr< FRepLayout > RepLayout = MakeShareable( new FRepLayout() );
+	RepLayout->InitFromObjectClass( ObjectClass );
+
+	FRepChangelistState RepChangelistState;
+	RepLayout->InitShadowData( RepChangelistState.StaticBuffer, ObjectClass, ( uint8* )Object );
+
+	FReplicationFlags RepFlags;
+
+	const int32 OldCompareSpans = GRepCompareSpans;
+
+	double Seconds[2];
+
+	for ( int32 Pass = 0; Pass < 2; Pass++ )
+	{
+		GRepCompareSpans = ( Pass == 0 ) ? 0 : 1;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for ( int32 i = 0; i < Iterations; i++ )
+		{
+			RepLayout->CompareProperties( &RepChangelistState, ( const uint8* )Object, RepFlags );
+		}
+
+		Seconds[Pass] = FPlatformTime::Seconds() - StartTime;
+	}
+
+	GRepCompareSpans = OldCompareSpans;
+
+	// The shadow data holds copies of strings, arrays etc. that FRepChangelistState doesn't free on its own
+	RepLayout->DestructShadowData( RepChangelistState.StaticBuffer );
+
+	int32 NumCmds = 0;
+	int32 NumSpanCmds = 0;
+	int32 NumSpans = 0;
+	RepLayout->GetCompareSpanStats( NumCmds, NumSpanCmds, NumSpans );
+
+	UE_LOG( LogRep, Display, TEXT( "BenchmarkCompareProperties: %s, %i cmds, %i in %i compare spans, %i iterations" ), *ObjectClass->GetName(), NumCmds, NumSpanCmds, NumSpans, Iterations );
+	UE_LOG( LogRep, Display, TEXT( "  Per property: %.3f us per compare" ), Seconds[0] * 1000000.0 / Iterations );
+	UE_LOG( LogRep, Display, TEXT( "  Spans:        %.3f us per compare" ), Seconds[1] * 1000000.0 / Iterations );
+}
+
+static FAutoConsoleCommand BenchmarkComparePropertiesCommand(
+	TEXT( "net.BenchmarkCompareProperties" ),
+	TEXT( "Times FRepLayout::CompareProperties on a class default object with and without compare spans. Usage: net.BenchmarkCompareProperties <Class name or path> [Iterations]" ),
+	FConsoleCommandWithArgsDelegate::CreateStatic( BenchmarkCompareProperties ) );
+
 void FRepLayout::InitFromFunction( UFunction * InFunction )
 {
 	int32 RelativeHandle = 0;
@@ -3485,7 +3807,12 @@ void FRepLayout::InitProperties( TArray< uint8, TAlignedHeapAllocator<16> >& Sha
 
 void FRepLayout::DestructProperties( FRepState * RepState ) const
 {
-	uint8* StoredData = RepState->StaticBuffer.GetData();
+	DestructShadowData( RepState->StaticBuffer );
+}
+
+void FRepLayout::DestructShadowData( TArray< uint8, TAlignedHeapAllocator<16> >& ShadowData ) const
+{
+	uint8* StoredData = ShadowData.GetData();
 
 	// Destruct all items
 	for ( int32 i = 0; i < Parents.Num(); i++ )
@@ -3494,13 +3821,13 @@ void FRepLayout::DestructProperties( FRepState * RepState ) const
 		if ( Parents[i].ArrayIndex == 0 )
 		{
 			PTRINT Offset = Parents[i].Property->ContainerPtrToValuePtr<uint8>( StoredData ) - StoredData;
-			check( Offset >= 0 && Offset < RepState->StaticBuffer.Num() );
+			check( Offset >= 0 && Offset < ShadowData.Num() );
 
 			Parents[i].Property->DestroyValue( StoredData + Offset );
 		}
 	}
 
-	RepState->StaticBuffer.Empty();
+	ShadowData.Empty();
 }
 
 void FRepLayout::GetLifetimeCustomDeltaProperties(TArray< int32 > & OutCustom, TArray< ELifetimeCondition >	& OutConditions)
@@ -112,6 +112,20 @@ public:
 	int32						CmdIndex;
 };
 
+/** FRepSerializedChangelist
+*  Property bits written by SendProperties for a changelist, reused for every connection that sends the same properties in the same replication frame
+*/
+class FRepSerializedChangelist
+{
+public:
+	FRepSerializedChangelist() : ReplicationFrame( 0 ), NumBits( 0 ) { }
+
+	uint32				ReplicationFrame;
+	TArray< uint16 >	Handles;		// Handles that were written, after condition and active filtering
+	TArray< uint8 >		Bits;
+	int64				NumBits;
+};
+
 /** FRepChangelistState
 *  Stores changelist history (that are used to know what properties have changed) for objects
 */
@@ -121,7 +135,8 @@ public:
 	FRepChangelistState() :
 		HistoryStart( 0 ),
 		HistoryEnd( 0 ),
-		CompareIndex( 0 )
+		CompareIndex( 0 ),
+		NextSerializedChangelist( 0 )
 	{ }
 
 	TSharedPtr< FRepLayout >						RepLayout;
@@ -135,6 +150,12 @@ public:
 
 	// Properties will be copied in here so memory needs aligned to largest type
 	TArray< uint8, TAlignedHeapAllocator<16> >		StaticBuffer;
+
+	static const int32 MAX_SERIALIZED_CHANGELISTS = 4;
+
+	// Recently serialized changelists, shared by all connections replicating this object (see net.ShareSerializedProperties)
+	FRepSerializedChangelist						SerializedChangelists[MAX_SERIALIZED_CHANGELISTS];
+	int32											NextSerializedChangelist;
 };
 
 /** FRepState
@@ -260,6 +281,18 @@ public:
 	uint16		ParentIndex;		// Index into Parents
 	uint32		CompatibleChecksum;	// Used to determine if property is still compatible
 };
+
+/** FRepCompareSpan
+ *  A run of consecutive plain data cmds that CompareProperties can check with a single memcmp before comparing them one by one
+ */
+class FRepCompareSpan
+{
+public:
+	FRepCompareSpan() : EndCmd( 0 ), NumBytes( 0 ) { }
+
+	uint16		EndCmd;				// One past the last cmd of the span, 0 if no span starts at this cmd
+	uint16		NumBytes;			// Bytes from the first cmd's offset to the end of the last cmd's data
+};
 	
 /** FHandleToCmdIndex
  *  Converts a relative handle to the appropriate index into the Cmds array
@@ -371,6 +404,9 @@ public:
 		UClass *									InObjectClass,
 		uint8 *										Src ) const;
 
+	/** Destroys the property values in shadow data created by InitShadowData, and empties it */
+	void DestructShadowData( TArray< uint8, TAlignedHeapAllocator<16> >& ShadowData ) const;
+
 	void InitRepState( 
 		FRepState *									RepState, 
 		UClass *									InObjectClass, 
@@ -438,6 +474,9 @@ public:
 
 	UObject* GetOwner() const { return Owner; }
 
+	/** Number of cmds, and how many of them are covered by how many compare spans */
+	void GetCompareSpanStats( int32& OutNumCmds, int32& OutNumSpanCmds, int32& OutNumSpans ) const;
+
 	void SendProperties_BackwardsCompatible(
 		FRepState* RESTRICT			RepState,
 		FRepChangedPropertyTracker* ChangedTracker,
@@ -484,6 +523,16 @@ private:
 		const int32							CmdEnd,
 		const uint8*						SourceData ) const;
 
+	bool SendProperties_Shared(
+		FRepState*	RESTRICT			RepState,
+		FRepChangelistState* RESTRICT	RepChangelistState,
+		FRepChangedPropertyTracker*		ChangedTracker,
+		const uint8* RESTRICT			Data,
+		UClass*							ObjectClass,
+		const uint32					ReplicationFrame,
+		FNetBitWriter&					Writer,
+		TArray< uint16 >&				Changed ) const;
+
 	void SendProperties_r(
 		FRepState*	RESTRICT				RepState,
 		FRepChangedPropertyTracker*			ChangedTracker,
@@ -600,12 +649,15 @@ private:
 
 	void BuildHandleToCmdIndexTable_r( const int32 CmdStart, const int32 CmdEnd, TArray< FHandleToCmdIndex >& HandleToCmdIndex );
 
+	void BuildCompareSpans();
+
 	void ConstructProperties( TArray< uint8, TAlignedHeapAllocator<16> >& ShadowData ) const;
 	void InitProperties( TArray< uint8, TAlignedHeapAllocator<16> >& ShadowData, uint8* Src ) const;
 	void DestructProperties( FRepState * RepState ) const;
 
 	TArray< FRepParentCmd >		Parents;
 	TArray< FRepLayoutCmd >		Cmds;
+	TArray< FRepCompareSpan >	CompareSpans;				// Parallel to Cmds, see BuildCompareSpans
 
 	TArray< FHandleToCmdIndex >	BaseHandleToCmdIndex;		// Converts a relative handle to the appropriate index into the Cmds array
 
@@ -18,11 +18,13 @@ namespace UnrealBuildTool.Rules
 				{
 					"CoreUObject",
 					"Engine",
+					"ImageCore",
 					"Slate",
 					"SlateCore",
 					"RenderCore",
 					"ShaderCore",
 					"RHI",
+					"Sockets",
 				}
 			);
 		}
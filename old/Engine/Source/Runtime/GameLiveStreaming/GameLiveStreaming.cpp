@@ -14,11 +14,20 @@
 #include "Features/IModularFeatures.h"
 #include "Features/ILiveStreamingService.h"
 #include "ScreenRendering.h"
+#include "Misc/CommandLine.h"
+#include "LocalLiveStreamingService.h"
 
 IMPLEMENT_MODULE( FGameLiveStreaming, GameLiveStreaming );
 
 #define LOCTEXT_NAMESPACE "GameLiveStreaming"
 
+static TAutoConsoleVariable<int32> CVarLiveStreamingNumReadbackBuffers(
+	TEXT( "GameLiveStreaming.NumReadbackBuffers" ),
+	4,
+	TEXT( "Number of textures game frames are copied back to the CPU through while broadcasting (3-8).\n" )
+	TEXT( "With more textures, frames reach the stream later but mapping a texture is less likely to wait on the GPU.\n" )
+	TEXT( "Takes effect when broadcasting starts." ) );
+
 FGameLiveStreaming::FGameLiveStreaming()
 	: BroadcastStartCommand
 		(
@@ -114,18 +123,29 @@ FGameLiveStreaming::FGameLiveStreaming()
 	bIsBroadcasting = false;
 	bIsWebCamEnabled = false;
 	LiveStreamer = nullptr;
-	ReadbackTextureIndex = 0;
-	ReadbackBufferIndex = 0;
-	ReadbackBuffers[0] = nullptr;
-	ReadbackBuffers[1] = nullptr;
+	ReadbackFrameIndex = 0;
 	bMirrorWebCamImage = false;
 	bDrawSimpleWebCamVideo = true;
 	CoverUpImage = nullptr;
 }
 
 
+FGameLiveStreaming::~FGameLiveStreaming()
+{
+}
+
+
 void FGameLiveStreaming::StartupModule()
 {
+	// Cloud gaming servers encode and hand off frames locally instead of broadcasting through a live streaming plugin
+	FString LocalStreamTarget;
+	if( FParse::Value( FCommandLine::Get(), TEXT( "-LocalLiveStreaming=" ), LocalStreamTarget ) )
+	{
+		FString EncoderName;
+		FParse::Value( FCommandLine::Get(), TEXT( "-LocalLiveStreamingEncoder=" ), EncoderName );
+
+		LocalStreamer.Reset( new FLocalLiveStreamingService( LocalStreamTarget, EncoderName.IsEmpty() ? NAME_None : FName( *EncoderName ) ) );
+	}
 }
 
 
@@ -136,7 +156,7 @@ void FGameLiveStreaming::ShutdownModule()
 		// Make sure the LiveStreaming plugin is actually still loaded.  During shutdown, it may have been unloaded before us,
 		// and we can't dereference our LiveStreamer pointer if the memory was deleted already!
 		static const FName LiveStreamingFeatureName( "LiveStreaming" );
-		if( IModularFeatures::Get().IsModularFeatureAvailable( LiveStreamingFeatureName ) )	// Make sure the feature hasn't been destroyed before us
+		if( LiveStreamer == LocalStreamer.Get() || IModularFeatures::Get().IsModularFeatureAvailable( LiveStreamingFeatureName ) )	// Make sure the feature hasn't been destroyed before us
 		{
 			// Turn off the web camera.  It's important this happens first to avoid a shutdown crash.
 			StopWebCam();
@@ -149,6 +169,8 @@ void FGameLiveStreaming::ShutdownModule()
 		}
 		LiveStreamer = nullptr;
 	}
+
+	LocalStreamer.Reset();
 }
 
 
@@ -204,20 +226,24 @@ void FGameLiveStreaming::StartBroadcastingGame( const FGameBroadcastConfig& Game
 
 			// Setup readback buffer textures
 			{
-				for( int32 TextureIndex = 0; TextureIndex < 2; ++TextureIndex )
-				{
-					ReadbackTextures[ TextureIndex ] = nullptr;
-				}
+				// Texture reads trail copies by two frames (see StartCopyingNextGameVideoFrame), so a third texture is needed to have any copy in flight
+				const int32 NumReadbackBuffers = FMath::Clamp( CVarLiveStreamingNumReadbackBuffers.GetValueOnGameThread(), 3, 8 );
+
+				ReadbackTextures.Reset();
+				ReadbackTextures.SetNum( NumReadbackBuffers );
+				ReadbackBuffers.Reset();
+				ReadbackBuffers.SetNumZeroed( NumReadbackBuffers );
+
 				ENQUEUE_UNIQUE_RENDER_COMMAND_THREEPARAMETER(
 					FWebMRecordCreateBufers,
 					int32,InVideoWidth,BroadcastConfig.VideoBufferWidth,
 					int32,InVideoHeight,BroadcastConfig.VideoBufferHeight,
-					FTexture2DRHIRef*,InReadbackTextures,ReadbackTextures,
+					TArray<FTexture2DRHIRef>*,InReadbackTextures,&ReadbackTextures,
 				{
-					for (int32 TextureIndex = 0; TextureIndex < 2; ++TextureIndex)
+					for (int32 TextureIndex = 0; TextureIndex < InReadbackTextures->Num(); ++TextureIndex)
 					{
 						FRHIResourceCreateInfo CreateInfo;
-						InReadbackTextures[ TextureIndex ] = RHICreateTexture2D(
+						(*InReadbackTextures)[ TextureIndex ] = RHICreateTexture2D(
 							InVideoWidth,
 							InVideoHeight,
 							PF_B8G8R8A8,
@@ -229,16 +255,12 @@ void FGameLiveStreaming::StartBroadcastingGame( const FGameBroadcastConfig& Game
 					}
 				});
 				FlushRenderingCommands();
-				for (int32 TextureIndex = 0; TextureIndex < 2; ++TextureIndex)
+				for (int32 TextureIndex = 0; TextureIndex < ReadbackTextures.Num(); ++TextureIndex)
 				{
 					check(ReadbackTextures[TextureIndex].GetReference());
 				}
-	
-				ReadbackTextureIndex = 0;
 
-				ReadbackBuffers[0] = nullptr;
-				ReadbackBuffers[1] = nullptr;
-				ReadbackBufferIndex = 0;
+				ReadbackFrameIndex = 0;
 			}
 
 			BroadcastConfig.FramesPerSecond = GameBroadcastConfig.FrameRate;
@@ -277,14 +299,24 @@ void FGameLiveStreaming::StopBroadcastingGame()
 
 		// Cleanup readback buffer textures
 		{
+			ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+				UnmapReadbackTextures,
+				FGameLiveStreaming*,This,this,
+			{
+				for( int32 Index = 0; Index < This->ReadbackBuffers.Num(); ++Index )
+				{
+					if( This->ReadbackBuffers[ Index ] != nullptr )
+					{
+						RHICmdList.UnmapStagingSurface( This->ReadbackTextures[ Index ] );
+						This->ReadbackBuffers[ Index ] = nullptr;
+					}
+				}
+			});
 			FlushRenderingCommands();
 
-			ReadbackTextures[0].SafeRelease();
-			ReadbackTextures[1].SafeRelease();
-			ReadbackTextureIndex = 0;
-			ReadbackBuffers[0] = nullptr;
-			ReadbackBuffers[1] = nullptr;
-			ReadbackBufferIndex = 0;
+			ReadbackTextures.Empty();
+			ReadbackBuffers.Empty();
+			ReadbackFrameIndex = 0;
 		}
 	}
 
@@ -370,26 +402,32 @@ void FGameLiveStreaming::OnSlateWindowRenderedDuringBroadcasting( SWindow& Slate
 
 void FGameLiveStreaming::BroadcastGameVideoFrame()
 {
-	if( ReadbackBuffers[ ReadbackBufferIndex ] != nullptr )
+	// The texture mapped two frames ago, which is also the one this frame will be copied into.  The render thread is at most a frame
+	// behind, so the map has run by now unless the GPU was still busy with the copy.
+	const int32 ReadyIndex = ReadbackFrameIndex % ReadbackBuffers.Num();
+	if( ReadbackBuffers[ ReadyIndex ] != nullptr )
 	{
 		// Great, we have a new frame back from the GPU.  Upload the video frame!
-		LiveStreamer->PushVideoFrame( (FColor*)ReadbackBuffers[ ReadbackBufferIndex ] );
+		LiveStreamer->PushVideoFrame( (FColor*)ReadbackBuffers[ ReadyIndex ] );
 
 		// Unmap the buffer now that we've pushed out the frame
 		{
 			struct FReadbackFromStagingBufferContext
 			{
 				FGameLiveStreaming* This;
+				int32 ReadbackIndex;
 			};
 			FReadbackFromStagingBufferContext ReadbackFromStagingBufferContext =
 			{
-				this
+				this,
+				ReadyIndex
 			};
 			ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
 				ReadbackFromStagingBuffer,
 				FReadbackFromStagingBufferContext,Context,ReadbackFromStagingBufferContext,
 			{
-				RHICmdList.UnmapStagingSurface(Context.This->ReadbackTextures[Context.This->ReadbackTextureIndex]);
+				RHICmdList.UnmapStagingSurface(Context.This->ReadbackTextures[Context.ReadbackIndex]);
+				Context.This->ReadbackBuffers[Context.ReadbackIndex] = nullptr;
 			});
 		}								
 	}
@@ -421,20 +459,30 @@ void FGameLiveStreaming::StartCopyingNextGameVideoFrame( const FViewportRHIRef&
 		FIntPoint ResizeTo;
 		FTexture2DRHIRef CoverUpImage;
 		FGameLiveStreaming* This;
+		int32 ReadbackIndex;
 	};
+	const int32 NumReadbackBuffers = ReadbackTextures.Num();
 	FCopyVideoFrame CopyVideoFrame =
 	{
 		ViewportRHI,
 		&RendererModule,
 		ResizeTo,
 		CoverUpImage != nullptr ? ( (FTexture2DResource*)( CoverUpImage->Resource ) )->GetTexture2DRHI() : nullptr,
-		this
+		this,
+		(int32)( ReadbackFrameIndex % NumReadbackBuffers )
 	};
 
 	ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
 		ReadSurfaceCommand,
 		FCopyVideoFrame,Context,CopyVideoFrame,
 	{
+		// The game thread didn't get to push this texture's last frame, so give up on it before copying over it
+		if( Context.This->ReadbackBuffers[ Context.ReadbackIndex ] != nullptr )
+		{
+			RHICmdList.UnmapStagingSurface( Context.This->ReadbackTextures[ Context.ReadbackIndex ] );
+			Context.This->ReadbackBuffers[ Context.ReadbackIndex ] = nullptr;
+		}
+
 		FPooledRenderTargetDesc OutputDesc(FPooledRenderTargetDesc::Create2DDesc(Context.ResizeTo, PF_B8G8R8A8, FClearValueBinding::None, TexCreate_None, TexCreate_RenderTargetable, false));
 			
 		const auto FeatureLevel = GMaxRHIFeatureLevel;
@@ -488,37 +536,41 @@ void FGameLiveStreaming::StartCopyingNextGameVideoFrame( const FViewportRHIRef&
 		const bool bKeepOriginalSurface = false;
 		RHICmdList.CopyToResolveTarget(
 			DestRenderTarget.TargetableTexture,
-			Context.This->ReadbackTextures[ Context.This->ReadbackTextureIndex ],
+			Context.This->ReadbackTextures[ Context.ReadbackIndex ],
 			bKeepOriginalSurface,
 			FResolveParams());
 	});
 							
 
-	// Start mapping the newly-rendered buffer
+	// Start mapping the texture that will be copied into two frames from now, which the GPU has had NumReadbackBuffers - 2 frames to finish.
+	// The game thread pushes it two frames from now, before that copy is issued.  Mapping the texture the next frame is copied into instead
+	// would race the render thread: if it hadn't run the map yet when the game thread looked, the next copy would unmap the frame unread.
+	if( ReadbackFrameIndex + 2 >= (uint32)NumReadbackBuffers )
 	{
 		struct FReadbackFromStagingBufferContext
 		{
 			FGameLiveStreaming* This;
+			int32 ReadbackIndex;
 		};
 		FReadbackFromStagingBufferContext ReadbackFromStagingBufferContext =
 		{
-			this
+			this,
+			(int32)( ( ReadbackFrameIndex + 2 ) % NumReadbackBuffers )
 		};
 		ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
 			ReadbackFromStagingBuffer,
 			FReadbackFromStagingBufferContext,Context,ReadbackFromStagingBufferContext,
 		{
-			int32 UnusedWidth = 0;
-			int32 UnusedHeight = 0;
-			RHICmdList.MapStagingSurface(Context.This->ReadbackTextures[Context.This->ReadbackTextureIndex], Context.This->ReadbackBuffers[Context.This->ReadbackBufferIndex], UnusedWidth, UnusedHeight);
-
-			// Ping pong between readback textures
-			Context.This->ReadbackTextureIndex = ( Context.This->ReadbackTextureIndex + 1 ) % 2;
+			if( Context.This->ReadbackBuffers[Context.ReadbackIndex] == nullptr )
+			{
+				int32 UnusedWidth = 0;
+				int32 UnusedHeight = 0;
+				RHICmdList.MapStagingSurface(Context.This->ReadbackTextures[Context.ReadbackIndex], Context.This->ReadbackBuffers[Context.ReadbackIndex], UnusedWidth, UnusedHeight);
+			}
 		});
 	}
 
-	// Ping pong between readback buffers
-	ReadbackBufferIndex = ( ReadbackBufferIndex + 1 ) % 2;
+	++ReadbackFrameIndex;
 }
 
 
@@ -570,10 +622,10 @@ ILiveStreamingService* FGameLiveStreaming::GetLiveStreamingService()
 	if( LiveStreamer == nullptr )
 	{
 		static const FName LiveStreamingFeatureName( "LiveStreaming" );
-		if( IModularFeatures::Get().IsModularFeatureAvailable( LiveStreamingFeatureName ) )
+		if( LocalStreamer.IsValid() || IModularFeatures::Get().IsModularFeatureAvailable( LiveStreamingFeatureName ) )
 		{
 			// Select a live streaming service
-			LiveStreamer = &IModularFeatures::Get().GetModularFeature<ILiveStreamingService>( LiveStreamingFeatureName );
+			LiveStreamer = LocalStreamer.IsValid() ? LocalStreamer.Get() : &IModularFeatures::Get().GetModularFeature<ILiveStreamingService>( LiveStreamingFeatureName );
 
 			// Register to find out about status changes
 			LiveStreamer->OnStatusChanged().AddRaw( this, &FGameLiveStreaming::BroadcastStatusCallback );
@@ -584,6 +636,24 @@ ILiveStreamingService* FGameLiveStreaming::GetLiveStreamingService()
 }
 
 
+void FGameLiveStreaming::SetVideoEncoderRegionsOfInterest( const TArray< FVideoEncoderRegionOfInterest >& Regions )
+{
+	if( LocalStreamer.IsValid() )
+	{
+		LocalStreamer->SetRegionsOfInterest( Regions );
+	}
+}
+
+
+void FGameLiveStreaming::RequestVideoKeyFrame()
+{
+	if( LocalStreamer.IsValid() )
+	{
+		LocalStreamer->RequestKeyFrame();
+	}
+}
+
+
 	
 void FGameLiveStreaming::BroadcastStatusCallback( const FLiveStreamingStatus& Status )
 {
@@ -9,6 +9,7 @@
 
 class SWindow;
 class UCanvas;
+class FLocalLiveStreamingService;
 
 /**
  * Implements support for broadcasting gameplay to a live internet stream
@@ -22,6 +23,9 @@ public:
 	/** Default constructor */
 	FGameLiveStreaming();
 
+	/** Destructor */
+	virtual ~FGameLiveStreaming();
+
 	/** IModuleInterface overrides */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
@@ -36,6 +40,8 @@ public:
 	virtual void DrawSimpleWebCamVideo( UCanvas* Canvas ) override;
 	virtual class UTexture2D* GetWebCamTexture( bool& bIsImageFlippedHorizontally, bool& bIsImageFlippedVertically ) override;
 	virtual class ILiveStreamingService* GetLiveStreamingService() override;
+	virtual void SetVideoEncoderRegionsOfInterest( const TArray< FVideoEncoderRegionOfInterest >& Regions ) override;
+	virtual void RequestVideoKeyFrame() override;
 
 	/** FGCObject overrides */
 	virtual void AddReferencedObjects( FReferenceCollector& Collector ) override;
@@ -75,17 +81,19 @@ private:
 	/** The live streaming service we're using.  Only valid while broadcasting. */
 	class ILiveStreamingService* LiveStreamer;
 
-	/** Static: Readback textures for asynchronously reading the viewport frame buffer back to the CPU.  We ping-pong between the buffers to avoid stalls. */
-	FTexture2DRHIRef ReadbackTextures[2];
-	
-	/** Static: We ping pong between the textures in case the GPU is a frame behind (GSystemSettings.bAllowOneFrameThreadLag) */
-	int32 ReadbackTextureIndex;
+	/** Built-in local encoder backend, only created when enabled on the command line.  Takes precedence over live streaming plugins. */
+	TUniquePtr< FLocalLiveStreamingService > LocalStreamer;
+
+	/** Readback textures for asynchronously reading the viewport frame buffer back to the CPU (GameLiveStreaming.NumReadbackBuffers of them).
+	    Each frame is copied into the next texture in turn.  A texture is mapped two frames before its next copy, which leaves the GPU
+	    NumReadbackBuffers - 2 frames to finish the copy before the map and the render thread a full frame to map it before the game thread reads it. */
+	TArray< FTexture2DRHIRef > ReadbackTextures;
 
-	/** Static: Pointers to mapped system memory readback textures that game frames will be asynchronously copied to */
-	void* ReadbackBuffers[2];
+	/** Pointers to mapped system memory for each readback texture, or null while the texture isn't mapped.  Set and cleared on the render thread. */
+	TArray< void* > ReadbackBuffers;
 
-	/** The current buffer index.  We bounce between them to avoid stalls. */
-	int32 ReadbackBufferIndex;
+	/** Number of frames we've started copying since broadcasting started.  Only accessed on the game thread. */
+	uint32 ReadbackFrameIndex;
 
 	/** True if the user prefers to flip the web camera image horizontally */
 	bool bMirrorWebCamImage;
@@ -0,0 +1,584 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#include "LocalLiveStreamingService.h"
+#include "HAL/FileManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ScopeLock.h"
+#include "Features/IModularFeatures.h"
+#include "Serialization/MemoryWriter.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+#include "IPAddress.h"
+#include "YUVImage.h"
+
+DEFINE_LOG_CATEGORY_STATIC( LogLocalLiveStreaming, Log, All );
+
+#define LOCTEXT_NAMESPACE "LocalLiveStreaming"
+
+namespace LocalLiveStreaming
+{
+	/** Number of frame buffers.  One is being encoded while the next ones wait, anything beyond that is dropped. */
+	static const int32 NumEncodeSlots = 3;
+
+	/** Stream header magic, 'UELS' */
+	static const uint32 StreamMagic = 0x534C4555;
+	static const uint32 StreamVersion = 1;
+
+	/** Packet flags */
+	static const uint8 PacketFlag_KeyFrame = 0x01;
+
+	static uint32 MakeFourCC( ANSICHAR A, ANSICHAR B, ANSICHAR C, ANSICHAR D )
+	{
+		return (uint32)A | ( (uint32)B << 8 ) | ( (uint32)C << 16 ) | ( (uint32)D << 24 );
+	}
+
+	/** Fallback used when no codec plugin is loaded: every frame is sent as uncompressed I420, which is only practical over a local socket */
+	class FRawVideoEncoder : public ILocalVideoEncoder
+	{
+	public:
+
+		virtual bool Initialize( const FVideoEncoderConfig& Config ) override
+		{
+			return true;
+		}
+
+		virtual uint32 GetCodecFourCC() const override
+		{
+			return MakeFourCC( 'I', '4', '2', '0' );
+		}
+
+		virtual bool Encode( const FVideoEncoderFrame& Frame, TArray< uint8 >& OutBitstream, bool& bOutKeyFrame ) override
+		{
+			OutBitstream.Append( Frame.Data, YUVImage::GetBufferSize( Frame.Width, Frame.Height ) );
+			bOutKeyFrame = true;
+			return true;
+		}
+	};
+
+	static TUniquePtr< ILocalVideoEncoder > CreateEncoder( FName EncoderName )
+	{
+		static const FName RawEncoderName( TEXT( "Raw" ) );
+		if( EncoderName != RawEncoderName )
+		{
+			TArray< ILocalVideoEncoderFactory* > Factories = IModularFeatures::Get().GetModularFeatureImplementations< ILocalVideoEncoderFactory >( ILocalVideoEncoderFactory::GetModularFeatureName() );
+			for( ILocalVideoEncoderFactory* Factory : Factories )
+			{
+				if( EncoderName == NAME_None || Factory->GetEncoderName() == EncoderName )
+				{
+					UE_LOG( LogLocalLiveStreaming, Log, TEXT( "Encoding with %s" ), *Factory->GetEncoderName().ToString() );
+					return Factory->CreateEncoder();
+				}
+			}
+
+			if( EncoderName != NAME_None )
+			{
+				UE_LOG( LogLocalLiveStreaming, Warning, TEXT( "Video encoder %s isn't available, sending uncompressed frames" ), *EncoderName.ToString() );
+			}
+		}
+
+		return MakeUnique< FRawVideoEncoder >();
+	}
+}
+
+
+/**
+ * Takes queued frames in order and runs them through the encoder, so encoding never holds up the game or render thread
+ */
+class FLocalLiveStreamingService::FEncodeThread : public FRunnable
+{
+public:
+
+	FEncodeThread( FLocalLiveStreamingService& InService )
+		: Service( InService )
+	{
+		WorkToDoEvent = FPlatformProcess::GetSynchEventFromPool();
+		bRunning = true;
+		Thread = FRunnableThread::Create( this, TEXT( "LocalLiveStreamingEncoder" ) );
+	}
+
+	virtual ~FEncodeThread()
+	{
+		Thread->Kill( true );
+		delete Thread;
+
+		FPlatformProcess::ReturnSynchEventToPool( WorkToDoEvent );
+	}
+
+	/** Wakes the thread up after a frame was queued */
+	void Wake()
+	{
+		WorkToDoEvent->Trigger();
+	}
+
+	virtual uint32 Run() override
+	{
+		TArray< uint8 > Bitstream;
+		uint32 LastFrameIndex = 0;
+		double LastTimestamp = 0.0;
+
+		for( ;; )
+		{
+			int32 SlotIndex = INDEX_NONE;
+			{
+				FScopeLock Lock( &Service.SlotsCritical );
+				if( Service.QueuedSlots.Num() )
+				{
+					SlotIndex = Service.QueuedSlots[ 0 ];
+					Service.QueuedSlots.RemoveAt( 0, 1, false );
+				}
+			}
+
+			if( SlotIndex == INDEX_NONE )
+			{
+				if( !bRunning )
+				{
+					break;
+				}
+				WorkToDoEvent->Wait( ~0 );
+				continue;
+			}
+
+			const FVideoEncoderFrame& Frame = Service.Slots[ SlotIndex ].Frame;
+			if( !Service.bFailed )
+			{
+				Bitstream.Reset();
+				bool bKeyFrame = false;
+				if( !Service.Encoder->Encode( Frame, Bitstream, bKeyFrame ) )
+				{
+					UE_LOG( LogLocalLiveStreaming, Error, TEXT( "Video encoder failed on frame %u, stopping the stream" ), Frame.FrameIndex );
+					Service.bFailed = true;
+				}
+				else if( Bitstream.Num() && !Service.WritePacket( Frame.FrameIndex, Frame.Timestamp, bKeyFrame, Bitstream ) )
+				{
+					UE_LOG( LogLocalLiveStreaming, Error, TEXT( "Couldn't write to %s, stopping the stream" ), *Service.StreamTarget );
+					Service.bFailed = true;
+				}
+			}
+			LastFrameIndex = Frame.FrameIndex;
+			LastTimestamp = Frame.Timestamp;
+
+			FScopeLock Lock( &Service.SlotsCritical );
+			Service.FreeSlots.Add( SlotIndex );
+		}
+
+		// Drain any frames the encoder held on to for lookahead
+		if( !Service.bFailed )
+		{
+			Bitstream.Reset();
+			Service.Encoder->Flush( Bitstream );
+			if( Bitstream.Num() )
+			{
+				Service.WritePacket( LastFrameIndex, LastTimestamp, false, Bitstream );
+			}
+		}
+
+		return 0;
+	}
+
+	virtual void Stop() override
+	{
+		bRunning = false;
+		WorkToDoEvent->Trigger();
+	}
+
+private:
+
+	/** The service we encode for */
+	FLocalLiveStreamingService& Service;
+
+	/** The thread itself */
+	FRunnableThread* Thread;
+
+	/** Triggered when a frame was queued */
+	FEvent* WorkToDoEvent;
+
+	/** Set to false when the thread should encode what's left and exit */
+	FThreadSafeBool bRunning;
+};
+
+
+FLocalLiveStreamingService::FLocalLiveStreamingService( const FString& InStreamTarget, FName InEncoderName )
+	: StreamTarget( InStreamTarget ),
+	  EncoderName( InEncoderName ),
+	  bIsBroadcasting( false ),
+	  Socket( nullptr ),
+	  FileWriter( nullptr ),
+	  bKeyFrameRequested( false ),
+	  NumPushedFrames( 0 ),
+	  BroadcastStartTime( 0.0 )
+{
+}
+
+
+FLocalLiveStreamingService::~FLocalLiveStreamingService()
+{
+	ShutdownStream();
+}
+
+
+ILiveStreamingService::FOnStatusChanged& FLocalLiveStreamingService::OnStatusChanged()
+{
+	return OnStatusChangedEvent;
+}
+
+
+void FLocalLiveStreamingService::StartBroadcasting( const FBroadcastConfig& Config )
+{
+	// Clean up after a previous stream that failed on the encoding thread
+	ShutdownStream();
+
+	BroadcastConfig = Config;
+	MakeValidVideoBufferResolution( BroadcastConfig.VideoBufferWidth, BroadcastConfig.VideoBufferHeight );
+
+	if( BroadcastConfig.PixelFormat != FBroadcastConfig::EBroadcastPixelFormat::B8G8R8A8 )
+	{
+		SendStatus( FLiveStreamingStatus::EStatusType::Failure, LOCTEXT( "UnsupportedPixelFormat", "Local live streaming only supports B8G8R8A8 frames" ) );
+		return;
+	}
+
+	FVideoEncoderConfig EncoderConfig;
+	EncoderConfig.Width = BroadcastConfig.VideoBufferWidth;
+	EncoderConfig.Height = BroadcastConfig.VideoBufferHeight;
+	EncoderConfig.FramesPerSecond = BroadcastConfig.FramesPerSecond;
+	FParse::Value( FCommandLine::Get(), TEXT( "-LocalLiveStreamingBitRate=" ), EncoderConfig.BitRateKbps );
+	FParse::Value( FCommandLine::Get(), TEXT( "-LocalLiveStreamingQP=" ), EncoderConfig.BaseQP );
+	EncoderConfig.KeyFrameInterval = FMath::Max( BroadcastConfig.FramesPerSecond * 4, 1 );
+
+	Encoder = LocalLiveStreaming::CreateEncoder( EncoderName );
+	if( !Encoder->Initialize( EncoderConfig ) )
+	{
+		Encoder.Reset();
+		SendStatus( FLiveStreamingStatus::EStatusType::Failure, LOCTEXT( "EncoderFailed", "Couldn't initialize the video encoder" ) );
+		return;
+	}
+
+	if( !OpenStream() )
+	{
+		Encoder.Reset();
+		SendStatus( FLiveStreamingStatus::EStatusType::Failure, FText::Format( LOCTEXT( "StreamFailed", "Couldn't open {0}" ), FText::FromString( StreamTarget ) ) );
+		return;
+	}
+
+	// Stream header
+	{
+		TArray< uint8 > Header;
+		FMemoryWriter Writer( Header );
+
+		uint32 Magic = LocalLiveStreaming::StreamMagic;
+		uint32 Version = LocalLiveStreaming::StreamVersion;
+		uint32 FourCC = Encoder->GetCodecFourCC();
+		uint32 Width = BroadcastConfig.VideoBufferWidth;
+		uint32 Height = BroadcastConfig.VideoBufferHeight;
+		uint32 FramesPerSecond = BroadcastConfig.FramesPerSecond;
+		Writer << Magic << Version << FourCC << Width << Height << FramesPerSecond;
+
+		WriteToStream( Header.GetData(), Header.Num() );
+	}
+
+	const int32 FrameSize = YUVImage::GetBufferSize( BroadcastConfig.VideoBufferWidth, BroadcastConfig.VideoBufferHeight );
+	Slots.SetNum( LocalLiveStreaming::NumEncodeSlots );
+	FreeSlots.Reset();
+	QueuedSlots.Reset();
+	for( int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex )
+	{
+		Slots[ SlotIndex ].Planes.SetNumUninitialized( FrameSize );
+		FreeSlots.Add( SlotIndex );
+	}
+
+	NumPushedFrames = 0;
+	NumDroppedFrames.Reset();
+	bKeyFrameRequested = true;
+	bFailed = false;
+	BroadcastStartTime = FPlatformTime::Seconds();
+
+	EncodeThread.Reset( new FEncodeThread( *this ) );
+	bIsBroadcasting = true;
+
+	UE_LOG( LogLocalLiveStreaming, Log, TEXT( "Streaming %dx%d at %d fps to %s" ), BroadcastConfig.VideoBufferWidth, BroadcastConfig.VideoBufferHeight, BroadcastConfig.FramesPerSecond, *StreamTarget );
+	SendStatus( FLiveStreamingStatus::EStatusType::BroadcastStarted, FText::Format( LOCTEXT( "BroadcastStarted", "Streaming to {0}" ), FText::FromString( StreamTarget ) ) );
+}
+
+
+void FLocalLiveStreamingService::StopBroadcasting()
+{
+	if( bIsBroadcasting )
+	{
+		ShutdownStream();
+		SendStatus( FLiveStreamingStatus::EStatusType::BroadcastStopped, LOCTEXT( "BroadcastStopped", "Stopped streaming" ) );
+	}
+}
+
+
+bool FLocalLiveStreamingService::IsBroadcasting() const
+{
+	// A failed stream reports as stopped, so the game stops pushing frames; it is cleaned up when broadcasting starts again
+	return bIsBroadcasting && !bFailed;
+}
+
+
+bool FLocalLiveStreamingService::IsReadyForVideoFrames() const
+{
+	return IsBroadcasting();
+}
+
+
+void FLocalLiveStreamingService::MakeValidVideoBufferResolution( int& VideoBufferWidth, int& VideoBufferHeight ) const
+{
+	// Chroma is subsampled 2x2, so encoders want even sizes
+	VideoBufferWidth = FMath::Max( VideoBufferWidth & ~1, 2 );
+	VideoBufferHeight = FMath::Max( VideoBufferHeight & ~1, 2 );
+}
+
+
+void FLocalLiveStreamingService::QueryBroadcastConfig( FBroadcastConfig& OutBroadcastConfig ) const
+{
+	OutBroadcastConfig = BroadcastConfig;
+}
+
+
+void FLocalLiveStreamingService::PushVideoFrame( const FColor* VideoFrameBuffer )
+{
+	const uint32 FrameIndex = NumPushedFrames++;
+
+	int32 SlotIndex = INDEX_NONE;
+	{
+		FScopeLock Lock( &SlotsCritical );
+		if( FreeSlots.Num() )
+		{
+			SlotIndex = FreeSlots.Pop( false );
+		}
+	}
+
+	if( SlotIndex == INDEX_NONE )
+	{
+		// The encoder is behind.  Dropping the frame keeps latency down, and the readback buffer is released right away.
+		NumDroppedFrames.Increment();
+		return;
+	}
+
+	FEncodeSlot& Slot = Slots[ SlotIndex ];
+	YUVImage::ConvertBGRA8( VideoFrameBuffer, BroadcastConfig.VideoBufferWidth, BroadcastConfig.VideoBufferHeight, EYUVFormat::I420, Slot.Planes.GetData() );
+
+	Slot.Frame.Data = Slot.Planes.GetData();
+	Slot.Frame.Width = BroadcastConfig.VideoBufferWidth;
+	Slot.Frame.Height = BroadcastConfig.VideoBufferHeight;
+	Slot.Frame.FrameIndex = FrameIndex;
+	Slot.Frame.Timestamp = FPlatformTime::Seconds() - BroadcastStartTime;
+	{
+		FScopeLock Lock( &HintsCritical );
+		Slot.Frame.RegionsOfInterest = RegionsOfInterest;
+		Slot.Frame.bForceKeyFrame = bKeyFrameRequested;
+		bKeyFrameRequested = false;
+	}
+
+	{
+		FScopeLock Lock( &SlotsCritical );
+		QueuedSlots.Add( SlotIndex );
+	}
+	EncodeThread->Wake();
+}
+
+
+void FLocalLiveStreamingService::StartWebCam( const FWebCamConfig& Config )
+{
+	// Web cameras aren't supported by the local backend
+}
+
+
+void FLocalLiveStreamingService::StopWebCam()
+{
+}
+
+
+bool FLocalLiveStreamingService::IsWebCamEnabled() const
+{
+	return false;
+}
+
+
+UTexture2D* FLocalLiveStreamingService::GetWebCamTexture( bool& bIsImageFlippedHorizontally, bool& bIsImageFlippedVertically )
+{
+	bIsImageFlippedHorizontally = false;
+	bIsImageFlippedVertically = false;
+	return nullptr;
+}
+
+
+ILiveStreamingService::FOnChatMessage& FLocalLiveStreamingService::OnChatMessage()
+{
+	return OnChatMessageEvent;
+}
+
+
+void FLocalLiveStreamingService::ConnectToChat()
+{
+	// Chat isn't supported by the local backend
+}
+
+
+void FLocalLiveStreamingService::DisconnectFromChat()
+{
+}
+
+
+bool FLocalLiveStreamingService::IsChatEnabled() const
+{
+	return false;
+}
+
+
+void FLocalLiveStreamingService::SendChatMessage( const FString& ChatMessage )
+{
+}
+
+
+void FLocalLiveStreamingService::QueryLiveStreams( const FString& GameName, FQueryLiveStreamsCallback CompletionCallback )
+{
+	// There is no directory of local streams
+	CompletionCallback.ExecuteIfBound( TArray< FLiveStreamInfo >(), false );
+}
+
+
+void FLocalLiveStreamingService::SetRegionsOfInterest( const TArray< FVideoEncoderRegionOfInterest >& Regions )
+{
+	FScopeLock Lock( &HintsCritical );
+	RegionsOfInterest = Regions;
+}
+
+
+void FLocalLiveStreamingService::RequestKeyFrame()
+{
+	FScopeLock Lock( &HintsCritical );
+	bKeyFrameRequested = true;
+}
+
+
+bool FLocalLiveStreamingService::OpenStream()
+{
+	if( StreamTarget.StartsWith( TEXT( "tcp:" ) ) )
+	{
+		FString Host, Port;
+		if( !StreamTarget.Mid( 4 ).Split( TEXT( ":" ), &Host, &Port, ESearchCase::CaseSensitive, ESearchDir::FromEnd ) )
+		{
+			UE_LOG( LogLocalLiveStreaming, Error, TEXT( "Expected tcp:<host>:<port>, got %s" ), *StreamTarget );
+			return false;
+		}
+
+		ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM );
+		TSharedRef< FInternetAddr > Address = SocketSubsystem->CreateInternetAddr();
+		bool bIsValid = false;
+		Address->SetIp( *Host, bIsValid );
+		Address->SetPort( FCString::Atoi( *Port ) );
+		if( !bIsValid )
+		{
+			UE_LOG( LogLocalLiveStreaming, Error, TEXT( "Invalid address %s" ), *Host );
+			return false;
+		}
+
+		Socket = SocketSubsystem->CreateSocket( NAME_Stream, TEXT( "LocalLiveStreaming" ) );
+		if( Socket == nullptr || !Socket->Connect( *Address ) )
+		{
+			UE_LOG( LogLocalLiveStreaming, Error, TEXT( "Couldn't connect to %s" ), *StreamTarget );
+			if( Socket != nullptr )
+			{
+				SocketSubsystem->DestroySocket( Socket );
+				Socket = nullptr;
+			}
+			return false;
+		}
+
+		// Frames are large, let the stack batch them instead of waiting on acks for every segment
+		int32 NewSize = 0;
+		Socket->SetSendBufferSize( 4 * 1024 * 1024, NewSize );
+		return true;
+	}
+
+	FileWriter = IFileManager::Get().CreateFileWriter( *StreamTarget );
+	return FileWriter != nullptr;
+}
+
+
+bool FLocalLiveStreamingService::WriteToStream( const uint8* Data, int32 Size )
+{
+	if( Socket != nullptr )
+	{
+		while( Size > 0 )
+		{
+			int32 BytesSent = 0;
+			if( !Socket->Send( Data, Size, BytesSent ) )
+			{
+				return false;
+			}
+			Data += BytesSent;
+			Size -= BytesSent;
+		}
+		return true;
+	}
+
+	if( FileWriter != nullptr )
+	{
+		FileWriter->Serialize( (void*)Data, Size );
+		return !FileWriter->IsError();
+	}
+
+	return false;
+}
+
+
+bool FLocalLiveStreamingService::WritePacket( uint32 FrameIndex, double Timestamp, bool bKeyFrame, const TArray< uint8 >& Bitstream )
+{
+	TArray< uint8 > Header;
+	FMemoryWriter Writer( Header );
+
+	uint32 PayloadSize = Bitstream.Num();
+	uint64 TimestampMicroseconds = (uint64)( Timestamp * 1000000.0 );
+	uint8 Flags = bKeyFrame ? LocalLiveStreaming::PacketFlag_KeyFrame : 0;
+	Writer << PayloadSize << FrameIndex << TimestampMicroseconds << Flags;
+
+	return WriteToStream( Header.GetData(), Header.Num() ) && WriteToStream( Bitstream.GetData(), Bitstream.Num() );
+}
+
+
+void FLocalLiveStreamingService::ShutdownStream()
+{
+	// Finishes encoding whatever was queued first
+	EncodeThread.Reset();
+	Encoder.Reset();
+
+	if( Socket != nullptr )
+	{
+		Socket->Close();
+		ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM )->DestroySocket( Socket );
+		Socket = nullptr;
+	}
+
+	if( FileWriter != nullptr )
+	{
+		FileWriter->Close();
+		delete FileWriter;
+		FileWriter = nullptr;
+	}
+
+	if( bIsBroadcasting )
+	{
+		UE_LOG( LogLocalLiveStreaming, Log, TEXT( "Stream ended after %u frames, %d dropped because the encoder was behind" ), NumPushedFrames, NumDroppedFrames.GetValue() );
+		bIsBroadcasting = false;
+	}
+
+	Slots.Empty();
+	FreeSlots.Empty();
+	QueuedSlots.Empty();
+}
+
+
+void FLocalLiveStreamingService::SendStatus( FLiveStreamingStatus::EStatusType StatusType, const FText& Description )
+{
+	FLiveStreamingStatus Status;
+	Status.StatusType = StatusType;
+	Status.CustomStatusDescription = Description;
+	OnStatusChangedEvent.Broadcast( Status );
+}
+
+
+#undef LOCTEXT_NAMESPACE
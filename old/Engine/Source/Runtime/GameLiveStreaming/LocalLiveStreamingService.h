@@ -0,0 +1,146 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Features/ILiveStreamingService.h"
+#include "ILocalVideoEncoder.h"
+
+class FArchive;
+class FSocket;
+
+/**
+ * First-party live streaming backend for cloud gaming: frames are converted to YUV, encoded in-process by an
+ * ILocalVideoEncoder and written out as packets to a local TCP socket or a file, for a streaming server to pick up.
+ *
+ * Enabled with -LocalLiveStreaming=<tcp:host:port or file path>, the encoder is picked with -LocalLiveStreamingEncoder=<Name>
+ * (the first registered ILocalVideoEncoderFactory by default, or uncompressed I420 when no codec plugin is loaded).
+ *
+ * Stream layout, all values little endian:
+ *		header:	'UELS' magic, uint32 version, uint32 codec FourCC, uint32 width, uint32 height, uint32 frames per second
+ *		packet:	uint32 payload size, uint32 frame index, uint64 timestamp in microseconds, uint8 flags (1 = key frame), payload
+ */
+class FLocalLiveStreamingService
+	: public ILiveStreamingService
+{
+
+public:
+
+	/**
+	 * Creates the backend.  Nothing is opened until broadcasting starts.
+	 *
+	 * @param	InStreamTarget	tcp:<host>:<port> to connect to, otherwise a file to write
+	 * @param	InEncoderName	Encoder factory to use, or NAME_None for the default
+	 */
+	FLocalLiveStreamingService( const FString& InStreamTarget, FName InEncoderName );
+
+	/** Destructor */
+	virtual ~FLocalLiveStreamingService();
+
+	/** ILiveStreamingService overrides */
+	virtual FOnStatusChanged& OnStatusChanged() override;
+	virtual void StartBroadcasting( const FBroadcastConfig& Config ) override;
+	virtual void StopBroadcasting() override;
+	virtual bool IsBroadcasting() const override;
+	virtual bool IsReadyForVideoFrames() const override;
+	virtual void MakeValidVideoBufferResolution( int& VideoBufferWidth, int& VideoBufferHeight ) const override;
+	virtual void QueryBroadcastConfig( FBroadcastConfig& OutBroadcastConfig ) const override;
+	virtual void PushVideoFrame( const FColor* VideoFrameBuffer ) override;
+	virtual void StartWebCam( const FWebCamConfig& Config ) override;
+	virtual void StopWebCam() override;
+	virtual bool IsWebCamEnabled() const override;
+	virtual class UTexture2D* GetWebCamTexture( bool& bIsImageFlippedHorizontally, bool& bIsImageFlippedVertically ) override;
+	virtual FOnChatMessage& OnChatMessage() override;
+	virtual void ConnectToChat() override;
+	virtual void DisconnectFromChat() override;
+	virtual bool IsChatEnabled() const override;
+	virtual void SendChatMessage( const FString& ChatMessage ) override;
+	virtual void QueryLiveStreams( const FString& GameName, FQueryLiveStreamsCallback CompletionCallback ) override;
+
+	/** Sets the quantizer hints passed to the encoder with every frame pushed from now on */
+	void SetRegionsOfInterest( const TArray< FVideoEncoderRegionOfInterest >& Regions );
+
+	/** Makes the encoder start a key frame at the next pushed frame */
+	void RequestKeyFrame();
+
+
+protected:
+
+	/** Encoding thread */
+	class FEncodeThread;
+
+	/** Opens the socket or file the packets go to */
+	bool OpenStream();
+
+	/** Writes bytes to the socket or file, called on the encoding thread once broadcasting has started */
+	bool WriteToStream( const uint8* Data, int32 Size );
+
+	/** Writes one encoded frame as a packet */
+	bool WritePacket( uint32 FrameIndex, double Timestamp, bool bKeyFrame, const TArray< uint8 >& Bitstream );
+
+	/** Stops the encoding thread and closes the stream, also used to clean up after a stream that failed */
+	void ShutdownStream();
+
+	/** Broadcasts a status change */
+	void SendStatus( FLiveStreamingStatus::EStatusType StatusType, const FText& Description );
+
+
+private:
+
+	/** A frame buffer that is either free, waiting to be encoded or being encoded */
+	struct FEncodeSlot
+	{
+		TArray< uint8 > Planes;
+		FVideoEncoderFrame Frame;
+	};
+
+	/** Where the packets go */
+	FString StreamTarget;
+
+	/** Which encoder factory to use */
+	FName EncoderName;
+
+	/** The current broadcast's settings */
+	FBroadcastConfig BroadcastConfig;
+
+	/** Whether we're currently broadcasting */
+	bool bIsBroadcasting;
+
+	/** Set by the encoding thread when the encoder or the stream failed */
+	FThreadSafeBool bFailed;
+
+	/** The encoder for the current broadcast */
+	TUniquePtr< ILocalVideoEncoder > Encoder;
+
+	/** The encoding thread for the current broadcast */
+	TUniquePtr< FEncodeThread > EncodeThread;
+
+	/** Stream destination, one of these is valid while broadcasting */
+	FSocket* Socket;
+	FArchive* FileWriter;
+
+	/** Frame buffers, a fixed set so a slow encoder drops frames instead of queueing them up */
+	TArray< FEncodeSlot > Slots;
+
+	/** Slot indices that are free, and queued for encoding in order */
+	FCriticalSection SlotsCritical;
+	TArray< int32 > FreeSlots;
+	TArray< int32 > QueuedSlots;
+
+	/** Quantizer hints and key frame request for the next pushed frame */
+	FCriticalSection HintsCritical;
+	TArray< FVideoEncoderRegionOfInterest > RegionsOfInterest;
+	bool bKeyFrameRequested;
+
+	/** Frames pushed since the broadcast started, and how many of those were dropped because the encoder was behind */
+	uint32 NumPushedFrames;
+	FThreadSafeCounter NumDroppedFrames;
+
+	/** When the broadcast started, in FPlatformTime::Seconds() */
+	double BroadcastStartTime;
+
+	/** Delegates for status changes and chat messages */
+	FOnStatusChanged OnStatusChangedEvent;
+	FOnChatMessage OnChatMessageEvent;
+};
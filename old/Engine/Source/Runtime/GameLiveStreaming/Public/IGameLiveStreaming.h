@@ -6,6 +6,7 @@
 #include "Modules/ModuleManager.h"
 
 class UCanvas;
+struct FVideoEncoderRegionOfInterest;
 
 /**
  * Web camera settings for game broadcasting
@@ -159,6 +160,18 @@ public:
 	 */
 	virtual class ILiveStreamingService* GetLiveStreamingService() = 0;
 
+	/**
+	 * Sets regions of the broadcast video the encoder should spend more or fewer bits on, such as the crosshair or
+	 * static HUD frames.  The hints apply to every frame from now on, pass an empty array to clear them.  Only the
+	 * local encoder backend (-LocalLiveStreaming) uses these.
+	 *
+	 * @param	Regions		Rectangles in broadcast video pixels, with a quantizer offset for each
+	 */
+	virtual void SetVideoEncoderRegionsOfInterest( const TArray< FVideoEncoderRegionOfInterest >& Regions ) = 0;
+
+	/** Asks the local encoder backend to start a key frame with the next frame, such as when a new viewer connects */
+	virtual void RequestVideoKeyFrame() = 0;
+
 
 public:
 
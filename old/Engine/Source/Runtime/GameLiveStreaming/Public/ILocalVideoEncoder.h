@@ -0,0 +1,172 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Features/IModularFeature.h"
+
+/**
+ * A rectangle of the broadcast video the encoder should spend more bits on (negative QPDelta), such as
+ * the crosshair or text, or fewer bits on (positive QPDelta), such as a static minimap frame
+ */
+struct FVideoEncoderRegionOfInterest
+{
+	/** Area in broadcast video pixels.  Encoders round it out to whole macroblocks. */
+	FIntRect Rect;
+
+	/** Offset from the frame's quantizer for the blocks in Rect */
+	int32 QPDelta;
+
+
+	/** Default constructor */
+	FVideoEncoderRegionOfInterest()
+		: Rect(),
+		  QPDelta( 0 )
+	{
+	}
+
+	FVideoEncoderRegionOfInterest( const FIntRect& InRect, int32 InQPDelta )
+		: Rect( InRect ),
+		  QPDelta( InQPDelta )
+	{
+	}
+};
+
+
+/**
+ * Settings a local video encoder is created with
+ */
+struct FVideoEncoderConfig
+{
+	/** Frame size in pixels, always even */
+	int32 Width;
+	int32 Height;
+
+	/** Expected frame rate, for rate control */
+	int32 FramesPerSecond;
+
+	/** Target bit rate in kilobits per second.  Zero to encode at a constant quantizer of BaseQP. */
+	int32 BitRateKbps;
+
+	/** Quantizer used when there is no bit rate, and the base that region of interest deltas apply to */
+	int32 BaseQP;
+
+	/** Maximum number of frames between key frames */
+	int32 KeyFrameInterval;
+
+
+	/** Default constructor */
+	FVideoEncoderConfig()
+		: Width( 1280 ),
+		  Height( 720 ),
+		  FramesPerSecond( 30 ),
+		  BitRateKbps( 8000 ),
+		  BaseQP( 26 ),
+		  KeyFrameInterval( 120 )
+	{
+	}
+};
+
+
+/**
+ * One frame to encode.  Pixels are I420: the Y plane, then the U and V planes at half resolution in each direction.
+ */
+struct FVideoEncoderFrame
+{
+	/** The planes, Width * Height * 3 / 2 bytes.  Only valid for the duration of ILocalVideoEncoder::Encode(). */
+	const uint8* Data;
+
+	/** Frame size in pixels, matching the encoder config */
+	int32 Width;
+	int32 Height;
+
+	/** Index of the frame since the broadcast started, counting frames that were dropped before encoding */
+	uint32 FrameIndex;
+
+	/** Capture time in seconds since the broadcast started */
+	double Timestamp;
+
+	/** True when the encoder should start a new key frame here, such as when a new viewer joined */
+	bool bForceKeyFrame;
+
+	/** Quantizer hints for this frame */
+	TArray< FVideoEncoderRegionOfInterest > RegionsOfInterest;
+
+
+	/** Default constructor */
+	FVideoEncoderFrame()
+		: Data( nullptr ),
+		  Width( 0 ),
+		  Height( 0 ),
+		  FrameIndex( 0 ),
+		  Timestamp( 0.0 ),
+		  bForceKeyFrame( false )
+	{
+	}
+};
+
+
+/**
+ * Thin interface to an in-process video encoder used by the local live streaming backend.  Encoders are only
+ * ever called from the encoding thread, one frame at a time, so they don't need to be thread safe.
+ */
+class ILocalVideoEncoder
+{
+public:
+
+	virtual ~ILocalVideoEncoder() {}
+
+	/**
+	 * Sets up the encoder for a new stream
+	 *
+	 * @param	Config	Frame size, rate and rate control settings
+	 *
+	 * @return	True if the encoder is ready to take frames
+	 */
+	virtual bool Initialize( const FVideoEncoderConfig& Config ) = 0;
+
+	/**
+	 * Four character code of the bitstream this encoder produces, written into the stream header so the reader knows
+	 * how to decode it, such as 'H264'
+	 */
+	virtual uint32 GetCodecFourCC() const = 0;
+
+	/**
+	 * Encodes a frame
+	 *
+	 * @param	Frame			The frame to encode
+	 * @param	OutBitstream	(Out) Receives the encoded data.  May be left empty by encoders that buffer frames for lookahead.
+	 * @param	bOutKeyFrame	(Out) True if the data starts a key frame
+	 *
+	 * @return	False if the encoder failed and the stream should be stopped
+	 */
+	virtual bool Encode( const FVideoEncoderFrame& Frame, TArray< uint8 >& OutBitstream, bool& bOutKeyFrame ) = 0;
+
+	/**
+	 * Called when the stream ends, to drain any frames the encoder was holding on to
+	 *
+	 * @param	OutBitstream	(Out) Receives the remaining encoded data
+	 */
+	virtual void Flush( TArray< uint8 >& OutBitstream ) {}
+};
+
+
+/**
+ * Modular feature for plugins that wrap a video codec (x264, openh264, hardware encoders) to make it available
+ * to the local live streaming backend, which picks one by name with -LocalLiveStreamingEncoder=<Name>
+ */
+class ILocalVideoEncoderFactory : public IModularFeature
+{
+public:
+
+	static FName GetModularFeatureName()
+	{
+		static FName FeatureName = FName( TEXT( "LocalVideoEncoder" ) );
+		return FeatureName;
+	}
+
+	/** Name this encoder is picked by */
+	virtual FName GetEncoderName() const = 0;
+
+	/** Creates a new encoder instance for a stream */
+	virtual TUniquePtr< ILocalVideoEncoder > CreateEncoder() = 0;
+};
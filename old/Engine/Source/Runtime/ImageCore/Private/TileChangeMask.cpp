@@ -0,0 +1,124 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "TileChangeMask.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	#include <emmintrin.h>
+#endif
+
+
+/* Local helper functions
+ *****************************************************************************/
+
+namespace TileChangeMaskImpl
+{
+	/** Sum of absolute differences of the color channels of two pixels */
+	FORCEINLINE uint32 Difference(const FColor& A, const FColor& B)
+	{
+		return FMath::Abs(A.R - B.R) + FMath::Abs(A.G - B.G) + FMath::Abs(A.B - B.B);
+	}
+
+	/** Sum of absolute differences of a row of pixels */
+	static uint64 RowDifference(const FColor* Row0, const FColor* Row1, int32 Count)
+	{
+		uint64 Sum = 0;
+		int32 X = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		const __m128i ColorMask = _mm_set1_epi32(0x00FFFFFF);
+		__m128i Sums = _mm_setzero_si128();
+
+		// a 16 pixel tile row is four loads from each frame
+		for (; X + 4 <= Count; X += 4)
+		{
+			const __m128i A = _mm_and_si128(_mm_loadu_si128((const __m128i*)(Row0 + X)), ColorMask);
+			const __m128i B = _mm_and_si128(_mm_loadu_si128((const __m128i*)(Row1 + X)), ColorMask);
+			Sums = _mm_add_epi64(Sums, _mm_sad_epu8(A, B));
+		}
+
+		// _mm_sad_epu8 leaves one sum in each 64 bit half
+		Sum = (uint32)_mm_cvtsi128_si32(Sums) + (uint32)_mm_cvtsi128_si32(_mm_srli_si128(Sums, 8));
+#endif
+
+		for (; X < Count; X++)
+		{
+			Sum += Difference(Row0[X], Row1[X]);
+		}
+
+		return Sum;
+	}
+
+	/** Compares one row of tiles, returns the number of tiles that changed */
+	static int32 CompareTileRow(const FColor* Current, const FColor* Previous, int32 SizeX, int32 SizeY, int32 TileSize, uint32 Threshold, int32 TileY, uint8* OutTiles)
+	{
+		const int32 FirstY = TileY * TileSize;
+		const int32 LastY = FMath::Min(FirstY + TileSize, SizeY);
+		int32 NumChanged = 0;
+
+		for (int32 FirstX = 0, TileX = 0; FirstX < SizeX; FirstX += TileSize, TileX++)
+		{
+			const int32 Width = FMath::Min(TileSize, SizeX - FirstX);
+			uint64 Sum = 0;
+
+			// stop reading the tile as soon as it has changed enough
+			for (int32 Y = FirstY; Y < LastY && Sum <= Threshold; Y++)
+			{
+				const int32 Offset = Y * SizeX + FirstX;
+				Sum += RowDifference(Current + Offset, Previous + Offset, Width);
+			}
+
+			OutTiles[TileX] = Sum > Threshold ? 1 : 0;
+			NumChanged += OutTiles[TileX];
+		}
+
+		return NumChanged;
+	}
+}
+
+
+/* FTileChangeMask interface
+ *****************************************************************************/
+
+void FTileChangeMask::Compare(const FColor* Current, const FColor* Previous, int32 InSizeX, int32 InSizeY)
+{
+	Resize(InSizeX, InSizeY);
+
+	FThreadSafeCounter ChangedCounter;
+	const int32 LocalTileSize = TileSize;
+	const uint32 LocalThreshold = Threshold;
+	uint8* TileData = Tiles.GetData();
+	const int32 LocalNumTilesX = NumTilesX;
+
+	ParallelFor(NumTilesY, [&](int32 TileY)
+	{
+		const int32 NumChanged = TileChangeMaskImpl::CompareTileRow(Current, Previous, InSizeX, InSizeY, LocalTileSize, LocalThreshold, TileY, TileData + TileY * LocalNumTilesX);
+		ChangedCounter.Add(NumChanged);
+	});
+
+	NumChangedTiles = ChangedCounter.GetValue();
+}
+
+
+void FTileChangeMask::MarkAllChanged(int32 InSizeX, int32 InSizeY)
+{
+	Resize(InSizeX, InSizeY);
+
+	FMemory::Memset(Tiles.GetData(), 1, Tiles.Num());
+	NumChangedTiles = Tiles.Num();
+}
+
+
+void FTileChangeMask::Resize(int32 InSizeX, int32 InSizeY)
+{
+	check(TileSize > 0);
+
+	SizeX = InSizeX;
+	SizeY = InSizeY;
+	NumTilesX = FMath::DivideAndRoundUp(InSizeX, TileSize);
+	NumTilesY = FMath::DivideAndRoundUp(InSizeY, TileSize);
+
+	Tiles.SetNumUninitialized(NumTilesX * NumTilesY);
+	NumChangedTiles = 0;
+}
@@ -0,0 +1,212 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "YUVImage.h"
+#include "Async/ParallelFor.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	#include <emmintrin.h>
+#endif
+
+
+/* Local helper functions
+ *****************************************************************************/
+
+namespace YUVImageImpl
+{
+	/** BT.709 limited range coefficients, scaled by 256 */
+	enum
+	{
+		YR = 47, YG = 157, YB = 16,
+		UR = -26, UG = -86, UB = 112,
+		VR = 112, VG = -102, VB = -10,
+	};
+
+	/** Number of row pairs converted by each worker task */
+	static const int32 RowPairsPerTask = 16;
+
+	FORCEINLINE uint8 Luma(const FColor& Color)
+	{
+		return (uint8)(((YR * Color.R + YG * Color.G + YB * Color.B + 128) >> 8) + 16);
+	}
+
+	FORCEINLINE uint8 Average(uint8 A, uint8 B)
+	{
+		return (uint8)((A + B + 1) >> 1);
+	}
+
+	/** Averages a 2x2 block the same way the vector path does, so both paths produce identical output */
+	FORCEINLINE void Chroma(const FColor& P00, const FColor& P01, const FColor& P10, const FColor& P11, uint8& OutU, uint8& OutV)
+	{
+		const int32 R = Average(Average(P00.R, P10.R), Average(P01.R, P11.R));
+		const int32 G = Average(Average(P00.G, P10.G), Average(P01.G, P11.G));
+		const int32 B = Average(Average(P00.B, P10.B), Average(P01.B, P11.B));
+
+		OutU = (uint8)(((UR * R + UG * G + UB * B + 128) >> 8) + 128);
+		OutV = (uint8)(((VR * R + VG * G + VB * B + 128) >> 8) + 128);
+	}
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	/** Dot product of four BGRA pixels with a set of coefficients, returns four int32 */
+	FORCEINLINE __m128i DotBGRA4(__m128i Pixels, __m128i Coefficients)
+	{
+		const __m128i Zero = _mm_setzero_si128();
+		__m128i Lo = _mm_madd_epi16(_mm_unpacklo_epi8(Pixels, Zero), Coefficients);
+		__m128i Hi = _mm_madd_epi16(_mm_unpackhi_epi8(Pixels, Zero), Coefficients);
+
+		// each pixel is now B+G in one lane and R+A in the next, add them together into the even lanes
+		Lo = _mm_add_epi32(Lo, _mm_srli_epi64(Lo, 32));
+		Hi = _mm_add_epi32(Hi, _mm_srli_epi64(Hi, 32));
+		return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(Lo), _mm_castsi128_ps(Hi), _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+
+	/** Scales a dot product back down and adds the offset */
+	FORCEINLINE __m128i Normalize(__m128i Sum, __m128i Offset)
+	{
+		return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(Sum, _mm_set1_epi32(128)), 8), Offset);
+	}
+
+	/** Converts sixteen pixels of luma */
+	FORCEINLINE void Luma16(const FColor* Src, uint8* Dest)
+	{
+		const __m128i Coefficients = _mm_setr_epi16(YB, YG, YR, 0, YB, YG, YR, 0);
+		const __m128i Offset = _mm_set1_epi32(16);
+
+		const __m128i Y0 = Normalize(DotBGRA4(_mm_loadu_si128((const __m128i*)(Src + 0)), Coefficients), Offset);
+		const __m128i Y1 = Normalize(DotBGRA4(_mm_loadu_si128((const __m128i*)(Src + 4)), Coefficients), Offset);
+		const __m128i Y2 = Normalize(DotBGRA4(_mm_loadu_si128((const __m128i*)(Src + 8)), Coefficients), Offset);
+		const __m128i Y3 = Normalize(DotBGRA4(_mm_loadu_si128((const __m128i*)(Src + 12)), Coefficients), Offset);
+
+		_mm_storeu_si128((__m128i*)Dest, _mm_packus_epi16(_mm_packs_epi32(Y0, Y1), _mm_packs_epi32(Y2, Y3)));
+	}
+
+	/** Averages four pixels of two rows down to the two chroma blocks they cover, in pixels 0 and 2 */
+	FORCEINLINE __m128i AverageBlocks(const FColor* Row0, const FColor* Row1)
+	{
+		const __m128i Vertical = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)Row0), _mm_loadu_si128((const __m128i*)Row1));
+		return _mm_avg_epu8(Vertical, _mm_srli_epi64(Vertical, 32));
+	}
+
+	/** Converts eight pixels of two rows into four U and four V samples, returned as U0..U3 V0..V3 in the low eight bytes */
+	FORCEINLINE __m128i Chroma8(const FColor* Row0, const FColor* Row1)
+	{
+		const __m128i UCoefficients = _mm_setr_epi16(UB, UG, UR, 0, UB, UG, UR, 0);
+		const __m128i VCoefficients = _mm_setr_epi16(VB, VG, VR, 0, VB, VG, VR, 0);
+		const __m128i Offset = _mm_set1_epi32(128);
+
+		const __m128i Blocks01 = _mm_shuffle_epi32(AverageBlocks(Row0, Row1), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128i Blocks23 = _mm_shuffle_epi32(AverageBlocks(Row0 + 4, Row1 + 4), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128i Blocks = _mm_unpacklo_epi64(Blocks01, Blocks23);
+
+		const __m128i U = Normalize(DotBGRA4(Blocks, UCoefficients), Offset);
+		const __m128i V = Normalize(DotBGRA4(Blocks, VCoefficients), Offset);
+		const __m128i UV = _mm_packs_epi32(U, V);
+		return _mm_packus_epi16(UV, UV);
+	}
+#endif
+
+	/**
+	 * Converts two rows of pixels. Row1 is the same as Row0 and DestY1 is null for the last row of an odd height frame.
+	 * UVStride is 1 when U and V are separate planes and 2 when they are interleaved.
+	 */
+	static void ConvertRowPair(const FColor* Row0, const FColor* Row1, int32 SizeX, uint8* DestY0, uint8* DestY1, uint8* DestU, uint8* DestV, int32 UVStride)
+	{
+		int32 X = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		for (; X + 16 <= SizeX; X += 16)
+		{
+			Luma16(Row0 + X, DestY0 + X);
+			if (DestY1)
+			{
+				Luma16(Row1 + X, DestY1 + X);
+			}
+
+			for (int32 Half = 0; Half < 16; Half += 8)
+			{
+				const __m128i UV = Chroma8(Row0 + X + Half, Row1 + X + Half);
+				const int32 ChromaX = (X + Half) / 2;
+
+				if (UVStride == 1)
+				{
+					const int32 U = _mm_cvtsi128_si32(UV);
+					const int32 V = _mm_cvtsi128_si32(_mm_srli_si128(UV, 4));
+					FMemory::Memcpy(DestU + ChromaX, &U, 4);
+					FMemory::Memcpy(DestV + ChromaX, &V, 4);
+				}
+				else
+				{
+					_mm_storel_epi64((__m128i*)(DestU + ChromaX * 2), _mm_unpacklo_epi8(UV, _mm_srli_si128(UV, 4)));
+				}
+			}
+		}
+#endif
+
+		for (int32 Index = X; Index < SizeX; Index++)
+		{
+			DestY0[Index] = Luma(Row0[Index]);
+			if (DestY1)
+			{
+				DestY1[Index] = Luma(Row1[Index]);
+			}
+		}
+
+		for (; X < SizeX; X += 2)
+		{
+			const int32 X1 = FMath::Min(X + 1, SizeX - 1);
+			const int32 ChromaIndex = (X / 2) * UVStride;
+			Chroma(Row0[X], Row0[X1], Row1[X], Row1[X1], DestU[ChromaIndex], DestV[ChromaIndex]);
+		}
+	}
+}
+
+
+/* YUVImage interface
+ *****************************************************************************/
+
+int32 YUVImage::GetBufferSize(int32 SizeX, int32 SizeY)
+{
+	const int32 ChromaSize = ((SizeX + 1) / 2) * ((SizeY + 1) / 2);
+	return SizeX * SizeY + ChromaSize * 2;
+}
+
+
+void YUVImage::ConvertBGRA8Rows(const FColor* Src, int32 SizeX, int32 SizeY, EYUVFormat::Type Format, uint8* Dest, int32 FirstRowPair, int32 NumRowPairs)
+{
+	const int32 ChromaSizeX = (SizeX + 1) / 2;
+	const int32 ChromaSizeY = (SizeY + 1) / 2;
+
+	uint8* PlaneY = Dest;
+	uint8* PlaneU = PlaneY + SizeX * SizeY;
+	uint8* PlaneV = Format == EYUVFormat::NV12 ? PlaneU + 1 : PlaneU + ChromaSizeX * ChromaSizeY;
+	const int32 UVStride = Format == EYUVFormat::NV12 ? 2 : 1;
+
+	const int32 LastRowPair = FMath::Min(FirstRowPair + NumRowPairs, ChromaSizeY);
+	for (int32 RowPair = FirstRowPair; RowPair < LastRowPair; RowPair++)
+	{
+		const int32 Y0 = RowPair * 2;
+		const int32 Y1 = FMath::Min(Y0 + 1, SizeY - 1);
+		const int32 ChromaOffset = RowPair * ChromaSizeX * UVStride;
+
+		YUVImageImpl::ConvertRowPair(
+			Src + Y0 * SizeX,
+			Src + Y1 * SizeX,
+			SizeX,
+			PlaneY + Y0 * SizeX,
+			Y1 != Y0 ? PlaneY + Y1 * SizeX : nullptr,
+			PlaneU + ChromaOffset,
+			PlaneV + ChromaOffset,
+			UVStride);
+	}
+}
+
+
+void YUVImage::ConvertBGRA8(const FColor* Src, int32 SizeX, int32 SizeY, EYUVFormat::Type Format, uint8* Dest)
+{
+	const int32 NumRowPairs = (SizeY + 1) / 2;
+	const int32 NumTasks = FMath::DivideAndRoundUp(NumRowPairs, YUVImageImpl::RowPairsPerTask);
+
+	ParallelFor(NumTasks, [=](int32 TaskIndex)
+	{
+		ConvertBGRA8Rows(Src, SizeX, SizeY, Format, Dest, TaskIndex * YUVImageImpl::RowPairsPerTask, YUVImageImpl::RowPairsPerTask);
+	});
+}
@@ -0,0 +1,123 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+
+/* Dependencies
+ *****************************************************************************/
+
+#include "CoreMinimal.h"
+
+/* Types
+ *****************************************************************************/
+
+/**
+ * Per-tile record of which parts of a BGRA8 frame changed since the previous frame.
+ *
+ * A tile counts as changed when the sum of absolute differences of its color channels exceeds the
+ * threshold, so a threshold of zero flags any change at all. Alpha is ignored. Tiles on the right
+ * and bottom edges are cut short when the frame size is not a multiple of the tile size.
+ */
+struct FTileChangeMask
+{
+	/** Width and height of a tile in pixels. */
+	int32 TileSize;
+
+	/** Largest difference a tile may have and still count as unchanged. */
+	uint32 Threshold;
+
+	/** Size of the frame the mask was computed for. */
+	int32 SizeX;
+	int32 SizeY;
+
+	/** Number of tiles in each direction. Zero when no mask has been computed. */
+	int32 NumTilesX;
+	int32 NumTilesY;
+
+	/** One entry per tile, row by row, non-zero if the tile changed. */
+	TArray<uint8> Tiles;
+
+	/** The number of non-zero entries in Tiles. */
+	int32 NumChangedTiles;
+
+public:
+
+	/**
+	 * Creates and initializes a new, empty mask.
+	 *
+	 * @param InTileSize - The tile width and height in pixels.
+	 * @param InThreshold - Largest sum of absolute differences of an unchanged tile.
+	 */
+	FTileChangeMask(int32 InTileSize = 16, uint32 InThreshold = 0)
+		: TileSize(InTileSize)
+		, Threshold(InThreshold)
+		, SizeX(0)
+		, SizeY(0)
+		, NumTilesX(0)
+		, NumTilesY(0)
+		, NumChangedTiles(0)
+	{ }
+
+public:
+
+	/**
+	 * Compares two frames, splitting rows of tiles across task graph workers.
+	 *
+	 * @param Current - The new frame, InSizeX * InSizeY tightly packed.
+	 * @param Previous - The frame before it, with the same size.
+	 * @param InSizeX - The frame width.
+	 * @param InSizeY - The frame height.
+	 */
+	IMAGECORE_API void Compare(const FColor* Current, const FColor* Previous, int32 InSizeX, int32 InSizeY);
+
+	/**
+	 * Flags every tile as changed, for the first frame or after the frame size changed.
+	 *
+	 * @param InSizeX - The frame width.
+	 * @param InSizeY - The frame height.
+	 */
+	IMAGECORE_API void MarkAllChanged(int32 InSizeX, int32 InSizeY);
+
+	/**
+	 * Checks whether a mask has been computed.
+	 *
+	 * @return true if the mask covers a frame, false otherwise.
+	 */
+	bool IsValid() const
+	{
+		return Tiles.Num() > 0;
+	}
+
+	/**
+	 * Checks whether a tile changed.
+	 *
+	 * @param TileX - Column of the tile.
+	 * @param TileY - Row of the tile.
+	 * @return true if the tile changed, false otherwise.
+	 */
+	bool IsTileChanged(int32 TileX, int32 TileY) const
+	{
+		return Tiles[TileY * NumTilesX + TileX] != 0;
+	}
+
+	/**
+	 * Gets the pixels a tile covers, clipped to the frame.
+	 *
+	 * @param TileX - Column of the tile.
+	 * @param TileY - Row of the tile.
+	 * @return The tile rectangle.
+	 */
+	FIntRect GetTileRect(int32 TileX, int32 TileY) const
+	{
+		return FIntRect(
+			TileX * TileSize,
+			TileY * TileSize,
+			FMath::Min((TileX + 1) * TileSize, SizeX),
+			FMath::Min((TileY + 1) * TileSize, SizeY));
+	}
+
+private:
+
+	/** Sizes the tile array for a frame. */
+	void Resize(int32 InSizeX, int32 InSizeY);
+};
@@ -0,0 +1,71 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+
+/* Dependencies
+ *****************************************************************************/
+
+#include "CoreMinimal.h"
+
+/* Types
+ *****************************************************************************/
+
+namespace EYUVFormat
+{
+	/**
+	 * Enumerates supported 8 bit 4:2:0 layouts.
+	 */
+	enum Type
+	{
+		/** Y plane, then U plane, then V plane, each chroma plane a quarter of the Y plane. */
+		I420,
+
+		/** Y plane, then a single plane of interleaved U and V samples. */
+		NV12
+	};
+};
+
+
+/**
+ * Conversion of BGRA8 frames to 8 bit 4:2:0 YUV for video encoders and raw video files.
+ *
+ * Uses BT.709 limited range coefficients. Chroma is the average of each 2x2 block, which puts the
+ * samples at the block centres (what Y4M calls C420jpeg). Odd sizes round the chroma planes up.
+ */
+namespace YUVImage
+{
+	/**
+	 * Gets the number of bytes needed to hold a frame.
+	 *
+	 * @param SizeX - The frame width.
+	 * @param SizeY - The frame height.
+	 * @return Size of the Y plane plus both chroma planes.
+	 */
+	IMAGECORE_API int32 GetBufferSize(int32 SizeX, int32 SizeY);
+
+	/**
+	 * Converts a BGRA8 frame, splitting the rows across task graph workers.
+	 *
+	 * @param Src - The source pixels, SizeX * SizeY tightly packed. Alpha is ignored.
+	 * @param SizeX - The frame width.
+	 * @param SizeY - The frame height.
+	 * @param Format - The layout to write.
+	 * @param Dest - Destination buffer of at least GetBufferSize(SizeX, SizeY) bytes.
+	 */
+	IMAGECORE_API void ConvertBGRA8(const FColor* Src, int32 SizeX, int32 SizeY, EYUVFormat::Type Format, uint8* Dest);
+
+	/**
+	 * Converts part of a BGRA8 frame on the calling thread. Rows are converted in pairs since each
+	 * pair shares one row of chroma samples.
+	 *
+	 * @param Src - The source pixels of the whole frame.
+	 * @param SizeX - The frame width.
+	 * @param SizeY - The frame height.
+	 * @param Format - The layout to write.
+	 * @param Dest - Destination buffer for the whole frame.
+	 * @param FirstRowPair - Index of the first pair of rows to convert.
+	 * @param NumRowPairs - The number of row pairs to convert.
+	 */
+	IMAGECORE_API void ConvertBGRA8Rows(const FColor* Src, int32 SizeX, int32 SizeY, EYUVFormat::Type Format, uint8* Dest, int32 FirstRowPair, int32 NumRowPairs);
+}
@@ -0,0 +1,87 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "ImageEncodeHelpers.h"
+#include "Misc/ScopeLock.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	#include <emmintrin.h>
+#endif
+
+namespace ImageEncodeHelpers
+{
+	/** Released buffers, kept to a handful so a burst of large images doesn't pin memory forever */
+	static const int32 MaxPooledBuffers = 16;
+	static TArray<TArray<uint8>> GBufferPool;
+	static FCriticalSection GBufferPoolCritical;
+
+	void SwapRedBlue(const uint8* Src, uint8* Dest, int32 NumPixels)
+	{
+		int32 Index = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		const __m128i GreenAlphaMask = _mm_set1_epi32((int32)0xFF00FF00);
+		const __m128i LowByteMask = _mm_set1_epi32(0x000000FF);
+		for (; Index + 4 <= NumPixels; Index += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128((const __m128i*)(Src + Index * 4));
+			const __m128i GreenAlpha = _mm_and_si128(Pixels, GreenAlphaMask);
+			const __m128i FirstToThird = _mm_slli_epi32(_mm_and_si128(Pixels, LowByteMask), 16);
+			const __m128i ThirdToFirst = _mm_and_si128(_mm_srli_epi32(Pixels, 16), LowByteMask);
+			_mm_storeu_si128((__m128i*)(Dest + Index * 4), _mm_or_si128(GreenAlpha, _mm_or_si128(FirstToThird, ThirdToFirst)));
+		}
+#endif
+
+		for (; Index < NumPixels; Index++)
+		{
+			const uint8* Pixel = Src + Index * 4;
+			uint8* DestPixel = Dest + Index * 4;
+			const uint8 First = Pixel[0];
+			DestPixel[0] = Pixel[2];
+			DestPixel[1] = Pixel[1];
+			DestPixel[2] = First;
+			DestPixel[3] = Pixel[3];
+		}
+	}
+
+	void AcquireBuffer(TArray<uint8>& OutBuffer, int32 MinSize)
+	{
+		{
+			FScopeLock Lock(&GBufferPoolCritical);
+
+			// prefer the smallest pooled buffer that is big enough
+			int32 BestIndex = INDEX_NONE;
+			for (int32 Index = 0; Index < GBufferPool.Num(); Index++)
+			{
+				const int32 Max = GBufferPool[Index].Max();
+				if (Max >= MinSize && (BestIndex == INDEX_NONE || Max < GBufferPool[BestIndex].Max()))
+				{
+					BestIndex = Index;
+				}
+			}
+			if (BestIndex == INDEX_NONE && GBufferPool.Num() > 0)
+			{
+				BestIndex = GBufferPool.Num() - 1;
+			}
+			if (BestIndex != INDEX_NONE)
+			{
+				OutBuffer = MoveTemp(GBufferPool[BestIndex]);
+				GBufferPool.RemoveAtSwap(BestIndex, 1, false);
+			}
+		}
+
+		OutBuffer.SetNumUninitialized(MinSize, false);
+	}
+
+	void ReleaseBuffer(TArray<uint8>& Buffer)
+	{
+		TArray<uint8> Released = MoveTemp(Buffer);
+		if (Released.Max() > 0)
+		{
+			FScopeLock Lock(&GBufferPoolCritical);
+			if (GBufferPool.Num() < MaxPooledBuffers)
+			{
+				GBufferPool.Add(MoveTemp(Released));
+			}
+		}
+	}
+}
@@ -0,0 +1,23 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace ImageEncodeHelpers
+{
+	/**
+	 * Swaps the R and B channels of 8 bit four channel pixels, BGRA <-> RGBA, four pixels at a time where SSE2 is available.
+	 * Src and Dest may be the same.
+	 */
+	void SwapRedBlue(const uint8* Src, uint8* Dest, int32 NumPixels);
+
+	/**
+	 * Grabs a scratch buffer of at least MinSize bytes, reusing one that was released earlier if possible,
+	 * so encoding a stream of frames doesn't keep reallocating megabyte sized buffers.
+	 */
+	void AcquireBuffer(TArray<uint8>& OutBuffer, int32 MinSize);
+
+	/** Gives a buffer from AcquireBuffer back to the pool, leaving OutBuffer empty. */
+	void ReleaseBuffer(TArray<uint8>& Buffer);
+}
@@ -2,6 +2,8 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
 #include "Interfaces/IImageWrapperModule.h"
 #include "JpegImageWrapper.h"
 #include "PngImageWrapper.h"
@@ -126,6 +128,17 @@ public:
 		return Format;
 	}
 
+	virtual void CompressImages( const TArray<IImageWrapperPtr>& ImageWrappers, int32 Quality ) override
+	{
+		ParallelFor(ImageWrappers.Num(), [&](int32 Index)
+		{
+			if (ImageWrappers[Index].IsValid())
+			{
+				ImageWrappers[Index]->GetCompressed(Quality);
+			}
+		});
+	}
+
 public:
 
 	// IModuleInterface interface
@@ -136,3 +149,101 @@ public:
 
 
 IMPLEMENT_MODULE(FImageWrapperModule, ImageWrapper);
+
+
+/* Benchmark
+ *****************************************************************************/
+
+namespace ImageWrapperBenchmark
+{
+	/** A BGRA frame with smooth gradients, flat areas and some noise, roughly what a game capture compresses like */
+	static void MakeTestImage(int32 Width, int32 Height, TArray<uint8>& OutPixels)
+	{
+		OutPixels.SetNumUninitialized(Width * Height * 4);
+		uint32 Random = 0x12345678;
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			for (int32 X = 0; X < Width; X++)
+			{
+				Random = Random * 1664525 + 1013904223;
+				const bool bFlat = ((X / 64) + (Y / 64)) % 3 == 0;
+				uint8* Pixel = &OutPixels[(Y * Width + X) * 4];
+				Pixel[0] = bFlat ? 40 : uint8(X * 255 / Width + (Random >> 29));
+				Pixel[1] = bFlat ? 90 : uint8(Y * 255 / Height + (Random >> 30));
+				Pixel[2] = bFlat ? 160 : uint8((X + Y) >> 2);
+				Pixel[3] = 255;
+			}
+		}
+	}
+
+	/** Compresses the image a few times and returns the best time in seconds */
+	static double TimeCompress(IImageWrapperModule& Module, EImageFormat::Type Format, const TArray<uint8>& Pixels, int32 Width, int32 Height, int32& OutSize)
+	{
+		double BestTime = MAX_dbl;
+		for (int32 Run = 0; Run < 3; Run++)
+		{
+			IImageWrapperPtr Wrapper = Module.CreateImageWrapper(Format);
+			Wrapper->SetRaw(Pixels.GetData(), Pixels.Num(), Width, Height, ERGBFormat::BGRA, 8);
+
+			const double StartTime = FPlatformTime::Seconds();
+			OutSize = Wrapper->GetCompressed().Num();
+			BestTime = FMath::Min(BestTime, FPlatformTime::Seconds() - StartTime);
+		}
+		return BestTime;
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		IImageWrapperModule& Module = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+		IConsoleVariable* StripRowsVar = IConsoleManager::Get().FindConsoleVariable(TEXT("ImageWrapper.PngStripRows"));
+		const int32 StripRows = StripRowsVar ? StripRowsVar->GetInt() : 0;
+
+		const FIntPoint Resolutions[] = { FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+		for (const FIntPoint& Resolution : Resolutions)
+		{
+			TArray<uint8> Pixels;
+			MakeTestImage(Resolution.X, Resolution.Y, Pixels);
+			const double MegaPixels = Resolution.X * Resolution.Y / 1000000.0;
+
+			int32 Size = 0;
+			if (StripRowsVar)
+			{
+				StripRowsVar->Set(0);
+				const double Time = TimeCompress(Module, EImageFormat::PNG, Pixels, Resolution.X, Resolution.Y, Size);
+				UE_LOG(LogImageWrapper, Display, TEXT("%dx%d PNG libpng:      %7.1f ms %7.1f MPix/s %9d bytes"), Resolution.X, Resolution.Y, Time * 1000.0, MegaPixels / Time, Size);
+				StripRowsVar->Set(FMath::Max(StripRows, 16));
+			}
+
+			double Time = TimeCompress(Module, EImageFormat::PNG, Pixels, Resolution.X, Resolution.Y, Size);
+			UE_LOG(LogImageWrapper, Display, TEXT("%dx%d PNG strips:      %7.1f ms %7.1f MPix/s %9d bytes"), Resolution.X, Resolution.Y, Time * 1000.0, MegaPixels / Time, Size);
+
+			Time = TimeCompress(Module, EImageFormat::JPEG, Pixels, Resolution.X, Resolution.Y, Size);
+			UE_LOG(LogImageWrapper, Display, TEXT("%dx%d JPEG:            %7.1f ms %7.1f MPix/s %9d bytes"), Resolution.X, Resolution.Y, Time * 1000.0, MegaPixels / Time, Size);
+
+			// a capture queue's worth of frames at once
+			const int32 BatchSize = 8;
+			TArray<IImageWrapperPtr> Batch;
+			for (int32 Index = 0; Index < BatchSize; Index++)
+			{
+				IImageWrapperPtr Wrapper = Module.CreateImageWrapper(EImageFormat::JPEG);
+				Wrapper->SetRaw(Pixels.GetData(), Pixels.Num(), Resolution.X, Resolution.Y, ERGBFormat::BGRA, 8);
+				Batch.Add(Wrapper);
+			}
+			const double StartTime = FPlatformTime::Seconds();
+			Module.CompressImages(Batch);
+			Time = FPlatformTime::Seconds() - StartTime;
+			UE_LOG(LogImageWrapper, Display, TEXT("%dx%d JPEG batch of %d: %7.1f ms %7.1f MPix/s"), Resolution.X, Resolution.Y, BatchSize, Time * 1000.0, MegaPixels * BatchSize / Time);
+		}
+
+		if (StripRowsVar)
+		{
+			StripRowsVar->Set(StripRows);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("ImageWrapper.Benchmark"),
+		TEXT("Times PNG (libpng and strips) and JPEG compression of synthetic 1080p and 4K frames, and a batch of JPEGs compressed in parallel."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Run)
+		);
+}
@@ -2,6 +2,8 @@
 
 #include "JpegImageWrapper.h"
 #include "Misc/ScopeLock.h"
+#include "Async/ParallelFor.h"
+#include "ImageEncodeHelpers.h"
 
 
 #if WITH_UNREALJPEG
@@ -90,8 +92,8 @@ void FJpegImageWrapper::Compress( int32 Quality )
 {
 	if (CompressedData.Num() == 0)
 	{
-		FScopeLock JPEGLock(&GJPEGSection);
-		
+		// No lock, unlike decoding: jpge keeps all of its state in the encoder on the stack, so images can be compressed in parallel
+
 		if (Quality == 0) {Quality = 85;}
 		ensure(Quality >= 1 && Quality <= 100);
 		Quality = FMath::Clamp(Quality, 1, 100);
@@ -100,17 +102,21 @@ void FJpegImageWrapper::Compress( int32 Quality )
 		check( Width > 0 );
 		check( Height > 0 );
 
-		// re-order components if required - JPEGs expect RGBA
+		// re-order components if required - JPEGs expect RGBA. Done into a scratch copy so RawData keeps matching RawFormat
+		const uint8* Pixels = RawData.GetData();
+		TArray<uint8> Swizzled;
 		if(RawFormat == ERGBFormat::BGRA)
 		{
-			FColor* Colors = (FColor*)RawData.GetData();
-			const int32 NumColors = RawData.Num() / 4;
-			for(int32 ColorIndex = 0; ColorIndex < NumColors; ColorIndex++)
+			ImageEncodeHelpers::AcquireBuffer(Swizzled, RawData.Num());
+
+			const int32 RowsPerTask = 64;
+			ParallelFor(FMath::DivideAndRoundUp(Height, RowsPerTask), [&](int32 TaskIndex)
 			{
-				uint8 Temp = Colors[ColorIndex].B;
-				Colors[ColorIndex].B = Colors[ColorIndex].R;
-				Colors[ColorIndex].R = Temp;
-			}
+				const int32 FirstRow = TaskIndex * RowsPerTask;
+				const int32 NumPixels = FMath::Min(RowsPerTask, Height - FirstRow) * Width;
+				ImageEncodeHelpers::SwapRedBlue(RawData.GetData() + FirstRow * Width * 4, Swizzled.GetData() + FirstRow * Width * 4, NumPixels);
+			});
+			Pixels = Swizzled.GetData();
 		}
 
 		CompressedData.Empty();
@@ -121,11 +127,13 @@ void FJpegImageWrapper::Compress( int32 Quality )
 		jpge::params Parameters;
 		Parameters.m_quality = Quality;
 		bool bSuccess = jpge::compress_image_to_jpeg_file_in_memory(
-			CompressedData.GetData(), OutBufferSize, Width, Height, NumComponents, RawData.GetData(), Parameters);
+			CompressedData.GetData(), OutBufferSize, Width, Height, NumComponents, Pixels, Parameters);
 		
 		check(bSuccess);
 
 		CompressedData.RemoveAt(OutBufferSize, CompressedData.Num() - OutBufferSize);
+
+		ImageEncodeHelpers::ReleaseBuffer(Swizzled);
 	}
 }
 
@@ -2,7 +2,10 @@
 
 #include "PngImageWrapper.h"
 #include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
 #include "ImageWrapperPrivate.h"
+#include "ImageEncodeHelpers.h"
 
 
 #if WITH_UNREALPNG
@@ -16,6 +19,12 @@
 /** Only allow one thread to use libpng at a time (it's not thread safe) */
 FCriticalSection GPNGSection;
 
+static int32 GPngStripRows = 64;
+static FAutoConsoleVariableRef CVarPngStripRows(
+	TEXT("ImageWrapper.PngStripRows"),
+	GPngStripRows,
+	TEXT("PNGs are compressed in strips of this many rows on worker threads, each deflated on its own. 0 compresses with libpng on the calling thread."));
+
 
 /* Local helper classes
  *****************************************************************************/
@@ -117,6 +126,11 @@ FPngImageWrapper::FPngImageWrapper()
 
 void FPngImageWrapper::Compress( int32 Quality )
 {
+	if (!CompressedData.Num() && GPngStripRows > 0 && CompressStrips(GPngStripRows))
+	{
+		return;
+	}
+
 	if (!CompressedData.Num())
 	{
 		// thread safety
@@ -173,6 +187,245 @@ void FPngImageWrapper::Compress( int32 Quality )
 }
 
 
+/**
+ * Strip compression writes the PNG itself: every strip of rows is filtered and raw deflated on its own worker thread,
+ * ending in a sync flush so the strips concatenate into a single zlib stream (as pigz does), and the Adler-32 of
+ * the whole stream is combined from the strips'. Rows are filtered against the row above even across strip boundaries
+ * since that row is right there in the raw data, so only the deflate dictionary restarts at each strip.
+ */
+namespace PngStrips
+{
+	/** Filters one row with the filter that minimizes the sum of absolute differences (the libpng heuristic), writing the filter byte and the row to Dest */
+	static void FilterRow(const uint8* Row, const uint8* PrevRow, int32 RowBytes, int32 BytesPerPixel, uint8* Dest, uint8* Scratch)
+	{
+		// None, Sub, Up, Average, Paeth, each RowBytes long in Scratch
+		uint32 Sums[5] = { 0, 0, 0, 0, 0 };
+		for (int32 Index = 0; Index < RowBytes; Index++)
+		{
+			const int32 Left = Index >= BytesPerPixel ? Row[Index - BytesPerPixel] : 0;
+			const int32 Up = PrevRow ? PrevRow[Index] : 0;
+			const int32 UpLeft = (PrevRow && Index >= BytesPerPixel) ? PrevRow[Index - BytesPerPixel] : 0;
+
+			const int32 Estimate = Left + Up - UpLeft;
+			const int32 DistLeft = FMath::Abs(Estimate - Left);
+			const int32 DistUp = FMath::Abs(Estimate - Up);
+			const int32 DistUpLeft = FMath::Abs(Estimate - UpLeft);
+			const int32 Paeth = (DistLeft <= DistUp && DistLeft <= DistUpLeft) ? Left : (DistUp <= DistUpLeft ? Up : UpLeft);
+
+			const uint8 Filtered[5] =
+			{
+				Row[Index],
+				uint8(Row[Index] - Left),
+				uint8(Row[Index] - Up),
+				uint8(Row[Index] - ((Left + Up) >> 1)),
+				uint8(Row[Index] - Paeth),
+			};
+			for (int32 Filter = 0; Filter < 5; Filter++)
+			{
+				Scratch[Filter * RowBytes + Index] = Filtered[Filter];
+				Sums[Filter] += FMath::Abs((int32)(int8)Filtered[Filter]);
+			}
+		}
+
+		int32 BestFilter = 0;
+		for (int32 Filter = 1; Filter < 5; Filter++)
+		{
+			if (Sums[Filter] < Sums[BestFilter])
+			{
+				BestFilter = Filter;
+			}
+		}
+
+		Dest[0] = (uint8)BestFilter;
+		FMemory::Memcpy(Dest + 1, Scratch + BestFilter * RowBytes, RowBytes);
+	}
+
+	static void WriteUInt32(TArray<uint8>& Out, uint32 Value)
+	{
+		const uint8 Bytes[4] = { uint8(Value >> 24), uint8(Value >> 16), uint8(Value >> 8), uint8(Value) };
+		Out.Append(Bytes, 4);
+	}
+
+	static void WriteChunk(TArray<uint8>& Out, const char* Type, const uint8* Data, uint32 Length)
+	{
+		WriteUInt32(Out, Length);
+		Out.Append((const uint8*)Type, 4);
+
+		uLong Crc = crc32(0L, (const Bytef*)Type, 4);
+		if (Length > 0)
+		{
+			Out.Append(Data, Length);
+			Crc = crc32(Crc, Data, Length);
+		}
+		WriteUInt32(Out, (uint32)Crc);
+	}
+}
+
+bool FPngImageWrapper::CompressStrips( int32 StripRows )
+{
+	check(RawData.Num());
+	check(Width > 0);
+	check(Height > 0);
+
+	if (RawBitDepth != 8 && RawBitDepth != 16)
+	{
+		return false;
+	}
+
+	const bool bGray = (RawFormat == ERGBFormat::Gray);
+	const int32 PixelChannels = bGray ? 1 : 4;
+	const int32 BytesPerChannel = RawBitDepth / 8;
+	const int32 BytesPerPixel = PixelChannels * BytesPerChannel;
+	const int32 RowBytes = BytesPerPixel * Width;
+	const int32 NumStrips = FMath::DivideAndRoundUp(Height, FMath::Max(StripRows, 1));
+	StripRows = FMath::DivideAndRoundUp(Height, NumStrips);
+
+	// Puts a row in PNG byte order: RGBA, 16 bit channels big endian
+	auto PrepareRow = [&](int32 Y, uint8* Dest)
+	{
+		const uint8* Src = &RawData[Y * RowBytes];
+		if (BytesPerChannel == 1)
+		{
+			if (RawFormat == ERGBFormat::BGRA)
+			{
+				ImageEncodeHelpers::SwapRedBlue(Src, Dest, Width);
+			}
+			else
+			{
+				FMemory::Memcpy(Dest, Src, RowBytes);
+			}
+			return;
+		}
+
+		for (int32 X = 0; X < Width; X++)
+		{
+			const uint16* SrcPixel = (const uint16*)(Src + X * BytesPerPixel);
+			uint8* DestPixel = Dest + X * BytesPerPixel;
+			for (int32 Channel = 0; Channel < PixelChannels; Channel++)
+			{
+				const int32 SrcChannel = (RawFormat == ERGBFormat::BGRA && Channel != 1 && Channel != 3) ? 2 - Channel : Channel;
+				DestPixel[Channel * 2] = uint8(SrcPixel[SrcChannel] >> 8);
+				DestPixel[Channel * 2 + 1] = uint8(SrcPixel[SrcChannel]);
+			}
+		}
+	};
+
+	struct FStrip
+	{
+		TArray<uint8> Deflated;
+		uLong Adler;
+		uLong FilteredSize;
+		bool bSucceeded;
+	};
+	TArray<FStrip> Strips;
+	Strips.SetNum(NumStrips);
+
+	ParallelFor(NumStrips, [&](int32 StripIndex)
+	{
+		FStrip& Strip = Strips[StripIndex];
+		Strip.bSucceeded = false;
+
+		const int32 FirstRow = StripIndex * StripRows;
+		const int32 NumRows = FMath::Min(StripRows, Height - FirstRow);
+		const int32 FilteredRowBytes = RowBytes + 1;
+
+		// rows (previous and current) in PNG byte order, five filter candidates, then the filtered strip
+		TArray<uint8> Scratch;
+		ImageEncodeHelpers::AcquireBuffer(Scratch, RowBytes * 7 + FilteredRowBytes * NumRows);
+		uint8* PrevRow = Scratch.GetData();
+		uint8* CurRow = PrevRow + RowBytes;
+		uint8* Candidates = CurRow + RowBytes;
+		uint8* Filtered = Candidates + RowBytes * 5;
+
+		if (FirstRow > 0)
+		{
+			PrepareRow(FirstRow - 1, PrevRow);
+		}
+		for (int32 Row = 0; Row < NumRows; Row++)
+		{
+			PrepareRow(FirstRow + Row, CurRow);
+			PngStrips::FilterRow(CurRow, (FirstRow + Row > 0) ? PrevRow : nullptr, RowBytes, BytesPerPixel, Filtered + Row * FilteredRowBytes, Candidates);
+			Swap(PrevRow, CurRow);
+		}
+
+		Strip.FilteredSize = (uLong)FilteredRowBytes * NumRows;
+		Strip.Adler = adler32(adler32(0L, Z_NULL, 0), Filtered, Strip.FilteredSize);
+
+		z_stream Stream;
+		FMemory::Memzero(Stream);
+		if (deflateInit2(&Stream, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+		{
+			ImageEncodeHelpers::AcquireBuffer(Strip.Deflated, (int32)deflateBound(&Stream, Strip.FilteredSize) + 16);
+
+			Stream.next_in = Filtered;
+			Stream.avail_in = Strip.FilteredSize;
+			Stream.next_out = Strip.Deflated.GetData();
+			Stream.avail_out = Strip.Deflated.Num();
+
+			// only the last strip finishes the stream, the others end on a byte boundary so they can be appended
+			const int32 Result = deflate(&Stream, StripIndex == NumStrips - 1 ? Z_FINISH : Z_SYNC_FLUSH);
+			if ((Result == Z_OK || Result == Z_STREAM_END) && Stream.avail_in == 0)
+			{
+				Strip.Deflated.SetNum(Strip.Deflated.Num() - Stream.avail_out, false);
+				Strip.bSucceeded = true;
+			}
+			deflateEnd(&Stream);
+		}
+
+		ImageEncodeHelpers::ReleaseBuffer(Scratch);
+	});
+
+	int32 DeflatedSize = 0;
+	uLong Adler = adler32(0L, Z_NULL, 0);
+	bool bSucceeded = true;
+	for (const FStrip& Strip : Strips)
+	{
+		bSucceeded &= Strip.bSucceeded;
+		DeflatedSize += Strip.Deflated.Num();
+		Adler = adler32_combine(Adler, Strip.Adler, Strip.FilteredSize);
+	}
+
+	if (bSucceeded)
+	{
+		static const uint8 Signature[8] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+
+		TArray<uint8> IDAT;
+		ImageEncodeHelpers::AcquireBuffer(IDAT, 0);
+		IDAT.Reserve(DeflatedSize + 6);
+
+		// zlib header for a 32K window at the fastest level, then the strips and the checksum of the whole stream
+		const uint8 ZlibHeader[2] = { 0x78, 0x01 };
+		IDAT.Append(ZlibHeader, 2);
+		for (const FStrip& Strip : Strips)
+		{
+			IDAT.Append(Strip.Deflated);
+		}
+		PngStrips::WriteUInt32(IDAT, (uint32)Adler);
+
+		TArray<uint8> IHDR;
+		PngStrips::WriteUInt32(IHDR, Width);
+		PngStrips::WriteUInt32(IHDR, Height);
+		const uint8 Header[5] = { (uint8)RawBitDepth, uint8(bGray ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGBA), PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT, PNG_INTERLACE_NONE };
+		IHDR.Append(Header, 5);
+
+		CompressedData.Reset(IDAT.Num() + 64);
+		CompressedData.Append(Signature, 8);
+		PngStrips::WriteChunk(CompressedData, "IHDR", IHDR.GetData(), IHDR.Num());
+		PngStrips::WriteChunk(CompressedData, "IDAT", IDAT.GetData(), IDAT.Num());
+		PngStrips::WriteChunk(CompressedData, "IEND", nullptr, 0);
+
+		ImageEncodeHelpers::ReleaseBuffer(IDAT);
+	}
+
+	for (FStrip& Strip : Strips)
+	{
+		ImageEncodeHelpers::ReleaseBuffer(Strip.Deflated);
+	}
+
+	return bSucceeded;
+}
+
+
 void FPngImageWrapper::Reset( )
 {
 	FImageWrapperBase::Reset();
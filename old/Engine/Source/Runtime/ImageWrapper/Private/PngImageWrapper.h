@@ -65,6 +65,14 @@ public:
 	/** Helper function used to uncompress PNG data from a buffer */
 	void UncompressPNGData( const ERGBFormat::Type InFormat, const int32 InBitDepth );
 
+	/**
+	 * Compresses the raw data in strips of rows on worker threads without libpng.
+	 *
+	 * @param StripRows Number of rows in each strip
+	 * @return false if the raw data isn't in a format this supports, or zlib failed
+	 */
+	bool CompressStrips( int32 StripRows );
+
 protected:
 
 	// Callbacks for the pnglibs
@@ -32,6 +32,15 @@ public:
 	 */
 	virtual EImageFormat::Type DetectImageFormat( const void* InCompressedData, int32 InCompressedSize) = 0;
 
+	/**
+	 * Compresses several images in parallel, e.g. a batch of captured frames. Afterwards GetCompressed() on each
+	 * of the wrappers returns the compressed data without compressing again.
+	 *
+	 * @param ImageWrappers - The wrappers to compress, with their raw data set.
+	 * @param Quality - The compression quality passed to each wrapper.
+	 */
+	virtual void CompressImages( const TArray<IImageWrapperPtr>& ImageWrappers, int32 Quality = 0 ) = 0;
+
 public:
 
 	/**
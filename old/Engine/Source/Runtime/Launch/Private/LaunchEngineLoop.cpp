@@ -20,12 +20,14 @@
 #include "Misc/AutomationTest.h"
 #include "Misc/CommandLine.h"
 #include "Misc/App.h"
+#include "Misc/MemStack.h"
 #include "Misc/OutputDeviceConsole.h"
 #include "HAL/PlatformFilemanager.h"
 #include "Templates/ScopedPointer.h"
 #include "HAL/FileManagerGeneric.h"
 #include "HAL/ExceptionHandling.h"
 #include "Stats/StatsMallocProfilerProxy.h"
+#include "HAL/MallocSampling.h"
 #include "HAL/PlatformSplash.h"
 #include "HAL/ThreadManager.h"
 #include "ProfilingDebugging/ExternalProfiler.h"
@@ -3104,10 +3106,18 @@ void FEngineLoop::Tick()
 			GEngine->TickDeferredCommands();		
 		}
 
+		// Per-frame temporaries (TFrameAllocator) are dead by now on both threads.
+		FFrameMemStack::Get().EndFrame();
+
 		ENQUEUE_UNIQUE_RENDER_COMMAND(
 			EndFrame,
 		{
 			RHICmdList.EndFrame();
+			// Without a rendering thread this runs on the game thread, whose frame stack was already emptied above
+			if (!IsInGameThread())
+			{
+				FFrameMemStack::Get().EndFrame();
+			}
 			GPU_STATS_ENDFRAME(RHICmdList);
 			RHICmdList.PopEvent();
 		});
@@ -3274,6 +3284,11 @@ bool FEngineLoop::AppInit( )
 		FMemory::EnablePoisonTests();
 	}
 
+	if (FParse::Param(FCommandLine::Get(), TEXT("MallocSampling")))
+	{
+		FMallocSamplingProxy::Enable();
+	}
+
 #if !UE_BUILD_SHIPPING
 	if (FParse::Param(FCommandLine::Get(), TEXT("BUILDMACHINE")))
 	{
@@ -20,6 +20,7 @@ public class MovieSceneCapture : ModuleRules
 
 		PublicDependencyModuleNames.AddRange(
 			new string[] {
+				"ImageCore",
 				"LevelSequence",
 			}
 		);
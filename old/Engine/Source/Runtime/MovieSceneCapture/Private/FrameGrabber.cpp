@@ -191,6 +191,9 @@ FFrameGrabber::FFrameGrabber(TSharedRef<FSceneViewport> Viewport, FIntPoint Desi
 
 	CurrentFrameIndex = 0;
 
+	ChangeMaskTileSize = 0;
+	ChangeMaskThreshold = 0;
+
 	check(NumSurfaces != 0);
 
 	FIntRect CaptureRect(0,0,Viewport->GetSize().X, Viewport->GetSize().Y);
@@ -285,6 +288,17 @@ void FFrameGrabber::StopCapturingFrames()
 	State = EFrameGrabberState::PendingShutdown;
 }
 
+void FFrameGrabber::EnableTileChangeMasks(int32 TileSize, uint32 Threshold)
+{
+	if (!ensure(State == EFrameGrabberState::Inactive && TileSize > 0))
+	{
+		return;
+	}
+
+	ChangeMaskTileSize = TileSize;
+	ChangeMaskThreshold = Threshold;
+}
+
 void FFrameGrabber::Shutdown()
 {
 	State = EFrameGrabberState::Inactive;
@@ -394,6 +408,24 @@ void FFrameGrabber::OnFrameReady(int32 BufferIndex, FColor* ColorBuffer, int32 W
 		Dest += MaxWidth;
 	}
 
+	if (ChangeMaskTileSize > 0)
+	{
+		ResolvedFrameData.ChangeMask = FTileChangeMask(ChangeMaskTileSize, ChangeMaskThreshold);
+
+		const TArray<FColor>& CurrentFrame = ResolvedFrameData.ColorBuffer;
+		if (PreviousFrame.Num() == CurrentFrame.Num())
+		{
+			ResolvedFrameData.ChangeMask.Compare(CurrentFrame.GetData(), PreviousFrame.GetData(), TargetSize.X, TargetSize.Y);
+		}
+		else
+		{
+			ResolvedFrameData.ChangeMask.MarkAllChanged(TargetSize.X, TargetSize.Y);
+		}
+
+		PreviousFrame.SetNumUninitialized(CurrentFrame.Num());
+		FMemory::Memcpy(PreviousFrame.GetData(), CurrentFrame.GetData(), CurrentFrame.Num() * sizeof(FColor));
+	}
+
 	{
 		FScopeLock Lock(&CapturedFramesMutex);
 		CapturedFrames.Add(MoveTemp(ResolvedFrameData));
@@ -12,15 +12,27 @@ bool FFrameGrabberProtocol::Initialize(const FCaptureProtocolInitSettings& InSet
 {
 	EPixelFormat PixelFormat = PF_B8G8R8A8;
 	uint32 RingBufferSize = 3;
+	int32 ChangeMaskTileSize = 0;
+	uint32 ChangeMaskThreshold = 0;
 
 	if (UFrameGrabberProtocolSettings* Settings = Cast<UFrameGrabberProtocolSettings>(InSettings.ProtocolSettings))
 	{
 		PixelFormat = Settings->DesiredPixelFormat;
 		RingBufferSize = Settings->RingBufferSize;
+
+		if (Settings->bComputeTileChangeMasks)
+		{
+			ChangeMaskTileSize = FMath::Max(Settings->ChangeMaskTileSize, 1);
+			ChangeMaskThreshold = FMath::Max(Settings->ChangeMaskThreshold, 0);
+		}
 	}
 
 	// We'll use our own grabber to capture the entire viewport
 	FrameGrabber.Reset(new FFrameGrabber(InSettings.SceneViewport.ToSharedRef(), InSettings.DesiredSize, PixelFormat, RingBufferSize));
+	if (ChangeMaskTileSize > 0)
+	{
+		FrameGrabber->EnableTileChangeMasks(ChangeMaskTileSize, ChangeMaskThreshold);
+	}
 	FrameGrabber->StartCapturingFrames();
 	return true;
 }
@@ -20,6 +20,7 @@
 #include "Protocols/ImageSequenceProtocol.h"
 #include "Protocols/CompositionGraphCaptureProtocol.h"
 #include "Protocols/VideoCaptureProtocol.h"
+#include "Protocols/RawVideoProtocol.h"
 
 #define LOCTEXT_NAMESPACE "MovieSceneCapture"
 
@@ -51,6 +52,14 @@ private:
 			};
 			ProtocolRegistry.RegisterProtocol(TEXT("CustomRenderPasses"), Info);
 		}
+		{
+			Info.DisplayName = LOCTEXT("RawVideoDescription", "Raw Video Stream (y4m, yuv)");
+			Info.SettingsClassType = URawVideoCaptureSettings::StaticClass();
+			Info.Factory = []() -> TSharedRef<IMovieSceneCaptureProtocol> {
+				return MakeShareable(new FRawVideoProtocol());
+			};
+			ProtocolRegistry.RegisterProtocol(TEXT("RawVideo"), Info);
+		}
 #if WITH_EDITOR
 		{
 			Info.DisplayName = LOCTEXT("VideoDescription", "Video Sequence");
@@ -0,0 +1,499 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "Protocols/RawVideoProtocol.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/Casts.h"
+#include "YUVImage.h"
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <pthread.h>
+	#include <signal.h>
+	#include <stdio.h>
+	#include <unistd.h>
+	#include <sys/socket.h>
+	#include <sys/stat.h>
+	#include <sys/un.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogRawVideoCapture, Log, All);
+
+/** Destination for the stream of frames */
+struct IRawVideoSink
+{
+	virtual ~IRawVideoSink() {}
+
+	/** Writes all of Data, blocking until the destination has taken it. Returns false if the destination went away. */
+	virtual bool Write(const uint8* Data, int64 Size) = 0;
+};
+
+/** A regular file, through the platform file layer */
+struct FRawVideoFileSink : IRawVideoSink
+{
+	explicit FRawVideoFileSink(IFileHandle* InHandle) : Handle(InHandle) {}
+
+	virtual bool Write(const uint8* Data, int64 Size) override
+	{
+		return Handle->Write(Data, Size);
+	}
+
+	TUniquePtr<IFileHandle> Handle;
+};
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+
+/** A named pipe, a Unix domain socket or the stdin of an encoder process, none of which the platform file layer can open */
+struct FRawVideoDescriptorSink : IRawVideoSink
+{
+	FRawVideoDescriptorSink(int32 InDescriptor, FILE* InProcess) : Descriptor(InDescriptor), Process(InProcess) {}
+
+	~FRawVideoDescriptorSink()
+	{
+		if (Process)
+		{
+			// Closes stdin and waits for the encoder to finish the file
+			pclose(Process);
+		}
+		else
+		{
+			close(Descriptor);
+		}
+	}
+
+	virtual bool Write(const uint8* Data, int64 Size) override
+	{
+		while (Size > 0)
+		{
+			const ssize_t Written = write(Descriptor, Data, Size);
+			if (Written < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+
+			Data += Written;
+			Size -= Written;
+		}
+		return true;
+	}
+
+	int32 Descriptor;
+	FILE* Process;
+};
+
+#endif
+
+namespace RawVideoProtocol
+{
+	static TUniquePtr<IRawVideoSink> OpenSink(const FString& Target)
+	{
+#if PLATFORM_LINUX || PLATFORM_MAC
+		if (Target.StartsWith(TEXT("unix:")))
+		{
+			const FTCHARToUTF8 Path(*Target.Mid(5));
+
+			sockaddr_un Address;
+			FMemory::Memzero(Address);
+			Address.sun_family = AF_UNIX;
+			if (Path.Length() >= (int32)sizeof(Address.sun_path))
+			{
+				UE_LOG(LogRawVideoCapture, Error, TEXT("Socket path is too long: %s"), *Target);
+				return nullptr;
+			}
+			FMemory::Memcpy(Address.sun_path, Path.Get(), Path.Length());
+
+			const int32 Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (Socket == -1 || connect(Socket, (sockaddr*)&Address, sizeof(Address)) == -1)
+			{
+				UE_LOG(LogRawVideoCapture, Error, TEXT("Couldn't connect to %s: %s"), *Target, UTF8_TO_TCHAR(strerror(errno)));
+				if (Socket != -1)
+				{
+					close(Socket);
+				}
+				return nullptr;
+			}
+			return MakeUnique<FRawVideoDescriptorSink>(Socket, nullptr);
+		}
+
+		if (Target.StartsWith(TEXT("pipe:")))
+		{
+			FILE* Process = popen(TCHAR_TO_UTF8(*Target.Mid(5)), "w");
+			if (!Process)
+			{
+				UE_LOG(LogRawVideoCapture, Error, TEXT("Couldn't start %s: %s"), *Target.Mid(5), UTF8_TO_TCHAR(strerror(errno)));
+				return nullptr;
+			}
+			return MakeUnique<FRawVideoDescriptorSink>(fileno(Process), Process);
+		}
+
+		struct stat FileInfo;
+		if (stat(TCHAR_TO_UTF8(*Target), &FileInfo) == 0 && S_ISFIFO(FileInfo.st_mode))
+		{
+			// Blocks until the reader has opened its end
+			const int32 Descriptor = open(TCHAR_TO_UTF8(*Target), O_WRONLY | O_CLOEXEC);
+			if (Descriptor == -1)
+			{
+				UE_LOG(LogRawVideoCapture, Error, TEXT("Couldn't open %s: %s"), *Target, UTF8_TO_TCHAR(strerror(errno)));
+				return nullptr;
+			}
+			return MakeUnique<FRawVideoDescriptorSink>(Descriptor, nullptr);
+		}
+#else
+		if (Target.StartsWith(TEXT("unix:")) || Target.StartsWith(TEXT("pipe:")))
+		{
+			UE_LOG(LogRawVideoCapture, Error, TEXT("%s: sockets and encoder processes are only supported on Linux and Mac"), *Target);
+			return nullptr;
+		}
+#endif
+
+		IFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Target);
+		if (!Handle)
+		{
+			UE_LOG(LogRawVideoCapture, Error, TEXT("Couldn't open %s for writing"), *Target);
+			return nullptr;
+		}
+		return MakeUnique<FRawVideoFileSink>(Handle);
+	}
+
+	/** Expresses the capture frequency as the ratio Y4M wants, 29.97 and friends as the usual NTSC ratios */
+	static void GetFrameRateRatio(float FrameRate, int32& OutNumerator, int32& OutDenominator)
+	{
+		const float NTSCRate = FrameRate * 1.001f;
+
+		if (FMath::IsNearlyEqual(FrameRate, FMath::RoundToFloat(FrameRate), 0.001f))
+		{
+			OutNumerator = FMath::RoundToInt(FrameRate);
+			OutDenominator = 1;
+		}
+		else if (FMath::IsNearlyEqual(NTSCRate, FMath::RoundToFloat(NTSCRate), 0.001f))
+		{
+			OutNumerator = FMath::RoundToInt(NTSCRate) * 1000;
+			OutDenominator = 1001;
+		}
+		else
+		{
+			OutNumerator = FMath::RoundToInt(FrameRate * 1000.f);
+			OutDenominator = 1000;
+		}
+	}
+}
+
+struct FRawVideoFrameData : IFramePayload
+{
+	uint32 NumDroppedFrames;
+};
+
+/** Thread converting captured frames to YUV and writing them out in order */
+class FRawVideoStreamWriter : public FRunnable
+{
+public:
+	FRawVideoStreamWriter(TUniquePtr<IRawVideoSink> InSink, ERawVideoFormat InFormat, FIntPoint InFrameSize, float InFrameRate, int32 InMaxQueuedFrames, bool bInRepeatDroppedFrames)
+		: Sink(MoveTemp(InSink))
+		, Format(InFormat)
+		, FrameSize(InFrameSize)
+		, FrameRate(InFrameRate)
+		, MaxQueuedFrames(InMaxQueuedFrames)
+		, bRepeatDroppedFrames(bInRepeatDroppedFrames)
+		, NumWritingFrames(0)
+		, StallSeconds(0.0)
+		, NumWrittenFrames(0)
+	{
+		WorkToDoEvent = FPlatformProcess::GetSynchEventFromPool();
+		SpaceAvailableEvent = FPlatformProcess::GetSynchEventFromPool();
+
+		QueuedFrames.Reserve(MaxQueuedFrames);
+		bRunning = true;
+
+		static int32 Index = 0;
+		Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("RawVideoWriterThread_%d"), ++Index));
+	}
+
+	~FRawVideoStreamWriter()
+	{
+		Close();
+
+		FPlatformProcess::ReturnSynchEventToPool(WorkToDoEvent);
+		FPlatformProcess::ReturnSynchEventToPool(SpaceAvailableEvent);
+	}
+
+	/** Queues a frame, blocking while MaxQueuedFrames are already waiting to be written */
+	void Add(FCapturedFrameData Frame)
+	{
+		double StallStartTime = 0.0;
+		for (;;)
+		{
+			{
+				FScopeLock Lock(&QueueMutex);
+				if (QueuedFrames.Num() + NumWritingFrames < MaxQueuedFrames || bFailed)
+				{
+					QueuedFrames.Add(MoveTemp(Frame));
+					break;
+				}
+			}
+
+			if (StallStartTime == 0.0)
+			{
+				StallStartTime = FPlatformTime::Seconds();
+			}
+			SpaceAvailableEvent->Wait(~0);
+		}
+
+		if (StallStartTime != 0.0)
+		{
+			StallSeconds += FPlatformTime::Seconds() - StallStartTime;
+		}
+
+		WorkToDoEvent->Trigger();
+	}
+
+	int32 GetNumOutstandingFrames() const
+	{
+		FScopeLock Lock(&QueueMutex);
+		return QueuedFrames.Num() + NumWritingFrames;
+	}
+
+	/** Writes out everything that is still queued and closes the stream */
+	void Close()
+	{
+		if (Thread)
+		{
+			Thread->Kill(true);
+			delete Thread;
+			Thread = nullptr;
+
+			// Closing the sink may wait on an encoder process to finish up
+			Sink.Reset();
+
+			UE_LOG(LogRawVideoCapture, Log, TEXT("Wrote %d frames, capture stalled %.2fs waiting on the stream"), NumWrittenFrames, StallSeconds);
+		}
+	}
+
+	virtual uint32 Run() override
+	{
+#if PLATFORM_LINUX || PLATFORM_MAC
+		// A reader going away should fail the write rather than raise SIGPIPE, which the crash handler treats as fatal
+		sigset_t SignalMask;
+		sigemptyset(&SignalMask);
+		sigaddset(&SignalMask, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &SignalMask, nullptr);
+#endif
+
+		if (Format == RVF_Y4M)
+		{
+			int32 Numerator = 0, Denominator = 0;
+			RawVideoProtocol::GetFrameRateRatio(FrameRate, Numerator, Denominator);
+
+			const FString Header = FString::Printf(TEXT("YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n"), FrameSize.X, FrameSize.Y, Numerator, Denominator);
+			WriteToSink((const uint8*)TCHAR_TO_ANSI(*Header), Header.Len());
+		}
+
+		for (;;)
+		{
+			TArray<FCapturedFrameData> Frames;
+			{
+				FScopeLock Lock(&QueueMutex);
+				Swap(Frames, QueuedFrames);
+				NumWritingFrames = Frames.Num();
+			}
+
+			if (!Frames.Num())
+			{
+				if (!bRunning)
+				{
+					break;
+				}
+				WorkToDoEvent->Wait(~0);
+				continue;
+			}
+
+			for (FCapturedFrameData& Frame : Frames)
+			{
+				WriteFrame(Frame);
+
+				// Free the frame before making room for the next one
+				Frame.ColorBuffer.Empty();
+				{
+					FScopeLock Lock(&QueueMutex);
+					--NumWritingFrames;
+				}
+				SpaceAvailableEvent->Trigger();
+			}
+		}
+
+		return 0;
+	}
+
+	virtual void Stop() override
+	{
+		bRunning = false;
+		WorkToDoEvent->Trigger();
+	}
+
+private:
+
+	void WriteFrame(FCapturedFrameData& Frame)
+	{
+		if (bFailed)
+		{
+			return;
+		}
+
+		if (Frame.BufferSize != FrameSize || Frame.ColorBuffer.Num() != FrameSize.X * FrameSize.Y)
+		{
+			UE_LOG(LogRawVideoCapture, Warning, TEXT("Skipping a %dx%d frame in a %dx%d stream"), Frame.BufferSize.X, Frame.BufferSize.Y, FrameSize.X, FrameSize.Y);
+			return;
+		}
+
+		// Repeat the last frame over any dropped ones so the stream keeps its frame rate
+		const FRawVideoFrameData* Payload = Frame.GetPayload<FRawVideoFrameData>();
+		if (bRepeatDroppedFrames && Payload && YUVBuffer.Num())
+		{
+			for (uint32 Index = 0; Index < Payload->NumDroppedFrames; ++Index)
+			{
+				WriteYUVBuffer();
+			}
+		}
+
+		YUVBuffer.SetNumUninitialized(YUVImage::GetBufferSize(FrameSize.X, FrameSize.Y), false);
+		YUVImage::ConvertBGRA8(Frame.ColorBuffer.GetData(), FrameSize.X, FrameSize.Y, Format == RVF_NV12 ? EYUVFormat::NV12 : EYUVFormat::I420, YUVBuffer.GetData());
+		WriteYUVBuffer();
+	}
+
+	void WriteYUVBuffer()
+	{
+		static const ANSICHAR FrameHeader[] = "FRAME\n";
+		if (Format == RVF_Y4M)
+		{
+			WriteToSink((const uint8*)FrameHeader, sizeof(FrameHeader) - 1);
+		}
+
+		WriteToSink(YUVBuffer.GetData(), YUVBuffer.Num());
+		++NumWrittenFrames;
+	}
+
+	void WriteToSink(const uint8* Data, int64 Size)
+	{
+		if (!bFailed && !Sink->Write(Data, Size))
+		{
+			UE_LOG(LogRawVideoCapture, Error, TEXT("Raw video stream was closed by the reader, dropping the remaining frames"));
+			bFailed = true;
+			SpaceAvailableEvent->Trigger();
+		}
+	}
+
+private:
+	/** The thread itself */
+	FRunnableThread* Thread;
+	/** Where the frames go */
+	TUniquePtr<IRawVideoSink> Sink;
+	/** Layout of the frames */
+	ERawVideoFormat Format;
+	/** Size every frame must have */
+	FIntPoint FrameSize;
+	/** Frames per second, for the Y4M header */
+	float FrameRate;
+	/** Frames that may be queued or being written before Add blocks */
+	int32 MaxQueuedFrames;
+	/** Whether to fill in dropped frames so the stream keeps a constant rate */
+	bool bRepeatDroppedFrames;
+
+	/** Frames waiting for the thread, and the number it has taken but not finished yet */
+	mutable FCriticalSection QueueMutex;
+	TArray<FCapturedFrameData> QueuedFrames;
+	int32 NumWritingFrames;
+
+	/** Triggered when frames are queued */
+	FEvent* WorkToDoEvent;
+	/** Triggered when a frame has been written */
+	FEvent* SpaceAvailableEvent;
+	/** Set to false when the thread should finish the queue and exit */
+	FThreadSafeBool bRunning;
+	/** Set when the destination went away, from then on frames are dropped without blocking */
+	FThreadSafeBool bFailed;
+
+	/** The last converted frame, kept to repeat over dropped frames */
+	TArray<uint8> YUVBuffer;
+
+	/** Time the capture spent blocked in Add, only touched by the thread calling Add */
+	double StallSeconds;
+	/** Number of frames written, only touched by the writer thread */
+	int32 NumWrittenFrames;
+};
+
+FRawVideoProtocol::FRawVideoProtocol()
+{
+}
+
+FRawVideoProtocol::~FRawVideoProtocol()
+{
+}
+
+bool FRawVideoProtocol::Initialize(const FCaptureProtocolInitSettings& InSettings, const ICaptureProtocolHost& Host)
+{
+	ERawVideoFormat Format = RVF_Y4M;
+	FString StreamTarget;
+	int32 MaxQueuedFrames = 4;
+
+	if (URawVideoCaptureSettings* CaptureSettings = Cast<URawVideoCaptureSettings>(InSettings.ProtocolSettings))
+	{
+		Format = CaptureSettings->Format;
+		StreamTarget = CaptureSettings->StreamTarget;
+		MaxQueuedFrames = FMath::Clamp(CaptureSettings->MaxQueuedFrames, 1, 32);
+	}
+
+	// Capture farms configure the stream on the command line
+	FString FormatName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-RawVideoFormat="), FormatName))
+	{
+		Format = FormatName == TEXT("NV12") ? RVF_NV12 : FormatName == TEXT("I420") ? RVF_I420 : RVF_Y4M;
+	}
+	FParse::Value(FCommandLine::Get(), TEXT("-RawVideoTarget="), StreamTarget);
+
+	if (StreamTarget.IsEmpty())
+	{
+		StreamTarget = Host.GenerateFilename(FFrameMetrics(), Format == RVF_Y4M ? TEXT(".y4m") : TEXT(".yuv"));
+		Host.EnsureFileWritable(StreamTarget);
+	}
+
+	TUniquePtr<IRawVideoSink> Sink = RawVideoProtocol::OpenSink(StreamTarget);
+	if (!Sink.IsValid() || !FFrameGrabberProtocol::Initialize(InSettings, Host))
+	{
+		return false;
+	}
+
+	Writer.Reset(new FRawVideoStreamWriter(MoveTemp(Sink), Format, InSettings.DesiredSize, Host.GetCaptureFrequency(), MaxQueuedFrames, Host.GetCaptureStrategy().ShouldSynchronizeFrames()));
+
+	return true;
+}
+
+FFramePayloadPtr FRawVideoProtocol::GetFramePayload(const FFrameMetrics& FrameMetrics, const ICaptureProtocolHost& Host)
+{
+	TSharedRef<FRawVideoFrameData, ESPMode::ThreadSafe> FrameData = MakeShareable(new FRawVideoFrameData);
+	FrameData->NumDroppedFrames = FrameMetrics.NumDroppedFrames;
+	return FrameData;
+}
+
+void FRawVideoProtocol::ProcessFrame(FCapturedFrameData Frame)
+{
+	Writer->Add(MoveTemp(Frame));
+}
+
+bool FRawVideoProtocol::HasFinishedProcessing() const
+{
+	return FFrameGrabberProtocol::HasFinishedProcessing() && Writer->GetNumOutstandingFrames() == 0;
+}
+
+void FRawVideoProtocol::Finalize()
+{
+	Writer.Reset();
+
+	FFrameGrabberProtocol::Finalize();
+}
@@ -6,6 +6,7 @@
 #include "HAL/ThreadSafeCounter.h"
 #include "HAL/ThreadSafeBool.h"
 #include "Slate/SceneViewport.h"
+#include "TileChangeMask.h"
 
 class SWindow;
 
@@ -74,8 +75,8 @@ struct FCapturedFrameData
 {
 	FCapturedFrameData(FIntPoint InBufferSize, FFramePayloadPtr InPayload) : BufferSize(InBufferSize), Payload(MoveTemp(InPayload)) {}
 
-	FCapturedFrameData(FCapturedFrameData&& In) : ColorBuffer(MoveTemp(In.ColorBuffer)), BufferSize(In.BufferSize), Payload(MoveTemp(In.Payload)) {}
-	FCapturedFrameData& operator=(FCapturedFrameData&& In){ ColorBuffer = MoveTemp(In.ColorBuffer); BufferSize = In.BufferSize; Payload = MoveTemp(In.Payload); return *this; }
+	FCapturedFrameData(FCapturedFrameData&& In) : ColorBuffer(MoveTemp(In.ColorBuffer)), BufferSize(In.BufferSize), ChangeMask(MoveTemp(In.ChangeMask)), Payload(MoveTemp(In.Payload)) {}
+	FCapturedFrameData& operator=(FCapturedFrameData&& In){ ColorBuffer = MoveTemp(In.ColorBuffer); BufferSize = In.BufferSize; ChangeMask = MoveTemp(In.ChangeMask); Payload = MoveTemp(In.Payload); return *this; }
 
 	template<typename T>
 	T* GetPayload() { return static_cast<T*>(Payload.Get()); }
@@ -86,6 +87,9 @@ struct FCapturedFrameData
 	/** The size of the resulting color buffer */
 	FIntPoint BufferSize;
 
+	/** Which tiles of the color buffer changed since the previously captured frame. Only valid when enabled with FFrameGrabber::EnableTileChangeMasks. */
+	FTileChangeMask ChangeMask;
+
 	/** Optional user-specified payload */
 	FFramePayloadPtr Payload;
 	
@@ -127,6 +131,15 @@ public:
 	/** Stop capturing frames */
 	void StopCapturingFrames();
 
+	/**
+	 * Compare each captured frame against the previous one and record which tiles changed in FCapturedFrameData::ChangeMask,
+	 * so consumers can skip unchanged parts of the frame. Must be called before capturing starts.
+	 *
+	 * @param TileSize		The width and height of a tile in pixels
+	 * @param Threshold		Largest sum of absolute color differences a tile may have and still count as unchanged
+	 */
+	void EnableTileChangeMasks(int32 TileSize = 16, uint32 Threshold = 0);
+
 	/** Shut down this grabber, ensuring that any threaded operations are finished */
 	void Shutdown();
 
@@ -199,4 +212,13 @@ private:
 
 	/** The desired target size to resolve frames to */
 	FIntPoint TargetSize;
+
+	/** Tile size for change masks, or 0 when they are disabled */
+	int32 ChangeMaskTileSize;
+
+	/** Difference threshold for change masks */
+	uint32 ChangeMaskThreshold;
+
+	/** Copy of the last captured frame that the next one is compared against - only accessed on the thread frames are resolved on */
+	TArray<FColor> PreviousFrame;
 };
@@ -14,7 +14,7 @@ UCLASS()
 class MOVIESCENECAPTURE_API UFrameGrabberProtocolSettings : public UMovieSceneCaptureProtocolSettings
 {
 public:
-	UFrameGrabberProtocolSettings(const FObjectInitializer&) : DesiredPixelFormat(PF_B8G8R8A8), RingBufferSize(3) {}
+	UFrameGrabberProtocolSettings(const FObjectInitializer&) : DesiredPixelFormat(PF_B8G8R8A8), RingBufferSize(3), bComputeTileChangeMasks(false), ChangeMaskTileSize(16), ChangeMaskThreshold(0) {}
 
 	GENERATED_BODY()
 
@@ -23,6 +23,18 @@ public:
 
 	/** The size of the render-target resolution surface ring-buffer */
 	uint32 RingBufferSize;
+
+	/** Whether to compare each captured frame against the previous one and pass a mask of the tiles that changed along with the frame */
+	UPROPERTY(config, EditAnywhere, Category=ChangeDetection, AdvancedDisplay)
+	bool bComputeTileChangeMasks;
+
+	/** Width and height in pixels of the tiles frames are compared in */
+	UPROPERTY(config, EditAnywhere, Category=ChangeDetection, AdvancedDisplay, meta=(EditCondition=bComputeTileChangeMasks, ClampMin=4, ClampMax=256))
+	int32 ChangeMaskTileSize;
+
+	/** Largest sum of absolute color differences a tile may have and still count as unchanged. 0 flags any change. */
+	UPROPERTY(config, EditAnywhere, Category=ChangeDetection, AdvancedDisplay, meta=(EditCondition=bComputeTileChangeMasks, ClampMin=0))
+	int32 ChangeMaskThreshold;
 };
 
 struct MOVIESCENECAPTURE_API FFrameGrabberProtocol : IMovieSceneCaptureProtocol
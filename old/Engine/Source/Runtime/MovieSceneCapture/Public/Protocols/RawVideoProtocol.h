@@ -0,0 +1,69 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "IMovieSceneCaptureProtocol.h"
+#include "FrameGrabber.h"
+#include "Protocols/FrameGrabberProtocol.h"
+#include "RawVideoProtocol.generated.h"
+
+class FRawVideoStreamWriter;
+
+/** Layout of the frames written by the raw video protocol */
+UENUM()
+enum ERawVideoFormat
+{
+	RVF_Y4M UMETA(DisplayName = "Y4M (I420)"),
+	RVF_I420 UMETA(DisplayName = "Raw I420"),
+	RVF_NV12 UMETA(DisplayName = "Raw NV12"),
+};
+
+UCLASS(config=EditorPerProjectUserSettings, DisplayName="Raw Video Stream")
+class MOVIESCENECAPTURE_API URawVideoCaptureSettings : public UFrameGrabberProtocolSettings
+{
+public:
+	URawVideoCaptureSettings(const FObjectInitializer& Init) : UFrameGrabberProtocolSettings(Init), Format(RVF_Y4M), MaxQueuedFrames(4) {}
+
+	GENERATED_BODY()
+
+	/** Layout of the written frames. Y4M carries the frame size and rate in a header, the raw layouts are just the planes of each frame back to back. */
+	UPROPERTY(config, EditAnywhere, Category=RawVideoSettings)
+	TEnumAsByte<enum ERawVideoFormat> Format;
+
+	/**
+	 * Where to stream to instead of a file named from the output format. May be a file or named pipe path,
+	 * unix:<path> to connect to a Unix domain socket, or pipe:<command> to start an encoder that reads the stream from stdin.
+	 */
+	UPROPERTY(config, EditAnywhere, Category=RawVideoSettings)
+	FString StreamTarget;
+
+	/** Number of captured frames that may wait to be converted and written before the capture stalls for the destination to catch up */
+	UPROPERTY(config, EditAnywhere, Category=RawVideoSettings, AdvancedDisplay, meta=(ClampMin=1, ClampMax=32))
+	int32 MaxQueuedFrames;
+};
+
+/**
+ * Streams captured frames as 8 bit 4:2:0 YUV into a single file, named pipe or socket, for capture farms and external encoders.
+ * Frames are converted and written in order on a dedicated thread. When the destination falls behind, ProcessFrame blocks,
+ * which stops the frame grabber from recycling its surfaces until there is room again.
+ */
+struct MOVIESCENECAPTURE_API FRawVideoProtocol : FFrameGrabberProtocol
+{
+	FRawVideoProtocol();
+	~FRawVideoProtocol();
+
+	/**~ FFrameGrabberProtocol implementation */
+	virtual bool Initialize(const FCaptureProtocolInitSettings& InSettings, const ICaptureProtocolHost& Host) override;
+	virtual FFramePayloadPtr GetFramePayload(const FFrameMetrics& FrameMetrics, const ICaptureProtocolHost& Host);
+	virtual void ProcessFrame(FCapturedFrameData Frame);
+	virtual void Finalize() override;
+	virtual bool HasFinishedProcessing() const override;
+	/**~ End FFrameGrabberProtocol implementation */
+
+private:
+
+	/** Thread converting and writing out frames */
+	TUniquePtr<FRawVideoStreamWriter> Writer;
+};
@@ -0,0 +1,21 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+namespace UnrealBuildTool.Rules
+{
+	public class LocalFileNetworkReplayStreaming : ModuleRules
+	{
+		public LocalFileNetworkReplayStreaming( TargetInfo Target )
+		{
+			PrivateIncludePaths.Add( "Runtime/NetworkReplayStreaming/LocalFileNetworkReplayStreaming/Private" );
+
+			PrivateDependencyModuleNames.AddRange(
+				new string[]
+				{
+					"Core",
+					"Engine",
+					"NetworkReplayStreaming",
+				}
+			);
+		}
+	}
+}
@@ -0,0 +1,1039 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "LocalFileNetworkReplayStreaming.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Compression.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/NetworkVersion.h"
+#include "Serialization/BufferReader.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#elif PLATFORM_LINUX || PLATFORM_MAC
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC( LogLocalFileReplay, Log, All );
+
+static TAutoConsoleVariable<float> CVarLocalFileReplayChunkSeconds( TEXT( "demo.LocalFileReplay.ChunkSeconds" ), 5.0f, TEXT( "Seconds of replay data the local file replay streamer buffers before writing a chunk. Live playback of a recording lags behind by up to this much." ) );
+
+static TAutoConsoleVariable<int32> CVarLocalFileReplayCompress( TEXT( "demo.LocalFileReplay.Compress" ), 1, TEXT( "Compress local file replay chunks with zlib." ) );
+
+static const uint32 LOCAL_REPLAY_FILE_MAGIC		= 0x1CA1F11E;
+static const uint32 LOCAL_REPLAY_FILE_VERSION	= 1;
+static const uint32 LOCAL_REPLAY_CHUNK_MAGIC	= 0x1CA1C4A7;
+static const uint32 LOCAL_REPLAY_TABLE_MAGIC	= 0x1CA17AB1;
+static const uint32 LOCAL_REPLAY_FOOTER_MAGIC	= 0x1CA1F007;
+
+/** Size of the magic and FLocalFileReplayChunk in front of each chunk */
+static const int64 LOCAL_REPLAY_CHUNK_HEADER_SIZE = 40;
+
+/** Size of the table offset and magic at the very end of finished replays */
+static const int64 LOCAL_REPLAY_FOOTER_SIZE = 12;
+
+/** Replay data is also written out once this much is pending, regardless of demo.LocalFileReplay.ChunkSeconds */
+static const int32 MAX_PENDING_STREAM_BYTES = 1024 * 1024;
+
+/**
+ * Read only memory mapping of a replay file, so opening a replay and seeking in it only touches the pages holding
+ * the chunk table and the chunks actually read. Platforms without mmap support read the whole file instead.
+ */
+class FLocalFileReplayMapping
+{
+public:
+	FLocalFileReplayMapping() :
+#if PLATFORM_WINDOWS
+		FileHandle( INVALID_HANDLE_VALUE ),
+		MappingHandle( NULL ),
+#elif PLATFORM_LINUX || PLATFORM_MAC
+		FileDescriptor( -1 ),
+#endif
+		Data( nullptr ),
+		Size( 0 )
+	{}
+
+	~FLocalFileReplayMapping()
+	{
+		Unmap();
+	}
+
+	/** Maps the whole file at its current size, replacing any previous mapping */
+	bool Map( const FString& Filename )
+	{
+		Unmap();
+
+		const FString FullFilename = FPaths::ConvertRelativePathToFull( Filename );
+
+#if PLATFORM_WINDOWS
+		// Share write access, live replays are still being recorded into
+		FileHandle = CreateFileW( *FullFilename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+		LARGE_INTEGER FileSize;
+
+		if ( FileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx( FileHandle, &FileSize ) )
+		{
+			Unmap();
+			return false;
+		}
+
+		Size = FileSize.QuadPart;
+
+		if ( Size > 0 )
+		{
+			MappingHandle = CreateFileMappingW( FileHandle, NULL, PAGE_READONLY, 0, 0, NULL );
+			Data = MappingHandle != NULL ? ( const uint8* )MapViewOfFile( MappingHandle, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+
+			if ( Data == nullptr )
+			{
+				Unmap();
+				return false;
+			}
+		}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+		FileDescriptor = open( TCHAR_TO_UTF8( *FullFilename ), O_RDONLY );
+
+		struct stat FileInfo;
+
+		if ( FileDescriptor == -1 || fstat( FileDescriptor, &FileInfo ) != 0 )
+		{
+			Unmap();
+			return false;
+		}
+
+		Size = FileInfo.st_size;
+
+		if ( Size > 0 )
+		{
+			void* MappedData = mmap( nullptr, Size, PROT_READ, MAP_SHARED, FileDescriptor, 0 );
+
+			if ( MappedData == MAP_FAILED )
+			{
+				Unmap();
+				return false;
+			}
+
+			Data = ( const uint8* )MappedData;
+		}
+#else
+		if ( !FFileHelper::LoadFileToArray( FallbackData, *FullFilename, FILEREAD_AllowWrite ) )
+		{
+			return false;
+		}
+
+		Data = FallbackData.GetData();
+		Size = FallbackData.Num();
+#endif
+
+		return true;
+	}
+
+	void Unmap()
+	{
+#if PLATFORM_WINDOWS
+		if ( Data != nullptr )
+		{
+			UnmapViewOfFile( Data );
+		}
+
+		if ( MappingHandle != NULL )
+		{
+			CloseHandle( MappingHandle );
+			MappingHandle = NULL;
+		}
+
+		if ( FileHandle != INVALID_HANDLE_VALUE )
+		{
+			CloseHandle( FileHandle );
+			FileHandle = INVALID_HANDLE_VALUE;
+		}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+		if ( Data != nullptr )
+		{
+			munmap( ( void* )Data, Size );
+		}
+
+		if ( FileDescriptor != -1 )
+		{
+			close( FileDescriptor );
+			FileDescriptor = -1;
+		}
+#else
+		FallbackData.Empty();
+#endif
+
+		Data = nullptr;
+		Size = 0;
+	}
+
+	const uint8* GetData() const
+	{
+		return Data;
+	}
+
+	int64 GetSize() const
+	{
+		return Size;
+	}
+
+private:
+#if PLATFORM_WINDOWS
+	HANDLE FileHandle;
+	HANDLE MappingHandle;
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	int FileDescriptor;
+#else
+	TArray<uint8> FallbackData;
+#endif
+
+	const uint8* Data;
+	int64 Size;
+};
+
+static FString GetStreamBaseFilename( const FString& StreamName )
+{
+	int32 Year, Month, DayOfWeek, Day, Hour, Min, Sec, MSec;
+	FPlatformTime::SystemTime( Year, Month, DayOfWeek, Day, Hour, Min, Sec, MSec );
+
+	FString DemoName = StreamName;
+
+	DemoName.ReplaceInline( TEXT( "%td" ), *FDateTime::Now().ToString() );
+	DemoName.ReplaceInline( TEXT( "%d" ), *FString::Printf( TEXT( "%i-%i-%i" ), Month, Day, Year ) );
+	DemoName.ReplaceInline( TEXT( "%t" ), *FString::Printf( TEXT( "%i" ), ( ( Hour * 3600 ) + ( Min * 60 ) + Sec ) * 1000 + MSec ) );
+	DemoName.ReplaceInline( TEXT( "%v" ), *FString::Printf( TEXT( "%i" ), FEngineVersion::Current().GetChangelist() ) );
+
+	// replace bad characters with underscores
+	DemoName.ReplaceInline( TEXT( "\\" ),	TEXT( "_" ) );
+	DemoName.ReplaceInline( TEXT( "/" ),	TEXT( "_" ) );
+	DemoName.ReplaceInline( TEXT( "." ),	TEXT( "_" ) );
+	DemoName.ReplaceInline( TEXT( " " ),	TEXT( "_" ) );
+	DemoName.ReplaceInline( TEXT( "%" ),	TEXT( "_" ) );
+
+	return DemoName;
+}
+
+static FString GetDemoPath()
+{
+	return FPaths::Combine( *FPaths::GameSavedDir(), TEXT( "Demos/" ) );
+}
+
+static FString GetReplayFilename( const FString& StreamName )
+{
+	return FPaths::Combine( *GetDemoPath(), *GetStreamBaseFilename( StreamName ) ) + TEXT( ".replay" );
+}
+
+// Returns a name formatted as "demoX", where X is 1-10.
+// Returns the first value that doesn't yet exist, or if they all exist, returns the oldest one
+// (it will be overwritten).
+static FString GetAutomaticDemoName()
+{
+	FString FinalDemoName;
+	FDateTime BestDateTime = FDateTime::MaxValue();
+
+	const int MAX_DEMOS = 10;
+
+	for ( int32 i = 0; i < MAX_DEMOS; i++ )
+	{
+		const FString DemoName = FString::Printf( TEXT( "demo%i" ), i + 1 );
+
+		FDateTime DateTime = IFileManager::Get().GetTimeStamp( *GetReplayFilename( DemoName ) );
+
+		if ( DateTime == FDateTime::MinValue() )
+		{
+			// If we don't find this file, we can early out now
+			FinalDemoName = DemoName;
+			break;
+		}
+		else if ( DateTime < BestDateTime )
+		{
+			// Use the oldest file
+			FinalDemoName = DemoName;
+			BestDateTime = DateTime;
+		}
+	}
+
+	return FinalDemoName;
+}
+
+static void AddChunkToIndex( FLocalFileReplayInfo& Info, const FLocalFileReplayChunk& Chunk )
+{
+	switch ( Chunk.Type )
+	{
+		case ELocalFileChunkType::Header:
+			Info.HeaderChunk = Chunk;
+			break;
+
+		case ELocalFileChunkType::ReplayData:
+			Info.DataChunks.Add( Chunk );
+			Info.LengthInMS = FMath::Max( Info.LengthInMS, Chunk.Time2 );
+			break;
+
+		case ELocalFileChunkType::Checkpoint:
+			Info.Checkpoints.Add( Chunk );
+			Info.LengthInMS = FMath::Max( Info.LengthInMS, Chunk.Time1 );
+			break;
+	}
+}
+
+/** Reads the chunk table at the end of a finished replay, returns false if the replay isn't finished */
+static bool ReadReplayChunkTable( const uint8* Data, const int64 Size, FLocalFileReplayInfo& Info )
+{
+	if ( Size < Info.ScanOffset + LOCAL_REPLAY_FOOTER_SIZE )
+	{
+		return false;
+	}
+
+	int64 TableOffset = 0;
+	uint32 FooterMagic = 0;
+
+	FBufferReader FooterReader( ( void* )( Data + Size - LOCAL_REPLAY_FOOTER_SIZE ), LOCAL_REPLAY_FOOTER_SIZE, false );
+	FooterReader << TableOffset << FooterMagic;
+
+	if ( FooterMagic != LOCAL_REPLAY_FOOTER_MAGIC || TableOffset < Info.ScanOffset || TableOffset > Size - LOCAL_REPLAY_FOOTER_SIZE )
+	{
+		return false;
+	}
+
+	FBufferReader TableReader( ( void* )( Data + TableOffset ), Size - LOCAL_REPLAY_FOOTER_SIZE - TableOffset, false );
+
+	uint32 TableMagic = 0;
+	uint32 LengthInMS = 0;
+	int32 NumChunks = 0;
+
+	TableReader << TableMagic << LengthInMS << NumChunks;
+
+	if ( TableMagic != LOCAL_REPLAY_TABLE_MAGIC || NumChunks < 0 || NumChunks > ( TableReader.TotalSize() - TableReader.Tell() ) / ( LOCAL_REPLAY_CHUNK_HEADER_SIZE - 4 ) )
+	{
+		return false;
+	}
+
+	Info.HeaderChunk = FLocalFileReplayChunk();
+	Info.DataChunks.Reset();
+	Info.Checkpoints.Reset();
+
+	for ( int32 i = 0; i < NumChunks; i++ )
+	{
+		FLocalFileReplayChunk Chunk;
+		TableReader << Chunk;
+		AddChunkToIndex( Info, Chunk );
+	}
+
+	if ( TableReader.IsError() )
+	{
+		return false;
+	}
+
+	Info.LengthInMS = LengthInMS;
+	Info.bIsLive = false;
+	Info.ScanOffset = TableOffset;
+
+	return true;
+}
+
+/**
+ * Reads the file header and indexes the chunks of a mapped replay file.
+ * Finished replays are indexed from their chunk table. Live replays are indexed by walking the chunk headers,
+ * and calling this again once the file has grown continues from the last complete chunk.
+ */
+static bool IndexReplayFile( const uint8* Data, const int64 Size, FLocalFileReplayInfo& Info )
+{
+	if ( !Info.bIsValid )
+	{
+		FBufferReader Reader( ( void* )Data, Size, false );
+
+		uint32 Magic = 0;
+		uint32 Version = 0;
+
+		Reader << Magic << Version;
+
+		if ( Reader.IsError() || Magic != LOCAL_REPLAY_FILE_MAGIC || Version != LOCAL_REPLAY_FILE_VERSION )
+		{
+			return false;
+		}
+
+		Reader << Info.NetworkVersion << Info.Changelist << Info.FriendlyName;
+
+		if ( Reader.IsError() )
+		{
+			return false;
+		}
+
+		Info.ScanOffset = Reader.Tell();
+		Info.bIsValid = true;
+
+		if ( ReadReplayChunkTable( Data, Size, Info ) )
+		{
+			return true;
+		}
+	}
+
+	while ( Info.bIsLive && Info.ScanOffset + LOCAL_REPLAY_CHUNK_HEADER_SIZE <= Size )
+	{
+		FBufferReader Reader( ( void* )( Data + Info.ScanOffset ), LOCAL_REPLAY_CHUNK_HEADER_SIZE, false );
+
+		uint32 Magic = 0;
+		FLocalFileReplayChunk Chunk;
+
+		Reader << Magic << Chunk;
+
+		if ( Magic == LOCAL_REPLAY_TABLE_MAGIC )
+		{
+			// The recording finished, switch to the chunk table once it's completely written
+			ReadReplayChunkTable( Data, Size, Info );
+			break;
+		}
+
+		if ( Magic != LOCAL_REPLAY_CHUNK_MAGIC || Chunk.DataOffset != Info.ScanOffset + LOCAL_REPLAY_CHUNK_HEADER_SIZE || Chunk.CompressedSize < 0 || Chunk.UncompressedSize < 0 )
+		{
+			UE_LOG( LogLocalFileReplay, Warning, TEXT( "IndexReplayFile: Invalid chunk at offset %lld" ), Info.ScanOffset );
+			break;
+		}
+
+		if ( Chunk.DataOffset + Chunk.CompressedSize > Size )
+		{
+			// Still being written
+			break;
+		}
+
+		AddChunkToIndex( Info, Chunk );
+
+		Info.ScanOffset = Chunk.DataOffset + Chunk.CompressedSize;
+	}
+
+	return true;
+}
+
+/** Maps a replay file just long enough to read its info */
+static bool ReadReplayFileInfo( const FString& Filename, FLocalFileReplayInfo& OutInfo )
+{
+	FLocalFileReplayMapping Mapping;
+
+	return Mapping.Map( Filename ) && IndexReplayFile( Mapping.GetData(), Mapping.GetSize(), OutInfo ) && OutInfo.bIsValid;
+}
+
+FLocalFileNetworkReplayStreamer::FLocalFileNetworkReplayStreamer() :
+	StreamerState( EStreamerState::Idle ),
+	bHeaderWritten( false ),
+	PendingStreamStartTimeInMS( 0 ),
+	LastStreamChunkTime( 0.0 ),
+	CachedChunkIndex( INDEX_NONE )
+{
+}
+
+FLocalFileNetworkReplayStreamer::~FLocalFileNetworkReplayStreamer()
+{
+}
+
+void FLocalFileNetworkReplayStreamer::StartStreaming( const FString& CustomName, const FString& FriendlyName, const TArray< FString >& UserNames, bool bRecord, const FNetworkReplayVersion& ReplayVersion, const FOnStreamReadyDelegate& Delegate )
+{
+	FString FinalDemoName = CustomName;
+
+	if ( CustomName.IsEmpty() )
+	{
+		if ( bRecord )
+		{
+			// If we're recording and the caller didn't provide a name, generate one automatically
+			FinalDemoName = GetAutomaticDemoName();
+		}
+		else
+		{
+			// Can't play a replay if the user didn't provide a name!
+			Delegate.ExecuteIfBound( false, bRecord );
+			return;
+		}
+	}
+
+	CurrentStreamName = FinalDemoName;
+	ReplayInfo = FLocalFileReplayInfo();
+	CachedChunkIndex = INDEX_NONE;
+
+	const FString Filename = GetReplayFilename( CurrentStreamName );
+
+	if ( !bRecord )
+	{
+		Mapping.Reset( new FLocalFileReplayMapping );
+
+		if ( !Mapping->Map( Filename ) || !IndexReplayFile( Mapping->GetData(), Mapping->GetSize(), ReplayInfo ) || !ReadChunk( ReplayInfo.HeaderChunk, HeaderData ) || HeaderData.Num() == 0 )
+		{
+			UE_LOG( LogLocalFileReplay, Warning, TEXT( "FLocalFileNetworkReplayStreamer::StartStreaming. Couldn't open replay %s" ), *Filename );
+			Mapping.Reset();
+			CurrentStreamName.Empty();
+			Delegate.ExecuteIfBound( false, bRecord );
+			return;
+		}
+
+		HeaderAr.Reset( new FMemoryReader( HeaderData ) );
+		StreamAr.Reset( new FLocalFileReplayStreamArchive( *this ) );
+		StreamAr->ArIsLoading = true;
+		StreamerState = EStreamerState::Playback;
+	}
+	else
+	{
+		IFileManager::Get().MakeDirectory( *GetDemoPath(), true );
+
+		// Overwrites any existing demo with this name
+		ReplayFileAr.Reset( IFileManager::Get().CreateFileWriter( *Filename, FILEWRITE_AllowRead ) );
+
+		if ( !ReplayFileAr.IsValid() )
+		{
+			CurrentStreamName.Empty();
+			Delegate.ExecuteIfBound( false, bRecord );
+			return;
+		}
+
+		ReplayInfo.NetworkVersion = ReplayVersion.NetworkVersion;
+		ReplayInfo.Changelist = ReplayVersion.Changelist;
+		ReplayInfo.FriendlyName = FriendlyName;
+		ReplayInfo.bIsValid = true;
+
+		uint32 Magic = LOCAL_REPLAY_FILE_MAGIC;
+		uint32 Version = LOCAL_REPLAY_FILE_VERSION;
+
+		*ReplayFileAr << Magic << Version << ReplayInfo.NetworkVersion << ReplayInfo.Changelist << ReplayInfo.FriendlyName;
+		ReplayFileAr->Flush();
+
+		HeaderData.Reset();
+		bHeaderWritten = false;
+		HeaderAr.Reset( new FMemoryWriter( HeaderData ) );
+
+		PendingStreamData.Reset();
+		PendingStreamStartTimeInMS = 0;
+		LastStreamChunkTime = FPlatformTime::Seconds();
+
+		StreamAr.Reset( new FLocalFileReplayStreamArchive( *this ) );
+		StreamAr->ArIsSaving = true;
+		StreamerState = EStreamerState::Recording;
+	}
+
+	// Notify immediately
+	Delegate.ExecuteIfBound( true, bRecord );
+}
+
+void FLocalFileNetworkReplayStreamer::StopStreaming()
+{
+	if ( StreamerState == EStreamerState::Recording )
+	{
+		FlushStreamChunk();
+
+		// Write the chunk table, so the replay can be opened without walking all the chunks
+		int64 TableOffset = ReplayFileAr->Tell();
+
+		uint32 TableMagic = LOCAL_REPLAY_TABLE_MAGIC;
+		int32 NumChunks = ( bHeaderWritten ? 1 : 0 ) + ReplayInfo.DataChunks.Num() + ReplayInfo.Checkpoints.Num();
+
+		*ReplayFileAr << TableMagic << ReplayInfo.LengthInMS << NumChunks;
+
+		if ( bHeaderWritten )
+		{
+			*ReplayFileAr << ReplayInfo.HeaderChunk;
+		}
+
+		for ( FLocalFileReplayChunk& Chunk : ReplayInfo.DataChunks )
+		{
+			*ReplayFileAr << Chunk;
+		}
+
+		for ( FLocalFileReplayChunk& Chunk : ReplayInfo.Checkpoints )
+		{
+			*ReplayFileAr << Chunk;
+		}
+
+		uint32 FooterMagic = LOCAL_REPLAY_FOOTER_MAGIC;
+
+		*ReplayFileAr << TableOffset << FooterMagic;
+	}
+
+	HeaderAr.Reset();
+	StreamAr.Reset();
+	CheckpointAr.Reset();
+	ReplayFileAr.Reset();
+	Mapping.Reset();
+
+	HeaderData.Empty();
+	CheckpointData.Empty();
+	PendingStreamData.Empty();
+	CachedChunkData.Empty();
+	CachedChunkIndex = INDEX_NONE;
+
+	CurrentStreamName.Empty();
+	StreamerState = EStreamerState::Idle;
+}
+
+FArchive* FLocalFileNetworkReplayStreamer::GetHeaderArchive()
+{
+	return HeaderAr.Get();
+}
+
+FArchive* FLocalFileNetworkReplayStreamer::GetStreamingArchive()
+{
+	return StreamAr.Get();
+}
+
+void FLocalFileNetworkReplayStreamer::UpdateTotalDemoTime( uint32 TimeInMS )
+{
+	check( StreamerState == EStreamerState::Recording );
+
+	ReplayInfo.LengthInMS = TimeInMS;
+}
+
+bool FLocalFileNetworkReplayStreamer::IsDataAvailable() const
+{
+	check( StreamerState == EStreamerState::Playback );
+
+	return StreamAr.IsValid() && StreamAr->Tell() < StreamAr->TotalSize();
+}
+
+bool FLocalFileNetworkReplayStreamer::IsLive() const
+{
+	return StreamerState == EStreamerState::Recording || ( StreamerState == EStreamerState::Playback && ReplayInfo.bIsLive );
+}
+
+void FLocalFileNetworkReplayStreamer::DeleteFinishedStream( const FString& StreamName, const FOnDeleteFinishedStreamComplete& Delegate ) const
+{
+	const FString Filename = GetReplayFilename( StreamName );
+
+	FLocalFileReplayInfo StoredReplayInfo;
+
+	// Live streams can't be deleted
+	if ( ReadReplayFileInfo( Filename, StoredReplayInfo ) && StoredReplayInfo.bIsLive )
+	{
+		UE_LOG( LogLocalFileReplay, Log, TEXT( "Can't delete network replay stream %s because it is live!" ), *StreamName );
+		Delegate.ExecuteIfBound( false );
+		return;
+	}
+
+	Delegate.ExecuteIfBound( IFileManager::Get().Delete( *Filename ) );
+}
+
+void FLocalFileNetworkReplayStreamer::EnumerateStreams( const FNetworkReplayVersion& ReplayVersion, const FString& UserString, const FString& MetaString, const FOnEnumerateStreamsComplete& Delegate )
+{
+	EnumerateStreams( ReplayVersion, UserString, MetaString, TArray< FString >(), Delegate );
+}
+
+void FLocalFileNetworkReplayStreamer::EnumerateStreams( const FNetworkReplayVersion& ReplayVersion, const FString& UserString, const FString& MetaString, const TArray< FString >& ExtraParms, const FOnEnumerateStreamsComplete& Delegate )
+{
+	// Returns a stream for each replay file in the Saved/Demos directory
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles( Filenames, *( GetDemoPath() + TEXT( "*.replay" ) ), true, false );
+
+	TArray<FNetworkReplayStreamInfo> Results;
+
+	for ( const FString& Filename : Filenames )
+	{
+		const FString FullFilename = FPaths::Combine( *GetDemoPath(), *Filename );
+
+		FLocalFileReplayInfo StoredReplayInfo;
+
+		if ( !ReadReplayFileInfo( FullFilename, StoredReplayInfo ) )
+		{
+			continue;
+		}
+
+		// Check version. NetworkVersion and changelist of 0 will ignore version check.
+		const bool NetworkVersionMatches = ReplayVersion.NetworkVersion == StoredReplayInfo.NetworkVersion;
+		const bool ChangelistMatches = ReplayVersion.Changelist == StoredReplayInfo.Changelist;
+
+		const bool NetworkVersionPasses = ReplayVersion.NetworkVersion == 0 || NetworkVersionMatches;
+		const bool ChangelistPasses = ReplayVersion.Changelist == 0 || ChangelistMatches;
+
+		if ( NetworkVersionPasses && ChangelistPasses )
+		{
+			FNetworkReplayStreamInfo Info;
+
+			Info.Name = FPaths::GetBaseFilename( Filename );
+			Info.FriendlyName = StoredReplayInfo.FriendlyName;
+			Info.Timestamp = IFileManager::Get().GetTimeStamp( *FullFilename );
+			Info.SizeInBytes = IFileManager::Get().FileSize( *FullFilename );
+			Info.LengthInMS = StoredReplayInfo.LengthInMS;
+			Info.Changelist = StoredReplayInfo.Changelist;
+			Info.bIsLive = StoredReplayInfo.bIsLive;
+
+			Results.Add( Info );
+		}
+	}
+
+	Delegate.ExecuteIfBound( Results );
+}
+
+void FLocalFileNetworkReplayStreamer::AddUserToReplay( const FString& UserString )
+{
+	UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::AddUserToReplay is currently unsupported." ) );
+}
+
+void FLocalFileNetworkReplayStreamer::AddEvent( const uint32 TimeInMS, const FString& Group, const FString& Meta, const TArray<uint8>& Data )
+{
+	UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::AddEvent is currently unsupported." ) );
+}
+
+void FLocalFileNetworkReplayStreamer::EnumerateEvents( const FString& Group, const FEnumerateEventsCompleteDelegate& EnumerationCompleteDelegate )
+{
+	UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::EnumerateEvents is currently unsupported." ) );
+}
+
+void FLocalFileNetworkReplayStreamer::RequestEventData( const FString& EventID, const FOnRequestEventDataComplete& RequestEventDataComplete )
+{
+	UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::RequestEventData is currently unsupported." ) );
+}
+
+void FLocalFileNetworkReplayStreamer::SearchEvents( const FString& EventGroup, const FOnEnumerateStreamsComplete& Delegate )
+{
+	UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::SearchEvents is currently unsupported." ) );
+}
+
+FArchive* FLocalFileNetworkReplayStreamer::GetCheckpointArchive()
+{
+	// If the archive is null, and the API is being used properly, the caller is writing a checkpoint...
+	if ( CheckpointAr.Get() == nullptr )
+	{
+		check( StreamerState == EStreamerState::Recording );
+
+		CheckpointData.Reset();
+		CheckpointAr.Reset( new FMemoryWriter( CheckpointData ) );
+	}
+
+	return CheckpointAr.Get();
+}
+
+void FLocalFileNetworkReplayStreamer::FlushCheckpoint( const uint32 TimeInMS )
+{
+	UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::FlushCheckpoint. TimeInMS: %u" ), TimeInMS );
+
+	check( StreamerState == EStreamerState::Recording );
+
+	CheckpointAr.Reset();
+
+	// Start a new data chunk at every checkpoint, so loading one only needs the data chunk it points at
+	FlushStreamChunk();
+
+	FLocalFileReplayChunk Chunk;
+	Chunk.Type = ELocalFileChunkType::Checkpoint;
+	Chunk.Time1 = TimeInMS;
+	Chunk.Time2 = TimeInMS;
+	Chunk.StreamOffset = StreamAr->Tell();
+
+	WriteChunk( Chunk, CheckpointData );
+	ReplayInfo.Checkpoints.Add( Chunk );
+
+	CheckpointData.Reset();
+}
+
+void FLocalFileNetworkReplayStreamer::GotoCheckpointIndex( const int32 CheckpointIndex, const FOnCheckpointReadyDelegate& Delegate )
+{
+	GotoCheckpointIndexInternal( CheckpointIndex, Delegate, -1 );
+}
+
+void FLocalFileNetworkReplayStreamer::GotoCheckpointIndexInternal( int32 CheckpointIndex, const FOnCheckpointReadyDelegate& Delegate, int32 TimeInMS )
+{
+	check( StreamAr.Get() != nullptr );
+
+	CheckpointAr.Reset();
+
+	if ( CheckpointIndex == -1 )
+	{
+		// Create a dummy checkpoint archive to indicate this is the first checkpoint
+		CheckpointAr.Reset( new FArchive );
+
+		StreamAr->Seek( 0 );
+
+		Delegate.ExecuteIfBound( true, TimeInMS );
+		return;
+	}
+
+	if ( !ReplayInfo.Checkpoints.IsValidIndex( CheckpointIndex ) || !ReadChunk( ReplayInfo.Checkpoints[CheckpointIndex], CheckpointData ) )
+	{
+		UE_LOG( LogLocalFileReplay, Log, TEXT( "FLocalFileNetworkReplayStreamer::GotoCheckpointIndex. Couldn't load checkpoint %i." ), CheckpointIndex );
+		Delegate.ExecuteIfBound( false, TimeInMS );
+		return;
+	}
+
+	CheckpointAr.Reset( new FMemoryReader( CheckpointData ) );
+
+	StreamAr->Seek( ReplayInfo.Checkpoints[CheckpointIndex].StreamOffset );
+
+	Delegate.ExecuteIfBound( true, TimeInMS );
+}
+
+void FLocalFileNetworkReplayStreamer::GotoTimeInMS( const uint32 TimeInMS, const FOnCheckpointReadyDelegate& Delegate )
+{
+	// Checkpoints are sorted by time, find the last one at or before the requested time
+	// For fine scrubbing, we'll fast forward the rest of the way
+	// NOTE - If we're before the very first checkpoint, we'll get -1, which is what we want when we want to start from the very beginning
+	int32 First = 0;
+	int32 Count = ReplayInfo.Checkpoints.Num();
+
+	while ( Count > 0 )
+	{
+		const int32 Step = Count / 2;
+
+		if ( ReplayInfo.Checkpoints[First + Step].Time1 <= TimeInMS )
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+
+	const int32 CheckpointIndex = First - 1;
+
+	int32 ExtraSkipTimeInMS = TimeInMS;
+
+	if ( CheckpointIndex >= 0 )
+	{
+		// Subtract off checkpoint time so we pass in the leftover to the engine to fast forward through for the fine scrubbing part
+		ExtraSkipTimeInMS = TimeInMS - ReplayInfo.Checkpoints[CheckpointIndex].Time1;
+	}
+
+	GotoCheckpointIndexInternal( CheckpointIndex, Delegate, ExtraSkipTimeInMS );
+}
+
+void FLocalFileNetworkReplayStreamer::WriteChunk( FLocalFileReplayChunk& Chunk, const TArray<uint8>& Data )
+{
+	check( ReplayFileAr.IsValid() );
+
+	Chunk.UncompressedSize = Data.Num();
+	Chunk.CompressedSize = Data.Num();
+
+	const uint8* DataToWrite = Data.GetData();
+
+	TArray<uint8> CompressedData;
+
+	if ( CVarLocalFileReplayCompress.GetValueOnGameThread() != 0 && Data.Num() > 0 )
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound( COMPRESS_ZLIB, Data.Num() );
+		CompressedData.SetNumUninitialized( CompressedSize );
+
+		// Keep the data uncompressed if it doesn't get any smaller, the sizes being equal is what marks a chunk as uncompressed
+		if ( FCompression::CompressMemory( COMPRESS_ZLIB, CompressedData.GetData(), CompressedSize, Data.GetData(), Data.Num() ) && CompressedSize < Data.Num() )
+		{
+			Chunk.CompressedSize = CompressedSize;
+			DataToWrite = CompressedData.GetData();
+		}
+	}
+
+	Chunk.DataOffset = ReplayFileAr->Tell() + LOCAL_REPLAY_CHUNK_HEADER_SIZE;
+
+	uint32 Magic = LOCAL_REPLAY_CHUNK_MAGIC;
+	*ReplayFileAr << Magic << Chunk;
+
+	check( ReplayFileAr->Tell() == Chunk.DataOffset );
+
+	ReplayFileAr->Serialize( ( void* )DataToWrite, Chunk.CompressedSize );
+	ReplayFileAr->Flush();
+}
+
+void FLocalFileNetworkReplayStreamer::FlushStreamChunk()
+{
+	// The header always comes first, so live playback can start as soon as there is any replay data
+	if ( !bHeaderWritten && HeaderData.Num() > 0 )
+	{
+		ReplayInfo.HeaderChunk.Type = ELocalFileChunkType::Header;
+		WriteChunk( ReplayInfo.HeaderChunk, HeaderData );
+		bHeaderWritten = true;
+	}
+
+	if ( PendingStreamData.Num() == 0 )
+	{
+		return;
+	}
+
+	FLocalFileReplayChunk Chunk;
+	Chunk.Type = ELocalFileChunkType::ReplayData;
+	Chunk.Time1 = PendingStreamStartTimeInMS;
+	Chunk.Time2 = ReplayInfo.LengthInMS;
+	Chunk.StreamOffset = ReplayInfo.GetStreamSize();
+
+	WriteChunk( Chunk, PendingStreamData );
+	ReplayInfo.DataChunks.Add( Chunk );
+
+	PendingStreamData.Reset();
+	PendingStreamStartTimeInMS = ReplayInfo.LengthInMS;
+	LastStreamChunkTime = FPlatformTime::Seconds();
+}
+
+void FLocalFileNetworkReplayStreamer::RefreshLiveReplay()
+{
+	const FString Filename = GetReplayFilename( CurrentStreamName );
+
+	if ( IFileManager::Get().FileSize( *Filename ) > Mapping->GetSize() )
+	{
+		if ( !Mapping->Map( Filename ) )
+		{
+			UE_LOG( LogLocalFileReplay, Warning, TEXT( "FLocalFileNetworkReplayStreamer::RefreshLiveReplay. Couldn't map %s" ), *Filename );
+			return;
+		}
+
+		IndexReplayFile( Mapping->GetData(), Mapping->GetSize(), ReplayInfo );
+	}
+}
+
+bool FLocalFileNetworkReplayStreamer::ReadChunk( const FLocalFileReplayChunk& Chunk, TArray<uint8>& OutData ) const
+{
+	if ( !Mapping.IsValid() || Chunk.DataOffset <= 0 || Chunk.DataOffset + Chunk.CompressedSize > Mapping->GetSize() )
+	{
+		return false;
+	}
+
+	const uint8* ChunkData = Mapping->GetData() + Chunk.DataOffset;
+
+	OutData.SetNumUninitialized( Chunk.UncompressedSize );
+
+	if ( Chunk.IsCompressed() )
+	{
+		return FCompression::UncompressMemory( COMPRESS_ZLIB, OutData.GetData(), Chunk.UncompressedSize, ChunkData, Chunk.CompressedSize );
+	}
+
+	FMemory::Memcpy( OutData.GetData(), ChunkData, Chunk.UncompressedSize );
+
+	return true;
+}
+
+int32 FLocalFileNetworkReplayStreamer::FindDataChunk( int64 StreamPosition ) const
+{
+	// Data chunks are contiguous and sorted by StreamOffset, find the last one starting at or before the position
+	int32 First = 0;
+	int32 Count = ReplayInfo.DataChunks.Num();
+
+	while ( Count > 0 )
+	{
+		const int32 Step = Count / 2;
+
+		if ( ReplayInfo.DataChunks[First + Step].StreamOffset <= StreamPosition )
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+
+	const int32 ChunkIndex = First - 1;
+
+	if ( ChunkIndex < 0 || StreamPosition >= ReplayInfo.DataChunks[ChunkIndex].StreamOffset + ReplayInfo.DataChunks[ChunkIndex].UncompressedSize )
+	{
+		return INDEX_NONE;
+	}
+
+	return ChunkIndex;
+}
+
+void FLocalFileNetworkReplayStreamer::Tick( float DeltaSeconds )
+{
+	// This relies on the fact that the DemoNetDriver isn't currently in the middle of its own tick,
+	// and has either read or written a whole demo frame.
+	if ( StreamerState == EStreamerState::Playback )
+	{
+		if ( ReplayInfo.bIsLive )
+		{
+			RefreshLiveReplay();
+		}
+	}
+	else if ( StreamerState == EStreamerState::Recording )
+	{
+		const bool bChunkTimeElapsed = FPlatformTime::Seconds() - LastStreamChunkTime >= CVarLocalFileReplayChunkSeconds.GetValueOnGameThread();
+
+		if ( ( !bHeaderWritten && HeaderData.Num() > 0 ) || ( PendingStreamData.Num() > 0 && bChunkTimeElapsed ) || PendingStreamData.Num() >= MAX_PENDING_STREAM_BYTES )
+		{
+			FlushStreamChunk();
+		}
+	}
+}
+
+TStatId FLocalFileNetworkReplayStreamer::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( FLocalFileNetworkReplayStreamer, STATGROUP_Tickables );
+}
+
+void FLocalFileReplayStreamArchive::Serialize( void* V, int64 Length )
+{
+	if ( IsLoading() )
+	{
+		if ( Pos + Length > TotalSize() )
+		{
+			ArIsError = true;
+			return;
+		}
+
+		uint8* Dest = ( uint8* )V;
+
+		// A single read can span chunks, chunks are cut wherever the recording was when they were written
+		while ( Length > 0 )
+		{
+			const TArray<FLocalFileReplayChunk>& DataChunks = Streamer.ReplayInfo.DataChunks;
+
+			if ( !DataChunks.IsValidIndex( Streamer.CachedChunkIndex ) || Pos < DataChunks[Streamer.CachedChunkIndex].StreamOffset || Pos >= DataChunks[Streamer.CachedChunkIndex].StreamOffset + DataChunks[Streamer.CachedChunkIndex].UncompressedSize )
+			{
+				const int32 ChunkIndex = Streamer.FindDataChunk( Pos );
+
+				if ( ChunkIndex == INDEX_NONE || !Streamer.ReadChunk( DataChunks[ChunkIndex], Streamer.CachedChunkData ) )
+				{
+					Streamer.CachedChunkIndex = INDEX_NONE;
+					ArIsError = true;
+					return;
+				}
+
+				Streamer.CachedChunkIndex = ChunkIndex;
+			}
+
+			const FLocalFileReplayChunk& Chunk = DataChunks[Streamer.CachedChunkIndex];
+
+			const int64 OffsetIntoChunk = Pos - Chunk.StreamOffset;
+			const int64 BytesToCopy = FMath::Min( Length, Chunk.UncompressedSize - OffsetIntoChunk );
+
+			FMemory::Memcpy( Dest, Streamer.CachedChunkData.GetData() + OffsetIntoChunk, BytesToCopy );
+
+			Dest += BytesToCopy;
+			Pos += BytesToCopy;
+			Length -= BytesToCopy;
+		}
+	}
+	else
+	{
+		check( Pos == TotalSize() );
+
+		Streamer.PendingStreamData.Append( ( const uint8* )V, Length );
+
+		Pos += Length;
+	}
+}
+
+int64 FLocalFileReplayStreamArchive::Tell()
+{
+	return Pos;
+}
+
+int64 FLocalFileReplayStreamArchive::TotalSize()
+{
+	return Streamer.ReplayInfo.GetStreamSize() + Streamer.PendingStreamData.Num();
+}
+
+void FLocalFileReplayStreamArchive::Seek( int64 InPos )
+{
+	check( InPos <= TotalSize() );
+	check( IsLoading() || InPos == TotalSize() );
+
+	Pos = InPos;
+}
+
+bool FLocalFileReplayStreamArchive::AtEnd()
+{
+	return Pos >= TotalSize();
+}
+
+IMPLEMENT_MODULE( FLocalFileNetworkReplayStreamingFactory, LocalFileNetworkReplayStreaming )
+
+TSharedPtr< INetworkReplayStreamer > FLocalFileNetworkReplayStreamingFactory::CreateReplayStreamer()
+{
+	return TSharedPtr< INetworkReplayStreamer >( new FLocalFileNetworkReplayStreamer );
+}
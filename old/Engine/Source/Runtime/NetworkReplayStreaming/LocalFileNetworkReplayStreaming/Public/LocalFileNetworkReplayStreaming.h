@@ -0,0 +1,229 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Serialization/Archive.h"
+#include "NetworkReplayStreaming.h"
+#include "Tickable.h"
+
+class FNetworkReplayVersion;
+class FLocalFileReplayMapping;
+class FLocalFileNetworkReplayStreamer;
+
+namespace ELocalFileChunkType
+{
+	enum Type
+	{
+		Header,				// The demo header, written once
+		ReplayData,			// A piece of the replay stream
+		Checkpoint,			// A checkpoint and where in the replay stream it was taken
+	};
+}
+
+/**
+ * Describes one chunk of a local replay file. Written in front of every chunk, and again in the chunk table
+ * at the end of finished replays so they can be opened without walking the chunks.
+ */
+struct FLocalFileReplayChunk
+{
+	FLocalFileReplayChunk() : Type( 0 ), Time1( 0 ), Time2( 0 ), StreamOffset( 0 ), DataOffset( 0 ), UncompressedSize( 0 ), CompressedSize( 0 ) {}
+
+	uint32		Type;				// ELocalFileChunkType
+	uint32		Time1;				// ReplayData: demo time of the first frame. Checkpoint: time of the checkpoint
+	uint32		Time2;				// ReplayData: demo time after the last frame
+	int64		StreamOffset;		// ReplayData: position of the first byte in the replay stream. Checkpoint: stream position to resume playback from
+	int64		DataOffset;			// Position of the chunk data in the file
+	int32		UncompressedSize;
+	int32		CompressedSize;		// Same as UncompressedSize if the data is stored uncompressed
+
+	bool IsCompressed() const
+	{
+		return CompressedSize != UncompressedSize;
+	}
+
+	friend FArchive& operator<<( FArchive& Ar, FLocalFileReplayChunk& Chunk )
+	{
+		Ar << Chunk.Type << Chunk.Time1 << Chunk.Time2 << Chunk.StreamOffset << Chunk.DataOffset << Chunk.UncompressedSize << Chunk.CompressedSize;
+		return Ar;
+	}
+};
+
+/* Metadata and chunk index of a local replay file */
+struct FLocalFileReplayInfo
+{
+	FLocalFileReplayInfo() : NetworkVersion( 0 ), Changelist( 0 ), LengthInMS( 0 ), bIsLive( true ), bIsValid( false ), ScanOffset( 0 ) {}
+
+	uint32			NetworkVersion;
+	uint32			Changelist;
+	FString			FriendlyName;
+	uint32			LengthInMS;
+	bool			bIsLive;			// True until the chunk table has been written at the end of the file
+	bool			bIsValid;
+
+	FLocalFileReplayChunk			HeaderChunk;
+	TArray<FLocalFileReplayChunk>	DataChunks;			// Sorted by StreamOffset
+	TArray<FLocalFileReplayChunk>	Checkpoints;		// Sorted by Time1
+
+	/** File position of the next chunk to read when walking the chunks of a live replay */
+	int64			ScanOffset;
+
+	int64 GetStreamSize() const
+	{
+		return DataChunks.Num() > 0 ? DataChunks.Last().StreamOffset + DataChunks.Last().UncompressedSize : 0;
+	}
+};
+
+/**
+ * Reads and writes the replay stream. When recording, data goes into a pending buffer the streamer writes out as
+ * ReplayData chunks. When playing, the chunk containing the current position is found with a binary search and
+ * decompressed from the mapped file.
+ */
+class FLocalFileReplayStreamArchive : public FArchive
+{
+public:
+	FLocalFileReplayStreamArchive( FLocalFileNetworkReplayStreamer& InStreamer )
+		: Pos( 0 )
+		, Streamer( InStreamer )
+	{}
+
+	virtual void	Serialize( void* V, int64 Length ) override;
+	virtual int64	Tell() override;
+	virtual int64	TotalSize() override;
+	virtual void	Seek( int64 InPos ) override;
+	virtual bool	AtEnd() override;
+
+private:
+	int64 Pos;
+	FLocalFileNetworkReplayStreamer& Streamer;
+};
+
+/**
+ * Streamer that records each replay to a single file in Saved/Demos as a series of chunks.
+ * Replay data is written as ReplayData chunks every few seconds and at every checkpoint, each optionally compressed.
+ * Finished replays end with a table of all chunks, so opening one and seeking to any time is a binary search
+ * over the checkpoints plus decompressing one checkpoint and one data chunk, all read through a memory mapping.
+ * Select with DefaultFactoryName=LocalFileNetworkReplayStreaming in the [NetworkReplayStreaming] section of the engine ini.
+ */
+class FLocalFileNetworkReplayStreamer : public INetworkReplayStreamer, public FTickableGameObject
+{
+	friend class FLocalFileReplayStreamArchive;
+
+public:
+	FLocalFileNetworkReplayStreamer();
+	virtual ~FLocalFileNetworkReplayStreamer();
+
+	/** INetworkReplayStreamer implementation */
+	virtual void StartStreaming( const FString& CustomName, const FString& FriendlyName, const TArray< FString >& UserNames, bool bRecord, const FNetworkReplayVersion& ReplayVersion, const FOnStreamReadyDelegate& Delegate ) override;
+	virtual void StopStreaming() override;
+	virtual FArchive* GetHeaderArchive() override;
+	virtual FArchive* GetStreamingArchive() override;
+	virtual FArchive* GetCheckpointArchive() override;
+	virtual void FlushCheckpoint( const uint32 TimeInMS ) override;
+	virtual void GotoCheckpointIndex( const int32 CheckpointIndex, const FOnCheckpointReadyDelegate& Delegate ) override;
+	virtual void GotoTimeInMS( const uint32 TimeInMS, const FOnCheckpointReadyDelegate& Delegate ) override;
+	virtual void UpdateTotalDemoTime( uint32 TimeInMS ) override;
+	virtual uint32 GetTotalDemoTime() const override { return ReplayInfo.LengthInMS; }
+	virtual bool IsDataAvailable() const override;
+	virtual void SetHighPriorityTimeRange( const uint32 StartTimeInMS, const uint32 EndTimeInMS ) override { }
+	virtual bool IsDataAvailableForTimeRange( const uint32 StartTimeInMS, const uint32 EndTimeInMS ) override { return true; }
+	virtual bool IsLoadingCheckpoint() const override { return false; }
+	virtual bool IsLive() const override;
+	virtual void DeleteFinishedStream( const FString& StreamName, const FOnDeleteFinishedStreamComplete& Delegate) const override;
+	virtual void EnumerateStreams( const FNetworkReplayVersion& ReplayVersion, const FString& UserString, const FString& MetaString, const FOnEnumerateStreamsComplete& Delegate ) override;
+	virtual void EnumerateStreams( const FNetworkReplayVersion& InReplayVersion, const FString& UserString, const FString& MetaString, const TArray< FString >& ExtraParms, const FOnEnumerateStreamsComplete& Delegate ) override;
+	virtual void EnumerateRecentStreams( const FNetworkReplayVersion& ReplayVersion, const FString& RecentViewer, const FOnEnumerateStreamsComplete& Delegate ) override {}
+	virtual ENetworkReplayError::Type GetLastError() const override { return ENetworkReplayError::None; }
+	virtual void AddUserToReplay(const FString& UserString) override;
+	virtual void AddEvent(const uint32 TimeInMS, const FString& Group, const FString& Meta, const TArray<uint8>& Data) override;
+	virtual void AddOrUpdateEvent( const FString& Name, const uint32 TimeInMS, const FString& Group, const FString& Meta, const TArray<uint8>& Data ) override {}
+	virtual void EnumerateEvents( const FString& Group, const FEnumerateEventsCompleteDelegate& EnumerationCompleteDelegate ) override;
+	virtual void EnumerateEvents( const FString& ReplayName, const FString& Group, const FEnumerateEventsCompleteDelegate& EnumerationCompleteDelegate ) override {}
+	virtual void RequestEventData(const FString& EventID, const FOnRequestEventDataComplete& RequestEventDataComplete) override;
+	virtual void SearchEvents(const FString& EventGroup, const FOnEnumerateStreamsComplete& Delegate) override;
+	virtual void KeepReplay( const FString& ReplayName, const bool bKeep ) override {}
+	virtual FString	GetReplayID() const override { return TEXT( "" ); }
+	virtual void SetTimeBufferHintSeconds(const float InTimeBufferHintSeconds) override {}
+	virtual void RefreshHeader() override {};
+
+	/** FTickableObjectBase implementation */
+	virtual void Tick(float DeltaSeconds) override;
+	virtual bool IsTickable() const override { return true; }
+	virtual TStatId GetStatId() const override;
+
+	/** FTickableGameObject implementation */
+	virtual bool IsTickableWhenPaused() const override { return true; }
+
+private:
+	/** Handles the details of loading a checkpoint */
+	void GotoCheckpointIndexInternal( int32 CheckpointIndex, const FOnCheckpointReadyDelegate& Delegate, int32 TimeInMS );
+
+	/** Writes a chunk (compressing it if enabled) to the end of the replay file */
+	void WriteChunk( FLocalFileReplayChunk& Chunk, const TArray<uint8>& Data );
+
+	/** Writes the replay data recorded since the last chunk as a new ReplayData chunk */
+	void FlushStreamChunk();
+
+	/** Remaps the replay file if a live recording has grown, and indexes the new chunks */
+	void RefreshLiveReplay();
+
+	/** Reads the chunk's data out of the mapped file, returns false if it isn't mapped or fails to decompress */
+	bool ReadChunk( const FLocalFileReplayChunk& Chunk, TArray<uint8>& OutData ) const;
+
+	/** Returns the index of the data chunk containing the given stream position, or INDEX_NONE */
+	int32 FindDataChunk( int64 StreamPosition ) const;
+
+	/** Overall state of the streamer */
+	enum class EStreamerState
+	{
+		Idle,					// The streamer is idle. Either we haven't started streaming yet, or we are done
+		Recording,				// We are in the process of recording a replay to disk
+		Playback,				// We are in the process of playing a replay from disk
+	};
+
+	EStreamerState StreamerState;
+
+	/** Remember the name of the current stream, if any. */
+	FString CurrentStreamName;
+
+	/** Currently playing or recording replay metadata and chunk index */
+	FLocalFileReplayInfo ReplayInfo;
+
+	/** Archive the demo header is written to or read from */
+	TUniquePtr<FArchive> HeaderAr;
+
+	/** Archive over the replay stream */
+	TUniquePtr<FLocalFileReplayStreamArchive> StreamAr;
+
+	/** Archive the current checkpoint is written to or read from */
+	TUniquePtr<FArchive> CheckpointAr;
+
+	/** Recording: the replay file */
+	TUniquePtr<FArchive> ReplayFileAr;
+
+	/** Playback: the mapped replay file */
+	TUniquePtr<FLocalFileReplayMapping> Mapping;
+
+	/** Recording: the demo header until it is written out on the first tick. Playback: the demo header */
+	TArray<uint8> HeaderData;
+	bool bHeaderWritten;
+
+	/** Recording: the checkpoint being written. Playback: the loaded checkpoint */
+	TArray<uint8> CheckpointData;
+
+	/** Recording: replay data not written to a chunk yet */
+	TArray<uint8> PendingStreamData;
+	uint32 PendingStreamStartTimeInMS;
+	double LastStreamChunkTime;
+
+	/** Playback: the decompressed data chunk the stream archive is reading from */
+	TArray<uint8> CachedChunkData;
+	int32 CachedChunkIndex;
+};
+
+class FLocalFileNetworkReplayStreamingFactory : public INetworkReplayStreamingFactory
+{
+public:
+	virtual TSharedPtr< INetworkReplayStreamer > CreateReplayStreamer();
+};
@@ -2,6 +2,7 @@
 
 #include "IPlatformFilePak.h"
 #include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
 #include "Misc/CoreMisc.h"
 #include "Misc/CommandLine.h"
 #include "Async/AsyncWork.h"
@@ -22,6 +23,14 @@
 #include "Templates/Greater.h"
 #include "Serialization/ArchiveProxy.h"
 
+#if PLATFORM_LINUX
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+#endif
+
 DEFINE_LOG_CATEGORY(LogPakFile);
 
 DEFINE_STAT(STAT_PakFile_Read);
@@ -3441,6 +3450,357 @@ bool FPakPlatformFile::IsNonPakFilenameAllowed(const FString& InFilename)
 }
 
 
+static int32 GPakBlockCache_Enable = 1;
+static FAutoConsoleVariableRef CVar_PakBlockCacheEnable(
+	TEXT("pakblockcache.Enable"),
+	GPakBlockCache_Enable,
+	TEXT("If > 0, synchronous pak reads go through a block cache shared by all handles.")
+	);
+
+static int32 GPakBlockCache_SizeMB = 32;
+static FAutoConsoleVariableRef CVar_PakBlockCacheSizeMB(
+	TEXT("pakblockcache.SizeMB"),
+	GPakBlockCache_SizeMB,
+	TEXT("Maximum size (in MB) of the pak block cache, least recently used blocks are dropped first.")
+	);
+
+static int32 GPakBlockCache_ReadAheadBlocks = 4;
+static FAutoConsoleVariableRef CVar_PakBlockCacheReadAheadBlocks(
+	TEXT("pakblockcache.ReadAheadBlocks"),
+	GPakBlockCache_ReadAheadBlocks,
+	TEXT("Number of extra blocks read in the same request when a thread reads a pak sequentially.")
+	);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("PakBlockCache Hits"), STAT_PakBlockCache_Hits, STATGROUP_PakFile);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("PakBlockCache Misses"), STAT_PakBlockCache_Misses, STATGROUP_PakFile);
+DECLARE_MEMORY_STAT(TEXT("PakBlockCache Current"), STAT_PakBlockCacheMem, STATGROUP_Memory);
+
+/** Size of the blocks in the pak block cache, offsets in the pak are cached in aligned blocks of this size */
+#define PAK_BLOCK_CACHE_BLOCK_SIZE (64 * 1024)
+/** Reads at least this big go straight to the pak file, they are usually bulk data read once */
+#define PAK_BLOCK_CACHE_MAX_CACHED_READ (256 * 1024)
+
+/**
+ * LRU cache of pak file blocks shared by all pak files, handles and threads.
+ * Small scattered reads (package summaries, export tables, the alignment reads of encrypted files) that land in the
+ * same block only cost one IO, and sequential reads are turned into fewer, bigger requests.
+ * IO happens outside the lock, on the calling thread's own pak reader.
+ */
+class FPakBlockCache
+{
+public:
+	static FPakBlockCache& Get()
+	{
+		static FPakBlockCache Singleton;
+		return Singleton;
+	}
+
+	FPakBlockCache()
+		: LruHead(nullptr)
+		, LruTail(nullptr)
+		, CachedBytes(0)
+		, NumHits(0)
+		, NumMisses(0)
+	{}
+
+	/**
+	 * Reads from the pak through the cache.
+	 *
+	 * @param PakFile Pak file the reader belongs to.
+	 * @param Reader The calling thread's reader for the pak, used to read missing blocks.
+	 * @param PakSize Size of the pak.
+	 * @param Offset Offset in the pak to read from.
+	 * @param Dest Where to copy the data to.
+	 * @param Length Bytes to read.
+	 * @param InOutNextBlock Block after the reader's previous read, reading it again is sequential and reads ahead.
+	 * @return false if reading the pak failed, Reader has its error set then and nothing was cached.
+	 */
+	bool Read(const FPakFile* PakFile, FArchive& Reader, int64 PakSize, int64 Offset, uint8* Dest, int64 Length, int64& InOutNextBlock)
+	{
+		while (Length > 0)
+		{
+			const int64 BlockIndex = Offset / PAK_BLOCK_CACHE_BLOCK_SIZE;
+			const int64 OffsetInBlock = Offset - BlockIndex * PAK_BLOCK_CACHE_BLOCK_SIZE;
+
+			FBlockRef Block = FindBlock(PakFile, BlockIndex);
+
+			if (!Block.IsValid())
+			{
+				// Read every block the rest of the request needs at once, plus the read ahead if this continues the last read
+				int64 LastBlock = (Offset + Length - 1) / PAK_BLOCK_CACHE_BLOCK_SIZE;
+				if (BlockIndex == InOutNextBlock)
+				{
+					LastBlock += FMath::Max(GPakBlockCache_ReadAheadBlocks, 0);
+				}
+				LastBlock = FMath::Min(LastBlock, (PakSize - 1) / PAK_BLOCK_CACHE_BLOCK_SIZE);
+
+				const int64 ReadStart = BlockIndex * PAK_BLOCK_CACHE_BLOCK_SIZE;
+				const int64 ReadSize = FMath::Min((LastBlock + 1) * PAK_BLOCK_CACHE_BLOCK_SIZE, PakSize) - ReadStart;
+
+				TArray<uint8> Buffer;
+				Buffer.SetNumUninitialized(ReadSize);
+				Reader.Seek(ReadStart);
+				Reader.Serialize(Buffer.GetData(), ReadSize);
+				if (Reader.IsError())
+				{
+					// Never cache a failed or short read, every handle would copy the garbage from then on
+					return false;
+				}
+
+				Block = AddBlocks(PakFile, BlockIndex, Buffer);
+			}
+
+			const int64 CopySize = FMath::Min(Length, Block->Data.Num() - OffsetInBlock);
+			if (CopySize <= 0)
+			{
+				// Read past the end of the pak
+				Reader.SetError();
+				return false;
+			}
+			FMemory::Memcpy(Dest, Block->Data.GetData() + OffsetInBlock, CopySize);
+
+			Dest += CopySize;
+			Offset += CopySize;
+			Length -= CopySize;
+			InOutNextBlock = BlockIndex + 1;
+		}
+		return true;
+	}
+
+	/** Drops all blocks of an unmounted pak */
+	void RemovePak(const FPakFile* PakFile)
+	{
+		FScopeLock ScopedLock(&CriticalSection);
+		for (auto It = Blocks.CreateIterator(); It; ++It)
+		{
+			if (It.Key().PakFile == PakFile)
+			{
+				CachedBytes -= It.Value()->Data.Num();
+				Unlink(It.Value().Get());
+				It.RemoveCurrent();
+			}
+		}
+		SET_MEMORY_STAT(STAT_PakBlockCacheMem, CachedBytes);
+	}
+
+	void GetStats(int64& OutCachedBytes, int64& OutNumHits, int64& OutNumMisses)
+	{
+		FScopeLock ScopedLock(&CriticalSection);
+		OutCachedBytes = CachedBytes;
+		OutNumHits = NumHits;
+		OutNumMisses = NumMisses;
+	}
+
+private:
+	struct FBlockKey
+	{
+		const FPakFile* PakFile;
+		int64 BlockIndex;
+
+		bool operator==(const FBlockKey& Other) const
+		{
+			return PakFile == Other.PakFile && BlockIndex == Other.BlockIndex;
+		}
+
+		friend uint32 GetTypeHash(const FBlockKey& Key)
+		{
+			return HashCombine(PointerHash(Key.PakFile), GetTypeHash(Key.BlockIndex));
+		}
+	};
+
+	struct FBlock
+	{
+		TArray<uint8> Data;
+		FBlockKey Key;
+		/** Neighbours in the LRU list, towards the most and the least recently used block. Only valid while cached. */
+		FBlock* LruPrev;
+		FBlock* LruNext;
+	};
+
+	/** Blocks are reference counted so they can be copied from outside the lock while another thread evicts them */
+	typedef TSharedPtr<FBlock, ESPMode::ThreadSafe> FBlockRef;
+
+	FBlockRef FindBlock(const FPakFile* PakFile, int64 BlockIndex)
+	{
+		FScopeLock ScopedLock(&CriticalSection);
+		FBlockKey Key = { PakFile, BlockIndex };
+		FBlockRef* Found = Blocks.Find(Key);
+		if (Found)
+		{
+			Unlink(Found->Get());
+			LinkHead(Found->Get());
+			NumHits++;
+			INC_DWORD_STAT(STAT_PakBlockCache_Hits);
+			return *Found;
+		}
+		NumMisses++;
+		INC_DWORD_STAT(STAT_PakBlockCache_Misses);
+		return FBlockRef();
+	}
+
+	/** Splits the data read from FirstBlockIndex on into blocks and caches them, returns the first one */
+	FBlockRef AddBlocks(const FPakFile* PakFile, int64 FirstBlockIndex, const TArray<uint8>& Data)
+	{
+		FBlockRef FirstBlock;
+
+		FScopeLock ScopedLock(&CriticalSection);
+		for (int64 Start = 0; Start < Data.Num(); Start += PAK_BLOCK_CACHE_BLOCK_SIZE)
+		{
+			FBlockKey Key = { PakFile, FirstBlockIndex + Start / PAK_BLOCK_CACHE_BLOCK_SIZE };
+
+			FBlockRef Block = MakeShareable(new FBlock);
+			Block->Data.Append(Data.GetData() + Start, FMath::Min<int64>(PAK_BLOCK_CACHE_BLOCK_SIZE, Data.Num() - Start));
+			Block->Key = Key;
+
+			FBlockRef& Slot = Blocks.FindOrAdd(Key);
+			if (Slot.IsValid())
+			{
+				// Another thread read it meanwhile
+				CachedBytes -= Slot->Data.Num();
+				Unlink(Slot.Get());
+			}
+			Slot = Block;
+			LinkHead(Block.Get());
+			CachedBytes += Block->Data.Num();
+
+			if (!FirstBlock.IsValid())
+			{
+				FirstBlock = Block;
+			}
+		}
+
+		// Drop the least recently used blocks until we fit in the budget again
+		const int64 MaxCachedBytes = int64(FMath::Max(GPakBlockCache_SizeMB, 1)) * 1024 * 1024;
+		while (CachedBytes > MaxCachedBytes && LruTail != LruHead)
+		{
+			FBlock* Oldest = LruTail;
+			const FBlockKey OldestKey = Oldest->Key;
+			CachedBytes -= Oldest->Data.Num();
+			Unlink(Oldest);
+			Blocks.Remove(OldestKey);
+		}
+		SET_MEMORY_STAT(STAT_PakBlockCacheMem, CachedBytes);
+
+		return FirstBlock;
+	}
+
+	/** Makes a block the most recently used one, must not be linked */
+	void LinkHead(FBlock* Block)
+	{
+		Block->LruPrev = nullptr;
+		Block->LruNext = LruHead;
+		if (LruHead)
+		{
+			LruHead->LruPrev = Block;
+		}
+		else
+		{
+			LruTail = Block;
+		}
+		LruHead = Block;
+	}
+
+	void Unlink(FBlock* Block)
+	{
+		if (Block->LruPrev)
+		{
+			Block->LruPrev->LruNext = Block->LruNext;
+		}
+		else
+		{
+			LruHead = Block->LruNext;
+		}
+		if (Block->LruNext)
+		{
+			Block->LruNext->LruPrev = Block->LruPrev;
+		}
+		else
+		{
+			LruTail = Block->LruPrev;
+		}
+		Block->LruPrev = nullptr;
+		Block->LruNext = nullptr;
+	}
+
+	FCriticalSection CriticalSection;
+	TMap<FBlockKey, FBlockRef> Blocks;
+	/** Cached blocks from the most (head) to the least (tail) recently used, evicted from the tail */
+	FBlock* LruHead;
+	FBlock* LruTail;
+	int64 CachedBytes;
+	int64 NumHits;
+	int64 NumMisses;
+};
+
+/**
+ * FPakBlockCachingArchive - per thread pak reader that reads through FPakBlockCache
+ */
+class FPakBlockCachingArchive : public FArchive
+{
+public:
+	FPakBlockCachingArchive(FArchive* InReader, const FPakFile* InPakFile)
+		: Reader(InReader)
+		, PakFile(InPakFile)
+		, PakSize(InReader->TotalSize())
+		, Pos(0)
+		, NextBlock(INDEX_NONE)
+	{
+		ArIsLoading = true;
+	}
+
+	virtual ~FPakBlockCachingArchive()
+	{
+		delete Reader;
+	}
+
+	//~ Begin FArchive Interface
+	virtual void Serialize(void* Data, int64 Length) override
+	{
+		if (!GPakBlockCache_Enable || Length >= PAK_BLOCK_CACHE_MAX_CACHED_READ)
+		{
+			Reader->Seek(Pos);
+			Reader->Serialize(Data, Length);
+		}
+		else
+		{
+			if (!FPakBlockCache::Get().Read(PakFile, *Reader, PakSize, Pos, (uint8*)Data, Length, NextBlock))
+			{
+				ArIsError = true;
+			}
+		}
+		Pos += Length;
+		if (Reader->IsError())
+		{
+			ArIsError = true;
+		}
+	}
+	virtual void Seek(int64 InPos) override
+	{
+		Pos = InPos;
+	}
+	virtual int64 Tell() override
+	{
+		return Pos;
+	}
+	virtual int64 TotalSize() override
+	{
+		return PakSize;
+	}
+	virtual FString GetArchiveName() const override
+	{
+		return Reader->GetArchiveName();
+	}
+	//~ End FArchive Interface
+
+private:
+	FArchive* Reader;
+	const FPakFile* PakFile;
+	int64 PakSize;
+	int64 Pos;
+	/** Block following the last read, to detect sequential reads */
+	int64 NextBlock;
+};
+
 #if IS_PROGRAM
 FPakFile::FPakFile(const TCHAR* Filename, bool bIsSigned)
 	: PakFilename(Filename)
@@ -3484,6 +3844,7 @@ FPakFile::FPakFile(FArchive* Archive)
 
 FPakFile::~FPakFile()
 {
+	FPakBlockCache::Get().RemovePak(this);
 }
 
 FArchive* FPakFile::CreatePakReader(const TCHAR* Filename)
@@ -3748,6 +4109,7 @@ FArchive* FPakFile::GetSharedReader(IPlatformFile* LowerLevel)
 		{
 			UE_LOG(LogPakFile, Fatal, TEXT("Unable to create pak \"%s\" handle"), *GetFilename());
 		}
+		PakReader = new FPakBlockCachingArchive(PakReader, this);
 		{
 			FScopeLock ScopedLock(&CriticalSection);
 #if DO_CHECK
@@ -3789,6 +4151,11 @@ public:
 			PlatformFile.HandlePakListCommand(Cmd, Ar);
 			return true;
 		}
+		else if (FParse::Command(&Cmd, TEXT("PakBenchOpenLog")))
+		{
+			PlatformFile.HandlePakBenchOpenLogCommand(Cmd, Ar);
+			return true;
+		}
 		return false;
 	}
 };
@@ -3822,11 +4189,73 @@ void FPakPlatformFile::HandlePakListCommand(const TCHAR* Cmd, FOutputDevice& Ar)
 		Ar.Logf(TEXT("%s Mounted to %s"), *Pak.PakFile->GetFilename(), *Pak.PakFile->GetMountPoint());
 	}	
 }
+
+void FPakPlatformFile::HandlePakBenchOpenLogCommand(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	const FString LogFilename = FParse::Token(Cmd, false);
+	const FString ReadSizeString = FParse::Token(Cmd, false);
+	const int32 ReadSize = ReadSizeString.IsEmpty() ? 16 * 1024 : FMath::Max(FCString::Atoi(*ReadSizeString), 1);
+
+	TArray<FString> Lines;
+	if (LogFilename.IsEmpty() || !FFileHelper::LoadANSITextFileToStrings(*LogFilename, NULL, Lines))
+	{
+		Ar.Logf(TEXT("Usage: PakBenchOpenLog <GameOpenOrder.log written by -fileopenlog> [ReadSize]"));
+		return;
+	}
+
+	int64 StartCachedBytes, StartHits, StartMisses;
+	FPakBlockCache::Get().GetStats(StartCachedBytes, StartHits, StartMisses);
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(ReadSize);
+
+	int32 NumFiles = 0;
+	int64 NumBytes = 0;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Open and read the files in the logged order, in ReadSize pieces like the loader's small reads
+	for (const FString& Line : Lines)
+	{
+		const TCHAR* LineText = *Line;
+		const FString Filename = FParse::Token(LineText, false);
+
+		FPakFile* PakFile = NULL;
+		const FPakEntry* FileEntry = Filename.IsEmpty() ? NULL : FindFileInPakFiles(*Filename, &PakFile);
+		if (FileEntry == NULL)
+		{
+			continue;
+		}
+
+		TUniquePtr<IFileHandle> Handle(CreatePakFileHandle(*Filename, PakFile, FileEntry));
+		for (int64 Remaining = Handle->Size(); Remaining > 0; )
+		{
+			const int64 BytesToRead = FMath::Min<int64>(Remaining, ReadSize);
+			if (!Handle->Read(Buffer.GetData(), BytesToRead))
+			{
+				Ar.Logf(TEXT("PakBenchOpenLog: Failed to read %s"), *Filename);
+				break;
+			}
+			Remaining -= BytesToRead;
+			NumBytes += BytesToRead;
+		}
+		NumFiles++;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	int64 CachedBytes, Hits, Misses;
+	FPakBlockCache::Get().GetStats(CachedBytes, Hits, Misses);
+
+	Ar.Logf(TEXT("PakBenchOpenLog: %d files, %.2f MB in %.3f s (%.2f MB/s), block cache %s, %lld hits, %lld misses, %.2f MB cached"),
+		NumFiles, NumBytes / (1024.0 * 1024.0), Seconds, Seconds > 0.0 ? NumBytes / (1024.0 * 1024.0) / Seconds : 0.0,
+		GPakBlockCache_Enable ? TEXT("on") : TEXT("off"), Hits - StartHits, Misses - StartMisses, CachedBytes / (1024.0 * 1024.0));
+}
 #endif // !UE_BUILD_SHIPPING
 
 FPakPlatformFile::FPakPlatformFile()
 	: LowerLevel(NULL)
 	, bSigned(false)
+	, bSharedPakMemory(false)
 {
 }
 
@@ -3973,6 +4402,21 @@ bool FPakPlatformFile::Initialize(IPlatformFile* Inner, const TCHAR* CmdLine)
 	DecryptionKey.Exponent.Parse(DECRYPTION_KEY_EXPONENT);
 	DecryptionKey.Modulus.Parse(DECRYPTION_KEY_MODULUS);
 	bSigned = !DecryptionKey.Exponent.IsZero() && !DecryptionKey.Modulus.IsZero();
+	bSharedPakMemory = FParse::Param(CmdLine, TEXT("SharedPakMemory"));
+	if (bSharedPakMemory)
+	{
+#if PLATFORM_LINUX
+		// Shared regions hold the content outside of the pak, where the signature checks don't reach
+		if (bSigned || FParse::Param(CmdLine, TEXT("signedpak")) || FParse::Param(CmdLine, TEXT("signed")))
+		{
+			UE_LOG(LogPakFile, Log, TEXT("-SharedPakMemory is ignored for signed paks."));
+			bSharedPakMemory = false;
+		}
+#else
+		UE_LOG(LogPakFile, Log, TEXT("-SharedPakMemory is only supported on Linux."));
+		bSharedPakMemory = false;
+#endif
+	}
 	
 	bool bMountPaks = true;
 	TArray<FString> PaksToLoad;
@@ -4120,6 +4564,434 @@ bool FPakPlatformFile::Unmount(const TCHAR* InPakFilename)
 	return false;
 }
 
+static int32 GPakSharedMemory_MinSizeKB = 512;
+static FAutoConsoleVariableRef CVar_PakSharedMemoryMinSizeKB(
+	TEXT("paksharedmemory.MinSizeKB"),
+	GPakSharedMemory_MinSizeKB,
+	TEXT("With -SharedPakMemory, compressed pak entries at least this big (in KB) are decompressed into host wide shared memory.")
+	);
+
+static int32 GPakSharedMemory_MaxMB = 2048;
+static FAutoConsoleVariableRef CVar_PakSharedMemoryMaxMB(
+	TEXT("paksharedmemory.MaxMB"),
+	GPakSharedMemory_MaxMB,
+	TEXT("Maximum amount (in MB) of shared pak memory a process maps, entries past the budget are read privately.")
+	);
+
+static int32 GPakSharedMemory_WriteTimeoutSeconds = 120;
+static FAutoConsoleVariableRef CVar_PakSharedMemoryWriteTimeoutSeconds(
+	TEXT("paksharedmemory.WriteTimeoutSeconds"),
+	GPakSharedMemory_WriteTimeoutSeconds,
+	TEXT("A shared pak memory region still being written after this many seconds is taken over by the next process that opens it.")
+	);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("PakSharedMemory Hits"), STAT_PakSharedMemory_Hits, STATGROUP_PakFile);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("PakSharedMemory Published"), STAT_PakSharedMemory_Published, STATGROUP_PakFile);
+DECLARE_MEMORY_STAT(TEXT("PakSharedMemory Mapped"), STAT_PakSharedMemoryMem, STATGROUP_Memory);
+
+#if PLATFORM_LINUX
+
+/**
+ * File handle reading a pak entry that has been decompressed into shared memory.
+ */
+class FPakSharedMemoryHandle : public IFileHandle
+{
+public:
+	FPakSharedMemoryHandle(const uint8* InData, int64 InSize)
+		: Data(InData)
+		, FileSize(InSize)
+		, ReadPos(0)
+	{
+		INC_DWORD_STAT(STAT_PakFile_NumOpenHandles);
+	}
+
+	virtual ~FPakSharedMemoryHandle()
+	{
+		DEC_DWORD_STAT(STAT_PakFile_NumOpenHandles);
+	}
+
+	//~ Begin IFileHandle Interface
+	virtual int64 Tell() override
+	{
+		return ReadPos;
+	}
+	virtual bool Seek(int64 NewPosition) override
+	{
+		if (NewPosition > FileSize || NewPosition < 0)
+		{
+			return false;
+		}
+		ReadPos = NewPosition;
+		return true;
+	}
+	virtual bool SeekFromEnd(int64 NewPositionRelativeToEnd) override
+	{
+		return Seek(FileSize - NewPositionRelativeToEnd);
+	}
+	virtual bool Read(uint8* Destination, int64 BytesToRead) override
+	{
+		if (BytesToRead < 0 || ReadPos + BytesToRead > FileSize)
+		{
+			return false;
+		}
+		FMemory::Memcpy(Destination, Data + ReadPos, BytesToRead);
+		ReadPos += BytesToRead;
+		return true;
+	}
+	virtual bool Write(const uint8* Source, int64 BytesToWrite) override
+	{
+		// Writing in pak files is not allowed.
+		return false;
+	}
+	virtual int64 Size() override
+	{
+		return FileSize;
+	}
+	//~ End IFileHandle Interface
+
+private:
+	const uint8* Data;
+	int64 FileSize;
+	int64 ReadPos;
+};
+
+/**
+ * Decompressed pak entries shared by the game processes of one user on the host (enabled with -SharedPakMemory, Linux only).
+ *
+ * Each entry gets a named shared memory region keyed by the user, the entry's hash and sizes. The first process to open
+ * the entry decompresses it into the region, the others map the same pages instead of decompressing their own copy.
+ * A process that finds an entry still being written by another one reads it privately this time and checks again
+ * on the next open. The writer's process id and start time are kept in the region, so a region whose writer died or
+ * has been writing for longer than paksharedmemory.WriteTimeoutSeconds is taken over instead of staying unusable.
+ *
+ * A region holds pak content outside of the pak, so it must not let other users read or replace it:
+ *  - encrypted entries are never shared, and sharing is turned off for signed paks (see FPakPlatformFile::Initialize),
+ *  - regions are created owner only (0600), and a region owned by another user or open to others is never used,
+ *  - the entry data is mapped read only, only the header holding the state is writable; the writer fills the data
+ *    through the file descriptor,
+ *  - the writer stores the SHA1 of the decompressed data in the header, and every process checks it once before
+ *    reading the region. The pak entry hash covers the stored (compressed) bytes, so it can't be checked against the
+ *    region without decompressing the entry again.
+ *
+ * Regions are never unmapped, they stay in /dev/shm (UEPak3_*) after the processes exit so the next instance on the host
+ * finds them too. Entries are keyed by content, so a new build only adds regions; clean them up between deployments.
+ */
+class FPakSharedMemoryCache
+{
+public:
+	static FPakSharedMemoryCache& Get()
+	{
+		static FPakSharedMemoryCache Singleton;
+		return Singleton;
+	}
+
+	FPakSharedMemoryCache()
+		: MappedBytes(0)
+	{}
+
+	/** Returns whether the entry is worth sharing and may be shared */
+	static bool ShouldShare(const FPakEntry& Entry)
+	{
+		// Encrypted entries would end up decrypted in memory other processes can map
+		if (Entry.bEncrypted || Entry.CompressionMethod == COMPRESS_None || Entry.UncompressedSize < int64(GPakSharedMemory_MinSizeKB) * 1024)
+		{
+			return false;
+		}
+		// Old paks can have entries without a hash, those can't be told apart
+		for (int32 Index = 0; Index < ARRAY_COUNT(Entry.Hash); Index++)
+		{
+			if (Entry.Hash[Index] != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Returns a handle reading the entry from shared memory, publishing it there first if no other process has.
+	 *
+	 * @param Entry Entry to open.
+	 * @param Source Private handle to the entry, used to fill the region.
+	 * @return The handle, or NULL if the entry can't be shared right now and Source should be used.
+	 */
+	IFileHandle* CreateHandle(const FPakEntry& Entry, IFileHandle& Source)
+	{
+		FRegion* Region = NULL;
+		{
+			FScopeLock ScopedLock(&CriticalSection);
+			const FString Name = GetRegionName(Entry);
+			FRegion** Found = Regions.Find(Name);
+			Region = Found ? *Found : MapRegion(Name, Entry.UncompressedSize);
+		}
+		if (!Region)
+		{
+			return NULL;
+		}
+
+		// Regions are never unmapped, so the rest can run outside the lock; the state in the header is what keeps
+		// threads and processes from writing the same region twice
+
+		FRegionHeader* Header = Region->Header;
+
+		const int64 CurrentState = Header->State;
+		const int64 WritingState = MakeWritingState();
+		const bool bClaimable = CurrentState == StateEmpty || (CurrentState != StateReady && IsAbandoned(CurrentState));
+
+		if (bClaimable && FPlatformAtomics::InterlockedCompareExchange(&Header->State, WritingState, CurrentState) == CurrentState)
+		{
+			// We are the first process to open this entry, or the one taking over from a writer that went away
+			if (CurrentState != StateEmpty)
+			{
+				UE_LOG(LogPakFile, Log, TEXT("Taking over shared pak memory abandoned by process %u."), uint32(CurrentState & 0xffffffff));
+			}
+
+			if (!WriteRegion(*Region, Source, Entry.UncompressedSize))
+			{
+				// Give the region back so the next open tries again, unless someone already took it over from us
+				FPlatformAtomics::InterlockedCompareExchange(&Header->State, int64(StateEmpty), WritingState);
+				Source.Seek(0);
+				return NULL;
+			}
+
+			Header->Size = Entry.UncompressedSize;
+			Header->Magic = RegionMagic;
+			FPlatformMisc::MemoryBarrier();
+			if (FPlatformAtomics::InterlockedCompareExchange(&Header->State, int64(StateReady), WritingState) != WritingState)
+			{
+				// We took too long and another process took over, it publishes the same data when it is done
+				Source.Seek(0);
+				return NULL;
+			}
+			// What we published is what we hashed, no need to read it back
+			FPlatformAtomics::InterlockedExchange(&Region->Verified, 1);
+			INC_DWORD_STAT(STAT_PakSharedMemory_Published);
+		}
+		else if (Header->State == StateReady)
+		{
+			INC_DWORD_STAT(STAT_PakSharedMemory_Hits);
+		}
+
+		if (Header->State != StateReady || Header->Magic != RegionMagic || Header->Size != Entry.UncompressedSize)
+		{
+			return NULL;
+		}
+		FPlatformMisc::MemoryBarrier();
+		if (!VerifyRegion(*Region))
+		{
+			return NULL;
+		}
+		return new FPakSharedMemoryHandle(Region->Data, Entry.UncompressedSize);
+	}
+
+private:
+	/** Written at the start of every region, in a page of its own */
+	struct FRegionHeader
+	{
+		uint32 Magic;
+		uint32 Padding;
+		/** StateEmpty, StateReady, or while being written the writer's start time (unix seconds) << 32 | process id */
+		volatile int64 State;
+		int64 Size;
+		/** SHA1 of the Size bytes of data */
+		uint8 DataHash[20];
+	};
+
+	/** A region mapped by this process */
+	struct FRegion
+	{
+		/** Writable mapping of the header page */
+		FRegionHeader* Header;
+		/** Read only mapping of the data, which starts DataOffset bytes into the region */
+		const uint8* Data;
+		int64 DataOffset;
+		int64 DataSize;
+		/** Kept open to fill the data, the mapping of it is read only */
+		int Fd;
+		/** 0 while the data hasn't been checked against DataHash yet, 1 if it matched, -1 if not */
+		volatile int32 Verified;
+	};
+
+	enum
+	{
+		/** Shared memory starts zeroed, so a new region is empty */
+		StateEmpty = 0,
+		StateReady = -1,
+		RegionMagic = 0x5AC0DEC2,
+		/** Size of the buffer data is moved through when filling or checking a region */
+		CopyChunkSize = 1024 * 1024,
+	};
+
+	static int64 MakeWritingState()
+	{
+		const uint32 StartTime = uint32(FDateTime::UtcNow().ToUnixTimestamp());
+		return (int64(StartTime) << 32) | int64(FPlatformProcess::GetCurrentProcessId());
+	}
+
+	/** Whether the writer of a region in the writing state died or has been at it for too long */
+	static bool IsAbandoned(int64 WritingState)
+	{
+		const uint32 WriterId = uint32(WritingState & 0xffffffff);
+		const uint32 StartTime = uint32(uint64(WritingState) >> 32);
+		const int64 WritingSeconds = FDateTime::UtcNow().ToUnixTimestamp() - int64(StartTime);
+
+		if (WritingSeconds > FMath::Max(GPakSharedMemory_WriteTimeoutSeconds, 1))
+		{
+			return true;
+		}
+		return WriterId != FPlatformProcess::GetCurrentProcessId() && !FPlatformProcess::IsApplicationRunning(WriterId);
+	}
+
+	static FString GetRegionName(const FPakEntry& Entry)
+	{
+		// The version in the name keeps regions with an older layout left in /dev/shm from being mapped, the user id keeps
+		// the names of different users apart since a region is only ever used by the user that created it
+		return FString::Printf(TEXT("UEPak3_%u_%s_%llx_%llx_%x"), uint32(geteuid()), *BytesToHex(Entry.Hash, ARRAY_COUNT(Entry.Hash)), Entry.Size, Entry.UncompressedSize, Entry.CompressionMethod);
+	}
+
+	/** Reads the entry from Source into the region's data and stores its hash in the header */
+	static bool WriteRegion(FRegion& Region, IFileHandle& Source, int64 Size)
+	{
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(int32(FMath::Min<int64>(Size, CopyChunkSize)));
+		FSHA1 Hash;
+		for (int64 Offset = 0; Offset < Size;)
+		{
+			const int64 Count = FMath::Min<int64>(Buffer.Num(), Size - Offset);
+			if (!Source.Read(Buffer.GetData(), Count))
+			{
+				return false;
+			}
+			Hash.Update(Buffer.GetData(), uint32(Count));
+			for (int64 Written = 0; Written < Count;)
+			{
+				const ssize_t Result = pwrite(Region.Fd, Buffer.GetData() + Written, Count - Written, Region.DataOffset + Offset + Written);
+				if (Result <= 0)
+				{
+					UE_LOG(LogPakFile, Warning, TEXT("Failed to write shared pak memory (errno %d), reading it privately."), errno);
+					return false;
+				}
+				Written += Result;
+			}
+			Offset += Count;
+		}
+		Hash.Final();
+		Hash.GetHash(Region.Header->DataHash);
+		return true;
+	}
+
+	/** Checks the region's data against the hash in its header, the first time this process reads the region */
+	static bool VerifyRegion(FRegion& Region)
+	{
+		if (Region.Verified == 0)
+		{
+			// The size of our own mapping rather than the one in the header, which is only as trustworthy as the data
+			const int64 Size = Region.DataSize;
+			FSHA1 Hash;
+			for (int64 Offset = 0; Offset < Size; Offset += CopyChunkSize)
+			{
+				Hash.Update(Region.Data + Offset, uint32(FMath::Min<int64>(CopyChunkSize, Size - Offset)));
+			}
+			Hash.Final();
+			uint8 DataHash[20];
+			Hash.GetHash(DataHash);
+
+			const bool bMatches = FMemory::Memcmp(DataHash, Region.Header->DataHash, sizeof(DataHash)) == 0;
+			if (!bMatches)
+			{
+				UE_LOG(LogPakFile, Warning, TEXT("Shared pak memory doesn't match its hash, reading the entry privately."));
+			}
+			FPlatformAtomics::InterlockedExchange(&Region.Verified, bMatches ? 1 : -1);
+		}
+		return Region.Verified > 0;
+	}
+
+	FRegion* MapRegion(const FString& Name, int64 UncompressedSize)
+	{
+		FRegion* Region = NULL;
+
+		const int64 DataOffset = Align(int64(sizeof(FRegionHeader)), int32(FPlatformMemory::GetConstants().PageSize));
+		const int64 RegionSize = DataOffset + UncompressedSize;
+		if (MappedBytes + RegionSize <= int64(FMath::Max(GPakSharedMemory_MaxMB, 0)) * 1024 * 1024)
+		{
+			Region = OpenRegion(Name, DataOffset, UncompressedSize);
+			if (Region)
+			{
+				MappedBytes += RegionSize;
+				SET_MEMORY_STAT(STAT_PakSharedMemoryMem, MappedBytes);
+			}
+		}
+
+		// Remember failures too so we don't retry on every open
+		Regions.Add(Name, Region);
+		return Region;
+	}
+
+	static FRegion* OpenRegion(const FString& Name, int64 DataOffset, int64 DataSize)
+	{
+		const FString ShmName = FString(TEXT("/")) + Name;
+		FTCHARToUTF8 NameUTF8(*ShmName);
+
+		// Owner only if we create it; an existing region keeps the owner and mode it was created with, checked below
+		const int Fd = shm_open(NameUTF8.Get(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+		if (Fd == -1)
+		{
+			UE_LOG(LogPakFile, Log, TEXT("Failed to open shared pak memory %s (errno %d), reading it privately."), *Name, errno);
+			return NULL;
+		}
+
+		// Another user could have created the region first to read what we write into it, or to serve their own data
+		struct stat Stat;
+		if (fstat(Fd, &Stat) != 0 || Stat.st_uid != geteuid() || (Stat.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+		{
+			UE_LOG(LogPakFile, Warning, TEXT("Shared pak memory %s is not private to this user, reading it privately."), *Name);
+			close(Fd);
+			return NULL;
+		}
+
+		// The size is part of the name, so this only ever grows a region that was just created
+		if (Stat.st_size < DataOffset + DataSize && ftruncate(Fd, DataOffset + DataSize) != 0)
+		{
+			UE_LOG(LogPakFile, Log, TEXT("Failed to size shared pak memory %s (errno %d), reading it privately."), *Name, errno);
+			close(Fd);
+			return NULL;
+		}
+
+		void* HeaderPtr = mmap(NULL, DataOffset, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+		void* DataPtr = mmap(NULL, DataSize, PROT_READ, MAP_SHARED, Fd, DataOffset);
+		if (HeaderPtr == MAP_FAILED || DataPtr == MAP_FAILED)
+		{
+			UE_LOG(LogPakFile, Log, TEXT("Failed to map shared pak memory %s (errno %d), reading it privately."), *Name, errno);
+			if (HeaderPtr != MAP_FAILED)
+			{
+				munmap(HeaderPtr, DataOffset);
+			}
+			if (DataPtr != MAP_FAILED)
+			{
+				munmap(DataPtr, DataSize);
+			}
+			close(Fd);
+			return NULL;
+		}
+
+		FRegion* Region = new FRegion;
+		Region->Header = (FRegionHeader*)HeaderPtr;
+		Region->Data = (const uint8*)DataPtr;
+		Region->DataOffset = DataOffset;
+		Region->DataSize = DataSize;
+		Region->Fd = Fd;
+		Region->Verified = 0;
+		return Region;
+	}
+
+	FCriticalSection CriticalSection;
+	/** Regions mapped by this process, by name */
+	TMap<FString, FRegion*> Regions;
+	int64 MappedBytes;
+};
+
+#endif // PLATFORM_LINUX
+
 IFileHandle* FPakPlatformFile::CreatePakFileHandle(const TCHAR* Filename, FPakFile* PakFile, const FPakEntry* FileEntry)
 {
 	IFileHandle* Result = NULL;
@@ -4147,6 +5019,18 @@ IFileHandle* FPakPlatformFile::CreatePakFileHandle(const TCHAR* Filename, FPakFi
 		Result = new FPakFileHandle<>(*PakFile, *FileEntry, PakReader, bNeedsDelete);
 	}
 
+#if PLATFORM_LINUX
+	if (bSharedPakMemory && FPakSharedMemoryCache::ShouldShare(*FileEntry))
+	{
+		IFileHandle* SharedHandle = FPakSharedMemoryCache::Get().CreateHandle(*FileEntry, *Result);
+		if (SharedHandle)
+		{
+			delete Result;
+			Result = SharedHandle;
+		}
+	}
+#endif
+
 	return Result;
 }
 
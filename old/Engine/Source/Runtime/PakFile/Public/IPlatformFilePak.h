@@ -858,6 +858,8 @@ class PAKFILE_API FPakPlatformFile : public IPlatformFile
 	TArray<FPakListEntry> PakFiles;
 	/** True if this we're using signed content. */
 	bool bSigned;
+	/** True if large compressed entries are decompressed into memory shared with the other processes on the host (-SharedPakMemory). */
+	bool bSharedPakMemory;
 	/** Synchronization object for accessing the list of currently mounted pak files. */
 	FCriticalSection PakListCritical;
 	/** Cache of extensions that we automatically reject if not found in pak file */
@@ -1642,6 +1644,7 @@ public:
 	void HandlePakListCommand(const TCHAR* Cmd, FOutputDevice& Ar);
 	void HandleMountCommand(const TCHAR* Cmd, FOutputDevice& Ar);
 	void HandleUnmountCommand(const TCHAR* Cmd, FOutputDevice& Ar);
+	void HandlePakBenchOpenLogCommand(const TCHAR* Cmd, FOutputDevice& Ar);
 #endif
 	// END Console commands
 };
@@ -12,6 +12,7 @@
 #include <time.h>
 
 #include "../SurvivalGame 4.22/Source/SurvivalGame/ThirdParty/CloudImp/Server/FocusData.h"
+#include "../SurvivalGame 4.22/Source/SurvivalGame/ThirdParty/CloudImp/Server/FocusHeatmap.h"
 
 #pragma comment(lib,"ws2_32.lib") //Winsock Library
 
@@ -100,7 +101,7 @@ int main(int argc, char *argv[])
 		port = atoi(argv[1]);
 		interval = atoi(argv[2]);
 	}
-	else if (argc == 4)
+	else if (argc >= 4)
 	{
 		port = atoi(argv[1]);
 		interval = atoi(argv[2]);
@@ -110,6 +111,18 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	/// optional saliency heatmap accumulation: <map name> [screen width] [screen height]
+	FocusHeatmapService* heatmapService = NULL;
+	FocusHeatmapSession* heatmapSession = NULL;
+	if (argc >= 5)
+	{
+		float screenWidth = argc >= 7 ? (float)atof(argv[5]) : 1920.0f;
+		float screenHeight = argc >= 7 ? (float)atof(argv[6]) : 1080.0f;
+		heatmapService = new FocusHeatmapService(".");
+		heatmapSession = heatmapService->OpenSession(argv[4], screenWidth, screenHeight);
+		printf("Accumulating heatmap for map:%s\n", argv[4]);
+	}
+
 	printf("Initialising focus trace server with port:%d\n", port);
 	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
 	{
@@ -163,6 +176,7 @@ int main(int argc, char *argv[])
 	unsigned int totalSize = 0;
 	unsigned char header[4];
 	time_t now = time(0);
+	clock_t lastMerge = clock();
 	int count = 0;
 	/// receiving data
 	do {
@@ -177,6 +191,10 @@ int main(int argc, char *argv[])
 				{
 					FocusInfo info;
 					Deserialize(outPackets[i].buf, outPackets[i].size, &info);
+					if (heatmapSession != NULL)
+					{
+						heatmapSession->Accumulate(&info);
+					}
 
 					/// record data
 					time_t new_time = time(0);
@@ -190,6 +208,11 @@ int main(int argc, char *argv[])
 						printf("Camera Position:%.1f %.1f %.1f\n", info.camPos[0], info.camPos[1], info.camPos[2]);
 						printf("Camera Rotation:%.1f %.1f %.1f\n", info.camRot[0], info.camRot[1], info.camRot[2]);
 						printf("Scene Jumped:%d\n", info.sceneJumped);
+						printf("Scene Cut Confidence:%.2f Keyframe Hint:%d\n", info.sceneCutConfidence, info.keyframeHint);
+						if (heatmapSession != NULL)
+						{
+							printf("Heatmap Samples Dropped:%u\n", heatmapSession->GetDropped());
+						}
 
 						now = new_time;
 
@@ -207,6 +230,14 @@ int main(int argc, char *argv[])
 					delete[] outPackets[i].buf;
 				}
 			}
+
+			/// drain the session queue every receive so it never fills up between prints
+			if (heatmapService != NULL)
+			{
+				clock_t newMerge = clock();
+				heatmapService->Merge((float)(newMerge - lastMerge) / CLOCKS_PER_SEC);
+				lastMerge = newMerge;
+			}
 		}
 		else if (iResult == 0)
 			printf("Connection closed\n");
@@ -219,6 +250,13 @@ int main(int argc, char *argv[])
 	{
 		delete[] outBuf;
 	}
+	if (heatmapService != NULL)
+	{
+		heatmapService->CloseSession(heatmapSession);
+		heatmapService->Merge(0.0f);
+		heatmapService->SaveAll();
+		delete heatmapService;
+	}
 	closesocket(s);
 	WSACleanup();
 
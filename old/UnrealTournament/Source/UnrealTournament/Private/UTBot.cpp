@@ -2,6 +2,7 @@
 #include "UnrealTournament.h"
 #include "UTCharacterMovement.h"
 #include "UTBot.h"
+#include "UTBotPerception.h"
 #include "UTAIAction.h"
 #include "UTAIAction_WaitForMove.h"
 #include "UTAIAction_WaitForLanding.h"
@@ -23,6 +24,16 @@
 #include "UTGameState.h"
 #include "UTLineUpHelper.h"
 
+TAutoConsoleVariable<float> CVarUTBotDecisionBudget(
+	TEXT("UT.BotDecisionBudget"),
+	2.0f,
+	TEXT("Milliseconds per frame all bots together may spend in decision making (pathfinding included) before further decisions are postponed to the next frame. 0 disables.\n"));
+
+TAutoConsoleVariable<int32> CVarUTBotMaxDecisionDelay(
+	TEXT("UT.BotMaxDecisionDelay"),
+	4,
+	TEXT("Maximum number of frames a bot decision can be postponed by UT.BotDecisionBudget."));
+
 void FBotEnemyInfo::Update(EAIEnemyUpdateType UpdateType, const FVector& ViewerLoc)
 {
 	if (Pawn != NULL)
@@ -116,6 +127,8 @@ AUTBot::AUTBot(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
 	TacticalHeightAdvantage = 650.0f;
+	DeferredDecisionFrames = 0;
+	DecisionDelayLimit = 0;
 
 	bWantsPlayerState = true;
 	SightRadius = 20000.0f;
@@ -727,6 +740,13 @@ void AUTBot::Tick(float DeltaTime)
 			}
 		}
 
+		// first bot to tick this frame updates the shared visibility matrix; async results are only kept for one frame
+		FUTBotPerception* Perception = FUTBotPerception::Get(GetWorld());
+		if (Perception != NULL)
+		{
+			Perception->Update();
+		}
+
 		// check for enemy visibility
 		// check current enemy every frame, others on a slightly random timer to avoid hitches
 		if (Enemy != NULL)
@@ -789,12 +809,19 @@ void AUTBot::Tick(float DeltaTime)
 		}
 		// start new action, if requested
 		// make sure updates above didn't result in losing Pawn (stop firing -> suicide, etc)
-		if (bPendingWhatToDoNext && GetPawn() != NULL)
+		if (bPendingWhatToDoNext && GetPawn() != NULL && CanExecuteDecisionThisFrame())
 		{
+			const double DecisionStartTime = FPlatformTime::Seconds();
 			bExecutingWhatToDoNext = true;
 			ExecuteWhatToDoNext();
 			bExecutingWhatToDoNext = false;
 			bPendingWhatToDoNext = false;
+			DeferredDecisionFrames = 0;
+			AUTGameMode* Game = GetWorld()->GetAuthGameMode<AUTGameMode>();
+			if (Game != NULL)
+			{
+				Game->BotDecisionBudgetUsed += FPlatformTime::Seconds() - DecisionStartTime;
+			}
 			if (GetPawn() != NULL)
 			{
 				if (CurrentAction == NULL)
@@ -2760,6 +2787,38 @@ void AUTBot::WhatToDoNext()
 	bPendingWhatToDoNext = true;
 }
 
+bool AUTBot::CanExecuteDecisionThisFrame()
+{
+	// the budget is per game so bots in other worlds of this process (PIE, fast simulation) don't use it up
+	AUTGameMode* Game = GetWorld()->GetAuthGameMode<AUTGameMode>();
+	const float BudgetMS = CVarUTBotDecisionBudget.GetValueOnGameThread();
+	if (Game == NULL || BudgetMS <= 0.0f)
+	{
+		return true;
+	}
+	if (Game->BotDecisionBudgetFrame != GFrameCounter)
+	{
+		Game->BotDecisionBudgetFrame = GFrameCounter;
+		Game->BotDecisionBudgetUsed = 0.0;
+	}
+	if (Game->BotDecisionBudgetUsed * 1000.0 < BudgetMS || (DeferredDecisionFrames > 0 && DeferredDecisionFrames >= DecisionDelayLimit))
+	{
+		return true;
+	}
+	else
+	{
+		// spread replanning over frames when many bots want to decide at once (e.g. after a flag capture)
+		if (DeferredDecisionFrames == 0)
+		{
+			// bots postponed on the same frame get different limits so the forced decisions are staggered as well
+			const int32 MaxDelay = FMath::Max<int32>(CVarUTBotMaxDecisionDelay.GetValueOnGameThread(), 1);
+			DecisionDelayLimit = FMath::RandRange((MaxDelay + 1) / 2, MaxDelay);
+		}
+		DeferredDecisionFrames++;
+		return false;
+	}
+}
+
 void AUTBot::ExecuteWhatToDoNext()
 {
 	DECLARE_CYCLE_STAT(TEXT("Bot decision time"), STAT_AI_ExecuteWhatToDoNext, STATGROUP_AI);
@@ -4905,10 +4964,16 @@ bool AUTBot::CanSee(APawn* Other, bool bMaySkipChecks)
 						}
 						else
 						{
-							return Super::LineOfSightTo(Other, FVector(ForceInit), bMaySkipChecks);
+							bool bSharedVisible = false;
+							return CheckSharedLineOfSight(Other, bSharedVisible) ? bSharedVisible : Super::LineOfSightTo(Other, FVector(ForceInit), bMaySkipChecks);
 						}
 					}
 				}
+				else if (bMaySkipChecks)
+				{
+					bool bSharedVisible = false;
+					return CheckSharedLineOfSight(Other, bSharedVisible) ? bSharedVisible : LineOfSightTo(Other, FVector(ForceInit), bMaySkipChecks);
+				}
 				else
 				{
 					return LineOfSightTo(Other, FVector(ForceInit), bMaySkipChecks);
@@ -4917,6 +4982,14 @@ bool AUTBot::CanSee(APawn* Other, bool bMaySkipChecks)
 		}
 	}
 }
+bool AUTBot::CheckSharedLineOfSight(APawn* Other, bool& bVisible)
+{
+	// the shared matrix is traced from our Pawn's eyes so only valid when we're looking from it
+	// ragdolls need the raised second trace in UTLineOfSightTo() since their target location is in the ground
+	FUTBotPerception* Perception = FUTBotPerception::Get(GetWorld());
+	const bool bOtherIsRagdoll = Cast<AUTCharacter>(Other) != NULL && ((AUTCharacter*)Other)->IsRagdoll();
+	return (Perception != NULL && GetPawn() != NULL && !bOtherIsRagdoll && GetViewTarget() == GetPawn() && Perception->GetVisibility(GetPawn(), Other, bVisible));
+}
 bool AUTBot::LineOfSightTo(const class AActor* Other, FVector ViewPoint, bool bAlternateChecks) const
 {
 	return (Other == NULL) ? false : UTLineOfSightTo(Other, ViewPoint, bAlternateChecks, Other->GetTargetLocation(GetPawn()));
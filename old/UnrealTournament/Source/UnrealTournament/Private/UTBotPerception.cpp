@@ -0,0 +1,254 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#include "UnrealTournament.h"
+#include "UTBot.h"
+#include "UTBotPerception.h"
+
+TAutoConsoleVariable<int32> CVarUTBotSharedPerception(
+	TEXT("UT.BotSharedPerception"),
+	1,
+	TEXT("Bots use a shared, asynchronously traced visibility matrix when scanning for new Pawns instead of tracing individually.\n"));
+
+TAutoConsoleVariable<float> CVarUTBotPerceptionInterval(
+	TEXT("UT.BotPerceptionInterval"),
+	0.2f,
+	TEXT("Seconds over which the shared bot perception traces every Pawn pair once."));
+
+TMap<UWorld*, FUTBotPerception*> FUTBotPerception::WorldPerception;
+
+FUTBotPerception* FUTBotPerception::Get(UWorld* World)
+{
+	if (World == NULL || CVarUTBotSharedPerception.GetValueOnGameThread() == 0)
+	{
+		return NULL;
+	}
+	else
+	{
+		FUTBotPerception*& Result = WorldPerception.FindOrAdd(World);
+		if (Result == NULL)
+		{
+			if (WorldPerception.Num() == 1)
+			{
+				static bool bRegisteredCleanup = false;
+				if (!bRegisteredCleanup)
+				{
+					bRegisteredCleanup = true;
+					FWorldDelegates::OnWorldCleanup.AddStatic(&FUTBotPerception::OnWorldCleanup);
+				}
+			}
+			Result = new FUTBotPerception(World);
+		}
+		return Result;
+	}
+}
+
+void FUTBotPerception::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	FUTBotPerception* Perception = NULL;
+	if (WorldPerception.RemoveAndCopyValue(World, Perception))
+	{
+		delete Perception;
+	}
+}
+
+FUTBotPerception::FUTBotPerception(UWorld* InWorld)
+	: World(InWorld), LastUpdateFrame(0), NextPairA(0), NextPairB(1), MaxSightRadius(0.0f)
+{}
+
+int32 FUTBotPerception::GetSlot(APawn* P)
+{
+	int32* Existing = PawnToSlot.Find(P);
+	if (Existing != NULL)
+	{
+		return *Existing;
+	}
+	else
+	{
+		int32 Slot = Slots.IndexOfByPredicate([](const TWeakObjectPtr<APawn>& Item) { return !Item.IsValid(); });
+		if (Slot == INDEX_NONE)
+		{
+			// grow the matrix, keeping existing entries
+			const int32 OldNum = Slots.Num();
+			const int32 NewNum = FMath::Max<int32>(8, OldNum * 2);
+			TArray<FVisibilityEntry> NewMatrix;
+			NewMatrix.AddUninitialized(NewNum * NewNum);
+			for (int32 A = 0; A < NewNum; A++)
+			{
+				for (int32 B = 0; B < NewNum; B++)
+				{
+					FVisibilityEntry& Entry = NewMatrix[A * NewNum + B];
+					if (A < OldNum && B < OldNum)
+					{
+						Entry = Matrix[A * OldNum + B];
+					}
+					else
+					{
+						Entry.UpdateTime = -1.0f;
+						Entry.bVisible = false;
+					}
+				}
+			}
+			Exchange(Matrix, NewMatrix);
+			Slots.SetNum(NewNum);
+			SlotHasBot.SetNumZeroed(NewNum);
+			// pending traces refer to old slot indices which are unchanged, only the stride changed
+			Slot = OldNum;
+		}
+		else
+		{
+			ReleaseSlot(Slot);
+		}
+		Slots[Slot] = P;
+		PawnToSlot.Add(P, Slot);
+		return Slot;
+	}
+}
+
+void FUTBotPerception::ReleaseSlot(int32 Slot)
+{
+	const int32 Num = Slots.Num();
+	for (int32 i = 0; i < Num; i++)
+	{
+		Matrix[Slot * Num + i].UpdateTime = -1.0f;
+		Matrix[i * Num + Slot].UpdateTime = -1.0f;
+	}
+	Slots[Slot] = NULL;
+	SlotHasBot[Slot] = false;
+}
+
+void FUTBotPerception::Update()
+{
+	if (LastUpdateFrame == GFrameCounter)
+	{
+		return;
+	}
+	LastUpdateFrame = GFrameCounter;
+
+	const float WorldTime = World->TimeSeconds;
+
+	// drop dead Pawns
+	for (TMap<const APawn*, int32>::TIterator It(PawnToSlot); It; ++It)
+	{
+		if (!Slots[It.Value()].IsValid() || Slots[It.Value()]->IsPendingKillPending() || Slots[It.Value()]->Controller == NULL)
+		{
+			ReleaseSlot(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+	// register current Pawns
+	MaxSightRadius = 0.0f;
+	for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+	{
+		AController* C = It->Get();
+		if (C != NULL && C->GetPawn() != NULL && !C->GetPawn()->IsPendingKillPending() && !C->GetPawn()->IsA(ASpectatorPawn::StaticClass()))
+		{
+			const int32 Slot = GetSlot(C->GetPawn());
+			AUTBot* B = Cast<AUTBot>(C);
+			SlotHasBot[Slot] = (B != NULL);
+			if (B != NULL)
+			{
+				MaxSightRadius = FMath::Max<float>(MaxSightRadius, B->SightRadius);
+			}
+		}
+	}
+
+	const int32 Num = Slots.Num();
+
+	// gather last frame's results
+	for (const FPendingTrace& Pending : PendingTraces)
+	{
+		FTraceDatum Datum;
+		if (Pending.PawnA.IsValid() && Pending.PawnB.IsValid() && Slots.IsValidIndex(Pending.SlotA) && Slots.IsValidIndex(Pending.SlotB) &&
+			Slots[Pending.SlotA] == Pending.PawnA && Slots[Pending.SlotB] == Pending.PawnB && World->QueryTraceData(Pending.Handle, Datum))
+		{
+			FVisibilityEntry& Entry = Matrix[Pending.SlotA * Num + Pending.SlotB];
+			Entry.UpdateTime = WorldTime;
+			Entry.bVisible = (Datum.OutHits.Num() == 0);
+		}
+	}
+	PendingTraces.Reset();
+
+	if (Num < 2 || MaxSightRadius <= 0.0f)
+	{
+		return;
+	}
+
+	// start this frame's share of the pair traces
+	const float Interval = FMath::Max<float>(0.01f, CVarUTBotPerceptionInterval.GetValueOnGameThread());
+	const int32 NumPairs = Num * (Num - 1) / 2;
+	const int32 FramesPerInterval = FMath::Max<int32>(1, FMath::TruncToInt(Interval / FMath::Max<float>(World->GetDeltaSeconds(), 0.001f)));
+	int32 PairsToVisit = FMath::Min<int32>(NumPairs, FMath::DivideAndRoundUp(NumPairs, FramesPerInterval));
+	const float MaxSightRadiusSq = FMath::Square(MaxSightRadius);
+	for (; PairsToVisit > 0; PairsToVisit--)
+	{
+		if (NextPairA >= Num - 1 || NextPairB >= Num)
+		{
+			NextPairA = 0;
+			NextPairB = 1;
+		}
+		const int32 A = NextPairA;
+		const int32 B = NextPairB;
+		if (++NextPairB >= Num)
+		{
+			NextPairA++;
+			NextPairB = NextPairA + 1;
+		}
+
+		APawn* PawnA = Slots[A].Get();
+		APawn* PawnB = Slots[B].Get();
+		if (PawnA != NULL && PawnB != NULL && (PawnA->GetActorLocation() - PawnB->GetActorLocation()).SizeSquared() <= MaxSightRadiusSq)
+		{
+			// each direction is a separate entry, only traced for bot viewers
+			if (SlotHasBot[A])
+			{
+				StartTrace(A, B);
+			}
+			if (SlotHasBot[B])
+			{
+				StartTrace(B, A);
+			}
+		}
+	}
+}
+
+void FUTBotPerception::StartTrace(int32 ViewerSlot, int32 TargetSlot)
+{
+	static FName NAME_BotPerception(TEXT("BotPerception"));
+
+	APawn* Viewer = Slots[ViewerSlot].Get();
+	APawn* Target = Slots[TargetSlot].Get();
+	// same points as AUTBot::UTLineOfSightTo(): the viewer's eyes to the target location the target reports for it
+	const FVector ViewPoint = Viewer->GetActorLocation() + FVector(0.0f, 0.0f, Viewer->BaseEyeHeight);
+	const FVector TargetLocation = Target->GetTargetLocation(Viewer);
+	FCollisionQueryParams Params(NAME_BotPerception, true, Viewer);
+	Params.AddIgnoredActor(Target);
+	FPendingTrace* Pending = new(PendingTraces) FPendingTrace;
+	Pending->Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Test, ViewPoint, TargetLocation, ECC_Visibility, Params);
+	Pending->SlotA = ViewerSlot;
+	Pending->SlotB = TargetSlot;
+	Pending->PawnA = Viewer;
+	Pending->PawnB = Target;
+}
+
+bool FUTBotPerception::GetVisibility(const APawn* Viewer, const APawn* Target, bool& bVisible) const
+{
+	const int32* SlotA = PawnToSlot.Find(Viewer);
+	const int32* SlotB = (SlotA != NULL) ? PawnToSlot.Find(Target) : NULL;
+	if (SlotB == NULL)
+	{
+		return false;
+	}
+	else
+	{
+		const FVisibilityEntry& Entry = Matrix[*SlotA * Slots.Num() + *SlotB];
+		// allow one missed refresh before falling back to a direct trace
+		if (Entry.UpdateTime < 0.0f || World->TimeSeconds - Entry.UpdateTime > CVarUTBotPerceptionInterval.GetValueOnGameThread() * 2.0f + 0.1f)
+		{
+			return false;
+		}
+		else
+		{
+			bVisible = Entry.bVisible;
+			return true;
+		}
+	}
+}
@@ -93,6 +93,12 @@ UUTGameEngine::UUTGameEngine(const FObjectInitializer& ObjectInitializer)
 	ServerMaxPredictionPing = 120.f;
 	VideoRecorder = nullptr;
 
+	bFastSimulation = false;
+	FastSimulationTimeLimit = 0.f;
+	FastSimulationStartTime = 0.0;
+	FastSimulationSeconds = 0.0;
+	LastFastSimulationReportTime = 0.0;
+
 #if !UE_SERVER
 	ConstructorHelpers::FObjectFinder<UClass> TutorialMenuFinder(TEXT("/Game/RestrictedAssets/Tutorials/Blueprints/TutMainMenuWidget.TutMainMenuWidget_C"));
 	TutorialMenuClass = TutorialMenuFinder.Object;
@@ -160,6 +166,24 @@ void UUTGameEngine::Init(IEngineLoop* InEngineLoop)
 
 	FParse::Value(FCommandLine::Get(), TEXT("ClientProcID="), OwningProcessID);
 
+	bFastSimulation = FParse::Param(FCommandLine::Get(), TEXT("fastsim"));
+	if (bFastSimulation)
+	{
+		// fixed step ticking skips the frame rate wait in the engine loop entirely, so the game runs as fast as the CPU allows
+		// and the simulation doesn't depend on wall clock frame times
+		float SimFPS = 30.f;
+		FParse::Value(FCommandLine::Get(), TEXT("simfps="), SimFPS);
+		FParse::Value(FCommandLine::Get(), TEXT("simseconds="), FastSimulationTimeLimit);
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(1.0 / FMath::Clamp<float>(SimFPS, 1.f, 1000.f));
+		FastSimulationStartTime = LastFastSimulationReportTime = FPlatformTime::Seconds();
+		UE_LOG(UT, Log, TEXT("Fast simulation enabled at %.1f simulated FPS, time limit %.0f seconds"), float(1.0 / FApp::GetFixedDeltaTime()), FastSimulationTimeLimit);
+		if (FApp::CanEverRender())
+		{
+			UE_LOG(UT, Warning, TEXT("Fast simulation is rendering, run with -server or -nullrhi -nosound for headless matches"));
+		}
+	}
+
 	if (!IsRunningDedicatedServer())
 	{
 		static const FName VideoRecordingFeatureName("VideoRecording");
@@ -341,6 +365,21 @@ void UUTGameEngine::Tick(float DeltaSeconds, bool bIdleMode)
 		FPlatformMisc::RequestExit(false);
 	}
 
+	if (bFastSimulation)
+	{
+		FastSimulationSeconds += DeltaSeconds;
+		if (FastSimulationTimeLimit > 0.f && FastSimulationSeconds >= FastSimulationTimeLimit)
+		{
+			ReportFastSimulationRate(true);
+			bFastSimulation = false;
+			FPlatformMisc::RequestExit(false);
+		}
+		else if (FPlatformTime::Seconds() - LastFastSimulationReportTime > 10.0)
+		{
+			ReportFastSimulationRate(false);
+		}
+	}
+
 #if !UE_SERVER
 	if (GWorld->GetNetMode() != NM_DedicatedServer)
 	{
@@ -358,6 +397,27 @@ void UUTGameEngine::Tick(float DeltaSeconds, bool bIdleMode)
 #endif
 }
 
+void UUTGameEngine::ReportFastSimulationRate(bool bFinal)
+{
+	const double Now = FPlatformTime::Seconds();
+	const double WallSeconds = FMath::Max<double>(Now - FastSimulationStartTime, 0.001);
+	LastFastSimulationReportTime = Now;
+	UE_LOG(UT, Log, TEXT("Fast simulation: %.1f simulated seconds in %.1f wall seconds (%.2f simulated seconds per second)"), FastSimulationSeconds, WallSeconds, FastSimulationSeconds / WallSeconds);
+
+	if (bFinal)
+	{
+		const FString Filename = FPaths::GameSavedDir() + TEXT("FastSimulation.csv");
+		FString Line;
+		if (!FPaths::FileExists(Filename))
+		{
+			Line = TEXT("Map,Date,SimFPS,SimulatedSeconds,WallSeconds,SimulatedPerWallSecond\n");
+		}
+		Line += FString::Printf(TEXT("%s,%s,%.1f,%.1f,%.1f,%.2f\n"), (GWorld != NULL) ? *GWorld->GetMapName() : TEXT("None"), *FDateTime::Now().ToString(),
+			float(1.0 / FApp::GetFixedDeltaTime()), FastSimulationSeconds, WallSeconds, FastSimulationSeconds / WallSeconds);
+		FFileHelper::SaveStringToFile(Line, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}
+}
+
 EBrowseReturnVal::Type UUTGameEngine::Browse( FWorldContext& WorldContext, FURL URL, FString& Error )
 {
 	UUTLocalPlayer* UTLocalPlayer = Cast<UUTLocalPlayer>(GetLocalPlayerFromControllerId(WorldContext.World(),0));
@@ -448,6 +508,12 @@ static TAutoConsoleVariable<int32> CVarSmoothFrameRate(
 
 float UUTGameEngine::GetMaxTickRate(float DeltaTime, bool bAllowFrameRateSmoothing) const
 {
+	if (bFastSimulation)
+	{
+		// never throttle, not even by the dedicated server net tick rate
+		return 0.f;
+	}
+
 	float MaxTickRate = 0;
 	UWorld* World = NULL;
 
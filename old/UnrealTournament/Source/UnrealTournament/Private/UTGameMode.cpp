@@ -463,6 +463,13 @@ void AUTGameMode::InitGame( const FString& MapName, const FString& Options, FStr
 		BotFillCount = FMath::Max(BotFillCount, AdjustedBotFillCount());
 	}
 
+	UUTGameEngine* UTEngine = Cast<UUTGameEngine>(GEngine);
+	if (UTEngine != NULL && UTEngine->bFastSimulation && BotFillCount == 0 && !bForceNoBots)
+	{
+		// headless simulation (also with -server) has no humans, so without ?BotFill= fill the whole session with bots
+		BotFillCount = GameSession->MaxPlayers;
+	}
+
 	// Handle any associated ruleset
 	InOpt = UGameplayStatics::ParseOption(Options, TEXT("ART"));
 	if (!InOpt.IsEmpty()) ActiveRuleTag = InOpt;
@@ -3388,6 +3395,24 @@ bool AUTGameMode::ReadyToStartMatch_Implementation()
 
 	if (GetMatchState() == MatchState::WaitingToStart)
 	{
+		UUTGameEngine* UTEngine = Cast<UUTGameEngine>(GEngine);
+		if (UTEngine != NULL && UTEngine->bFastSimulation)
+		{
+			// headless bot match, there are no humans to wait for so fill with bots (?BotFill=) and start right away
+			for (int32 FailsafeCount = 0; NumPlayers + NumBots < BotFillCount && FailsafeCount < 64; FailsafeCount++)
+			{
+				AddBot();
+			}
+			if (NumBots == 0)
+			{
+				// nothing will ever join, so waiting would hang the simulation forever
+				UE_LOG(UT, Error, TEXT("Fast simulation could not add any bots (BotFill=%i), exiting"), BotFillCount);
+				FPlatformMisc::RequestExit(false);
+				return false;
+			}
+			return true;
+		}
+
 		if (bRankedSession)
 		{
 			if (ExpectedPlayerCount != 0 && ExpectedPlayerCount == NumPlayers)
@@ -375,7 +375,7 @@ void AUTHUD_Showdown::DrawHUD()
 void AUTHUD_Showdown::DrawPlayerList()
 {
 	AUTShowdownGameState* GS = GetWorld()->GetGameState<AUTShowdownGameState>();
-	TArray<AUTPlayerState*> LivePlayers;
+	TArray<AUTPlayerState*, TFrameAllocator<>> LivePlayers;
 	for (APlayerState* PS : GS->PlayerArray)
 	{
 		AUTPlayerState* UTPS = Cast<AUTPlayerState>(PS);
@@ -0,0 +1,359 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "UnrealTournament.h"
+#include "UTOptimizePakOrderCommandlet.h"
+#include "IPlatformFilePak.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogOptimizePakOrderCommandlet, Log, All);
+
+namespace PakOrder
+{
+	/** A traced file and how it was opened across all sessions */
+	struct FFileInfo
+	{
+		FString Filename;
+		/** Sum of the file's position in each session's open order, normalized to [0,1] */
+		double RankSum;
+		int32 NumSessions;
+		/** Files opened right after this one, and in how many sessions */
+		TMap<int32, int32> Successors;
+
+		FFileInfo(const FString& InFilename)
+			: Filename(InFilename)
+			, RankSum(0.0)
+			, NumSessions(0)
+		{}
+
+		double GetMeanRank() const
+		{
+			return NumSessions > 0 ? RankSum / NumSessions : 1.0;
+		}
+	};
+
+	/** Where a file lives in a pak layout. Offsets of different paks are kept apart by PakBaseShift */
+	struct FLayoutEntry
+	{
+		int64 Offset;
+		int64 Size;
+	};
+
+	const int32 PakBaseShift = 40;
+
+	struct FSimulationResult
+	{
+		int64 Reads;
+		int64 Seeks;
+		int64 ReadAheadHits;
+
+		FSimulationResult()
+			: Reads(0)
+			, Seeks(0)
+			, ReadAheadHits(0)
+		{}
+	};
+
+	/** Loads one open log into a session, a list of file indices in first open order */
+	static bool LoadSession(const FString& LogFilename, TMap<FString, int32>& FileIndices, TArray<FFileInfo>& Files, TArray<int32>& OutSession)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadANSITextFileToStrings(*LogFilename, NULL, Lines))
+		{
+			return false;
+		}
+
+		// Lines are "filename" order, written as files get opened by several threads so not quite sorted
+		struct FOpen
+		{
+			int64 Order;
+			FString Filename;
+		};
+		TArray<FOpen> Opens;
+		for (const FString& Line : Lines)
+		{
+			const TCHAR* LineText = *Line;
+			FString Filename = FParse::Token(LineText, false);
+			const FString OrderString = FParse::Token(LineText, false);
+			if (!Filename.IsEmpty() && !OrderString.IsEmpty())
+			{
+				FPaths::NormalizeFilename(Filename);
+				FOpen Open;
+				Open.Order = FCString::Atoi64(*OrderString);
+				Open.Filename = Filename;
+				Opens.Add(Open);
+			}
+		}
+		Opens.StableSort([](const FOpen& A, const FOpen& B) { return A.Order < B.Order; });
+
+		OutSession.Reset();
+		for (const FOpen& Open : Opens)
+		{
+			int32* FileIndex = FileIndices.Find(Open.Filename);
+			if (FileIndex == NULL)
+			{
+				FileIndex = &FileIndices.Add(Open.Filename, Files.Add(FFileInfo(Open.Filename)));
+			}
+			OutSession.AddUnique(*FileIndex);
+		}
+		return OutSession.Num() > 0;
+	}
+
+	/**
+	 * Orders the files by when they are opened on average, pulling each file's usual successor in right behind it so
+	 * files that are opened together end up next to each other.
+	 */
+	static void ComputeOrder(const TArray<FFileInfo>& Files, float GroupThreshold, TArray<int32>& OutOrder)
+	{
+		TArray<int32> ByRank;
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++)
+		{
+			ByRank.Add(FileIndex);
+		}
+		ByRank.StableSort([&Files](int32 A, int32 B)
+		{
+			const double RankA = Files[A].GetMeanRank();
+			const double RankB = Files[B].GetMeanRank();
+			return RankA != RankB ? RankA < RankB : Files[A].NumSessions > Files[B].NumSessions;
+		});
+
+		TBitArray<> Placed(false, Files.Num());
+		OutOrder.Reset(Files.Num());
+
+		for (int32 FirstIndex : ByRank)
+		{
+			// Follow the chain of files that are usually opened next
+			for (int32 Current = FirstIndex; Current != INDEX_NONE && !Placed[Current]; )
+			{
+				Placed[Current] = true;
+				OutOrder.Add(Current);
+
+				const FFileInfo& File = Files[Current];
+				int32 Next = INDEX_NONE;
+				int32 NextCount = 0;
+				for (const auto& Successor : File.Successors)
+				{
+					if (!Placed[Successor.Key] && Successor.Value > NextCount && Successor.Value >= GroupThreshold * File.NumSessions)
+					{
+						Next = Successor.Key;
+						NextCount = Successor.Value;
+					}
+				}
+				Current = Next;
+			}
+		}
+	}
+
+	/**
+	 * Replays the sessions from a cold start against a layout. Each read that isn't already buffered costs a seek
+	 * unless it starts inside the buffered range, and every read buffers ReadAhead more bytes after it.
+	 */
+	static FSimulationResult Simulate(const TArray<TArray<int32>>& Sessions, const TMap<int32, FLayoutEntry>& Layout, int64 ReadAhead)
+	{
+		FSimulationResult Result;
+
+		for (const TArray<int32>& Session : Sessions)
+		{
+			int64 BufferStart = -1;
+			int64 BufferEnd = -1;
+
+			for (int32 FileIndex : Session)
+			{
+				const FLayoutEntry* Entry = Layout.Find(FileIndex);
+				if (Entry == NULL)
+				{
+					continue;
+				}
+
+				Result.Reads++;
+				const int64 End = Entry->Offset + Entry->Size;
+				if (Entry->Offset >= BufferStart && End <= BufferEnd)
+				{
+					Result.ReadAheadHits++;
+					continue;
+				}
+				if (Entry->Offset < BufferStart || Entry->Offset > BufferEnd)
+				{
+					Result.Seeks++;
+					BufferStart = Entry->Offset;
+				}
+				BufferEnd = End + ReadAhead;
+			}
+		}
+		return Result;
+	}
+
+	static void LogResult(const TCHAR* Name, const FSimulationResult& Result, int32 NumSessions)
+	{
+		UE_LOG(LogOptimizePakOrderCommandlet, Display, TEXT("%s: %lld reads, %lld seeks (%.1f per session), read ahead hit rate %.1f%%"),
+			Name, Result.Reads, Result.Seeks, NumSessions > 0 ? double(Result.Seeks) / NumSessions : 0.0,
+			Result.Reads > 0 ? 100.0 * Result.ReadAheadHits / Result.Reads : 0.0);
+	}
+}
+
+UUTOptimizePakOrderCommandlet::UUTOptimizePakOrderCommandlet(const FObjectInitializer& ObjectInitializer)
+: Super(ObjectInitializer)
+{
+	IsEditor = false;
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UUTOptimizePakOrderCommandlet::Main(const FString& Params)
+{
+	using namespace PakOrder;
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> SwitchParams;
+	ParseCommandLine(*Params, Tokens, Switches, SwitchParams);
+
+	const FString* TracesParam = SwitchParams.Find(TEXT("Traces"));
+	const FString* OutputParam = SwitchParams.Find(TEXT("Output"));
+	const FString* PakParam = SwitchParams.Find(TEXT("Pak"));
+	const FString* ReadAheadParam = SwitchParams.Find(TEXT("ReadAheadKB"));
+	const FString* ThresholdParam = SwitchParams.Find(TEXT("GroupThreshold"));
+
+	if (TracesParam == NULL || OutputParam == NULL)
+	{
+		UE_LOG(LogOptimizePakOrderCommandlet, Warning, TEXT("Usage: -run=UTOptimizePakOrder -Traces=<log or directory>[+...] -Output=<order file> [-Pak=<pak>[+...]] [-ReadAheadKB=256] [-GroupThreshold=0.5]"));
+		return 1;
+	}
+
+	const int64 ReadAhead = int64(ReadAheadParam ? FMath::Max(FCString::Atoi(**ReadAheadParam), 0) : 256) * 1024;
+	const float GroupThreshold = ThresholdParam ? FMath::Clamp(FCString::Atof(**ThresholdParam), 0.0f, 1.0f) : 0.5f;
+
+	// Gather the logs, directories stand for all the .log files in them
+	TArray<FString> TraceFilenames;
+	TArray<FString> TracePaths;
+	TracesParam->ParseIntoArray(TracePaths, TEXT("+"), true);
+	for (const FString& TracePath : TracePaths)
+	{
+		if (IFileManager::Get().DirectoryExists(*TracePath))
+		{
+			TArray<FString> Found;
+			IFileManager::Get().FindFiles(Found, *(TracePath / TEXT("*.log")), true, false);
+			for (const FString& Filename : Found)
+			{
+				TraceFilenames.Add(TracePath / Filename);
+			}
+		}
+		else
+		{
+			TraceFilenames.Add(TracePath);
+		}
+	}
+
+	TMap<FString, int32> FileIndices;
+	TArray<FFileInfo> Files;
+	TArray<TArray<int32>> Sessions;
+
+	for (const FString& TraceFilename : TraceFilenames)
+	{
+		TArray<int32> Session;
+		if (!LoadSession(TraceFilename, FileIndices, Files, Session))
+		{
+			UE_LOG(LogOptimizePakOrderCommandlet, Warning, TEXT("Skipping %s, it could not be read or is empty."), *TraceFilename);
+			continue;
+		}
+
+		for (int32 Position = 0; Position < Session.Num(); Position++)
+		{
+			FFileInfo& File = Files[Session[Position]];
+			File.RankSum += Session.Num() > 1 ? double(Position) / (Session.Num() - 1) : 0.0;
+			File.NumSessions++;
+			if (Position + 1 < Session.Num())
+			{
+				File.Successors.FindOrAdd(Session[Position + 1])++;
+			}
+		}
+		Sessions.Add(MoveTemp(Session));
+	}
+
+	if (Sessions.Num() == 0)
+	{
+		UE_LOG(LogOptimizePakOrderCommandlet, Error, TEXT("No usable open logs found in %s."), **TracesParam);
+		return 1;
+	}
+
+	TArray<int32> Order;
+	ComputeOrder(Files, GroupThreshold, Order);
+
+	FString OrderText;
+	for (int32 Index = 0; Index < Order.Num(); Index++)
+	{
+		OrderText += FString::Printf(TEXT("\"%s\" %d\n"), *Files[Order[Index]].Filename, Index + 1);
+	}
+	if (!FFileHelper::SaveStringToFile(OrderText, **OutputParam))
+	{
+		UE_LOG(LogOptimizePakOrderCommandlet, Error, TEXT("Failed to write %s."), **OutputParam);
+		return 1;
+	}
+	UE_LOG(LogOptimizePakOrderCommandlet, Display, TEXT("Wrote order of %d files from %d sessions to %s."), Order.Num(), Sessions.Num(), **OutputParam);
+
+	if (PakParam == NULL)
+	{
+		return 0;
+	}
+
+	// Compare the current pak layout with the same paks rebuilt in the new order
+	TMap<int32, FLayoutEntry> CurrentLayout;
+	TArray<FString> PakFilenames;
+	PakParam->ParseIntoArray(PakFilenames, TEXT("+"), true);
+	for (int32 PakIndex = 0; PakIndex < PakFilenames.Num(); PakIndex++)
+	{
+		FPakFile PakFile(&FPlatformFileManager::Get().GetPlatformFile(), *PakFilenames[PakIndex], false);
+		if (!PakFile.IsValid())
+		{
+			UE_LOG(LogOptimizePakOrderCommandlet, Warning, TEXT("Could not open pak %s."), *PakFilenames[PakIndex]);
+			continue;
+		}
+
+		for (FPakFile::FFileIterator It(PakFile); It; ++It)
+		{
+			FString Filename = PakFile.GetMountPoint() + It.Filename();
+			FPaths::NormalizeFilename(Filename);
+
+			const int32* FileIndex = FileIndices.Find(Filename);
+			if (FileIndex != NULL && !CurrentLayout.Contains(*FileIndex))
+			{
+				FLayoutEntry Entry;
+				Entry.Offset = (int64(PakIndex) << PakBaseShift) + It.Info().Offset;
+				Entry.Size = It.Info().Size;
+				CurrentLayout.Add(*FileIndex, Entry);
+			}
+		}
+	}
+
+	if (CurrentLayout.Num() == 0)
+	{
+		UE_LOG(LogOptimizePakOrderCommandlet, Warning, TEXT("None of the traced files are in %s."), **PakParam);
+		return 0;
+	}
+
+	// Ordered files go first in their pak, in the new order
+	TMap<int32, FLayoutEntry> OptimizedLayout;
+	TMap<int64, int64> PakEnds;
+	for (int32 FileIndex : Order)
+	{
+		const FLayoutEntry* Current = CurrentLayout.Find(FileIndex);
+		if (Current != NULL)
+		{
+			const int64 PakBase = (Current->Offset >> PakBaseShift) << PakBaseShift;
+			int64& PakEnd = PakEnds.FindOrAdd(PakBase);
+
+			FLayoutEntry Entry;
+			Entry.Offset = PakBase + PakEnd;
+			Entry.Size = Current->Size;
+			OptimizedLayout.Add(FileIndex, Entry);
+
+			PakEnd += Current->Size;
+		}
+	}
+
+	UE_LOG(LogOptimizePakOrderCommandlet, Display, TEXT("Cold start replay of %d sessions, %d of %d traced files found in the paks, %lld KB read ahead:"),
+		Sessions.Num(), CurrentLayout.Num(), Files.Num(), ReadAhead / 1024);
+	LogResult(TEXT("Current layout"), Simulate(Sessions, CurrentLayout, ReadAhead), Sessions.Num());
+	LogResult(TEXT("Optimized layout"), Simulate(Sessions, OptimizedLayout, ReadAhead), Sessions.Num());
+
+	return 0;
+}
@@ -0,0 +1,227 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#include "UnrealTournament.h"
+#include "UTRecastNavMesh.h"
+#include "UTPathLandmarks.h"
+#include "UTReachSpec.h"
+
+void FUTPathLandmarkTable::Reset()
+{
+	NumNodes = 0;
+	GraphHash = 0;
+	Landmarks.Empty();
+	FromLandmark.Empty();
+	ToLandmark.Empty();
+}
+
+/** adjacency entry of the relaxed graph used for building */
+struct FLandmarkEdge
+{
+	int32 Target;
+	int32 Cost;
+};
+
+/** collects the relaxed graph edges (if OutForward and OutReverse are given) and returns a hash of their endpoints and costs */
+static uint32 GatherLandmarkEdges(const AUTRecastNavMesh* NavMesh, const TArray<UUTPathNode*>& PathNodes, TArray< TArray<FLandmarkEdge> >* OutForward, TArray< TArray<FLandmarkEdge> >* OutReverse)
+{
+	TMap<const UUTPathNode*, int32> NodeIndices;
+	for (int32 i = 0; i < PathNodes.Num(); i++)
+	{
+		NodeIndices.Add(PathNodes[i], i);
+	}
+	if (OutForward != NULL && OutReverse != NULL)
+	{
+		OutForward->Reset();
+		OutForward->SetNum(PathNodes.Num());
+		OutReverse->Reset();
+		OutReverse->SetNum(PathNodes.Num());
+	}
+
+	// cheapest cost of each link for any agent; FUTPathLink::CostFor() only adds to the stored distance and UUTReachSpec::GetMinCost() bounds what the spec can take off
+	uint32 Hash = uint32(PathNodes.Num());
+	for (int32 i = 0; i < PathNodes.Num(); i++)
+	{
+		const UUTPathNode* Node = PathNodes[i];
+		if (Node == NULL)
+		{
+			continue;
+		}
+		for (const FUTPathLink& Link : Node->Paths)
+		{
+			const int32* EndIndex = Link.End.IsValid() ? NodeIndices.Find(Link.End.Get()) : NULL;
+			if (EndIndex != NULL)
+			{
+				int32 MinCost = MAX_int32;
+				for (int32 j = 0; j < Node->Polys.Num() && j < Link.Distances.Num(); j++)
+				{
+					int32 Cost = Link.Distances[j];
+					if (Cost <= 0)
+					{
+						FVector Center1 = FVector::ZeroVector;
+						FVector Center2 = FVector::ZeroVector;
+						Cost = (NavMesh->GetPolyCenter(Node->Polys[j], Center1) && NavMesh->GetPolyCenter(Link.EndPoly, Center2)) ? FMath::TruncToInt((Center2 - Center1).Size()) : 1;
+					}
+					if (Link.Spec.IsValid())
+					{
+						Cost = Link.Spec->GetMinCost(Cost, Link, NavMesh);
+					}
+					MinCost = FMath::Min<int32>(MinCost, Cost);
+				}
+				// FindBestPath() never uses a cost below 1
+				MinCost = (MinCost == MAX_int32) ? 1 : FMath::Max<int32>(1, MinCost);
+
+				const int32 HashData[3] = { i, *EndIndex, MinCost };
+				Hash = FCrc::MemCrc32(HashData, sizeof(HashData), Hash);
+
+				if (OutForward != NULL && OutReverse != NULL)
+				{
+					FLandmarkEdge Edge;
+					Edge.Target = *EndIndex;
+					Edge.Cost = MinCost;
+					(*OutForward)[i].Add(Edge);
+					Edge.Target = i;
+					(*OutReverse)[*EndIndex].Add(Edge);
+				}
+			}
+		}
+	}
+	return Hash;
+}
+
+bool FUTPathLandmarkTable::MatchesGraph(const AUTRecastNavMesh* NavMesh, const TArray<UUTPathNode*>& PathNodes) const
+{
+	return IsValid() && NumNodes == PathNodes.Num() && GraphHash == GatherLandmarkEdges(NavMesh, PathNodes, NULL, NULL);
+}
+
+/** single source shortest paths over the given adjacency lists */
+static void LandmarkDijkstra(const TArray< TArray<FLandmarkEdge> >& Edges, int32 Source, TArray<int32>& OutDistances)
+{
+	OutDistances.Reset();
+	OutDistances.Init(MAX_int32, Edges.Num());
+	OutDistances[Source] = 0;
+
+	struct FQueued
+	{
+		int32 Node;
+		int32 Distance;
+	};
+	struct FQueuedPredicate
+	{
+		bool operator()(const FQueued& A, const FQueued& B) const
+		{
+			return A.Distance < B.Distance;
+		}
+	};
+	TArray<FQueued> Queue;
+	Queue.HeapPush(FQueued{ Source, 0 }, FQueuedPredicate());
+	while (Queue.Num() > 0)
+	{
+		FQueued Current;
+		Queue.HeapPop(Current, FQueuedPredicate(), false);
+		if (Current.Distance > OutDistances[Current.Node])
+		{
+			continue; // stale entry
+		}
+		for (const FLandmarkEdge& Edge : Edges[Current.Node])
+		{
+			const int32 NewDistance = Current.Distance + Edge.Cost;
+			if (NewDistance < OutDistances[Edge.Target])
+			{
+				OutDistances[Edge.Target] = NewDistance;
+				Queue.HeapPush(FQueued{ Edge.Target, NewDistance }, FQueuedPredicate());
+			}
+		}
+	}
+}
+
+static void StoreLandmarkDistances(const TArray<int32>& Distances, uint16* Dest)
+{
+	for (int32 i = 0; i < Distances.Num(); i++)
+	{
+		const int32 Scaled = (Distances[i] == MAX_int32) ? FUTPathLandmarkTable::UnreachableDistance : Distances[i] / FUTPathLandmarkTable::DistanceScale;
+		Dest[i] = uint16(FMath::Min<int32>(Scaled, FUTPathLandmarkTable::UnreachableDistance));
+	}
+}
+
+void FUTPathLandmarkTable::Build(const AUTRecastNavMesh* NavMesh, const TArray<UUTPathNode*>& PathNodes, int32 NumLandmarks)
+{
+	Reset();
+
+	NumNodes = PathNodes.Num();
+	if (NumNodes == 0 || NumLandmarks <= 0)
+	{
+		return;
+	}
+
+	TArray< TArray<FLandmarkEdge> > Forward, Reverse;
+	GraphHash = GatherLandmarkEdges(NavMesh, PathNodes, &Forward, &Reverse);
+
+	// farthest point selection: each new landmark is the node farthest from all landmarks picked so far
+	TArray<int32> MinDistance;
+	MinDistance.Init(MAX_int32, NumNodes);
+	TArray<int32> Distances;
+	int32 NextLandmark = 0;
+	{
+		// start from the node farthest from an arbitrary node rather than the arbitrary node itself
+		LandmarkDijkstra(Forward, 0, Distances);
+		int32 Farthest = 0;
+		for (int32 i = 0; i < NumNodes; i++)
+		{
+			if (Distances[i] != MAX_int32 && Distances[i] > Distances[Farthest])
+			{
+				Farthest = i;
+			}
+		}
+		NextLandmark = Farthest;
+	}
+	while (NextLandmark != INDEX_NONE && Landmarks.Num() < NumLandmarks)
+	{
+		const int32 Base = Landmarks.Num() * NumNodes;
+		Landmarks.Add(NextLandmark);
+		FromLandmark.AddUninitialized(NumNodes);
+		ToLandmark.AddUninitialized(NumNodes);
+
+		LandmarkDijkstra(Forward, NextLandmark, Distances);
+		StoreLandmarkDistances(Distances, FromLandmark.GetData() + Base);
+		for (int32 i = 0; i < NumNodes; i++)
+		{
+			MinDistance[i] = FMath::Min<int32>(MinDistance[i], Distances[i]);
+		}
+		LandmarkDijkstra(Reverse, NextLandmark, Distances);
+		StoreLandmarkDistances(Distances, ToLandmark.GetData() + Base);
+
+		// nodes unreachable from the first landmark are usually isolated (e.g. destination only) so aren't worth a landmark
+		NextLandmark = INDEX_NONE;
+		int32 BestDistance = 0;
+		for (int32 i = 0; i < NumNodes; i++)
+		{
+			if (PathNodes[i] != NULL && MinDistance[i] != MAX_int32 && MinDistance[i] > BestDistance && !Landmarks.Contains(i))
+			{
+				BestDistance = MinDistance[i];
+				NextLandmark = i;
+			}
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FUTPathLandmarkTable& Table)
+{
+	// version so tables saved in an older layout are rebuilt instead of misread
+	uint32 Version = FUTPathLandmarkTable::SerializeVersion;
+	Ar << Version;
+	if (Version != FUTPathLandmarkTable::SerializeVersion)
+	{
+		Ar.SetError();
+		Table.Reset();
+		return Ar;
+	}
+	Ar << Table.NumNodes;
+	Ar << Table.GraphHash;
+	Ar << Table.Landmarks;
+	Ar << Table.FromLandmark;
+	Ar << Table.ToLandmark;
+	if (Ar.IsLoading() && (Table.FromLandmark.Num() != Table.Landmarks.Num() * Table.NumNodes || Table.ToLandmark.Num() != Table.Landmarks.Num() * Table.NumNodes))
+	{
+		Table.Reset();
+	}
+	return Ar;
+}
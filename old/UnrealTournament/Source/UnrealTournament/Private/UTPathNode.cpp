@@ -220,6 +220,7 @@ UUTPathNode::UUTPathNode(const FObjectInitializer& ObjectInitializer)
 #if WITH_EDITORONLY_DATA
 	DebugDrawColor = FColor::MakeRandomColor();
 #endif
+	SearchIndex = INDEX_NONE;
 }
 
 int32 UUTPathNode::GetBestLinkTo(NavNodeRef StartPoly, const struct FRouteCacheItem& Target, APawn* Asker, const FNavAgentProperties& AgentProps, const AUTRecastNavMesh* NavMesh) const
@@ -68,7 +68,8 @@ AUTPlayerCameraManager::AUTPlayerCameraManager(const class FObjectInitializer& O
 	WallSlideCameraRoll = 12.5f;
 	DeathCamFOV = 100.f;
 
-	FocusTraceSystem::Instance()->InitializeCapture();
+	// capture factory and -capres settings have to be in place before BeginPlay starts the first capture
+	UTFocusInitializeCapture();
 }
 
 void AUTPlayerCameraManager::BeginPlay()
@@ -18,6 +18,7 @@
 #include "MessageLog.h"
 #include "UObjectToken.h"
 #include "UTMatineeActor.h"
+#include "ParallelFor.h"
 #if WITH_EDITOR
 #include "EditorBuildUtils.h"
 #include "MapErrors.h"
@@ -30,6 +31,21 @@
 #include "NotificationManager.h"
 #endif
 
+TAutoConsoleVariable<int32> CVarUTRecordPathQueries(
+	TEXT("UT.RecordPathQueries"),
+	0,
+	TEXT("Records successful FindBestPath() queries for replay with UT.BenchmarkPathQueries.\n"));
+
+TAutoConsoleVariable<int32> CVarUTParallelPathBuild(
+	TEXT("UT.ParallelPathBuild"),
+	1,
+	TEXT("Run the jump trace tests of full UT path builds on task graph worker threads.\n"));
+
+TAutoConsoleVariable<int32> CVarUTPathLandmarkCount(
+	TEXT("UT.PathLandmarkCount"),
+	12,
+	TEXT("Number of landmark nodes in the path distance table used for A* heuristics. 0 disables the table.\n"));
+
 void DrawDebugRoute(UWorld* World, APawn* QueryPawn, const TArray<FRouteCacheItem>& Route)
 {
 #if ENABLE_DRAW_DEBUG
@@ -622,6 +638,9 @@ void AUTRecastNavMesh::BuildNodeNetwork()
 		}
 	} QueryMark(this);
 
+	const double NodeNetworkStartTime = FPlatformTime::Seconds();
+	LastPathBuildMetrics = FUTPathBuildMetrics();
+
 	DeletePaths();
 
 	// move matinees with a path building position
@@ -1010,6 +1029,8 @@ void AUTRecastNavMesh::BuildNodeNetwork()
 		Builder->AddSpecialPaths(NULL, this);
 	}
 
+	LastPathBuildMetrics.NodeNetworkTime = FPlatformTime::Seconds() - NodeNetworkStartTime;
+
 	// start jump path generation (spread over a number of ticks)
 	SpecialLinkBuildNodeIndex = 0;
 	SpecialLinkBuildPass = 0;
@@ -1044,6 +1065,24 @@ void AUTRecastNavMesh::BuildNodeNetwork()
 #endif
 }
 
+void AUTRecastNavMesh::RecordPathBuildMetrics()
+{
+	const FUTPathBuildMetrics& M = LastPathBuildMetrics;
+	UE_LOG(UT, Log, TEXT("Path build times: node network %.1f ms, wall jumps %.1f ms, jump ups %.1f ms (%i candidates, gather %.1f ms, apply %.1f ms)"),
+		M.NodeNetworkTime * 1000.0, M.WallJumpTime * 1000.0, M.JumpUpTraceTime * 1000.0, M.JumpUpCandidates, M.JumpUpGatherTime * 1000.0, M.JumpUpApplyTime * 1000.0);
+
+	// keep a history per map so build changes can be compared
+	const FString Filename = FPaths::GameSavedDir() + TEXT("PathBuildMetrics.csv");
+	FString Line;
+	if (!FPaths::FileExists(Filename))
+	{
+		Line = TEXT("Map,Date,Nodes,Links,JumpLinks,NodeNetworkMs,WallJumpMs,JumpUpMs,JumpUpCandidates,JumpUpGatherMs,JumpUpApplyMs\n");
+	}
+	Line += FString::Printf(TEXT("%s,%s,%i,%i,%i,%.1f,%.1f,%.1f,%i,%.1f,%.1f\n"), *GetOutermost()->GetName(), *FDateTime::Now().ToString(), M.NumNodes, M.NumLinks, M.NumJumpLinks,
+		M.NodeNetworkTime * 1000.0, M.WallJumpTime * 1000.0, M.JumpUpTraceTime * 1000.0, M.JumpUpCandidates, M.JumpUpGatherTime * 1000.0, M.JumpUpApplyTime * 1000.0);
+	FFileHelper::SaveStringToFile(Line, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
 bool AUTRecastNavMesh::IsValidJumpPoint(const FVector& TestPolyCenter) const
 {
 	// skip if poly is under the world's KillZ
@@ -1171,6 +1210,7 @@ void AUTRecastNavMesh::BuildSpecialLinks(int32 NumToProcess)
 
 			if (SpecialLinkBuildPass == 0)
 			{
+				const double PassStartTime = FPlatformTime::Seconds();
 				for (; SpecialLinkBuildNodeIndex < PathNodes.Num() && NumToProcess > 0; SpecialLinkBuildNodeIndex++, NumToProcess--)
 				{
 					UUTPathNode* Node = PathNodes[SpecialLinkBuildNodeIndex];
@@ -1459,6 +1499,7 @@ void AUTRecastNavMesh::BuildSpecialLinks(int32 NumToProcess)
 						}
 					}
 				}
+				LastPathBuildMetrics.WallJumpTime += FPlatformTime::Seconds() - PassStartTime;
 				if (!PathNodes.IsValidIndex(SpecialLinkBuildNodeIndex))
 				{
 					SpecialLinkBuildPass++;
@@ -1468,8 +1509,173 @@ void AUTRecastNavMesh::BuildSpecialLinks(int32 NumToProcess)
 			// second pass: find all jump downs that are one way and jump test back up
 			// this is a more optimized approach to generating jump paths from open areas up to ledges and such
 			// which won't be detected by the previous pass due to checking only jumps from poly walls
-			if (SpecialLinkBuildPass == 1)
+			if (SpecialLinkBuildPass == 1 && CVarUTParallelPathBuild.GetValueOnGameThread() != 0 && FApp::ShouldUseThreadingForPerformance() && NumToProcess >= PathNodes.Num() - SpecialLinkBuildNodeIndex)
 			{
+				// same as the serial loop below, split in three steps so the jump simulations can run on worker threads:
+				// gather candidates on the game thread (UObject access, FindTeleportSpot()), trace in parallel, then add links in the original order
+				const double GatherStartTime = FPlatformTime::Seconds();
+				struct FJumpUpCandidate
+				{
+					UUTPathNode* Node;
+					UUTPathNode* StartNode;
+					NavNodeRef EndPoly;
+					FVector TestLoc;
+					int32 CollisionRadius;
+					int32 CollisionHeight;
+					APhysicsVolume* GravityVolume;
+					float GravityZ;
+					/** polys to jump from in test order and the adjusted start location of each, FVector::ZeroVector if there is no room */
+					TArray<NavNodeRef> TestPolys;
+					TArray<FVector> StartLocs;
+					/** results */
+					int32 FoundIndex;
+					float RequiredJumpZ;
+					float DodgeJumpZ;
+				};
+				TArray<FJumpUpCandidate> Candidates;
+				for (; SpecialLinkBuildNodeIndex < PathNodes.Num(); SpecialLinkBuildNodeIndex++, NumToProcess--)
+				{
+					UUTPathNode* Node = PathNodes[SpecialLinkBuildNodeIndex];
+					for (const FUTPathLink& Link : Node->Paths)
+					{
+						if ( !Link.End->bDestinationOnly && (Link.ReachFlags == R_JUMP) &&
+							(!Link.Spec.IsValid() || (Cast<UUTReachSpec_HighJump>(Link.Spec.Get()) != NULL && !((UUTReachSpec_HighJump*)Link.Spec.Get())->bJumpFromEdgePolyCenter)) &&
+							GetPolyCenter(Link.StartEdgePoly).Z > GetPolyCenter(Link.EndPoly).Z )
+						{
+							const FVector TestLoc = GetPolyCenter(Link.StartEdgePoly) + HeightAdjust;
+							bool bSkipForLift = false;
+							for (const FVector& LiftLoc : LiftHackLocs)
+							{
+								if ((TestLoc - LiftLoc).SizeSquared() < 250000.0f) // 500 * 500
+								{
+									bSkipForLift = true;
+									break;
+								}
+							}
+							if (!bSkipForLift)
+							{
+								FJumpUpCandidate* Candidate = new(Candidates) FJumpUpCandidate;
+								Candidate->Node = Node;
+								Candidate->StartNode = const_cast<UUTPathNode*>(Link.End.Get());
+								Candidate->EndPoly = Link.StartEdgePoly;
+								Candidate->TestLoc = TestLoc;
+								Candidate->CollisionRadius = Link.CollisionRadius;
+								Candidate->CollisionHeight = Link.CollisionHeight;
+								Candidate->GravityVolume = Node->PhysicsVolume;
+								Candidate->GravityZ = (Node->PhysicsVolume != NULL) ? Node->PhysicsVolume->GetGravityZ() : GetWorld()->GetGravityZ();
+								Candidate->FoundIndex = INDEX_NONE;
+								Candidate->RequiredJumpZ = 0.0f;
+								Candidate->DodgeJumpZ = 0.0f;
+								Candidate->TestPolys.Add(Link.EndPoly);
+								Candidate->TestPolys += Link.AdditionalEndPolys;
+								Candidate->TestPolys.Sort([=](const NavNodeRef A, const NavNodeRef B) { return (GetPolyCenter(A) - TestLoc).SizeSquared() < (GetPolyCenter(B) - TestLoc).SizeSquared(); });
+								for (int32 i = 0; i < Candidate->TestPolys.Num(); i++)
+								{
+									if (Link.End->Paths.ContainsByPredicate([&](const FUTPathLink& TestItem) { return TestItem.End == Node && TestItem.StartEdgePoly == Candidate->TestPolys[i] && TestItem.EndPoly == Candidate->EndPoly; }))
+									{
+										Candidate->TestPolys.RemoveAt(i, Candidate->TestPolys.Num() - i);
+										break;
+									}
+								}
+								for (NavNodeRef StartPoly : Candidate->TestPolys)
+								{
+									FVector StartLoc = GetPolySurfaceCenter(StartPoly) + HeightAdjust;
+									if (GetWorld()->FindTeleportSpot(DefaultScout, StartLoc, (TestLoc - StartLoc).GetSafeNormal2D().Rotation()))
+									{
+										StartLoc.Z += 0.5f; // avoid precision issues
+										Candidate->StartLocs.Add(StartLoc);
+									}
+									else
+									{
+										Candidate->StartLocs.Add(FVector::ZeroVector);
+									}
+								}
+							}
+						}
+					}
+				}
+
+				const double TraceStartTime = FPlatformTime::Seconds();
+				const AUTCharacter* UTScout = Cast<AUTCharacter>(DefaultScout);
+				const float ScoutWalkSpeed = DefaultScout->GetCharacterMovement()->MaxWalkSpeed;
+				const float DodgeSpeed = (UTScout != NULL) ? UTScout->UTCharacterMovement->DodgeImpulseHorizontal : 0.0f;
+				// traced in chunks so the game thread can keep the editor progress bar moving between them
+				const int32 ChunkSize = 256;
+				for (int32 ChunkStart = 0; ChunkStart < Candidates.Num(); ChunkStart += ChunkSize)
+				{
+					if (bDisplayProgressDialog)
+					{
+						GWarn->UpdateProgress(PathNodes.Num() + int32(int64(ChunkStart) * PathNodes.Num() / Candidates.Num()), PathNodes.Num() * 2);
+					}
+					ParallelFor(FMath::Min<int32>(ChunkSize, Candidates.Num() - ChunkStart), [&](int32 ChunkIndex)
+					{
+						FJumpUpCandidate& Candidate = Candidates[ChunkStart + ChunkIndex];
+						for (int32 i = 0; i < Candidate.TestPolys.Num(); i++)
+						{
+							if (!Candidate.StartLocs[i].IsZero())
+							{
+								float RequiredJumpZ = 0.0f;
+								if (JumpTraceTest(Candidate.StartLocs[i], Candidate.TestLoc, Candidate.TestPolys[i], Candidate.EndPoly, ScoutShape, ScoutWalkSpeed, Candidate.GravityZ, BaseJumpZ, -1.0f, &RequiredJumpZ) && RequiredJumpZ > BaseJumpZ)
+								{
+									Candidate.FoundIndex = i;
+									Candidate.RequiredJumpZ = RequiredJumpZ;
+									if (DodgeSpeed > ScoutWalkSpeed)
+									{
+										float DodgeJumpZ = 0.0f;
+										if (JumpTraceTest(Candidate.StartLocs[i], Candidate.TestLoc, Candidate.TestPolys[i], Candidate.EndPoly, ScoutShape, DodgeSpeed, Candidate.GravityZ, BaseJumpZ, RequiredJumpZ, &DodgeJumpZ))
+										{
+											Candidate.DodgeJumpZ = DodgeJumpZ;
+										}
+									}
+									break;
+								}
+							}
+						}
+					});
+				}
+
+				const double ApplyStartTime = FPlatformTime::Seconds();
+				for (const FJumpUpCandidate& Candidate : Candidates)
+				{
+					if (Candidate.FoundIndex != INDEX_NONE)
+					{
+						// links added by earlier candidates may make this one redundant, the serial build would have skipped testing the poly in that case
+						bool bRedundant = false;
+						for (int32 i = 0; i <= Candidate.FoundIndex && !bRedundant; i++)
+						{
+							bRedundant = Candidate.StartNode->Paths.ContainsByPredicate([&](const FUTPathLink& TestItem) { return TestItem.End == Candidate.Node && TestItem.StartEdgePoly == Candidate.TestPolys[i] && TestItem.EndPoly == Candidate.EndPoly; });
+						}
+						if (!bRedundant)
+						{
+							const NavNodeRef StartPoly = Candidate.TestPolys[Candidate.FoundIndex];
+							UUTReachSpec_HighJump* JumpSpec = NewObject<UUTReachSpec_HighJump>(Candidate.StartNode);
+							JumpSpec->bJumpFromEdgePolyCenter = true;
+							JumpSpec->RequiredJumpZ = Candidate.RequiredJumpZ;
+							if (Candidate.DodgeJumpZ != 0.0f)
+							{
+								JumpSpec->DodgeJumpZMult = Candidate.DodgeJumpZ / Candidate.RequiredJumpZ;
+							}
+							JumpSpec->GravityVolume = Candidate.GravityVolume;
+							JumpSpec->OriginalGravityZ = Candidate.GravityZ;
+							JumpSpec->JumpStart = GetPolyCenter(StartPoly);
+							JumpSpec->JumpEnd = GetPolyCenter(Candidate.EndPoly);
+							AllReachSpecs.Add(JumpSpec);
+							FUTPathLink* NewLink = new(Candidate.StartNode->Paths) FUTPathLink(Candidate.StartNode, StartPoly, Candidate.Node, Candidate.EndPoly, JumpSpec, FMath::Max<int32>(Candidate.CollisionRadius, PathSize.Radius), FMath::Max<int32>(Candidate.CollisionHeight, PathSize.Height), R_JUMP);
+							CalcJumpPathDistance(*NewLink);
+						}
+					}
+				}
+
+				LastPathBuildMetrics.JumpUpCandidates = Candidates.Num();
+				LastPathBuildMetrics.JumpUpGatherTime = TraceStartTime - GatherStartTime;
+				LastPathBuildMetrics.JumpUpTraceTime = ApplyStartTime - TraceStartTime;
+				LastPathBuildMetrics.JumpUpApplyTime = FPlatformTime::Seconds() - ApplyStartTime;
+				SpecialLinkBuildPass++;
+				SpecialLinkBuildNodeIndex = 0;
+			}
+			else if (SpecialLinkBuildPass == 1)
+			{
+				const double PassStartTime = FPlatformTime::Seconds();
 				for (; SpecialLinkBuildNodeIndex < PathNodes.Num() && NumToProcess > 0; SpecialLinkBuildNodeIndex++, NumToProcess--)
 				{
 					UUTPathNode* Node = PathNodes[SpecialLinkBuildNodeIndex];
@@ -1590,6 +1796,7 @@ void AUTRecastNavMesh::BuildSpecialLinks(int32 NumToProcess)
 						}
 					}
 				}
+				LastPathBuildMetrics.JumpUpTraceTime += FPlatformTime::Seconds() - PassStartTime;
 				if (!PathNodes.IsValidIndex(SpecialLinkBuildNodeIndex))
 				{
 					SpecialLinkBuildPass++;
@@ -1616,6 +1823,10 @@ void AUTRecastNavMesh::BuildSpecialLinks(int32 NumToProcess)
 					}
 				}
 				UE_LOG(UT, Log, TEXT("Built %i total paths (%i jump paths)"), TotalCount, JumpCount);
+				LastPathBuildMetrics.NumNodes = PathNodes.Num();
+				LastPathBuildMetrics.NumLinks = TotalCount;
+				LastPathBuildMetrics.NumJumpLinks = JumpCount;
+				RecordPathBuildMetrics();
 
 				UE_LOG(UT, Log, TEXT("PathNode special link building complete"));
 				SpecialLinkBuildNodeIndex = INDEX_NONE;
@@ -1642,6 +1853,7 @@ void AUTRecastNavMesh::DeletePaths()
 	PolyToNode.Empty();
 	AllReachSpecs.Empty();
 	POIToNode.Empty();
+	PathLandmarks.Reset();
 	VolumeToNode.Empty();
 	SpecialLinkBuildNodeIndex = INDEX_NONE;
 	SpecialLinkBuildPass = 0;
@@ -1747,7 +1959,14 @@ NavNodeRef AUTRecastNavMesh::UTFindNearestPoly(const FVector& Loc, const FVector
 			{
 				NavNodeRef ResultPolys[10];
 				int32 NumPolys = 0;
-				GetRecastNavMeshImpl()->SharedNavQuery.queryPolygons((float*)&RecastCenter, (float*)&RecastExtent, GetDefaultDetourFilter(), ResultPolys, &NumPolys, ARRAY_COUNT(ResultPolys));
+				// may be called from path building worker threads
+				dtNavMeshQuery NavQuery;
+				dtNavMeshQuery& NavQueryVariable = IsInGameThread() ? GetRecastNavMeshImpl()->SharedNavQuery : NavQuery;
+				if (!IsInGameThread())
+				{
+					NavQuery.init(GetRecastNavMeshImpl()->GetRecastMesh(), RECAST_MAX_SEARCH_NODES);
+				}
+				NavQueryVariable.queryPolygons((float*)&RecastCenter, (float*)&RecastExtent, GetDefaultDetourFilter(), ResultPolys, &NumPolys, ARRAY_COUNT(ResultPolys));
 				Extent2DPolys.Reserve(NumPolys);
 				for (int32 i = 0; i < NumPolys; i++)
 				{
@@ -2112,6 +2331,155 @@ FUTReachParams::FUTReachParams(APawn* Asker, const FNavAgentProperties& AgentPro
 	}
 }
 
+void FUTPathSearchState::BeginQuery(int32 NumNodes)
+{
+	if (Nodes.Num() != NumNodes)
+	{
+		Nodes.SetNumUninitialized(NumNodes);
+		for (FUTPathSearchNode& Entry : Nodes)
+		{
+			Entry.Generation = 0;
+		}
+		Generation = 0;
+	}
+	Generation++;
+	if (Generation == 0)
+	{
+		// wrapped, make sure no entry appears current
+		for (FUTPathSearchNode& Entry : Nodes)
+		{
+			Entry.Generation = 0;
+		}
+		Generation = 1;
+	}
+	OpenList.Reset();
+}
+
+FUTPathSearchNode& FUTPathSearchState::Touch(int32 Index, NavNodeRef InPoly)
+{
+	FUTPathSearchNode& Entry = Nodes[Index];
+	if (Entry.Generation != Generation)
+	{
+		Entry.Generation = Generation;
+		Entry.Poly = InPoly;
+		Entry.TotalDistance = BLOCKED_PATH_COST;
+		Entry.HeapCost = BLOCKED_PATH_COST;
+		Entry.PrevPath = INDEX_NONE;
+		Entry.HeapIndex = INDEX_NONE;
+		Entry.bAlreadyVisited = false;
+	}
+	return Entry;
+}
+
+void FUTPathSearchState::PushOrDecrease(int32 Index)
+{
+	FUTPathSearchNode& Entry = Nodes[Index];
+	if (Entry.HeapIndex == INDEX_NONE)
+	{
+		Entry.HeapIndex = OpenList.Add(Index);
+	}
+	SiftUp(Entry.HeapIndex);
+}
+
+int32 FUTPathSearchState::PopMin()
+{
+	if (OpenList.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+	else
+	{
+		const int32 Result = OpenList[0];
+		Nodes[Result].HeapIndex = INDEX_NONE;
+		const int32 Last = OpenList.Pop(false);
+		if (OpenList.Num() > 0)
+		{
+			OpenList[0] = Last;
+			Nodes[Last].HeapIndex = 0;
+			SiftDown(0);
+		}
+		return Result;
+	}
+}
+
+void FUTPathSearchState::SiftUp(int32 HeapPos)
+{
+	const int32 Index = OpenList[HeapPos];
+	const int32 Cost = Nodes[Index].HeapCost;
+	while (HeapPos > 0)
+	{
+		const int32 ParentPos = (HeapPos - 1) / 2;
+		const int32 ParentIndex = OpenList[ParentPos];
+		if (Nodes[ParentIndex].HeapCost <= Cost)
+		{
+			break;
+		}
+		OpenList[HeapPos] = ParentIndex;
+		Nodes[ParentIndex].HeapIndex = HeapPos;
+		HeapPos = ParentPos;
+	}
+	OpenList[HeapPos] = Index;
+	Nodes[Index].HeapIndex = HeapPos;
+}
+
+void FUTPathSearchState::SiftDown(int32 HeapPos)
+{
+	const int32 Index = OpenList[HeapPos];
+	const int32 Cost = Nodes[Index].HeapCost;
+	const int32 Count = OpenList.Num();
+	while (true)
+	{
+		int32 ChildPos = HeapPos * 2 + 1;
+		if (ChildPos >= Count)
+		{
+			break;
+		}
+		if (ChildPos + 1 < Count && Nodes[OpenList[ChildPos + 1]].HeapCost < Nodes[OpenList[ChildPos]].HeapCost)
+		{
+			ChildPos++;
+		}
+		const int32 ChildIndex = OpenList[ChildPos];
+		if (Nodes[ChildIndex].HeapCost >= Cost)
+		{
+			break;
+		}
+		OpenList[HeapPos] = ChildIndex;
+		Nodes[ChildIndex].HeapIndex = HeapPos;
+		HeapPos = ChildPos;
+	}
+	OpenList[HeapPos] = Index;
+	Nodes[Index].HeapIndex = HeapPos;
+}
+
+void AUTRecastNavMesh::UpdateSearchIndices()
+{
+	for (int32 i = 0; i < PathNodes.Num(); i++)
+	{
+		if (PathNodes[i] != NULL)
+		{
+			PathNodes[i]->SearchIndex = i;
+		}
+	}
+}
+
+int32 AUTRecastNavMesh::GetSearchIndex(const UUTPathNode* Node)
+{
+	if (Node == NULL)
+	{
+		return INDEX_NONE;
+	}
+	else if (PathNodes.IsValidIndex(Node->SearchIndex) && PathNodes[Node->SearchIndex] == Node)
+	{
+		return Node->SearchIndex;
+	}
+	else
+	{
+		// node graph changed since the indices were assigned
+		UpdateSearchIndices();
+		return (PathNodes.IsValidIndex(Node->SearchIndex) && PathNodes[Node->SearchIndex] == Node) ? Node->SearchIndex : INDEX_NONE;
+	}
+}
+
 bool AUTRecastNavMesh::FindBestPath(APawn* Asker, const FNavAgentProperties& AgentProps, AController* RequestOwner, FUTNodeEvaluator& NodeEval, const FVector& StartLoc, float& Weight, bool bAllowDetours, TArray<FRouteCacheItem>& NodeRoute, TArray<int32>* NodeCosts)
 {
 	DECLARE_CYCLE_STAT(TEXT("UT node pathing time"), STAT_Navigation_UTPathfinding, STATGROUP_Navigation);
@@ -2165,39 +2533,38 @@ bool AUTRecastNavMesh::FindBestPath(APawn* Asker, const FNavAgentProperties& Age
 			B->SetupSpecialPathAbilities();
 		}
 
-		struct FEvaluatedNode
+		const int32 StartIndex = GetSearchIndex(StartNode);
+		if (StartIndex == INDEX_NONE)
 		{
-			const UUTPathNode* Node;
-			NavNodeRef Poly;
-			int32 TotalDistance;
-			FEvaluatedNode* PrevPath;
-			FEvaluatedNode* PrevOrdered;
-			FEvaluatedNode* NextOrdered;
-			bool bAlreadyVisited;
-
-			FEvaluatedNode(const UUTPathNode* InNode, NavNodeRef InPoly, TMap<const UUTPathNode*, FEvaluatedNode*>& InNodeMap)
-				: Node(InNode), Poly(InPoly), TotalDistance(BLOCKED_PATH_COST), PrevPath(NULL), PrevOrdered(NULL), NextOrdered(NULL), bAlreadyVisited(false)
-			{
-				InNodeMap.Add(Node, this);
-			}
-		};
-		FEvaluatedNode* EvalNodePool = (FEvaluatedNode*)FMemory_Alloca(sizeof(FEvaluatedNode) * PathNodes.Num());
-		int32 EvalNodePoolIndex = 0;
-
-		TMap<const UUTPathNode*, FEvaluatedNode*> NodeMap;
+			return false;
+		}
 
-		FEvaluatedNode* CurrentNode = new(EvalNodePool + EvalNodePoolIndex++) FEvaluatedNode(StartNode, StartPoly, NodeMap);
-		CurrentNode->TotalDistance = 0;
-		FEvaluatedNode* LastAdd = CurrentNode;
-		FEvaluatedNode* BestDest = NULL;
-		while (CurrentNode != NULL)
-		{
-			CurrentNode->bAlreadyVisited = true;
-			float ThisWeight = NodeEval.Eval(Asker, AgentProps, RequestOwner, CurrentNode->Node, (CurrentNode->TotalDistance == 0) ? StartLoc : GetPolyCenter(CurrentNode->Poly), CurrentNode->TotalDistance);
+		// reuse the navmesh's tables unless a NodeEval callback is already pathing with them
+		FUTPathSearchState LocalSearchState;
+		FUTPathSearchState& Search = PathSearchState.bInUse ? LocalSearchState : PathSearchState;
+		TGuardValue<bool> SearchInUse(Search.bInUse, true);
+		Search.BeginQuery(PathNodes.Num());
+
+		// A* toward the goal if the evaluator only accepts one node and we have landmark data for this graph
+		const UUTPathNode* HeuristicGoal = PathLandmarks.IsValid() ? NodeEval.GetHeuristicGoal() : NULL;
+		const int32 HeuristicGoalIndex = (HeuristicGoal != NULL && PathLandmarks.NumNodes == PathNodes.Num()) ? GetSearchIndex(HeuristicGoal) : INDEX_NONE;
+
+		FUTPathSearchNode& StartEntry = Search.Touch(StartIndex, StartPoly);
+		StartEntry.TotalDistance = 0;
+		StartEntry.HeapCost = 0;
+		Search.PushOrDecrease(StartIndex);
+		int32 BestDest = INDEX_NONE;
+		for (int32 CurrentIndex = Search.PopMin(); CurrentIndex != INDEX_NONE; CurrentIndex = Search.PopMin())
+		{
+			// Nodes is sized up front so entry references stay valid while we touch neighbors
+			FUTPathSearchNode& CurrentNode = Search.Nodes[CurrentIndex];
+			const UUTPathNode* CurrentPathNode = PathNodes[CurrentIndex];
+			CurrentNode.bAlreadyVisited = true;
+			float ThisWeight = NodeEval.Eval(Asker, AgentProps, RequestOwner, CurrentPathNode, (CurrentNode.TotalDistance == 0) ? StartLoc : GetPolyCenter(CurrentNode.Poly), CurrentNode.TotalDistance);
 			if (ThisWeight > Weight)
 			{
 				Weight = ThisWeight;
-				BestDest = CurrentNode;
+				BestDest = CurrentIndex;
 				if (ThisWeight > 1.0f)
 				{
 					break;
@@ -2205,114 +2572,77 @@ bool AUTRecastNavMesh::FindBestPath(APawn* Asker, const FNavAgentProperties& Age
 			}
 
 			int32 NextDistance = 0;
-			for (int32 i = 0; i < CurrentNode->Node->Paths.Num(); i++)
+			for (int32 i = 0; i < CurrentPathNode->Paths.Num(); i++)
 			{
-				if (CurrentNode->Node->Paths[i].End.IsValid() && CurrentNode->Node->Paths[i].Supports(ReachParams.Radius, ReachParams.HalfHeight, ReachParams.InitialHalfHeight, ReachParams.MoveFlags))
+				const FUTPathLink& Link = CurrentPathNode->Paths[i];
+				if (Link.End.IsValid() && Link.Supports(ReachParams.Radius, ReachParams.HalfHeight, ReachParams.InitialHalfHeight, ReachParams.MoveFlags))
 				{
-					FEvaluatedNode* NextNode = NodeMap.FindRef(CurrentNode->Node->Paths[i].End.Get());
-					if (NextNode == NULL)
+					const int32 NextIndex = GetSearchIndex(Link.End.Get());
+					if (NextIndex == INDEX_NONE)
 					{
-						NextNode = new(EvalNodePool + EvalNodePoolIndex++) FEvaluatedNode(CurrentNode->Node->Paths[i].End.Get(), CurrentNode->Node->Paths[i].EndPoly, NodeMap);
+						continue;
 					}
-					if (!NextNode->bAlreadyVisited)
+					FUTPathSearchNode& NextNode = Search.Touch(NextIndex, Link.EndPoly);
+					if (!NextNode.bAlreadyVisited)
 					{
-						NextDistance = CurrentNode->Node->Paths[i].CostFor(Asker, AgentProps, ReachParams, RequestOwner, CurrentNode->Poly, this);
+						NextDistance = Link.CostFor(Asker, AgentProps, ReachParams, RequestOwner, CurrentNode.Poly, this);
 						if (NextDistance < BLOCKED_PATH_COST)
 						{
-							NextDistance += NodeEval.GetTransientCost(CurrentNode->Node->Paths[i], Asker, AgentProps, RequestOwner, CurrentNode->Poly, NextDistance + CurrentNode->TotalDistance);
+							NextDistance += NodeEval.GetTransientCost(Link, Asker, AgentProps, RequestOwner, CurrentNode.Poly, NextDistance + CurrentNode.TotalDistance);
 						}
 						if (NextDistance < BLOCKED_PATH_COST)
 						{
 							// don't allow zero or negative distance - could create a loop
 							if (NextDistance <= 0)
 							{
-								UE_LOG(UT, Warning, TEXT("FindBestPath(): negative weight %d from %s to %s (%s)"), NextDistance, *CurrentNode->Node->GetName(), *NextNode->Node->GetName(), *GetNameSafe(CurrentNode->Node->Paths[i].Spec.Get()));
+								UE_LOG(UT, Warning, TEXT("FindBestPath(): negative weight %d from %s to %s (%s)"), NextDistance, *CurrentPathNode->GetName(), *Link.End->GetName(), *GetNameSafe(Link.Spec.Get()));
 
 								NextDistance = 1;
 							}
 
-							int32 NewTotalDistance = NextDistance + CurrentNode->TotalDistance;
-							if (NextNode->TotalDistance > NewTotalDistance)
+							int32 NewTotalDistance = NextDistance + CurrentNode.TotalDistance;
+							if (NextNode.TotalDistance > NewTotalDistance)
 							{
-								NextNode->Poly = CurrentNode->Node->Paths[i].EndPoly;
-								NextNode->PrevPath = CurrentNode;
-								if (NextNode->PrevOrdered) //remove from old position
-								{
-									NextNode->PrevOrdered->NextOrdered = NextNode->NextOrdered;
-									if (NextNode->NextOrdered)
-									{
-										NextNode->NextOrdered->PrevOrdered = NextNode->PrevOrdered;
-									}
-									if (LastAdd == NextNode || LastAdd->TotalDistance > NextNode->TotalDistance)
-									{
-										LastAdd = NextNode->PrevOrdered;
-									}
-									NextNode->PrevOrdered = NULL;
-									NextNode->NextOrdered = NULL;
-								}
-								NextNode->TotalDistance = NewTotalDistance;
-
-								// LastAdd is a good starting point for searching the list and inserting this node
-								FEvaluatedNode* InsertAtNode = LastAdd;
-								if (InsertAtNode->TotalDistance <= NewTotalDistance)
-								{
-									while (InsertAtNode->NextOrdered != NULL && InsertAtNode->NextOrdered->TotalDistance < NewTotalDistance)
-									{
-										InsertAtNode = InsertAtNode->NextOrdered;
-									}
-								}
-								else
-								{
-									while (InsertAtNode->PrevOrdered != NULL && InsertAtNode->TotalDistance > NewTotalDistance)
-									{
-										InsertAtNode = InsertAtNode->PrevOrdered;
-									}
-								}
-
-								if (InsertAtNode->NextOrdered != NextNode)
-								{
-									if (InsertAtNode->NextOrdered != NULL)
-									{
-										InsertAtNode->NextOrdered->PrevOrdered = NextNode;
-									}
-									NextNode->NextOrdered = InsertAtNode->NextOrdered;
-									InsertAtNode->NextOrdered = NextNode;
-									NextNode->PrevOrdered = InsertAtNode;
-								}
-								LastAdd = NextNode;
+								NextNode.Poly = Link.EndPoly;
+								NextNode.PrevPath = CurrentIndex;
+								NextNode.TotalDistance = NewTotalDistance;
+								NextNode.HeapCost = NewTotalDistance + ((HeuristicGoalIndex != INDEX_NONE) ? PathLandmarks.GetLowerBound(NextIndex, HeuristicGoalIndex) : 0);
+								Search.PushOrDecrease(NextIndex);
 							}
 						}
 					}
 				}
 			}
-			CurrentNode = CurrentNode->NextOrdered;
 		}
 
-		if (BestDest == NULL)
+		if (BestDest == INDEX_NONE)
 		{
 			return false;
 		}
 		else
 		{
-			FEvaluatedNode* NextRouteNode = BestDest;
-			while (NextRouteNode->PrevPath != NULL) // don't need first node, we're already there
+			int32 NextRouteIndex = BestDest;
+			while (Search.Nodes[NextRouteIndex].PrevPath != INDEX_NONE) // don't need first node, we're already there
 			{
-				NodeRoute.Insert(FRouteCacheItem(NextRouteNode->Node, GetPolyCenter(NextRouteNode->Poly), NextRouteNode->Poly), 0);
+				const FUTPathSearchNode& RouteEntry = Search.Nodes[NextRouteIndex];
+				NodeRoute.Insert(FRouteCacheItem(PathNodes[NextRouteIndex], GetPolyCenter(RouteEntry.Poly), RouteEntry.Poly), 0);
 				if (NodeCosts != NULL)
 				{
-					NodeCosts->Insert(NextRouteNode->TotalDistance - NextRouteNode->PrevPath->TotalDistance, 0);
+					NodeCosts->Insert(RouteEntry.TotalDistance - Search.Nodes[RouteEntry.PrevPath].TotalDistance, 0);
 				}
-				NextRouteNode = NextRouteNode->PrevPath;
+				NextRouteIndex = RouteEntry.PrevPath;
 			}
+			const UUTPathNode* RouteStartNode = PathNodes[NextRouteIndex];
+			const NavNodeRef RouteStartPoly = Search.Nodes[NextRouteIndex].Poly;
 
 			// ask any ReachSpecs along path if there is an Actor target to assign to the route point
 			if (NodeRoute.Num() > 0)
 			{
 				{
-					int32 LinkIndex = NextRouteNode->Node->GetBestLinkTo(NextRouteNode->Poly, NodeRoute[0], Asker, AgentProps, this);
-					if (LinkIndex != INDEX_NONE && NextRouteNode->Node->Paths[LinkIndex].Spec.IsValid())
+					int32 LinkIndex = RouteStartNode->GetBestLinkTo(RouteStartPoly, NodeRoute[0], Asker, AgentProps, this);
+					if (LinkIndex != INDEX_NONE && RouteStartNode->Paths[LinkIndex].Spec.IsValid())
 					{
-						NodeRoute[0].Actor = NextRouteNode->Node->Paths[LinkIndex].Spec->GetDestActor();
+						NodeRoute[0].Actor = RouteStartNode->Paths[LinkIndex].Spec->GetDestActor();
 					}
 				}
 				for (int32 i = 1; i < NodeRoute.Num(); i++)
@@ -2336,13 +2666,23 @@ bool AUTRecastNavMesh::FindBestPath(APawn* Asker, const FNavAgentProperties& Age
 				new(NodeRoute) FRouteCacheItem(RouteGoal, RouteGoalLoc, FindNearestPoly(RouteGoalLoc, FVector(AgentProps.AgentRadius, AgentProps.AgentRadius, AgentProps.AgentHeight)));
 				if (NodeCosts != NULL)
 				{
-					NodeCosts->Add(FMath::TruncToInt((NodeRoute.Last().GetLocation(Asker) - GetPolyCenter(NextRouteNode->Poly)).Size()));
+					NodeCosts->Add(FMath::TruncToInt((NodeRoute.Last().GetLocation(Asker) - GetPolyCenter(RouteStartPoly)).Size()));
 				}
 			}
 
+			if (CVarUTRecordPathQueries.GetValueOnGameThread() != 0)
+			{
+				FUTRecordedPathQuery Query;
+				Query.StartLoc = StartLoc;
+				Query.GoalLoc = (NodeRoute.Num() > 0) ? NodeRoute.Last().GetLocation(NULL) : GetPolyCenter(RouteStartPoly);
+				Query.AgentRadius = AgentProps.AgentRadius;
+				Query.AgentHeight = AgentProps.AgentHeight;
+				RecordedPathQueries.Add(Query);
+			}
+
 			if (bNeedMoveToStartNode || NodeRoute.Num() == 0) // make sure success always returns a route
 			{
-				NodeRoute.Insert(FRouteCacheItem(NextRouteNode->Node, GetPolyCenter(NextRouteNode->Poly), NextRouteNode->Poly), 0);
+				NodeRoute.Insert(FRouteCacheItem(RouteStartNode, GetPolyCenter(RouteStartPoly), RouteStartPoly), 0);
 				if (NodeCosts != NULL)
 				{
 					NodeCosts->Insert(FMath::TruncToInt((NodeRoute[0].GetLocation(Asker) - StartLoc).Size()), 0);
@@ -2361,7 +2701,7 @@ bool AUTRecastNavMesh::FindBestPath(APawn* Asker, const FNavAgentProperties& Age
 				const float RespawnPredictionTime = (B != nullptr) ? B->RespawnPredictionTime : 0.0f;
 				AActor* BestDetour = NULL;
 				float BestDetourWeight = 0.0f;
-				for (TWeakObjectPtr<AActor> POI : NextRouteNode->Node->POIs)
+				for (TWeakObjectPtr<AActor> POI : RouteStartNode->POIs)
 				{
 					if (POI.IsValid())
 					{
@@ -2425,7 +2765,7 @@ bool AUTRecastNavMesh::FindBestPath(APawn* Asker, const FNavAgentProperties& Age
 				{
 					// intentional double height to be sure we get a poly
 					NavNodeRef DetourPoly = FindNearestPoly(BestDetour->GetActorLocation(), FVector(AgentProps.AgentRadius, AgentProps.AgentRadius, AgentProps.AgentHeight));
-					if (DetourPoly != INVALID_NAVNODEREF && NextRouteNode->Node->Polys.Contains(DetourPoly))
+					if (DetourPoly != INVALID_NAVNODEREF && RouteStartNode->Polys.Contains(DetourPoly))
 					{
 						NodeRoute.Insert(FRouteCacheItem(BestDetour, BestDetour->GetActorLocation(), DetourPoly), 0);
 						if (NodeCosts != NULL)
@@ -2821,6 +3161,7 @@ void AUTRecastNavMesh::BeginPlay()
 	if (GetNetMode() != NM_Client)
 	{
 		LoadMapLearningData();
+		LoadPathLandmarks();
 	}
 }
 
@@ -2886,6 +3227,78 @@ void AUTRecastNavMesh::SaveMapLearningData()
 	}
 }
 
+FString AUTRecastNavMesh::GetPathLandmarkFilename() const
+{
+	// same keying as the learning data, but the table only depends on the node network so isn't per game mode
+	return FPaths::GameSavedDir() + GetOutermost()->GetGuid().ToString() + TEXT(".alt");
+}
+
+void AUTRecastNavMesh::BuildPathLandmarks(bool bSave)
+{
+	DECLARE_CYCLE_STAT(TEXT("UT path landmark build time"), STAT_Navigation_UTPathLandmarkBuild, STATGROUP_Navigation);
+
+	SCOPE_CYCLE_COUNTER(STAT_Navigation_UTPathLandmarkBuild);
+
+	UpdateSearchIndices();
+	PathLandmarks.Build(this, PathNodes, CVarUTPathLandmarkCount.GetValueOnGameThread());
+	if (bSave && PathLandmarks.IsValid())
+	{
+		FArchive* FileAr = IFileManager::Get().CreateFileWriter(*GetPathLandmarkFilename());
+		if (FileAr != NULL)
+		{
+			uint32 Magic = NavMeshMagicNumberVersion1;
+			*FileAr << Magic;
+			*FileAr << PathLandmarks;
+			delete FileAr;
+		}
+	}
+}
+
+void AUTRecastNavMesh::LoadPathLandmarks()
+{
+	PathLandmarks.Reset();
+	if (CVarUTPathLandmarkCount.GetValueOnGameThread() <= 0 || PathNodes.Num() == 0)
+	{
+		return;
+	}
+
+	// table is stored uncompressed so loading is a single read with no decompression pass
+	const FString Filename = GetPathLandmarkFilename();
+	TArray<uint8> Data;
+	if (FPaths::FileExists(Filename) && FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		FMemoryReader Reader(Data, true);
+		uint32 Magic = 0;
+		Reader << Magic;
+		if (Magic == NavMeshMagicNumberVersion1)
+		{
+			Reader << PathLandmarks;
+		}
+		if (Reader.IsError() || !PathLandmarks.MatchesGraph(this, PathNodes))
+		{
+			PathLandmarks.Reset();
+		}
+	}
+	if (!PathLandmarks.IsValid())
+	{
+		BuildPathLandmarks(true);
+	}
+}
+
+int32 AUTRecastNavMesh::GetPathDistanceLowerBound(const UUTPathNode* StartNode, const UUTPathNode* GoalNode)
+{
+	if (!PathLandmarks.IsValid() || PathLandmarks.NumNodes != PathNodes.Num())
+	{
+		return 0;
+	}
+	else
+	{
+		const int32 StartIndex = GetSearchIndex(StartNode);
+		const int32 GoalIndex = GetSearchIndex(GoalNode);
+		return (StartIndex != INDEX_NONE && GoalIndex != INDEX_NONE) ? PathLandmarks.GetLowerBound(StartIndex, GoalIndex) : 0;
+	}
+}
+
 void AUTRecastNavMesh::LoadMapLearningData()
 {
 	if (GetWorld()->IsGameWorld())
@@ -3120,4 +3533,147 @@ void AUTRecastNavMesh::GetNodeTriangleMap(TMap<const UUTPathNode*, FNavMeshTrian
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+bool AUTRecastNavMesh::SaveRecordedPathQueries(const FString& FileName) const
+{
+	FString Text;
+	for (const FUTRecordedPathQuery& Query : RecordedPathQueries)
+	{
+		Text += FString::Printf(TEXT("%f,%f,%f,%f,%f,%f,%f,%f\n"), Query.StartLoc.X, Query.StartLoc.Y, Query.StartLoc.Z, Query.GoalLoc.X, Query.GoalLoc.Y, Query.GoalLoc.Z, Query.AgentRadius, Query.AgentHeight);
+	}
+	return FFileHelper::SaveStringToFile(Text, *FileName);
+}
+
+bool AUTRecastNavMesh::LoadRecordedPathQueries(const FString& FileName)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FileName))
+	{
+		return false;
+	}
+	else
+	{
+		RecordedPathQueries.Reset();
+		TArray<FString> Lines;
+		Text.ParseIntoArrayLines(Lines);
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Values;
+			if (Line.ParseIntoArray(Values, TEXT(","), true) == 8)
+			{
+				FUTRecordedPathQuery Query;
+				Query.StartLoc = FVector(FCString::Atof(*Values[0]), FCString::Atof(*Values[1]), FCString::Atof(*Values[2]));
+				Query.GoalLoc = FVector(FCString::Atof(*Values[3]), FCString::Atof(*Values[4]), FCString::Atof(*Values[5]));
+				Query.AgentRadius = FCString::Atof(*Values[6]);
+				Query.AgentHeight = FCString::Atof(*Values[7]);
+				RecordedPathQueries.Add(Query);
+			}
+		}
+		return true;
+	}
+}
+
+double AUTRecastNavMesh::BenchmarkRecordedPathQueries(int32 Iterations, int32& OutSucceeded)
+{
+	// don't record our own replay
+	const int32 OldRecord = CVarUTRecordPathQueries.GetValueOnGameThread();
+	CVarUTRecordPathQueries.AsVariable()->Set(0, ECVF_SetByCode);
+
+	OutSucceeded = 0;
+	TArray<FRouteCacheItem> Route;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; i++)
+	{
+		for (const FUTRecordedPathQuery& Query : RecordedPathQueries)
+		{
+			FNavAgentProperties AgentProps(Query.AgentRadius, Query.AgentHeight);
+			FSingleEndpointEval NodeEval(Query.GoalLoc);
+			float Weight = 0.0f;
+			if (FindBestPath(NULL, AgentProps, NULL, NodeEval, Query.StartLoc, Weight, false, Route))
+			{
+				OutSucceeded++;
+			}
+		}
+	}
+	const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+	CVarUTRecordPathQueries.AsVariable()->Set(OldRecord, ECVF_SetByCode);
+	return TotalTime;
+}
+
+static FString GetPathQueryFileName(UWorld* InWorld, const TArray<FString>& Args, int32 ArgIndex)
+{
+	if (Args.IsValidIndex(ArgIndex))
+	{
+		return Args[ArgIndex];
+	}
+	else
+	{
+		return FPaths::GameSavedDir() / TEXT("PathQueries") / (InWorld->GetMapName() + TEXT(".txt"));
+	}
+}
+
+static void HandleSavePathQueriesCommand(const TArray<FString>& Args, UWorld* InWorld)
+{
+	AUTRecastNavMesh* NavData = GetUTNavData(InWorld);
+	if (NavData != NULL)
+	{
+		const FString FileName = GetPathQueryFileName(InWorld, Args, 0);
+		if (NavData->SaveRecordedPathQueries(FileName))
+		{
+			UE_LOG(UT, Log, TEXT("Saved %d path queries to %s"), NavData->RecordedPathQueries.Num(), *FileName);
+		}
+		else
+		{
+			UE_LOG(UT, Warning, TEXT("Failed to save path queries to %s"), *FileName);
+		}
+	}
+}
+
+static void HandleBenchmarkPathQueriesCommand(const TArray<FString>& Args, UWorld* InWorld)
+{
+	AUTRecastNavMesh* NavData = GetUTNavData(InWorld);
+	if (NavData != NULL)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max<int32>(1, FCString::Atoi(*Args[0])) : 10;
+		const FString FileName = GetPathQueryFileName(InWorld, Args, 1);
+		if (NavData->RecordedPathQueries.Num() == 0 && !NavData->LoadRecordedPathQueries(FileName))
+		{
+			UE_LOG(UT, Warning, TEXT("No recorded path queries and couldn't load %s"), *FileName);
+		}
+		else if (NavData->RecordedPathQueries.Num() > 0)
+		{
+			int32 Succeeded = 0;
+			const double TotalTime = NavData->BenchmarkRecordedPathQueries(Iterations, Succeeded);
+			const int32 Total = Iterations * NavData->RecordedPathQueries.Num();
+			UE_LOG(UT, Log, TEXT("FindBestPath benchmark: %d queries (%d succeeded) over %d nodes in %.3f ms, %.3f us per query"), Total, Succeeded, NavData->GetAllNodes().Num(), TotalTime * 1000.0, TotalTime * 1000000.0 / Total);
+		}
+	}
+}
+
+static void HandleBuildPathLandmarksCommand(const TArray<FString>& Args, UWorld* InWorld)
+{
+	AUTRecastNavMesh* NavData = GetUTNavData(InWorld);
+	if (NavData != NULL)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		NavData->BuildPathLandmarks(true);
+		UE_LOG(UT, Log, TEXT("Built path landmark table for %d nodes in %.1f ms"), NavData->GetAllNodes().Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+}
+
+FAutoConsoleCommandWithWorldAndArgs BuildPathLandmarksCommand(
+	TEXT("UT.BuildPathLandmarks"),
+	TEXT("Rebuilds and saves the landmark path distance table for the current map."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(HandleBuildPathLandmarksCommand));
+
+FAutoConsoleCommandWithWorldAndArgs SavePathQueriesCommand(
+	TEXT("UT.SavePathQueries"),
+	TEXT("Saves path queries recorded with UT.RecordPathQueries to a file (default Saved/PathQueries/<map>.txt)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(HandleSavePathQueriesCommand));
+
+FAutoConsoleCommandWithWorldAndArgs BenchmarkPathQueriesCommand(
+	TEXT("UT.BenchmarkPathQueries"),
+	TEXT("Replays recorded path queries through FindBestPath and logs the time taken. Args: [iterations] [file]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(HandleBenchmarkPathQueriesCommand));
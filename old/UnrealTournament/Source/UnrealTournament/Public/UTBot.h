@@ -976,10 +976,19 @@ protected:
 	UFUNCTION()
 	void CheckWeaponFiringTimed();
 
+	/** checks the shared bot perception matrix for a recent line of sight result to Other, used by the periodic sight scan */
+	bool CheckSharedLineOfSight(APawn* Other, bool& bVisible);
+
 	virtual void ExecuteWhatToDoNext();
 	bool bPendingWhatToDoNext;
 	/** set during ExecuteWhatToDoNext() to catch decision loops */
 	bool bExecutingWhatToDoNext;
+	/** number of frames the pending decision has been postponed because the shared per frame decision budget was used up (see UT.BotDecisionBudget) */
+	int32 DeferredDecisionFrames;
+	/** frames the pending decision may be postponed before it runs regardless of the budget, rolled per postponed decision so forced decisions don't all land on the same frame */
+	int32 DecisionDelayLimit;
+	/** returns whether a pending decision may run this frame; a postponed bot keeps following its current MoveTarget until it gets a turn */
+	virtual bool CanExecuteDecisionThisFrame();
 
 	/** used to interleave sight checks so not all bots are checking at once */
 	float SightCounter;
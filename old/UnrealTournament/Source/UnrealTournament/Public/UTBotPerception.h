@@ -0,0 +1,67 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+// shared line of sight cache for bots
+// instead of every bot tracing to every other Pawn on its own sight timer, the Pawn pairs are visited once per UT.BotPerceptionInterval
+// and each bot's eyes to the other Pawn's target location is traced asynchronously; results are kept in a visibility matrix all bots read from
+
+class UNREALTOURNAMENT_API FUTBotPerception
+{
+public:
+	/** returns the perception cache for the given world, creating it if needed; NULL if shared perception is disabled */
+	static FUTBotPerception* Get(UWorld* World);
+
+	/** process last frame's trace results and start this frame's share of traces; does nothing if already called this frame */
+	void Update();
+
+	/** looks up the cached line of sight between two Pawns
+	 * @return whether a recent enough result exists, in which case bVisible is set
+	 */
+	bool GetVisibility(const APawn* Viewer, const APawn* Target, bool& bVisible) const;
+
+private:
+	explicit FUTBotPerception(UWorld* InWorld);
+
+	static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+	static TMap<UWorld*, FUTBotPerception*> WorldPerception;
+
+	/** returns Pawn's matrix slot, assigning a free one if it has none */
+	int32 GetSlot(APawn* P);
+	void ReleaseSlot(int32 Slot);
+	/** start the async trace for the matrix entry [ViewerSlot, TargetSlot] */
+	void StartTrace(int32 ViewerSlot, int32 TargetSlot);
+
+	struct FVisibilityEntry
+	{
+		/** world time of the last trace result, negative if never traced */
+		float UpdateTime;
+		bool bVisible;
+	};
+	struct FPendingTrace
+	{
+		FTraceHandle Handle;
+		/** viewer and target slot */
+		int32 SlotA;
+		int32 SlotB;
+		/** Pawns the slots referred to when the trace was started, to discard results if a slot was reused meanwhile */
+		TWeakObjectPtr<APawn> PawnA;
+		TWeakObjectPtr<APawn> PawnB;
+	};
+
+	UWorld* World;
+	uint64 LastUpdateFrame;
+
+	TArray< TWeakObjectPtr<APawn> > Slots;
+	TMap<const APawn*, int32> PawnToSlot;
+	/** whether the Pawn in each slot is controlled by a bot, pairs without a bot aren't traced */
+	TArray<bool> SlotHasBot;
+	/** [ViewerSlot * Slots.Num() + TargetSlot], not symmetric since the trace goes from the viewer's eyes to the target's target location */
+	TArray<FVisibilityEntry> Matrix;
+	/** round robin position over the pairs */
+	int32 NextPairA;
+	int32 NextPairB;
+	/** largest SightRadius of the bots in the world, pairs further apart than this aren't traced */
+	float MaxSightRadius;
+
+	TArray<FPendingTrace> PendingTraces;
+};
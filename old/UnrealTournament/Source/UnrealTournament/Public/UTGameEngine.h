@@ -93,6 +93,22 @@ public:
 
 	/** set to process ID of owning game client when running a "listen" server (which is really dedicated + client on same machine) */
 	uint32 OwningProcessID;
+
+	/** headless bot match mode (-fastsim): the game ticks with a fixed time step (-simfps=, default 30) as fast as the CPU allows
+	 * run with -server or -nullrhi -nosound so nothing is rendered; -simseconds= exits after that much simulated time
+	 */
+	bool bFastSimulation;
+	/** simulated seconds after which fast simulation exits, 0 for no limit */
+	float FastSimulationTimeLimit;
+	/** wall clock time fast simulation started */
+	double FastSimulationStartTime;
+	/** simulated seconds so far in fast simulation */
+	double FastSimulationSeconds;
+	/** wall clock time of the last simulation rate log */
+	double LastFastSimulationReportTime;
+
+	/** log simulated seconds per wall clock second; the final report is also appended to Saved/FastSimulation.csv */
+	void ReportFastSimulationRate(bool bFinal);
 	
 	UTVideoRecordingFeature* VideoRecorder;
 
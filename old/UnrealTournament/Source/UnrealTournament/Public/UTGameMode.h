@@ -643,6 +643,10 @@ public:
 	UFUNCTION(Exec, BlueprintCallable, Category = AI)
 	virtual void KillBots();
 
+	/** frame and seconds spent in AUTBot::ExecuteWhatToDoNext() by this game's bots, for UT.BotDecisionBudget */
+	uint64 BotDecisionBudgetFrame;
+	double BotDecisionBudgetUsed;
+
 	/** Starts a line-up of the specified type*/
 	UFUNCTION(Exec, BlueprintCallable, Category = LineUp)
 	virtual void BeginLineUp(const FString& LineUpTypeName);
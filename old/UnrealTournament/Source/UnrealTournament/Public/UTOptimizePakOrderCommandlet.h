@@ -0,0 +1,22 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "UTOptimizePakOrderCommandlet.generated.h"
+
+/**
+ * Builds a pak order file from the file open logs (-fileopenlog) of many sessions, placing files that are opened
+ * together next to each other, and reports how the new order would do against the current pak layout.
+ *
+ * -run=UTOptimizePakOrder -Traces=<log or directory of logs>[+...] -Output=<order file> [-Pak=<pak>[+...]]
+ *     [-ReadAheadKB=256] [-GroupThreshold=0.5]
+ */
+UCLASS()
+class UUTOptimizePakOrderCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet Interface
+};
@@ -0,0 +1,74 @@
+// landmark (ALT) distance table over the UT path node graph
+// stores shortest path distances from and to a small set of landmark nodes so that a lower bound on the path distance
+// between any two nodes can be computed with the triangle inequality, usable as an A* heuristic or for pruning in node evaluators
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+class UUTPathNode;
+class AUTRecastNavMesh;
+
+struct UNREALTOURNAMENT_API FUTPathLandmarkTable
+{
+	/** distances are stored in units of this many uu, rounded down so the bound stays conservative */
+	static const int32 DistanceScale = 8;
+	/** stored value for nodes that can't reach or be reached by a landmark */
+	static const uint16 UnreachableDistance = MAX_uint16;
+	/** written ahead of the table data, bump when the serialized layout changes */
+	static const uint32 SerializeVersion = 2;
+
+	/** number of path nodes and hash of the link endpoints and costs the table was built for, used to detect stale data */
+	int32 NumNodes;
+	uint32 GraphHash;
+	/** PathNodes indices of the landmarks */
+	TArray<int32> Landmarks;
+	/** [Landmark * NumNodes + Node] distance from landmark to node */
+	TArray<uint16> FromLandmark;
+	/** [Landmark * NumNodes + Node] distance from node to landmark */
+	TArray<uint16> ToLandmark;
+
+	FUTPathLandmarkTable()
+		: NumNodes(0), GraphHash(0)
+	{}
+
+	inline bool IsValid() const
+	{
+		return Landmarks.Num() > 0;
+	}
+	void Reset();
+
+	/** returns whether this table matches the given node graph, including the link costs */
+	bool MatchesGraph(const AUTRecastNavMesh* NavMesh, const TArray<UUTPathNode*>& PathNodes) const;
+
+	/** build the table with up to NumLandmarks landmarks picked by farthest point selection
+	 * link costs are the cheapest traversal cost of each link ignoring agent size and transient costs, lowered to UUTReachSpec::GetMinCost() for special moves, so the resulting bound holds for every query
+	 */
+	void Build(const AUTRecastNavMesh* NavMesh, const TArray<UUTPathNode*>& PathNodes, int32 NumLandmarks);
+
+	/** returns a lower bound on the path distance from the node with index StartIndex to the node with index GoalIndex */
+	inline int32 GetLowerBound(int32 StartIndex, int32 GoalIndex) const
+	{
+		int32 Best = 0;
+		for (int32 i = 0; i < Landmarks.Num(); i++)
+		{
+			const int32 Base = i * NumNodes;
+			// d(L, goal) - d(L, start)
+			const uint16 FromStart = FromLandmark[Base + StartIndex];
+			const uint16 FromGoal = FromLandmark[Base + GoalIndex];
+			if (FromStart != UnreachableDistance && FromGoal != UnreachableDistance)
+			{
+				Best = FMath::Max<int32>(Best, int32(FromGoal) - int32(FromStart));
+			}
+			// d(start, L) - d(goal, L)
+			const uint16 ToStart = ToLandmark[Base + StartIndex];
+			const uint16 ToGoal = ToLandmark[Base + GoalIndex];
+			if (ToStart != UnreachableDistance && ToGoal != UnreachableDistance)
+			{
+				Best = FMath::Max<int32>(Best, int32(ToStart) - int32(ToGoal));
+			}
+		}
+		// scaled values were rounded down independently, take off one unit to stay a lower bound
+		return FMath::Max<int32>(0, (Best - 1) * DistanceScale);
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FUTPathLandmarkTable& Table);
+};
@@ -253,6 +253,11 @@ class UNREALTOURNAMENT_API UUTPathNode : public UObject
 	UPROPERTY(BlueprintReadWrite, SaveGame, Category = AIMapData)
 	float AvgHideDuration;
 
+	/** transient index of this node in AUTRecastNavMesh::PathNodes, used by pathfinding to address its flat search tables
+	 * may be stale after the node network changes; the navmesh validates and rebuilds it on use
+	 */
+	int32 SearchIndex;
+
 	/** returns index to best link in Paths for Asker to move from this node to Target, or INDEX_NONE if no link is found that can be used
 	 * note that there may be multiple links to the other node with different traversability properties; the one with shortest Distance is used
 	 */
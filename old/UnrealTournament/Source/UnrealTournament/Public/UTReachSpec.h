@@ -42,6 +42,13 @@ class UNREALTOURNAMENT_API UUTReachSpec : public UObject
 	{
 		return DefaultCost;
 	}
+	/** return a lower bound on what CostFor() returns for any Asker, used by the path landmark table (FUTPathLandmarkTable)
+	 * specs whose CostFor() can go below DefaultCost must override this, otherwise the landmark A* heuristic overestimates and FindBestPath() can return longer routes
+	 */
+	virtual int32 GetMinCost(int32 DefaultCost, const FUTPathLink& OwnerLink, const class AUTRecastNavMesh* NavMesh) const
+	{
+		return DefaultCost;
+	}
 
 	/** called when AI is in the falling state to allow paths to handle special air control requirements (e.g. air control to wall or movement volume for special move instead of directly towards destination)
 	 * return true to skip normal fall control logic
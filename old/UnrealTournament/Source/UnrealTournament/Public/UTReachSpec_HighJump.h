@@ -195,6 +195,13 @@ class UNREALTOURNAMENT_API UUTReachSpec_HighJump : public UUTReachSpec
 		}
 	}
 
+	virtual int32 GetMinCost(int32 DefaultCost, const FUTPathLink& OwnerLink, const class AUTRecastNavMesh* NavMesh) const override
+	{
+		// translocating only counts half the jump distance plus a throw time of at least 450, which can be less than walking the link
+		const int32 JumpDist = FMath::TruncToInt((JumpEnd - JumpStart).Size());
+		return FMath::Min<int32>(DefaultCost, 450 + (DefaultCost - JumpDist) + (JumpDist / 2));
+	}
+
 	virtual bool WaitForMove(const FUTPathLink& OwnerLink, APawn* Asker, const FComponentBasedPosition& MovePos, const FRouteCacheItem& Target) const override
 	{
 		if (Asker == NULL)
@@ -9,6 +9,7 @@
 #include "UTReachSpec.h"
 #include "AI/Navigation/NavigationTypes.h"
 #include "UTPathNode.h"
+#include "UTPathLandmarks.h"
 #include "AI/Navigation/RecastNavMesh.h"
 
 #include "UTRecastNavMesh.generated.h"
@@ -178,6 +179,14 @@ struct UNREALTOURNAMENT_API FUTNodeEvaluator
 	{
 		return false;
 	}
+
+	/** optional function for evaluators whose only acceptable endpoint is a single node, called after InitForPathfinding()
+	 * if a node is returned pathfinding directs the search toward it using the navmesh's landmark distance table
+	 */
+	virtual const UUTPathNode* GetHeuristicGoal() const
+	{
+		return NULL;
+	}
 };
 
 /** basic node evaluator for single endpoint */
@@ -207,6 +216,12 @@ struct UNREALTOURNAMENT_API FSingleEndpointEval : public FUTNodeEvaluator
 		}
 	}
 
+	virtual const UUTPathNode* GetHeuristicGoal() const override
+	{
+		// partial paths need every node to be evaluated in distance order
+		return bAllowPartial ? NULL : GoalNode;
+	}
+
 	explicit FSingleEndpointEval(AActor* InGoalActor, bool bInAllowPartial = false)
 		: GoalActor(InGoalActor), GoalLoc(InGoalActor->GetActorLocation()), bAllowPartial(bInAllowPartial), GoalNode(nullptr), StartingDist(0.0f), bFoundGoalNode(false)
 	{}
@@ -323,6 +338,81 @@ struct FNavMeshTriangleList
 	TArray<FTriangle> Triangles;
 };
 
+/** per node state of a FindBestPath() query, indexed by UUTPathNode::SearchIndex */
+struct FUTPathSearchNode
+{
+	/** query that last initialized this entry; entries from older queries are reset on first touch instead of clearing the whole table */
+	uint32 Generation;
+	NavNodeRef Poly;
+	int32 TotalDistance;
+	/** TotalDistance plus the heuristic estimate to the goal, if any; the open list is ordered on this */
+	int32 HeapCost;
+	/** SearchIndex of the node this one was reached from, INDEX_NONE for the start node */
+	int32 PrevPath;
+	/** position in the open list heap, INDEX_NONE if not queued */
+	int32 HeapIndex;
+	bool bAlreadyVisited;
+};
+
+/** search tables reused across FindBestPath() queries so a query doesn't need to allocate or hash anything */
+struct UNREALTOURNAMENT_API FUTPathSearchState
+{
+	TArray<FUTPathSearchNode> Nodes;
+	/** binary min heap of SearchIndex values keyed on HeapCost */
+	TArray<int32> OpenList;
+	uint32 Generation;
+	/** set while a query is running so reentrant queries (e.g. from a node evaluator) use their own state */
+	bool bInUse;
+
+	FUTPathSearchState()
+		: Generation(0), bInUse(false)
+	{}
+
+	/** start a new query over NumNodes nodes */
+	void BeginQuery(int32 NumNodes);
+	/** returns the entry for the given index, initializing it if it wasn't used yet this query */
+	FUTPathSearchNode& Touch(int32 Index, NavNodeRef InPoly);
+	/** add Index to the open list, or move it up if it is already queued and its HeapCost was reduced */
+	void PushOrDecrease(int32 Index);
+	/** remove and return the queued index with the lowest HeapCost, INDEX_NONE if the open list is empty */
+	int32 PopMin();
+
+private:
+	void SiftUp(int32 HeapPos);
+	void SiftDown(int32 HeapPos);
+};
+
+/** timings and counts of the last UT path build, logged and appended to Saved/PathBuildMetrics.csv */
+struct FUTPathBuildMetrics
+{
+	int32 NumNodes;
+	int32 NumLinks;
+	int32 NumJumpLinks;
+	/** BuildNodeNetwork() excluding special links */
+	double NodeNetworkTime;
+	/** BuildSpecialLinks() pass that tests jumps from poly walls */
+	double WallJumpTime;
+	/** BuildSpecialLinks() pass that tests jumps back up existing jump down links; split into steps when run in parallel */
+	int32 JumpUpCandidates;
+	double JumpUpGatherTime;
+	double JumpUpTraceTime;
+	double JumpUpApplyTime;
+
+	FUTPathBuildMetrics()
+	{
+		FMemory::Memzero(*this);
+	}
+};
+
+/** a bot path query recorded for FindBestPath() benchmarking, see UT.RecordPathQueries */
+struct FUTRecordedPathQuery
+{
+	FVector StartLoc;
+	FVector GoalLoc;
+	float AgentRadius;
+	float AgentHeight;
+};
+
 UCLASS()
 class UNREALTOURNAMENT_API AUTRecastNavMesh : public ARecastNavMesh
 {
@@ -408,6 +498,14 @@ class UNREALTOURNAMENT_API AUTRecastNavMesh : public ARecastNavMesh
 	/** saves AI learning data for the current map */
 	virtual void SaveMapLearningData();
 
+	virtual FString GetPathLandmarkFilename() const;
+	/** loads the landmark distance table for the current map, building and saving it if missing or out of date */
+	virtual void LoadPathLandmarks();
+	/** rebuilds the landmark distance table from the current node network */
+	virtual void BuildPathLandmarks(bool bSave);
+	/** returns a lower bound on the path distance between two nodes for any agent, 0 if unknown */
+	int32 GetPathDistanceLowerBound(const UUTPathNode* StartNode, const UUTPathNode* GoalNode);
+
 	// add or remove an Actor from the list of POIs
 	// some pathfinding functions (inventory searches, for example) use this list to efficiently find possible endpoints
 	virtual void AddToNavigation(AActor* NewPOI);
@@ -475,6 +573,14 @@ public:
 	 */
 	virtual bool FindBestPath(APawn* Asker, const FNavAgentProperties& AgentProps, AController* RequestOwner, FUTNodeEvaluator& NodeEval, const FVector& StartLoc, float& Weight, bool bAllowDetours, TArray<FRouteCacheItem>& NodeRoute, TArray<int32>* NodeCosts = NULL);
 
+	/** queries recorded while UT.RecordPathQueries is enabled */
+	TArray<FUTRecordedPathQuery> RecordedPathQueries;
+	/** save/load RecordedPathQueries to a text file (one query per line) for replay with UT.BenchmarkPathQueries */
+	bool SaveRecordedPathQueries(const FString& FileName) const;
+	bool LoadRecordedPathQueries(const FString& FileName);
+	/** replay RecordedPathQueries through FindBestPath() with a single endpoint evaluator, returns total seconds spent */
+	double BenchmarkRecordedPathQueries(int32 Iterations, int32& OutSucceeded);
+
 	/** calculate effective traveling distance between two polys
 	 * returns direct distance if reachable by straight line or no navmesh path exists, otherwise does navmesh pathfinding and returns path distance
 	 * this function is designed for calculating UTPathLink distances between known accessible nodes during path building and isn't intended for gameplay
@@ -535,6 +641,20 @@ protected:
 	TMap<TWeakObjectPtr<AActor>, UUTPathNode*> POIToNode;
 	/** transient PhysicsVolume to Node table, primarily for water volume pathing */
 	TMultiMap<TWeakObjectPtr<APhysicsVolume>, UUTPathNode*> VolumeToNode;
+	/** transient search tables reused by FindBestPath() */
+	FUTPathSearchState PathSearchState;
+	/** metrics of the last path build */
+	FUTPathBuildMetrics LastPathBuildMetrics;
+	void RecordPathBuildMetrics();
+	/** landmark distances for A* heuristics, stored next to the map learning data */
+	FUTPathLandmarkTable PathLandmarks;
+
+	/** returns Node's index in PathNodes, rebuilding the cached UUTPathNode::SearchIndex values if they are stale
+	 * returns INDEX_NONE if the node isn't part of this navmesh's graph
+	 */
+	int32 GetSearchIndex(const UUTPathNode* Node);
+	/** refresh UUTPathNode::SearchIndex for all nodes */
+	void UpdateSearchIndices();
 
 	/** get size of poly edge link clamped to one of the SizeSteps
 	 * inputs are all assumed valid